@@ -0,0 +1,242 @@
+//------------------------------------------------------------------------
+// AINodeGrid
+//
+// Created:	2026/10/17
+// Author:	agent
+//
+// Uniform grid over path node positions on the XZ plane.
+//------------------------------------------------------------------------
+
+#include "AINodeGrid.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace week2;
+
+// Average number of nodes per cell the grid is sized for
+static const float s_fNodesPerCell = 2.0f;
+
+//------------------------------------------------------------------------------
+// Method:    AINodeGrid
+// Returns:
+//
+// Constructor. Empty until built.
+//------------------------------------------------------------------------------
+AINodeGrid::AINodeGrid()
+	:
+	m_vMin(0.0f, 0.0f),
+	m_fCellSize(1.0f),
+	m_iCellsX(0),
+	m_iCellsZ(0)
+{
+}
+
+//------------------------------------------------------------------------------
+// Method:    Build
+// Parameter: const std::vector<glm::vec3> & p_lPositions
+// Parameter: const std::vector<int> & p_lNodes
+// Returns:   void
+//
+// Builds the grid over the given nodes (indices into p_lPositions). Queries
+// return those same indices.
+//------------------------------------------------------------------------------
+void AINodeGrid::Build(const std::vector<glm::vec3>& p_lPositions, const std::vector<int>& p_lNodes)
+{
+	m_lCellStart.clear();
+	m_lCellNodes.clear();
+	m_lCellPositions.clear();
+	m_iCellsX = m_iCellsZ = 0;
+	if (p_lNodes.empty())
+	{
+		return;
+	}
+
+	// Bounds of the nodes
+	glm::vec2 vMax;
+	m_vMin = vMax = glm::vec2(p_lPositions[p_lNodes[0]].x, p_lPositions[p_lNodes[0]].z);
+	for (unsigned int i = 1; i < p_lNodes.size(); ++i)
+	{
+		const glm::vec3& vPos = p_lPositions[p_lNodes[i]];
+		m_vMin = glm::min(m_vMin, glm::vec2(vPos.x, vPos.z));
+		vMax = glm::max(vMax, glm::vec2(vPos.x, vPos.z));
+	}
+
+	// Square cells, enough of them to hold a couple of nodes each on average
+	glm::vec2 vSize = vMax - m_vMin;
+	float fArea = std::max(vSize.x, 1.0f) * std::max(vSize.y, 1.0f);
+	m_fCellSize = std::max(sqrtf(fArea * s_fNodesPerCell / p_lNodes.size()), 0.001f);
+	m_iCellsX = (int)(vSize.x / m_fCellSize) + 1;
+	m_iCellsZ = (int)(vSize.y / m_fCellSize) + 1;
+
+	// Count the nodes per cell, then place them
+	std::vector<int> lNodeCells(p_lNodes.size());
+	m_lCellStart.assign(m_iCellsX * m_iCellsZ + 1, 0);
+	for (unsigned int i = 0; i < p_lNodes.size(); ++i)
+	{
+		const glm::vec3& vPos = p_lPositions[p_lNodes[i]];
+		lNodeCells[i] = CellZ(vPos.z) * m_iCellsX + CellX(vPos.x);
+		m_lCellStart[lNodeCells[i] + 1]++;
+	}
+	for (unsigned int i = 1; i < m_lCellStart.size(); ++i)
+	{
+		m_lCellStart[i] += m_lCellStart[i - 1];
+	}
+
+	std::vector<int> lNext(m_lCellStart.begin(), m_lCellStart.end() - 1);
+	m_lCellNodes.resize(p_lNodes.size());
+	m_lCellPositions.resize(p_lNodes.size());
+	for (unsigned int i = 0; i < p_lNodes.size(); ++i)
+	{
+		int iSlot = lNext[lNodeCells[i]]++;
+		m_lCellNodes[iSlot] = p_lNodes[i];
+		m_lCellPositions[iSlot] = p_lPositions[p_lNodes[i]];
+	}
+}
+
+//------------------------------------------------------------------------------
+// Method:    FindNearest
+// Parameter: const glm::vec3 & p_vPosition
+// Returns:   int
+//
+// Returns the node nearest the given position on the XZ plane, or -1 if the
+// grid is empty. Searches outwards a ring of cells at a time, stopping once no
+// closer node could be in the next ring.
+//------------------------------------------------------------------------------
+int AINodeGrid::FindNearest(const glm::vec3& p_vPosition) const
+{
+	if (m_lCellNodes.empty())
+	{
+		return -1;
+	}
+
+	int iBest = -1;
+	float fBestDistSq = 0.0f;
+	int iX = CellX(p_vPosition.x), iZ = CellZ(p_vPosition.z);
+	int iMaxRing = std::max(m_iCellsX, m_iCellsZ);
+
+	for (int iRing = 0; iRing <= iMaxRing; ++iRing)
+	{
+		// Anything in this ring is at least this far away
+		float fRingDist = (iRing - 1) * m_fCellSize;
+		if (iBest != -1 && fRingDist > 0.0f && fRingDist * fRingDist >= fBestDistSq)
+		{
+			break;
+		}
+
+		if (iRing == 0)
+		{
+			CheckCell(iX, iZ, p_vPosition, iBest, fBestDistSq);
+			continue;
+		}
+
+		// Top and bottom rows of the ring, then the sides between them
+		for (int x = iX - iRing; x <= iX + iRing; ++x)
+		{
+			CheckCell(x, iZ - iRing, p_vPosition, iBest, fBestDistSq);
+			CheckCell(x, iZ + iRing, p_vPosition, iBest, fBestDistSq);
+		}
+		for (int z = iZ - iRing + 1; z <= iZ + iRing - 1; ++z)
+		{
+			CheckCell(iX - iRing, z, p_vPosition, iBest, fBestDistSq);
+			CheckCell(iX + iRing, z, p_vPosition, iBest, fBestDistSq);
+		}
+	}
+
+	return iBest;
+}
+
+//------------------------------------------------------------------------------
+// Method:    FindInRadius
+// Parameter: const glm::vec3 & p_vPosition
+// Parameter: float p_fRadius
+// Parameter: std::vector<int> & p_lNodes
+// Returns:   void
+//
+// Adds every node within the given distance of the given position (on the XZ
+// plane) to p_lNodes.
+//------------------------------------------------------------------------------
+void AINodeGrid::FindInRadius(const glm::vec3& p_vPosition, float p_fRadius, std::vector<int>& p_lNodes) const
+{
+	if (m_lCellNodes.empty())
+	{
+		return;
+	}
+
+	float fRadiusSq = p_fRadius * p_fRadius;
+	int iMaxX = CellX(p_vPosition.x + p_fRadius), iMaxZ = CellZ(p_vPosition.z + p_fRadius);
+	for (int z = CellZ(p_vPosition.z - p_fRadius); z <= iMaxZ; ++z)
+	{
+		for (int x = CellX(p_vPosition.x - p_fRadius); x <= iMaxX; ++x)
+		{
+			int iCell = z * m_iCellsX + x;
+			for (int i = m_lCellStart[iCell]; i < m_lCellStart[iCell + 1]; ++i)
+			{
+				float fDX = m_lCellPositions[i].x - p_vPosition.x;
+				float fDZ = m_lCellPositions[i].z - p_vPosition.z;
+				if (fDX * fDX + fDZ * fDZ <= fRadiusSq)
+				{
+					p_lNodes.push_back(m_lCellNodes[i]);
+				}
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Method:    CellX
+// Parameter: float p_fX
+// Returns:   int
+//
+// Returns the column the given X falls in, clamped to the grid.
+//------------------------------------------------------------------------------
+int AINodeGrid::CellX(float p_fX) const
+{
+	int iX = (int)floorf((p_fX - m_vMin.x) / m_fCellSize);
+	return std::min(std::max(iX, 0), m_iCellsX - 1);
+}
+
+//------------------------------------------------------------------------------
+// Method:    CellZ
+// Parameter: float p_fZ
+// Returns:   int
+//
+// Returns the row the given Z falls in, clamped to the grid.
+//------------------------------------------------------------------------------
+int AINodeGrid::CellZ(float p_fZ) const
+{
+	int iZ = (int)floorf((p_fZ - m_vMin.y) / m_fCellSize);
+	return std::min(std::max(iZ, 0), m_iCellsZ - 1);
+}
+
+//------------------------------------------------------------------------------
+// Method:    CheckCell
+// Parameter: int p_iX
+// Parameter: int p_iZ
+// Parameter: const glm::vec3 & p_vPosition
+// Parameter: int & p_iBest
+// Parameter: float & p_fBestDistSq
+// Returns:   void
+//
+// Updates the best node so far with any closer one in the given cell, if the
+// cell is in the grid.
+//------------------------------------------------------------------------------
+void AINodeGrid::CheckCell(int p_iX, int p_iZ, const glm::vec3& p_vPosition, int& p_iBest, float& p_fBestDistSq) const
+{
+	if (p_iX < 0 || p_iX >= m_iCellsX || p_iZ < 0 || p_iZ >= m_iCellsZ)
+	{
+		return;
+	}
+
+	int iCell = p_iZ * m_iCellsX + p_iX;
+	for (int i = m_lCellStart[iCell]; i < m_lCellStart[iCell + 1]; ++i)
+	{
+		float fDX = m_lCellPositions[i].x - p_vPosition.x;
+		float fDZ = m_lCellPositions[i].z - p_vPosition.z;
+		float fDistSq = fDX * fDX + fDZ * fDZ;
+		if (p_iBest == -1 || fDistSq < p_fBestDistSq)
+		{
+			p_iBest = m_lCellNodes[i];
+			p_fBestDistSq = fDistSq;
+		}
+	}
+}
@@ -0,0 +1,57 @@
+//------------------------------------------------------------------------
+// AINodeGrid
+//
+// Created:	2026/10/17
+// Author:	agent
+//
+// Uniform grid over path node positions on the XZ plane, for finding the
+// nearest node to a point or the nodes within a radius without checking
+// every node. Sized at build time to a couple of nodes per cell.
+//------------------------------------------------------------------------
+
+#ifndef AINODEGRID_H
+#define AINODEGRID_H
+
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace week2
+{
+	class AINodeGrid
+	{
+	public:
+		//------------------------------------------------------------------------------
+		// Public methods.
+		//------------------------------------------------------------------------------
+		AINodeGrid();
+
+		void Build(const std::vector<glm::vec3>& p_lPositions, const std::vector<int>& p_lNodes);
+		int FindNearest(const glm::vec3& p_vPosition) const;
+		void FindInRadius(const glm::vec3& p_vPosition, float p_fRadius, std::vector<int>& p_lNodes) const;
+
+	private:
+		//------------------------------------------------------------------------------
+		// Private methods.
+		//------------------------------------------------------------------------------
+		int CellX(float p_fX) const;
+		int CellZ(float p_fZ) const;
+		void CheckCell(int p_iX, int p_iZ, const glm::vec3& p_vPosition, int& p_iBest, float& p_fBestDistSq) const;
+
+	private:
+		//------------------------------------------------------------------------------
+		// Private members.
+		//------------------------------------------------------------------------------
+		glm::vec2 m_vMin;
+		float m_fCellSize;
+		int m_iCellsX;
+		int m_iCellsZ;
+
+		// Nodes in cell (x, z) are m_lCellNodes[m_lCellStart[z * m_iCellsX + x]] up
+		// to the next cell's start, with their positions alongside
+		std::vector<int> m_lCellStart;
+		std::vector<int> m_lCellNodes;
+		std::vector<glm::vec3> m_lCellPositions;
+	};
+}
+
+#endif // AINODEGRID_H
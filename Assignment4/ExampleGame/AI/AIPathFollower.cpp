@@ -0,0 +1,122 @@
+//------------------------------------------------------------------------
+// AIPathFollower
+//
+// Created:	2026/10/17
+// Author:	agent
+//
+// Steers one agent towards a target through AIPathfinder.
+//------------------------------------------------------------------------
+
+#include "AIPathFollower.h"
+
+using namespace week2;
+
+//------------------------------------------------------------------------------
+// Method:    AIPathFollower
+// Returns:
+//
+// Constructor. Starts without a path.
+//------------------------------------------------------------------------------
+AIPathFollower::AIPathFollower()
+	:
+	m_vPathGoal(0.0f, 0.0f, 0.0f)
+{
+}
+
+//------------------------------------------------------------------------------
+// Method:    GetMoveTarget
+// Parameter: Common::GameObjectHandle p_hAgent
+// Parameter: Common::GameObjectHandle p_hTarget
+// Parameter: const glm::vec3 & p_vPosition
+// Parameter: const glm::vec3 & p_vTarget
+// Returns:   glm::vec3
+//
+// Returns the next position the agent at p_vPosition should move towards to
+// reach the target at p_vTarget. Returns p_vPosition if there is nowhere to go
+// yet.
+//------------------------------------------------------------------------------
+glm::vec3 AIPathFollower::GetMoveTarget(Common::GameObjectHandle p_hAgent, Common::GameObjectHandle p_hTarget, const glm::vec3& p_vPosition, const glm::vec3& p_vTarget)
+{
+	AIPathfinder* pPathfinder = AIPathfinder::Instance();
+	if (!pPathfinder->IsFlowFieldMode())
+	{
+		return FollowPath(p_hAgent, p_vPosition, p_vTarget);
+	}
+
+	// Every agent after the same target follows the one field. Our own path
+	// is stale by the time we switch back.
+	m_lPath.clear();
+
+	glm::vec3 vMoveTarget = p_vPosition;
+	pPathfinder->GetNextHop(p_hTarget, p_vTarget, p_vPosition, vMoveTarget);
+	return vMoveTarget;
+}
+
+//------------------------------------------------------------------------------
+// Method:    Stop
+// Parameter: Common::GameObjectHandle p_hAgent
+// Returns:   void
+//
+// Drops our path and anything the pathfinder still holds for the agent.
+//------------------------------------------------------------------------------
+void AIPathFollower::Stop(Common::GameObjectHandle p_hAgent)
+{
+	m_lPath.clear();
+	AIPathfinder::Instance()->ReleaseAgent(p_hAgent);
+}
+
+//------------------------------------------------------------------------------
+// Method:    FollowPath
+// Parameter: Common::GameObjectHandle p_hAgent
+// Parameter: const glm::vec3 & p_vPosition
+// Parameter: const glm::vec3 & p_vTarget
+// Returns:   glm::vec3
+//
+// Keeps our own path to the target up to date and returns the next position
+// along it to move towards.
+//------------------------------------------------------------------------------
+glm::vec3 AIPathFollower::FollowPath(Common::GameObjectHandle p_hAgent, const glm::vec3& p_vPosition, const glm::vec3& p_vTarget)
+{
+	AIPathfinder* pPathfinder = AIPathfinder::Instance();
+
+	// In three cases we want to recalculate our path:
+	//	1. If we don't have a path
+	//  2. If our target position is different from the existing path we are following
+	//  3. If we're at the end of a path that stops short of the target (long
+	//     paths are handed out a cluster at a time)
+	// Asking again while the last request is still being searched is ignored.
+	const AIPathfinder::PathNode* const pEndNode = pPathfinder->GetClosestNode(p_vTarget);
+	if (m_lPath.empty() || pEndNode->m_vPosition != m_vPathGoal || (m_lPath.size() == 1 && m_lPath.back() != m_vPathGoal))
+	{
+		pPathfinder->RequestPath(p_hAgent, p_vPosition, p_vTarget);
+		m_vPathGoal = pEndNode->m_vPosition;
+	}
+
+	// Keep following the old path until the new one is ready
+	bool bHadPath = m_lPath.size() > 1;
+	glm::vec3 vOldNext = bHadPath ? m_lPath.front() : p_vPosition;
+	if (pPathfinder->TakePath(p_hAgent, m_lPath) && bHadPath && m_lPath.size() > 1)
+	{
+		// A new path starts at the node closest to us, which we may already
+		// have passed. If the old path was already heading for its second
+		// node, skip the first rather than turning back.
+		AIPathfinder::PositionList::const_iterator itSecond = ++m_lPath.begin();
+		if (itSecond->x == vOldNext.x && itSecond->z == vOldNext.z)
+		{
+			m_lPath.pop_front();
+		}
+	}
+
+	if (m_lPath.empty())
+	{
+		return p_vPosition;
+	}
+
+	// If we're here then choose the next node instead
+	if (m_lPath.size() > 1 && glm::length(m_lPath.front() - p_vPosition) < 0.5f)
+	{
+		m_lPath.pop_front();
+	}
+
+	return m_lPath.front();
+}
@@ -0,0 +1,51 @@
+//------------------------------------------------------------------------
+// AIPathFollower
+//
+// Created:	2026/10/17
+// Author:	agent
+//
+// Steers one agent towards a target through AIPathfinder. In flow field mode
+// it reads the next hop from the target's shared field; otherwise it keeps
+// the agent's own path up to date and walks along it. Used by the chasing
+// states.
+//------------------------------------------------------------------------
+
+#ifndef AIPATHFOLLOWER_H
+#define AIPATHFOLLOWER_H
+
+#include "AIPathfinder.h"
+#include "GameObjectHandle.h"
+
+namespace week2
+{
+	class AIPathFollower
+	{
+	public:
+		//------------------------------------------------------------------------------
+		// Public methods.
+		//------------------------------------------------------------------------------
+		AIPathFollower();
+
+		glm::vec3 GetMoveTarget(Common::GameObjectHandle p_hAgent, Common::GameObjectHandle p_hTarget, const glm::vec3& p_vPosition, const glm::vec3& p_vTarget);
+		void Stop(Common::GameObjectHandle p_hAgent);
+
+	private:
+		//------------------------------------------------------------------------------
+		// Private methods.
+		//------------------------------------------------------------------------------
+		glm::vec3 FollowPath(Common::GameObjectHandle p_hAgent, const glm::vec3& p_vPosition, const glm::vec3& p_vTarget);
+
+	private:
+		//------------------------------------------------------------------------------
+		// Private members.
+		//------------------------------------------------------------------------------
+
+		// Current path we are following
+		AIPathfinder::PositionList m_lPath;
+
+		// Node nearest the target when we last asked for a path
+		glm::vec3 m_vPathGoal;
+	};
+}
+
+#endif // AIPATHFOLLOWER_H
@@ -11,12 +11,43 @@
 #include "Assignment4\ExampleGame\src\ComponentRenderableMesh.h"
 #include "windows.h"
 #include "Assignment4\ExampleGame\src\ExampleGame.h"
+#include <algorithm>
 
 using namespace week2;
 
+// Define to trace every node the search opens and closes, and every path found.
+// Far too slow to leave on with several agents replanning.
+//#define AIPATHFINDER_TRACE
+
+#ifdef AIPATHFINDER_TRACE
+#define PATH_TRACE(...) { char strTraceBuffer[128]; sprintf(strTraceBuffer, __VA_ARGS__); OutputDebugString(strTraceBuffer); }
+#else
+#define PATH_TRACE(...)
+#endif
+
+// Added to the cost of going through a node an agent is standing on
+static const float s_fOccupiedPenalty = 100000.0f;
+
+// Number of recent searches kept for reuse
+static const unsigned int s_uiPathCacheSize = 64;
+
+// Nodes a flow field being rebuilt gets through each frame, and the number of
+// frames a flow field is kept after it was last followed
+static const unsigned int s_uiFlowFieldNodesPerFrame = 2048;
+static const unsigned int s_uiFlowFieldLifetime = 120;
+
+// Orders the open list heap lowest F first
+struct HigherF
+{
+	bool operator()(const AIPathfinder::SearchScratch::OpenEntry& p_a, const AIPathfinder::SearchScratch::OpenEntry& p_b) const { return p_a.m_fF > p_b.m_fF; }
+};
+
 // Static singleton instance
 AIPathfinder* AIPathfinder::s_pPathfindingInstance = NULL;
 
+// Names of the agents that occupy path nodes
+static const char* s_aOccupyingAgentNames[] = { "zombieCharacter", "zombieCoin1", "zombieCoin2" };
+
 //------------------------------------------------------------------------------
 // Method:    CreateInstance
 // Returns:   void
@@ -63,11 +94,27 @@ AIPathfinder* AIPathfinder::Instance()
 //------------------------------------------------------------------------------
 AIPathfinder::AIPathfinder()
 	:
+	m_fClusterSize(0.0f),
+	m_vClusterOrigin(0.0f, 0.0f),
+	m_iClustersX(0),
+	m_iClustersZ(0),
+	m_uiOccupancyEpoch(0),
+	m_bQuit(false),
+	m_mutex(NULL),
+	m_toSearch(NULL),
+	m_uiNextSerial(0),
+	m_bFlowFieldMode(false),
+	m_uiFrame(0),
 	m_bDebugRendering(false),
 	m_pLineDrawer(NULL)
 {
 	m_pLineDrawer = new wolf::LineDrawer();
 	m_pLineDrawer->Init("Assignment4/ExampleGame/data/path/lines.vsh", "Assignment4/ExampleGame/data/path/lines.fsh");
+
+	for (int i = 0; i < s_iNumOccupyingAgents; ++i)
+	{
+		m_ahOccupyingAgents[i] = Common::INVALID_GAMEOBJECT_HANDLE;
+	}
 }
 
 //------------------------------------------------------------------------------
@@ -78,14 +125,7 @@ AIPathfinder::AIPathfinder()
 //------------------------------------------------------------------------------
 AIPathfinder::~AIPathfinder()
 {
-	NodeList::iterator it = m_lPathNodes.begin(), end = m_lPathNodes.end();
-	for (; it != end; ++it)
-	{
-		PathNode* pNode = static_cast<PathNode*>(*it);
-		delete pNode;
-		pNode = NULL;
-	}	
-	m_lPathNodes.clear();
+	StopWorkers();
 
 	if (m_pLineDrawer)
 	{
@@ -136,10 +176,10 @@ bool AIPathfinder::Load(const char* p_strPathfindingData)
 		pPathNodeElement->QueryFloatAttribute("y", &y);
 		pPathNodeElement->QueryFloatAttribute("z", &z);
 
-		// Add the node to our list
-		PathNode* pNode = new PathNode();
-		pNode->m_vPosition = glm::vec3(x, y, z);
-		m_lPathNodes.push_back(pNode);
+		// Add the node to our list; heights are ignored
+		PathNode node;
+		node.m_vPosition = glm::vec3(x, 0.0f, z);
+		m_lPathNodes.push_back(node);
 		assert(idx == (m_lPathNodes.size()-1));
 
 		// Next sibling
@@ -153,7 +193,8 @@ bool AIPathfinder::Load(const char* p_strPathfindingData)
 		return false;
 	}
 
-	// Set up neighbour relationships
+	// Read the arcs, then lay them out by node with each arc going both ways
+	std::vector<std::pair<int, int> > lArcs;
 	TiXmlNode* pPath = pArcs->FirstChild("Path");
 	while (pPath)
 	{
@@ -167,15 +208,51 @@ bool AIPathfinder::Load(const char* p_strPathfindingData)
 		assert(nodeIdx1 >= 0 && nodeIdx1 < m_lPathNodes.size());
 		assert(nodeIdx2 >= 0 && nodeIdx2 < m_lPathNodes.size());
 
-		// Setup relationships
-		PathNode* pNode1 = m_lPathNodes[nodeIdx1];
-		PathNode* pNode2 = m_lPathNodes[nodeIdx2];
-		pNode1->m_lNeighbourNodes.push_back(pNode2);
-		pNode2->m_lNeighbourNodes.push_back(pNode1);
+		lArcs.push_back(std::make_pair(nodeIdx1, nodeIdx2));
+		lArcs.push_back(std::make_pair(nodeIdx2, nodeIdx1));
 
 		// Next arc
 		pPath = pPath->NextSibling();
 	}
+	std::sort(lArcs.begin(), lArcs.end());
+
+	int iNumNodes = (int)m_lPathNodes.size();
+	m_lEdgeStart.assign(iNumNodes + 1, 0);
+	m_lEdges.resize(lArcs.size());
+	m_lEdgeCosts.resize(lArcs.size());
+	for (unsigned int i = 0; i < lArcs.size(); ++i)
+	{
+		m_lEdgeStart[lArcs[i].first + 1]++;
+		m_lEdges[i] = lArcs[i].second;
+		m_lEdgeCosts[i] = glm::length(m_lPathNodes[lArcs[i].first].m_vPosition - m_lPathNodes[lArcs[i].second].m_vPosition);
+	}
+	for (int i = 0; i < iNumNodes; ++i)
+	{
+		m_lEdgeStart[i + 1] += m_lEdgeStart[i];
+	}
+
+	// Index the nodes for closest node lookups
+	std::vector<glm::vec3> lPositions(iNumNodes);
+	std::vector<int> lAllNodes(iNumNodes), lConnectedNodes;
+	for (int i = 0; i < iNumNodes; ++i)
+	{
+		lPositions[i] = m_lPathNodes[i].m_vPosition;
+		lAllNodes[i] = i;
+		if (m_lEdgeStart[i] != m_lEdgeStart[i + 1])
+		{
+			lConnectedNodes.push_back(i);
+		}
+	}
+	m_allNodeGrid.Build(lPositions, lAllNodes);
+	m_connectedNodeGrid.Build(lPositions, lConnectedNodes);
+
+	// Split the nodes into clusters for hierarchical searches if asked to
+	float fClusterSize = 0.0f;
+	pPaths->ToElement()->QueryFloatAttribute("clusterSize", &fClusterSize);
+	if (fClusterSize > 0.0f)
+	{
+		BuildHierarchy(fClusterSize);
+	}
 
 	// Initialized successfully
 	return true;
@@ -190,24 +267,37 @@ bool AIPathfinder::Load(const char* p_strPathfindingData)
 //------------------------------------------------------------------------------
 const AIPathfinder::PathNode* const AIPathfinder::GetClosestNode(const glm::vec3& p_vPosition)
 {
-	PathNode* pNode = NULL;
-	float fNodeDist = 10000.0f;
-
-	// Find the node closest to the given position
-	NodeList::const_iterator it = m_lPathNodes.begin(), end = m_lPathNodes.end();
-	for (; it != end; ++it)
-	{
-		PathNode* pTemp = static_cast<PathNode*>(*it);
-		float fTempDist = glm::length(pTemp->m_vPosition - p_vPosition);
+	int iNode = FindClosestNode(p_vPosition, false);
+	return iNode == -1 ? NULL : &m_lPathNodes[iNode];
+}
 
-		if (pNode == NULL || fTempDist < fNodeDist)
-		{
-			pNode = pTemp;
-			fNodeDist = fTempDist;
-		}
-	}
+//------------------------------------------------------------------------------
+// Method:    FindClosestNode
+// Parameter: const glm::vec3 & p_vPosition
+// Parameter: bool p_bConnectedOnly
+// Returns:   int
+//
+// Returns the index of the node closest to the given position, leaving out
+// nodes without neighbours if asked to. Returns -1 if there isn't one.
+//------------------------------------------------------------------------------
+int AIPathfinder::FindClosestNode(const glm::vec3& p_vPosition, bool p_bConnectedOnly) const
+{
+	return p_bConnectedOnly ? m_connectedNodeGrid.FindNearest(p_vPosition) : m_allNodeGrid.FindNearest(p_vPosition);
+}
 
-	return pNode;
+//------------------------------------------------------------------------------
+// Method:    GetNodesInRadius
+// Parameter: const glm::vec3 & p_vPosition
+// Parameter: float p_fRadius
+// Parameter: std::vector<int> & p_lNodes
+// Returns:   void
+//
+// Adds the index of every node within the given distance of the given position
+// (ignoring height) to p_lNodes.
+//------------------------------------------------------------------------------
+void AIPathfinder::GetNodesInRadius(const glm::vec3& p_vPosition, float p_fRadius, std::vector<int>& p_lNodes) const
+{
+	m_allNodeGrid.FindInRadius(p_vPosition, p_fRadius, p_lNodes);
 }
 
 //------------------------------------------------------------------------------
@@ -222,168 +312,1063 @@ const AIPathfinder::PathNode* const AIPathfinder::GetClosestNode(const glm::vec3
 //------------------------------------------------------------------------------
 const AIPathfinder::PositionList& AIPathfinder::FindPath(const glm::vec3& p_vStart, const glm::vec3& p_vDestination)
 {
-	PathNode* pStartNode = NULL;
-	PathNode* pEndNode = NULL;
-	float fDistance = glm::length(p_vStart - p_vDestination);
-	float fStartNodeDist = 10000.0f;
-	float fEndNodeDist = 10000.0f;
-	char strDebugBuffer[64];
-
 	// Find the start and end nodes; we'll just use the nodes that are closest to the start/destination positions
-	NodeList::const_iterator it = m_lPathNodes.begin(), end = m_lPathNodes.end();
-	for (; it != end; ++it)
+	int iStartNode = FindClosestNode(p_vStart, true);
+	int iEndNode = FindClosestNode(p_vDestination, true);
+
+	m_lLastPath.clear();
+	if (iStartNode != -1 && iEndNode != -1)
+	{
+		Search(iStartNode, iEndNode, m_lOccupied, m_scratch, m_lLastPath);
+	}
+
+	return m_lLastPath;
+}
+
+//------------------------------------------------------------------------------
+// Method:    Search
+// Parameter: int p_iStart
+// Parameter: int p_iGoal
+// Parameter: const std::vector<int> & p_lOccupied
+// Parameter: SearchScratch & p_scratch
+// Parameter: PositionList & p_lPath
+// Returns:   bool
+// 
+// Finds a path between the given nodes, going around the given occupied nodes
+// where it can. Between clusters (if there are any) only the leg through the
+// start cluster and onto the next one is filled in. Fills in the path and
+// returns true if the goal could be reached. Only reads the graph, so searches
+// with their own scratch can run side by side.
+//------------------------------------------------------------------------------
+bool AIPathfinder::Search(int p_iStart, int p_iGoal, const std::vector<int>& p_lOccupied, SearchScratch& p_scratch, PositionList& p_lPath) const
+{
+	if (m_fClusterSize > 0.0f && m_lNodeCluster[p_iStart] != m_lNodeCluster[p_iGoal])
+	{
+		return SearchHierarchical(p_iStart, p_iGoal, p_lOccupied, p_scratch, p_lPath);
+	}
+
+	if (!SearchNodes(p_iStart, p_iGoal, -1, p_lOccupied, p_scratch))
 	{
-		PathNode* pNode = static_cast<PathNode*>(*it);
+		return false;
+	}
+	AppendPath(p_iGoal, p_scratch, p_lPath);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Method:    SearchNodes
+// Parameter: int p_iStart
+// Parameter: int p_iGoal
+// Parameter: int p_iCluster
+// Parameter: const std::vector<int> & p_lOccupied
+// Parameter: SearchScratch & p_scratch
+// Returns:   bool
+// 
+// A* search between the given nodes. The open list is a binary heap ordered by
+// F; a node whose cost improves is pushed again rather than moved, and its
+// older entry skipped when it comes up. Going through the given occupied nodes
+// is penalized. If a cluster is given the search doesn't leave it, and with no
+// goal (-1) it visits every node it can reach. Returns true if the goal was
+// reached; the costs and parents are left in the scratch.
+//------------------------------------------------------------------------------
+bool AIPathfinder::SearchNodes(int p_iStart, int p_iGoal, int p_iCluster, const std::vector<int>& p_lOccupied, SearchScratch& p_scratch) const
+{
+	p_scratch.Begin((unsigned int)m_lPathNodes.size());
+	const unsigned int uiGen = p_scratch.m_uiGeneration;
+	const glm::vec3& vGoalPos = m_lPathNodes[p_iGoal == -1 ? p_iStart : p_iGoal].m_vPosition;
+	const float fHScale = p_iGoal == -1 ? 0.0f : 1.0f;
+
+	for (unsigned int i = 0; i < p_lOccupied.size(); ++i)
+	{
+		p_scratch.m_lOccupied[p_lOccupied[i]] = uiGen;
+	}
+
+	// Start by calculating our node costs for the start node and add it to the open list
+	p_scratch.m_lG[p_iStart] = 0.0f;													// No cost since we're starting here
+	p_scratch.m_lParent[p_iStart] = -1;
+	p_scratch.m_lSeen[p_iStart] = uiGen;
+	SearchScratch::OpenEntry start = { fHScale * glm::length(m_lPathNodes[p_iStart].m_vPosition - vGoalPos), p_iStart };	// "As the crow flies" cost to get to the end node
+	p_scratch.m_lOpenHeap.push_back(start);
 
-		// Reset cached values
-		pNode->pParentNode = NULL;
-		pNode->bInClosedList = false;
-		pNode->bInOpenList = false;
-		pNode->G = 0;
-		pNode->H = 0;
+	while (!p_scratch.m_lOpenHeap.empty())
+	{
+		// Take the node with the lowest F cost off the open list
+		std::pop_heap(p_scratch.m_lOpenHeap.begin(), p_scratch.m_lOpenHeap.end(), HigherF());
+		int iCurrent = p_scratch.m_lOpenHeap.back().m_iNode;
+		p_scratch.m_lOpenHeap.pop_back();
 
-		// Skip nodes without any neighbours
-		if (pNode->m_lNeighbourNodes.size() < 1)
+		// Stale entry for a node already closed with a better cost
+		if (p_scratch.m_lClosed[iCurrent] == uiGen)
 		{
 			continue;
 		}
+		p_scratch.m_lClosed[iCurrent] = uiGen;
 
-		float fDistToStartPos = glm::length(pNode->m_vPosition - p_vStart);
-		float fDistToEndPos = glm::length(pNode->m_vPosition - p_vDestination);
+		PATH_TRACE("Closed List: Adding [%f, %f]\n", m_lPathNodes[iCurrent].m_vPosition.x, m_lPathNodes[iCurrent].m_vPosition.z);
 
-		if (pStartNode == NULL || fDistToStartPos < fStartNodeDist)
+		// If this is our goal node, we're done.
+		if (iCurrent == p_iGoal)
 		{
-			pStartNode = pNode;
-			fStartNodeDist = fDistToStartPos;
+			return true;
 		}
-		if (pEndNode == NULL || fDistToEndPos < fEndNodeDist)
+
+		// Add all the neighbours of our current node to the open list, or update
+		// them if this is a better route to them
+		float fCurrentG = p_scratch.m_lG[iCurrent];
+		for (int e = m_lEdgeStart[iCurrent]; e < m_lEdgeStart[iCurrent + 1]; ++e)
 		{
-			pEndNode = pNode;
-			fEndNodeDist = fDistToEndPos;
+			int iNeighbour = m_lEdges[e];
+			if (p_scratch.m_lClosed[iNeighbour] == uiGen)
+			{
+				continue;
+			}
+			if (p_iCluster != -1 && m_lNodeCluster[iNeighbour] != p_iCluster)
+			{
+				continue;
+			}
+
+			float fNewG = fCurrentG + m_lEdgeCosts[e];
+			if (p_scratch.m_lSeen[iNeighbour] == uiGen && fNewG >= p_scratch.m_lG[iNeighbour])
+			{
+				continue;
+			}
+
+			p_scratch.m_lSeen[iNeighbour] = uiGen;
+			p_scratch.m_lG[iNeighbour] = fNewG;
+			p_scratch.m_lParent[iNeighbour] = iCurrent;
+
+			// "As the crow flies" cost to get to the end node, and dynamic avoidance
+			float fH = fHScale * glm::length(m_lPathNodes[iNeighbour].m_vPosition - vGoalPos);
+			if (p_scratch.m_lOccupied[iNeighbour] == uiGen)
+			{
+				fH += s_fOccupiedPenalty;
+			}
+
+			SearchScratch::OpenEntry entry = { fNewG + fH, iNeighbour };
+			p_scratch.m_lOpenHeap.push_back(entry);
+			std::push_heap(p_scratch.m_lOpenHeap.begin(), p_scratch.m_lOpenHeap.end(), HigherF());
+
+			PATH_TRACE("Open List: Adding [%f, %f]\n", m_lPathNodes[iNeighbour].m_vPosition.x, m_lPathNodes[iNeighbour].m_vPosition.z);
 		}
 	}
 
-	// The open list is all the nodes we're considering as options for our path
-	std::vector<PathNode*> lOpenList;
-	std::vector<PathNode*> lClosedList;
+	return false;
+}
 
-	// Start by calculating our node costs for the start node and add it to the open list
-	pStartNode->pParentNode = NULL;
-	pStartNode->bInOpenList = true;
-	pStartNode->bInClosedList = false;
-	pStartNode->G = 0;																	// No cost since we're starting here
-	pStartNode->H = glm::length(pStartNode->m_vPosition - pEndNode->m_vPosition);		// "As the crow flies" cost to get to the end square
-	lOpenList.push_back(pStartNode);
-
-	// Loop until we find a path using the A* search algorithm
-	bool bGoalFound = false;
-	PathNode* pCurrentNode = NULL;
-	while (!bGoalFound)
+//------------------------------------------------------------------------------
+// Method:    AppendPath
+// Parameter: int p_iGoal
+// Parameter: const SearchScratch & p_scratch
+// Parameter: PositionList & p_lPath
+// Returns:   void
+// 
+// Adds the path the last search found to the given goal onto the end of the
+// given path. If the path already has nodes, it's taken to end where this one
+// starts, so the start isn't added twice.
+//------------------------------------------------------------------------------
+void AIPathfinder::AppendPath(int p_iGoal, const SearchScratch& p_scratch, PositionList& p_lPath) const
+{
+	bool bJoin = !p_lPath.empty();
+
+	// Using our goal node; traverse each node by looking to the next parent to find our path
+	PositionList::iterator it = p_lPath.end();
+	for (int iNode = p_iGoal; iNode != -1; iNode = p_scratch.m_lParent[iNode])
+	{
+		it = p_lPath.insert(it, m_lPathNodes[iNode].m_vPosition);
+		PATH_TRACE("POS[%f, %f, %f]\n", m_lPathNodes[iNode].m_vPosition.x, m_lPathNodes[iNode].m_vPosition.y, m_lPathNodes[iNode].m_vPosition.z);
+	}
+
+	if (bJoin)
+	{
+		p_lPath.erase(it);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Method:    BuildHierarchy
+// Parameter: float p_fClusterSize
+// Returns:   void
+// 
+// Splits the nodes into square clusters of the given size, finds the entrances
+// between them and works out the cost of crossing each cluster from every
+// entrance to every other. Call once the node graph is built.
+//------------------------------------------------------------------------------
+void AIPathfinder::BuildHierarchy(float p_fClusterSize)
+{
+	int iNumNodes = (int)m_lPathNodes.size();
+	if (iNumNodes == 0)
+	{
+		return;
+	}
+
+	// Lay the clusters out over the bounds of the nodes
+	glm::vec2 vMax;
+	m_vClusterOrigin = vMax = glm::vec2(m_lPathNodes[0].m_vPosition.x, m_lPathNodes[0].m_vPosition.z);
+	for (int i = 1; i < iNumNodes; ++i)
+	{
+		const glm::vec3& vPos = m_lPathNodes[i].m_vPosition;
+		m_vClusterOrigin = glm::min(m_vClusterOrigin, glm::vec2(vPos.x, vPos.z));
+		vMax = glm::max(vMax, glm::vec2(vPos.x, vPos.z));
+	}
+	m_fClusterSize = p_fClusterSize;
+	m_iClustersX = (int)((vMax.x - m_vClusterOrigin.x) / m_fClusterSize) + 1;
+	m_iClustersZ = (int)((vMax.y - m_vClusterOrigin.y) / m_fClusterSize) + 1;
+
+	m_lNodeCluster.resize(iNumNodes);
+	for (int i = 0; i < iNumNodes; ++i)
+	{
+		m_lNodeCluster[i] = GetCluster(m_lPathNodes[i].m_vPosition);
+	}
+
+	// Entrances are the nodes with an arc into another cluster
+	std::vector<int> lNodeEntrance(iNumNodes, -1);
+	m_lEntranceNodes.clear();
+	for (int i = 0; i < iNumNodes; ++i)
 	{
-		// Make sure the open list is not empty
-		if (lOpenList.empty())
+		for (int e = m_lEdgeStart[i]; e < m_lEdgeStart[i + 1]; ++e)
 		{
-			break;
+			if (m_lNodeCluster[m_lEdges[e]] != m_lNodeCluster[i])
+			{
+				lNodeEntrance[i] = (int)m_lEntranceNodes.size();
+				m_lEntranceNodes.push_back(i);
+				break;
+			}
 		}
+	}
+
+	int iNumClusters = m_iClustersX * m_iClustersZ;
+	int iNumEntrances = (int)m_lEntranceNodes.size();
+	m_lClusterEntranceStart.assign(iNumClusters + 1, 0);
+	m_lClusterEntrances.resize(iNumEntrances);
+	for (int i = 0; i < iNumEntrances; ++i)
+	{
+		m_lClusterEntranceStart[m_lNodeCluster[m_lEntranceNodes[i]] + 1]++;
+	}
+	for (int i = 0; i < iNumClusters; ++i)
+	{
+		m_lClusterEntranceStart[i + 1] += m_lClusterEntranceStart[i];
+	}
+	std::vector<int> lNext(m_lClusterEntranceStart.begin(), m_lClusterEntranceStart.end() - 1);
+	for (int i = 0; i < iNumEntrances; ++i)
+	{
+		m_lClusterEntrances[lNext[m_lNodeCluster[m_lEntranceNodes[i]]]++] = i;
+	}
 
-		// Find the node in the open list with the lowest F cost
-		pCurrentNode = NULL;
-		NodeList::iterator openListIt = lOpenList.begin(), openListEnd = lOpenList.end();
-		NodeList::iterator bestIt = openListIt;
-		for (; openListIt != openListEnd; ++openListIt)
+	// Entrance graph edges: the arcs between clusters, and the cheapest way
+	// across a cluster between each pair of its entrances that are connected
+	std::vector<std::pair<std::pair<int, int>, float> > lEdges;
+	std::vector<float> lCosts;
+	for (int i = 0; i < iNumEntrances; ++i)
+	{
+		int iNode = m_lEntranceNodes[i];
+		for (int e = m_lEdgeStart[iNode]; e < m_lEdgeStart[iNode + 1]; ++e)
 		{
-			PathNode* pTemp = static_cast<PathNode*>(*openListIt);
-			// dynamic avoidance
-			if (pTemp->bIsOccupied)
+			int iNeighbour = m_lEdges[e];
+			if (m_lNodeCluster[iNeighbour] != m_lNodeCluster[iNode])
 			{
-				pTemp->H = 100000;
+				lEdges.push_back(std::make_pair(std::make_pair(i, lNodeEntrance[iNeighbour]), m_lEdgeCosts[e]));
 			}
-			if (pCurrentNode == NULL || (pTemp->G + pTemp->H) < (pCurrentNode->G + pCurrentNode->H))
+		}
+
+		GetEntranceCosts(iNode, m_scratch, lCosts);
+		int iCluster = m_lNodeCluster[iNode];
+		for (int c = m_lClusterEntranceStart[iCluster]; c < m_lClusterEntranceStart[iCluster + 1]; ++c)
+		{
+			int iOther = m_lClusterEntrances[c];
+			if (iOther != i && lCosts[iOther] >= 0.0f)
 			{
-				pCurrentNode = pTemp;
-				bestIt = openListIt;
+				lEdges.push_back(std::make_pair(std::make_pair(i, iOther), lCosts[iOther]));
 			}
 		}
+	}
+	std::sort(lEdges.begin(), lEdges.end());
 
-		// Drop this node from the open list and add it to our closed list
-		lOpenList.erase(bestIt);
-		lClosedList.push_back(pCurrentNode);
-		pCurrentNode->bInOpenList = false;
-		pCurrentNode->bInClosedList = true;
+	m_lEntranceEdgeStart.assign(iNumEntrances + 1, 0);
+	m_lEntranceEdges.resize(lEdges.size());
+	m_lEntranceEdgeCosts.resize(lEdges.size());
+	for (unsigned int i = 0; i < lEdges.size(); ++i)
+	{
+		m_lEntranceEdgeStart[lEdges[i].first.first + 1]++;
+		m_lEntranceEdges[i] = lEdges[i].first.second;
+		m_lEntranceEdgeCosts[i] = lEdges[i].second;
+	}
+	for (int i = 0; i < iNumEntrances; ++i)
+	{
+		m_lEntranceEdgeStart[i + 1] += m_lEntranceEdgeStart[i];
+	}
+}
 
-		sprintf(strDebugBuffer, "Closed List: Adding [%f, %f]\n", pCurrentNode->m_vPosition.x, pCurrentNode->m_vPosition.z);
-		OutputDebugString(strDebugBuffer);
+//------------------------------------------------------------------------------
+// Method:    GetCluster
+// Parameter: const glm::vec3 & p_vPosition
+// Returns:   int
+// 
+// Returns the cluster the given position falls in, clamped to the clusters.
+//------------------------------------------------------------------------------
+int AIPathfinder::GetCluster(const glm::vec3& p_vPosition) const
+{
+	int iX = (int)floorf((p_vPosition.x - m_vClusterOrigin.x) / m_fClusterSize);
+	int iZ = (int)floorf((p_vPosition.z - m_vClusterOrigin.y) / m_fClusterSize);
+	iX = iX < 0 ? 0 : (iX >= m_iClustersX ? m_iClustersX - 1 : iX);
+	iZ = iZ < 0 ? 0 : (iZ >= m_iClustersZ ? m_iClustersZ - 1 : iZ);
+	return iZ * m_iClustersX + iX;
+}
 
+//------------------------------------------------------------------------------
+// Method:    GetEntranceCosts
+// Parameter: int p_iNode
+// Parameter: SearchScratch & p_scratch
+// Parameter: std::vector<float> & p_lCosts
+// Returns:   void
+// 
+// Fills in the cost of the cheapest way from the given node to each entrance
+// of its cluster without leaving it, indexed by entrance. Entrances in other
+// clusters, or that can't be reached, are given -1. Arcs are the same both
+// ways, so these are also the costs from each entrance to the node.
+//------------------------------------------------------------------------------
+void AIPathfinder::GetEntranceCosts(int p_iNode, SearchScratch& p_scratch, std::vector<float>& p_lCosts) const
+{
+	static const std::vector<int> s_lNoneOccupied;
 
-		// If this is our goal node, we're done.
-		if (pCurrentNode == pEndNode)
+	p_lCosts.assign(m_lEntranceNodes.size(), -1.0f);
+
+	int iCluster = m_lNodeCluster[p_iNode];
+	SearchNodes(p_iNode, -1, iCluster, s_lNoneOccupied, p_scratch);
+	for (int c = m_lClusterEntranceStart[iCluster]; c < m_lClusterEntranceStart[iCluster + 1]; ++c)
+	{
+		int iEntranceNode = m_lEntranceNodes[m_lClusterEntrances[c]];
+		if (p_scratch.m_lClosed[iEntranceNode] == p_scratch.m_uiGeneration)
+		{
+			p_lCosts[m_lClusterEntrances[c]] = p_scratch.m_lG[iEntranceNode];
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Method:    SearchHierarchical
+// Parameter: int p_iStart
+// Parameter: int p_iGoal
+// Parameter: const std::vector<int> & p_lOccupied
+// Parameter: SearchScratch & p_scratch
+// Parameter: PositionList & p_lPath
+// Returns:   bool
+// 
+// Finds the route between nodes in different clusters over the entrance graph,
+// then fills in nodes along it until it's into another cluster. Occupied nodes
+// are only avoided in that part; the costs across clusters ignore them.
+//------------------------------------------------------------------------------
+bool AIPathfinder::SearchHierarchical(int p_iStart, int p_iGoal, const std::vector<int>& p_lOccupied, SearchScratch& p_scratch, PositionList& p_lPath) const
+{
+	if (!SearchEntrances(p_iStart, p_iGoal, p_scratch))
+	{
+		return false;
+	}
+
+	// Each leg of the route either crosses a cluster or is an arc between two
+	const std::vector<int>& lRoute = p_scratch.m_lRoute;
+	int iStartCluster = m_lNodeCluster[p_iStart];
+	p_lPath.push_back(m_lPathNodes[p_iStart].m_vPosition);
+	for (unsigned int i = 0; i + 1 < lRoute.size(); ++i)
+	{
+		int iFrom = lRoute[i], iTo = lRoute[i + 1];
+		if (m_lNodeCluster[iFrom] == m_lNodeCluster[iTo])
+		{
+			if (!SearchNodes(iFrom, iTo, m_lNodeCluster[iFrom], p_lOccupied, p_scratch))
+			{
+				p_lPath.clear();
+				return false;
+			}
+			AppendPath(iTo, p_scratch, p_lPath);
+		}
+		else
+		{
+			p_lPath.push_back(m_lPathNodes[iTo].m_vPosition);
+		}
+
+		// The rest is filled in when the agent asks again from here
+		if (m_lNodeCluster[iTo] != iStartCluster)
+		{
+			break;
+		}
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Method:    SearchEntrances
+// Parameter: int p_iStart
+// Parameter: int p_iGoal
+// Parameter: SearchScratch & p_scratch
+// Returns:   bool
+// 
+// A* search over the entrance graph, with the start and goal nodes joined to
+// the entrances of their clusters. Leaves the nodes along the way, start and
+// goal included, in the scratch's route and returns true if the goal could be
+// reached.
+//------------------------------------------------------------------------------
+bool AIPathfinder::SearchEntrances(int p_iStart, int p_iGoal, SearchScratch& p_scratch) const
+{
+	GetEntranceCosts(p_iStart, p_scratch, p_scratch.m_lStartCosts);
+	GetEntranceCosts(p_iGoal, p_scratch, p_scratch.m_lGoalCosts);
+
+	// The start and goal go on the end of the entrances
+	const int iNumEntrances = (int)m_lEntranceNodes.size();
+	const int iStart = iNumEntrances, iGoal = iNumEntrances + 1;
+	p_scratch.BeginAbstract(iNumEntrances + 2);
+	const unsigned int uiGen = p_scratch.m_uiAbstractGeneration;
+	const glm::vec3& vGoalPos = m_lPathNodes[p_iGoal].m_vPosition;
+	const int iStartCluster = m_lNodeCluster[p_iStart];
+
+	p_scratch.m_lAbstractG[iStart] = 0.0f;
+	p_scratch.m_lAbstractParent[iStart] = -1;
+	p_scratch.m_lAbstractSeen[iStart] = uiGen;
+	SearchScratch::OpenEntry start = { glm::length(m_lPathNodes[p_iStart].m_vPosition - vGoalPos), iStart };
+	p_scratch.m_lOpenHeap.push_back(start);
+
+	bool bGoalFound = false;
+	while (!p_scratch.m_lOpenHeap.empty())
+	{
+		std::pop_heap(p_scratch.m_lOpenHeap.begin(), p_scratch.m_lOpenHeap.end(), HigherF());
+		int iCurrent = p_scratch.m_lOpenHeap.back().m_iNode;
+		p_scratch.m_lOpenHeap.pop_back();
+
+		if (p_scratch.m_lAbstractClosed[iCurrent] == uiGen)
+		{
+			continue;
+		}
+		p_scratch.m_lAbstractClosed[iCurrent] = uiGen;
+
+		if (iCurrent == iGoal)
 		{
 			bGoalFound = true;
 			break;
 		}
 
-		// Add all the neighbours of our current node to the open list
-		NodeList::iterator it2 = pCurrentNode->m_lNeighbourNodes.begin(), end2 = pCurrentNode->m_lNeighbourNodes.end();
-		for (; it2 != end2; ++it2)
+		// The start leads to its cluster's entrances. Entrances lead along the
+		// entrance graph, and to the goal if it's in their cluster.
+		int iFirst, iLast;
+		if (iCurrent == iStart)
+		{
+			iFirst = m_lClusterEntranceStart[iStartCluster];
+			iLast = m_lClusterEntranceStart[iStartCluster + 1];
+		}
+		else
+		{
+			iFirst = m_lEntranceEdgeStart[iCurrent];
+			iLast = m_lEntranceEdgeStart[iCurrent + 1] + 1;
+		}
+
+		float fCurrentG = p_scratch.m_lAbstractG[iCurrent];
+		for (int e = iFirst; e < iLast; ++e)
 		{
-			PathNode* pNeighbour = static_cast<PathNode*>(*it2);
-			if (pNeighbour->bInClosedList)
+			int iNeighbour;
+			float fCost;
+			if (iCurrent == iStart)
 			{
-				// Skip
-				continue;
+				iNeighbour = m_lClusterEntrances[e];
+				fCost = p_scratch.m_lStartCosts[iNeighbour];
 			}
-			else if (pNeighbour->bInOpenList)
+			else if (e < iLast - 1)
 			{
-				// See if getting to this node from our current node is a better path
-				int currentGCost = pNeighbour->G;
-				int newGCost = pCurrentNode->G + glm::length(pCurrentNode->m_vPosition - pNeighbour->m_vPosition); // Parent cost + "as the crow flies" cost to get from parent to us
-				if (newGCost < currentGCost)
-				{
-					// Change parent; we found a better route
-					pNeighbour->pParentNode = pCurrentNode;
-					pNeighbour->G = newGCost;
-				}
+				iNeighbour = m_lEntranceEdges[e];
+				fCost = m_lEntranceEdgeCosts[e];
 			}
 			else
 			{
-				// New; add it to your list
-				pNeighbour->pParentNode = pCurrentNode;
-				pNeighbour->bInOpenList = true;
-				pNeighbour->bInClosedList = false;
-				pNeighbour->G = pCurrentNode->G + glm::length(pCurrentNode->m_vPosition - pNeighbour->m_vPosition);	// Parent cost + "as the crow flies" cost to get from parent to us
-				pNeighbour->H = glm::length(pNeighbour->m_vPosition - pEndNode->m_vPosition);			// "As the crow flies" cost to get to the end square
-				lOpenList.push_back(pNeighbour);
-
-				sprintf(strDebugBuffer, "Open List: Adding [%f, %f]\n", pNeighbour->m_vPosition.x, pNeighbour->m_vPosition.z);
-				OutputDebugString(strDebugBuffer);
+				iNeighbour = iGoal;
+				fCost = p_scratch.m_lGoalCosts[iCurrent];
+			}
+
+			if (fCost < 0.0f || p_scratch.m_lAbstractClosed[iNeighbour] == uiGen)
+			{
+				continue;
 			}
+
+			float fNewG = fCurrentG + fCost;
+			if (p_scratch.m_lAbstractSeen[iNeighbour] == uiGen && fNewG >= p_scratch.m_lAbstractG[iNeighbour])
+			{
+				continue;
+			}
+
+			p_scratch.m_lAbstractSeen[iNeighbour] = uiGen;
+			p_scratch.m_lAbstractG[iNeighbour] = fNewG;
+			p_scratch.m_lAbstractParent[iNeighbour] = iCurrent;
+
+			float fH = iNeighbour == iGoal ? 0.0f : glm::length(m_lPathNodes[m_lEntranceNodes[iNeighbour]].m_vPosition - vGoalPos);
+			SearchScratch::OpenEntry entry = { fNewG + fH, iNeighbour };
+			p_scratch.m_lOpenHeap.push_back(entry);
+			std::push_heap(p_scratch.m_lOpenHeap.begin(), p_scratch.m_lOpenHeap.end(), HigherF());
 		}
 	}
 
-	// Make sure we found the path
-	m_lLastPath.clear();
-	if (bGoalFound && pCurrentNode)
+	if (!bGoalFound)
+	{
+		return false;
+	}
+
+	// Back from the goal, as node indices
+	p_scratch.m_lRoute.clear();
+	for (int iNode = iGoal; iNode != -1; iNode = p_scratch.m_lAbstractParent[iNode])
+	{
+		int iPathNode = iNode == iGoal ? p_iGoal : (iNode == iStart ? p_iStart : m_lEntranceNodes[iNode]);
+		p_scratch.m_lRoute.push_back(iPathNode);
+	}
+	std::reverse(p_scratch.m_lRoute.begin(), p_scratch.m_lRoute.end());
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Method:    SearchScratch::Begin
+// Parameter: unsigned int p_uiNumNodes
+// Returns:   void
+// 
+// Gets ready for a new search over a graph of the given size by moving on to
+// the next generation. The arrays are only cleared when it wraps around.
+//------------------------------------------------------------------------------
+void AIPathfinder::SearchScratch::Begin(unsigned int p_uiNumNodes)
+{
+	if (m_lG.size() != p_uiNumNodes)
+	{
+		m_lG.resize(p_uiNumNodes);
+		m_lParent.resize(p_uiNumNodes);
+		m_lSeen.assign(p_uiNumNodes, 0);
+		m_lClosed.assign(p_uiNumNodes, 0);
+		m_lOccupied.assign(p_uiNumNodes, 0);
+	}
+
+	m_lOpenHeap.clear();
+	if (++m_uiGeneration == 0)
+	{
+		std::fill(m_lSeen.begin(), m_lSeen.end(), 0);
+		std::fill(m_lClosed.begin(), m_lClosed.end(), 0);
+		std::fill(m_lOccupied.begin(), m_lOccupied.end(), 0);
+		m_uiGeneration = 1;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Method:    SearchScratch::BeginAbstract
+// Parameter: unsigned int p_uiNumNodes
+// Returns:   void
+// 
+// The same as Begin(), for a search over the entrance graph.
+//------------------------------------------------------------------------------
+void AIPathfinder::SearchScratch::BeginAbstract(unsigned int p_uiNumNodes)
+{
+	if (m_lAbstractG.size() != p_uiNumNodes)
+	{
+		m_lAbstractG.resize(p_uiNumNodes);
+		m_lAbstractParent.resize(p_uiNumNodes);
+		m_lAbstractSeen.assign(p_uiNumNodes, 0);
+		m_lAbstractClosed.assign(p_uiNumNodes, 0);
+	}
+
+	m_lOpenHeap.clear();
+	if (++m_uiAbstractGeneration == 0)
+	{
+		std::fill(m_lAbstractSeen.begin(), m_lAbstractSeen.end(), 0);
+		std::fill(m_lAbstractClosed.begin(), m_lAbstractClosed.end(), 0);
+		m_uiAbstractGeneration = 1;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Method:    PathKey::operator<
+// Parameter: const PathKey & p_other
+// Returns:   bool
+// 
+// Orders keys for the path cache index.
+//------------------------------------------------------------------------------
+bool AIPathfinder::PathKey::operator<(const PathKey& p_other) const
+{
+	if (m_iStart != p_other.m_iStart)
+	{
+		return m_iStart < p_other.m_iStart;
+	}
+	if (m_iGoal != p_other.m_iGoal)
+	{
+		return m_iGoal < p_other.m_iGoal;
+	}
+	return m_uiEpoch < p_other.m_uiEpoch;
+}
+
+//------------------------------------------------------------------------------
+// Method:    StartWorkers
+// Parameter: unsigned int p_uiNumThreads
+// Returns:   void
+// 
+// Starts the threads that service RequestPath(). Call after Load(); the graph
+// mustn't change while they're running. Until this is called (or if no threads
+// could be started) requests are searched on the spot.
+//------------------------------------------------------------------------------
+void AIPathfinder::StartWorkers(unsigned int p_uiNumThreads)
+{
+	if (!m_lWorkers.empty())
+	{
+		return;
+	}
+
+	m_mutex = glfwCreateMutex();
+	m_toSearch = glfwCreateCond();
+	m_bQuit = false;
+
+	for (unsigned int i = 0; i < p_uiNumThreads; ++i)
+	{
+		Worker* pWorker = new Worker();
+		pWorker->m_pPathfinder = this;
+		pWorker->m_thread = glfwCreateThread(WorkerThread, pWorker);
+		if (pWorker->m_thread >= 0)
+		{
+			m_lWorkers.push_back(pWorker);
+		}
+		else
+		{
+			delete pWorker;
+		}
+	}
+
+	if (m_lWorkers.empty())
+	{
+		glfwDestroyCond(m_toSearch);
+		glfwDestroyMutex(m_mutex);
+		m_toSearch = NULL;
+		m_mutex = NULL;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Method:    StopWorkers
+// Returns:   void
+// 
+// Stops the worker threads and drops any requests they hadn't got to. Agents
+// waiting on those need to ask again.
+//------------------------------------------------------------------------------
+void AIPathfinder::StopWorkers()
+{
+	if (m_lWorkers.empty())
+	{
+		return;
+	}
+
+	glfwLockMutex(m_mutex);
+	m_bQuit = true;
+	glfwBroadcastCond(m_toSearch);
+	glfwUnlockMutex(m_mutex);
+
+	for (unsigned int i = 0; i < m_lWorkers.size(); ++i)
+	{
+		glfwWaitThread(m_lWorkers[i]->m_thread, GLFW_WAIT);
+		delete m_lWorkers[i];
+	}
+	m_lWorkers.clear();
+
+	// Nothing else touches the queues now
+	CollectSearchedPaths();
+	for (unsigned int i = 0; i < m_lToSearch.size(); ++i)
+	{
+		delete m_lToSearch[i];
+	}
+	m_lToSearch.clear();
+
+	std::map<Common::GameObjectHandle, AgentPath>::iterator it = m_agentPaths.begin(), end = m_agentPaths.end();
+	for (; it != end; ++it)
+	{
+		it->second.m_iPendingGoal = -1;
+	}
+
+	glfwDestroyCond(m_toSearch);
+	glfwDestroyMutex(m_mutex);
+	m_toSearch = NULL;
+	m_mutex = NULL;
+}
+
+//------------------------------------------------------------------------------
+// Method:    RequestPath
+// Parameter: Common::GameObjectHandle p_hAgent
+// Parameter: const glm::vec3 & p_vStart
+// Parameter: const glm::vec3 & p_vDestination
+// Returns:   void
+// 
+// Asks for a path for the given agent, replacing whatever it asked for before.
+// The path is ready straight away if it's cached, otherwise once a worker has
+// searched it and Update() has collected it. Asking again for the same goal
+// node while that's still going on does nothing.
+//------------------------------------------------------------------------------
+void AIPathfinder::RequestPath(Common::GameObjectHandle p_hAgent, const glm::vec3& p_vStart, const glm::vec3& p_vDestination)
+{
+	int iStartNode = FindClosestNode(p_vStart, true);
+	int iEndNode = FindClosestNode(p_vDestination, true);
+
+	AgentPath& agent = m_agentPaths[p_hAgent];
+	if (agent.m_iPendingGoal != -1 && agent.m_iPendingGoal == iEndNode)
+	{
+		return;
+	}
+
+	agent.m_uiSerial = ++m_uiNextSerial;
+	agent.m_iPendingGoal = -1;
+	agent.m_bReady = true;
+	agent.m_lPath.clear();
+	if (iStartNode == -1 || iEndNode == -1)
+	{
+		return;
+	}
+
+	PathKey key = { iStartNode, iEndNode, m_uiOccupancyEpoch };
+	const PositionList* pCachedPath = FindCachedPath(key);
+	if (pCachedPath)
+	{
+		agent.m_lPath = *pCachedPath;
+		return;
+	}
+
+	// No workers; search on the spot
+	if (m_lWorkers.empty())
+	{
+		Search(iStartNode, iEndNode, m_lOccupied, m_scratch, agent.m_lPath);
+		AddCachedPath(key, agent.m_lPath);
+		m_lLastPath = agent.m_lPath;
+		return;
+	}
+
+	PathRequest* pRequest = new PathRequest();
+	pRequest->m_hAgent = p_hAgent;
+	pRequest->m_uiSerial = agent.m_uiSerial;
+	pRequest->m_iStart = iStartNode;
+	pRequest->m_iGoal = iEndNode;
+	pRequest->m_uiEpoch = m_uiOccupancyEpoch;
+	pRequest->m_lOccupied = m_lOccupied;
+	agent.m_iPendingGoal = iEndNode;
+	agent.m_bReady = false;
+
+	glfwLockMutex(m_mutex);
+	m_lToSearch.push_back(pRequest);
+	glfwSignalCond(m_toSearch);
+	glfwUnlockMutex(m_mutex);
+}
+
+//------------------------------------------------------------------------------
+// Method:    TakePath
+// Parameter: Common::GameObjectHandle p_hAgent
+// Parameter: PositionList & p_lPath
+// Returns:   bool
+// 
+// If the path the given agent last asked for is ready, moves it into p_lPath
+// and returns true. It's empty if there's no way there. Returns false if it's
+// still being searched, or was already taken.
+//------------------------------------------------------------------------------
+bool AIPathfinder::TakePath(Common::GameObjectHandle p_hAgent, PositionList& p_lPath)
+{
+	std::map<Common::GameObjectHandle, AgentPath>::iterator it = m_agentPaths.find(p_hAgent);
+	if (it == m_agentPaths.end() || !it->second.m_bReady)
+	{
+		return false;
+	}
+
+	p_lPath.swap(it->second.m_lPath);
+	it->second.m_lPath.clear();
+	it->second.m_bReady = false;
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Method:    ReleaseAgent
+// Parameter: Common::GameObjectHandle p_hAgent
+// Returns:   void
+// 
+// Forgets the given agent's path; anything still being searched for it is
+// thrown away when it comes back.
+//------------------------------------------------------------------------------
+void AIPathfinder::ReleaseAgent(Common::GameObjectHandle p_hAgent)
+{
+	m_agentPaths.erase(p_hAgent);
+}
+
+//------------------------------------------------------------------------------
+// Method:    FindCachedPath
+// Parameter: const PathKey & p_key
+// Returns:   const AIPathfinder::PositionList*
+// 
+// Returns the cached path for the given key, marking it most recently used, or
+// NULL if it isn't cached.
+//------------------------------------------------------------------------------
+const AIPathfinder::PositionList* AIPathfinder::FindCachedPath(const PathKey& p_key)
+{
+	std::map<PathKey, PathCache::iterator>::iterator it = m_pathCacheIndex.find(p_key);
+	if (it == m_pathCacheIndex.end())
+	{
+		return NULL;
+	}
+
+	m_lPathCache.splice(m_lPathCache.begin(), m_lPathCache, it->second);
+	return &it->second->second;
+}
+
+//------------------------------------------------------------------------------
+// Method:    AddCachedPath
+// Parameter: const PathKey & p_key
+// Parameter: const PositionList & p_lPath
+// Returns:   void
+// 
+// Caches the given path, pushing out the least recently used one if full.
+//------------------------------------------------------------------------------
+void AIPathfinder::AddCachedPath(const PathKey& p_key, const PositionList& p_lPath)
+{
+	if (m_pathCacheIndex.find(p_key) != m_pathCacheIndex.end())
+	{
+		return;
+	}
+
+	if (m_lPathCache.size() >= s_uiPathCacheSize)
+	{
+		m_pathCacheIndex.erase(m_lPathCache.back().first);
+		m_lPathCache.pop_back();
+	}
+
+	m_lPathCache.push_front(std::make_pair(p_key, p_lPath));
+	m_pathCacheIndex[p_key] = m_lPathCache.begin();
+}
+
+//------------------------------------------------------------------------------
+// Method:    CollectSearchedPaths
+// Returns:   void
+// 
+// Caches everything the workers have finished and hands each path to its
+// agent, unless the agent has since asked for something else.
+//------------------------------------------------------------------------------
+void AIPathfinder::CollectSearchedPaths()
+{
+	if (m_mutex == NULL)
+	{
+		return;
+	}
+
+	std::deque<PathRequest*> lSearched;
+	glfwLockMutex(m_mutex);
+	lSearched.swap(m_lSearched);
+	glfwUnlockMutex(m_mutex);
+
+	for (unsigned int i = 0; i < lSearched.size(); ++i)
 	{
-		// Using our current (goal) node; traverse each node by looking to the next parent to find our path
-		PathNode* pNode = pCurrentNode;
-		while (pNode)
+		PathRequest* pRequest = lSearched[i];
+		PathKey key = { pRequest->m_iStart, pRequest->m_iGoal, pRequest->m_uiEpoch };
+		AddCachedPath(key, pRequest->m_lPath);
+		m_lLastPath = pRequest->m_lPath;
+
+		std::map<Common::GameObjectHandle, AgentPath>::iterator it = m_agentPaths.find(pRequest->m_hAgent);
+		if (it != m_agentPaths.end() && it->second.m_uiSerial == pRequest->m_uiSerial)
 		{
-			m_lLastPath.push_front(pNode->m_vPosition);
-			pNode = pNode->pParentNode;
+			it->second.m_lPath.swap(pRequest->m_lPath);
+			it->second.m_iPendingGoal = -1;
+			it->second.m_bReady = true;
 		}
+		delete pRequest;
+	}
+}
 
-		// Debugging path points
-		PositionList::iterator it = m_lLastPath.begin(), end = m_lLastPath.end();
-		for (; it != end; ++it)
+//------------------------------------------------------------------------------
+// Method:    WorkerThread
+// Parameter: void * p_pArg
+// Returns:   void
+// 
+// Worker threads take requests off the queue and search them with their own
+// scratch until told to quit.
+//------------------------------------------------------------------------------
+void GLFWCALL AIPathfinder::WorkerThread(void* p_pArg)
+{
+	Worker* pWorker = static_cast<Worker*>(p_pArg);
+	AIPathfinder* pPathfinder = pWorker->m_pPathfinder;
+
+	glfwLockMutex(pPathfinder->m_mutex);
+	for (;;)
+	{
+		while (pPathfinder->m_lToSearch.empty() && !pPathfinder->m_bQuit)
+		{
+			glfwWaitCond(pPathfinder->m_toSearch, pPathfinder->m_mutex, GLFW_INFINITY);
+		}
+		if (pPathfinder->m_bQuit)
 		{
-			glm::vec3 vPos = static_cast<glm::vec3>(*it);
-			char buff[64];
-			sprintf(buff, "POS[%f, %f, %f]\n", vPos.x, vPos.y, vPos.z);
-			OutputDebugString(buff);
+			break;
 		}
+
+		PathRequest* pRequest = pPathfinder->m_lToSearch.front();
+		pPathfinder->m_lToSearch.pop_front();
+		glfwUnlockMutex(pPathfinder->m_mutex);
+
+		pPathfinder->Search(pRequest->m_iStart, pRequest->m_iGoal, pRequest->m_lOccupied, pWorker->m_scratch, pRequest->m_lPath);
+
+		glfwLockMutex(pPathfinder->m_mutex);
+		pPathfinder->m_lSearched.push_back(pRequest);
+	}
+	glfwUnlockMutex(pPathfinder->m_mutex);
+}
+
+//------------------------------------------------------------------------------
+// Method:    GetNextHop
+// Parameter: Common::GameObjectHandle p_hTarget
+// Parameter: const glm::vec3 & p_vTarget
+// Parameter: const glm::vec3 & p_vPosition
+// Parameter: glm::vec3 & p_vNextHop
+// Returns:   bool
+// 
+// Gives the node to head for from the given position to get to the given
+// target, from the target's flow field. The field is made the first time the
+// target is asked about, and rebuilt over the next few frames whenever the
+// target moves to another node. Returns false if the target can't be reached
+// from here.
+//------------------------------------------------------------------------------
+bool AIPathfinder::GetNextHop(Common::GameObjectHandle p_hTarget, const glm::vec3& p_vTarget, const glm::vec3& p_vPosition, glm::vec3& p_vNextHop)
+{
+	int iTargetNode = FindClosestNode(p_vTarget, true);
+	int iNode = FindClosestNode(p_vPosition, true);
+	if (iTargetNode == -1 || iNode == -1)
+	{
+		return false;
+	}
+
+	FlowField& field = m_flowFields[p_hTarget];
+	field.m_uiLastUsedFrame = m_uiFrame;
+	if (field.m_iTarget == -1)
+	{
+		// Nothing to follow in the meantime, so build it all now
+		BeginFlowField(field, iTargetNode);
+		BuildFlowField(field, (unsigned int)m_lPathNodes.size());
+	}
+	else if (iTargetNode == field.m_iTarget)
+	{
+		// Back where the current field leads; forget any newer one
+		field.m_iBuildTarget = -1;
+	}
+	else if (iTargetNode != field.m_iBuildTarget)
+	{
+		BeginFlowField(field, iTargetNode);
+	}
+
+	int iNextHop = field.m_lNextHop[iNode];
+	if (iNextHop == -1)
+	{
+		return false;
+	}
+
+	p_vNextHop = m_lPathNodes[iNextHop].m_vPosition;
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Method:    BeginFlowField
+// Parameter: FlowField & p_field
+// Parameter: int p_iTarget
+// Returns:   void
+// 
+// Starts building a new flow field out from the given node.
+//------------------------------------------------------------------------------
+void AIPathfinder::BeginFlowField(FlowField& p_field, int p_iTarget) const
+{
+	unsigned int uiNumNodes = (unsigned int)m_lPathNodes.size();
+	p_field.m_iBuildTarget = p_iTarget;
+	p_field.m_lBuildCost.resize(uiNumNodes);
+	p_field.m_lBuildNextHop.assign(uiNumNodes, -1);
+	p_field.m_lBuildState.assign(uiNumNodes, 0);
+	p_field.m_lBuildHeap.clear();
+
+	p_field.m_lBuildCost[p_iTarget] = 0.0f;
+	p_field.m_lBuildNextHop[p_iTarget] = p_iTarget;
+	p_field.m_lBuildState[p_iTarget] = 1;
+	SearchScratch::OpenEntry entry = { 0.0f, p_iTarget };
+	p_field.m_lBuildHeap.push_back(entry);
+}
+
+//------------------------------------------------------------------------------
+// Method:    BuildFlowField
+// Parameter: FlowField & p_field
+// Parameter: unsigned int p_uiMaxNodes
+// Returns:   bool
+// 
+// Carries on the Dijkstra search out from the target of the field being built,
+// settling up to the given number of nodes. Each node's next hop is the one it
+// was reached from. Once every reachable node is settled the new field replaces
+// the current one, and true is returned.
+//------------------------------------------------------------------------------
+bool AIPathfinder::BuildFlowField(FlowField& p_field, unsigned int p_uiMaxNodes) const
+{
+	unsigned int uiSettled = 0;
+	while (!p_field.m_lBuildHeap.empty() && uiSettled < p_uiMaxNodes)
+	{
+		std::pop_heap(p_field.m_lBuildHeap.begin(), p_field.m_lBuildHeap.end(), HigherF());
+		int iCurrent = p_field.m_lBuildHeap.back().m_iNode;
+		p_field.m_lBuildHeap.pop_back();
+
+		// 0 = not seen, 1 = open, 2 = settled
+		if (p_field.m_lBuildState[iCurrent] == 2)
+		{
+			continue;
+		}
+		p_field.m_lBuildState[iCurrent] = 2;
+		++uiSettled;
+
+		float fCurrentCost = p_field.m_lBuildCost[iCurrent];
+		for (int e = m_lEdgeStart[iCurrent]; e < m_lEdgeStart[iCurrent + 1]; ++e)
+		{
+			int iNeighbour = m_lEdges[e];
+			if (p_field.m_lBuildState[iNeighbour] == 2)
+			{
+				continue;
+			}
+
+			float fNewCost = fCurrentCost + m_lEdgeCosts[e];
+			if (p_field.m_lBuildState[iNeighbour] == 1 && fNewCost >= p_field.m_lBuildCost[iNeighbour])
+			{
+				continue;
+			}
+
+			p_field.m_lBuildState[iNeighbour] = 1;
+			p_field.m_lBuildCost[iNeighbour] = fNewCost;
+			p_field.m_lBuildNextHop[iNeighbour] = iCurrent;
+
+			SearchScratch::OpenEntry entry = { fNewCost, iNeighbour };
+			p_field.m_lBuildHeap.push_back(entry);
+			std::push_heap(p_field.m_lBuildHeap.begin(), p_field.m_lBuildHeap.end(), HigherF());
+		}
+	}
+
+	if (!p_field.m_lBuildHeap.empty())
+	{
+		return false;
+	}
+
+	p_field.m_iTarget = p_field.m_iBuildTarget;
+	p_field.m_lNextHop.swap(p_field.m_lBuildNextHop);
+	p_field.m_iBuildTarget = -1;
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Method:    UpdateFlowFields
+// Returns:   void
+// 
+// Moves along the flow fields being rebuilt and drops the ones nobody has
+// followed for a while.
+//------------------------------------------------------------------------------
+void AIPathfinder::UpdateFlowFields()
+{
+	++m_uiFrame;
+
+	std::map<Common::GameObjectHandle, FlowField>::iterator it = m_flowFields.begin();
+	while (it != m_flowFields.end())
+	{
+		FlowField& field = it->second;
+		if (m_uiFrame - field.m_uiLastUsedFrame > s_uiFlowFieldLifetime)
+		{
+			m_flowFields.erase(it++);
+			continue;
+		}
+
+		if (field.m_iBuildTarget != -1)
+		{
+			BuildFlowField(field, s_uiFlowFieldNodesPerFrame);
+		}
+		++it;
 	}
-	
-	return m_lLastPath;
 }
 
 //------------------------------------------------------------------------------
@@ -421,8 +1406,7 @@ void AIPathfinder::ToggleDebugRendering(Common::GameObjectManager* p_pGameObject
 			p_pGameObjectManager->SetGameObjectGUID(pNode, goNameBuffer);
 
 			// Set position
-			PathNode* pPathNode = m_lPathNodes[i];
-			pNode->GetTransform().SetTranslation(pPathNode->m_vPosition);
+			pNode->GetTransform().SetTranslation(m_lPathNodes[i].m_vPosition);
 		}
 	}
 }
@@ -440,17 +1424,25 @@ void AIPathfinder::Render(const glm::mat4& p_mProj, const glm::mat4& p_mView)
 	if (m_bDebugRendering)
 	{
 		// Add lines for each connected node pair
-		NodeList::const_iterator it = m_lPathNodes.begin(), end = m_lPathNodes.end();
-		for (; it != end; ++it)
+		for (int i = 0; i < (int)m_lPathNodes.size(); ++i)
 		{
-			PathNode* pNode1 = static_cast<PathNode*>(*it);
+			for (int e = m_lEdgeStart[i]; e < m_lEdgeStart[i + 1]; ++e)
+			{
+				m_pLineDrawer->AddLine(m_lPathNodes[i].m_vPosition, m_lPathNodes[m_lEdges[e]].m_vPosition, wolf::Color4(0.8f, 0.8f, 0.8f, 1.0f));
+			}
+		}
 
-			// Iterator neighbours
-			NodeList::const_iterator it2 = pNode1->m_lNeighbourNodes.begin(), end2 = pNode1->m_lNeighbourNodes.end();
-			for (; it2 != end2; ++it2)
+		// Where each node leads to in every flow field
+		std::map<Common::GameObjectHandle, FlowField>::const_iterator itField = m_flowFields.begin(), endField = m_flowFields.end();
+		for (; itField != endField; ++itField)
+		{
+			const std::vector<int>& lNextHop = itField->second.m_lNextHop;
+			for (unsigned int i = 0; i < lNextHop.size(); ++i)
 			{
-				PathNode* pNode2 = static_cast<PathNode*>(*it2);
-				m_pLineDrawer->AddLine(pNode1->m_vPosition, pNode2->m_vPosition, wolf::Color4(0.8f, 0.8f, 0.8f, 1.0f));
+				if (lNextHop[i] != -1 && lNextHop[i] != (int)i)
+				{
+					m_pLineDrawer->AddLine(m_lPathNodes[i].m_vPosition + glm::vec3(0.0f, 0.1f, 0.0f), m_lPathNodes[lNextHop[i]].m_vPosition + glm::vec3(0.0f, 0.1f, 0.0f), wolf::Color4(0.0f, 0.8f, 0.0f, 1.0f));
+				}
 			}
 		}
 
@@ -477,37 +1469,16 @@ void AIPathfinder::Render(const glm::mat4& p_mProj, const glm::mat4& p_mView)
 	}
 }
 
-// check for  dynamic avoidance
+// check for  dynamic avoidance; marks the node closest to the given position
+// as occupied from the end of this Update()
 void AIPathfinder::UpdateNodeOccupied(const glm::vec3& p_vPos)
 {
-	PathNode* pUpdateNode = NULL;
-
-	float fNodeDist = 10000.0f;
-	char strDebugBuffer[64];
-
 	// Find the node; we'll just use the nodes that are closest to the node
-	NodeList::const_iterator it = m_lPathNodes.begin(), end = m_lPathNodes.end();
-	for (; it != end; ++it)
+	int iNode = FindClosestNode(p_vPos, true);
+	if (iNode != -1)
 	{
-		PathNode* pNode = static_cast<PathNode*>(*it);
-		pNode->bIsOccupied = false;
-		pNode->m_vPosition.y = 0;
-		// Skip nodes without any neighbours
-		if (pNode->m_lNeighbourNodes.size() < 1)
-		{
-			continue;
-		}
-
-		float fDistoPos = glm::length(pNode->m_vPosition - p_vPos);
-
-		if (pUpdateNode == NULL || fDistoPos < fNodeDist)
-		{
-			pUpdateNode = pNode;
-			fNodeDist = fDistoPos;
-		}
+		m_lNextOccupied.push_back(iNode);
 	}
-	
-	pUpdateNode->bIsOccupied = true;
 }
 
 void AIPathfinder::Update()
@@ -520,13 +1491,40 @@ void AIPathfinder::Update()
 	}
 	bLastKeyDown = bCurrentKeyDown;
 
+	// Switch the chasing zombies between their own paths (the default) and
+	// shared flow fields
+	static bool bLastFlowKeyDown = false;
+	bool bCurrentFlowKeyDown = glfwGetKey('F');
+	if (bCurrentFlowKeyDown && !bLastFlowKeyDown)
+	{
+		m_bFlowFieldMode = !m_bFlowFieldMode;
+	}
+	bLastFlowKeyDown = bCurrentFlowKeyDown;
 
-	Common::GameObject* pZombie1 = ExampleGame::GetInstance()->GameObjectManager()->GetGameObject("zombieCharacter");
-	this->UpdateNodeOccupied(pZombie1->GetTransform().GetTranslation());
+	// Hand out whatever the workers have finished, and carry on rebuilding flow fields
+	CollectSearchedPaths();
+	UpdateFlowFields();
 
-	Common::GameObject* pZombie2 = ExampleGame::GetInstance()->GameObjectManager()->GetGameObject("zombieCoin1");
-	this->UpdateNodeOccupied(pZombie2->GetTransform().GetTranslation());
+	// Every agent marks its node, starting from none
+	m_lNextOccupied.clear();
 
-	Common::GameObject* pZombie3 = ExampleGame::GetInstance()->GameObjectManager()->GetGameObject("zombieCoin2");
-	this->UpdateNodeOccupied(pZombie3->GetTransform().GetTranslation());
+	// Handles are only re-resolved by name when the agent was (re)created
+	Common::GameObjectManager* pGameObjectManager = ExampleGame::GetInstance()->GameObjectManager();
+	for (int i = 0; i < s_iNumOccupyingAgents; ++i)
+	{
+		Common::GameObject* pZombie = pGameObjectManager->ResolveGameObject(m_ahOccupyingAgents[i], s_aOccupyingAgentNames[i]);
+		if (pZombie)
+		{
+			this->UpdateNodeOccupied(pZombie->GetTransform().GetTranslation());
+		}
+	}
+
+	// Cached paths made around the old occupied nodes no longer apply
+	std::sort(m_lNextOccupied.begin(), m_lNextOccupied.end());
+	m_lNextOccupied.erase(std::unique(m_lNextOccupied.begin(), m_lNextOccupied.end()), m_lNextOccupied.end());
+	if (m_lNextOccupied != m_lOccupied)
+	{
+		m_lOccupied.swap(m_lNextOccupied);
+		++m_uiOccupancyEpoch;
+	}
 }
@@ -5,6 +5,26 @@
 // Author:	Carel Boers
 //	
 // This class manages finding paths given a set of traversable nodes.
+//
+// Agents ask for paths with RequestPath() and pick them up later with
+// TakePath(). Once StartWorkers() has been called the searches run on a pool
+// of worker threads, each with its own scratch, against the graph (which
+// doesn't change after Load()). Recent results are cached by start node, goal
+// node and occupancy epoch, so agents heading the same way share searches.
+//
+// If the data gives the Paths element a clusterSize, the nodes are also split
+// into square clusters of that size at load. Paths between clusters are then
+// found on a much smaller graph of the nodes on cluster borders (with the
+// costs across each cluster worked out up front), and only the leg through the
+// agent's current cluster is refined into nodes; the agent asks again for the
+// rest once it gets to the end of it.
+//
+// Agents that all chase the same target can instead share a flow field: one
+// search out from the target's node giving every node the next node to head
+// for. It's rebuilt, a slice a frame, when the target moves to another node.
+// Fields ignore the occupancy costs that keep per-agent paths apart, so agents
+// on one field bunch up along the same nodes. They're off by default; 'F'
+// switches them on for crowds where that matters less than the search cost.
 //------------------------------------------------------------------------
 
 #ifndef AIPATHFINDER_H
@@ -12,8 +32,12 @@
 
 #include "GameObjectManager.h"
 #include "W_LineDrawer.h"
+#include "W_Types.h"
+#include "AINodeGrid.h"
 #include "tinyxml.h"
+#include <deque>
 #include <list>
+#include <map>
 #include <vector>
 #include <glm/glm.hpp>
 
@@ -26,28 +50,51 @@ namespace week2
 		// Public types.
 		//------------------------------------------------------------------------------
 
-		// A traversable node
+		// A traversable node. Its neighbours are kept apart, in m_lEdges.
 		struct PathNode
 		{
 			glm::vec3 m_vPosition;
-			std::vector<PathNode*> m_lNeighbourNodes;
-
-			// Temporary cached values only relevant while calculating a path in FindPath. 
-			// These are here to make searching more efficient.
-			int G;
-			int H;
-			PathNode* pParentNode;
-			bool bInOpenList;
-			bool bInClosedList;
-			bool bIsOccupied;
-
-			PathNode() : G(0), H(0), pParentNode(NULL), bInOpenList(false), bInClosedList(false), bIsOccupied(false) {}
 		};
 
 		// Typedefs
-		typedef std::vector<PathNode*> NodeList;
+		typedef std::vector<PathNode> NodeList;
 		typedef std::list<glm::vec3> PositionList;
 
+		// Per search bookkeeping, sized to the graph. Values are only valid for
+		// nodes stamped with the current generation, so nothing needs resetting
+		// between searches; one of these can be reused for every search.
+		struct SearchScratch
+		{
+			struct OpenEntry
+			{
+				float m_fF;
+				int m_iNode;
+			};
+
+			std::vector<float> m_lG;
+			std::vector<int> m_lParent;
+			std::vector<unsigned int> m_lSeen;
+			std::vector<unsigned int> m_lClosed;
+			std::vector<unsigned int> m_lOccupied;
+			std::vector<OpenEntry> m_lOpenHeap;
+			unsigned int m_uiGeneration;
+
+			// The same again for the cluster entrance graph, plus the costs to
+			// each entrance from the start and goal of a hierarchical search
+			std::vector<float> m_lAbstractG;
+			std::vector<int> m_lAbstractParent;
+			std::vector<unsigned int> m_lAbstractSeen;
+			std::vector<unsigned int> m_lAbstractClosed;
+			std::vector<float> m_lStartCosts;
+			std::vector<float> m_lGoalCosts;
+			std::vector<int> m_lRoute;
+			unsigned int m_uiAbstractGeneration;
+
+			SearchScratch() : m_uiGeneration(0), m_uiAbstractGeneration(0) {}
+			void Begin(unsigned int p_uiNumNodes);
+			void BeginAbstract(unsigned int p_uiNumNodes);
+		};
+
 	public:
 		//------------------------------------------------------------------------------
 		// Public methods.
@@ -59,8 +106,20 @@ namespace week2
 		void Update();
 		bool Load(const char* p_strPathfindingData);
 		const PathNode* const GetClosestNode(const glm::vec3& p_vPosition);
+		void GetNodesInRadius(const glm::vec3& p_vPosition, float p_fRadius, std::vector<int>& p_lNodes) const;
 		const PositionList& FindPath(const glm::vec3& p_vStart, const glm::vec3& p_vDestination);
 
+		// Path requests, one outstanding per agent
+		void StartWorkers(unsigned int p_uiNumThreads = 2);
+		void StopWorkers();
+		void RequestPath(Common::GameObjectHandle p_hAgent, const glm::vec3& p_vStart, const glm::vec3& p_vDestination);
+		bool TakePath(Common::GameObjectHandle p_hAgent, PositionList& p_lPath);
+		void ReleaseAgent(Common::GameObjectHandle p_hAgent);
+
+		// Flow fields, one per target
+		bool IsFlowFieldMode() const { return m_bFlowFieldMode; }
+		bool GetNextHop(Common::GameObjectHandle p_hTarget, const glm::vec3& p_vTarget, const glm::vec3& p_vPosition, glm::vec3& p_vNextHop);
+
 		// Debug rendering
 		void ToggleDebugRendering(Common::GameObjectManager* p_pGameObjectManager);
 		void Render(const glm::mat4& p_mProj, const glm::mat4& p_mView);
@@ -75,6 +134,94 @@ namespace week2
 		AIPathfinder();
 		~AIPathfinder();
 
+		//------------------------------------------------------------------------------
+		// Private types.
+		//------------------------------------------------------------------------------
+
+		// A search handed to the worker threads
+		struct PathRequest
+		{
+			Common::GameObjectHandle m_hAgent;
+			unsigned int m_uiSerial;
+			int m_iStart;
+			int m_iGoal;
+			unsigned int m_uiEpoch;
+			std::vector<int> m_lOccupied;
+			PositionList m_lPath;
+		};
+
+		// An agent's latest request; m_bReady once its path is waiting to be taken
+		struct AgentPath
+		{
+			unsigned int m_uiSerial;
+			int m_iPendingGoal;
+			bool m_bReady;
+			PositionList m_lPath;
+
+			AgentPath() : m_uiSerial(0), m_iPendingGoal(-1), m_bReady(false) {}
+		};
+
+		// Cached searches are only good for the occupancy they were made with
+		struct PathKey
+		{
+			int m_iStart;
+			int m_iGoal;
+			unsigned int m_uiEpoch;
+
+			bool operator<(const PathKey& p_other) const;
+		};
+		typedef std::list<std::pair<PathKey, PositionList> > PathCache;
+
+		// Next node towards one target from every node, -1 where it can't be
+		// reached. While a field for the target's new node is being built, the
+		// old one is still followed.
+		struct FlowField
+		{
+			int m_iTarget;
+			std::vector<int> m_lNextHop;
+			unsigned int m_uiLastUsedFrame;
+
+			int m_iBuildTarget;
+			std::vector<float> m_lBuildCost;
+			std::vector<int> m_lBuildNextHop;
+			std::vector<unsigned char> m_lBuildState;
+			std::vector<SearchScratch::OpenEntry> m_lBuildHeap;
+
+			FlowField() : m_iTarget(-1), m_uiLastUsedFrame(0), m_iBuildTarget(-1) {}
+		};
+
+		// A worker thread and the scratch only it searches with
+		struct Worker
+		{
+			AIPathfinder* m_pPathfinder;
+			GLFWthread m_thread;
+			SearchScratch m_scratch;
+		};
+
+		//------------------------------------------------------------------------------
+		// Private methods.
+		//------------------------------------------------------------------------------
+		int FindClosestNode(const glm::vec3& p_vPosition, bool p_bConnectedOnly) const;
+		bool Search(int p_iStart, int p_iGoal, const std::vector<int>& p_lOccupied, SearchScratch& p_scratch, PositionList& p_lPath) const;
+		bool SearchNodes(int p_iStart, int p_iGoal, int p_iCluster, const std::vector<int>& p_lOccupied, SearchScratch& p_scratch) const;
+		void AppendPath(int p_iGoal, const SearchScratch& p_scratch, PositionList& p_lPath) const;
+
+		// Hierarchical search
+		void BuildHierarchy(float p_fClusterSize);
+		int GetCluster(const glm::vec3& p_vPosition) const;
+		void GetEntranceCosts(int p_iNode, SearchScratch& p_scratch, std::vector<float>& p_lCosts) const;
+		bool SearchHierarchical(int p_iStart, int p_iGoal, const std::vector<int>& p_lOccupied, SearchScratch& p_scratch, PositionList& p_lPath) const;
+		bool SearchEntrances(int p_iStart, int p_iGoal, SearchScratch& p_scratch) const;
+
+		const PositionList* FindCachedPath(const PathKey& p_key);
+		void AddCachedPath(const PathKey& p_key, const PositionList& p_lPath);
+		void CollectSearchedPaths();
+		static void GLFWCALL WorkerThread(void* p_pArg);
+
+		void BeginFlowField(FlowField& p_field, int p_iTarget) const;
+		bool BuildFlowField(FlowField& p_field, unsigned int p_uiMaxNodes) const;
+		void UpdateFlowFields();
+
 	private:
 		//------------------------------------------------------------------------------
 		// Private members.
@@ -86,12 +233,73 @@ namespace week2
 		// Complete node list
 		NodeList m_lPathNodes;
 
+		// Neighbours of node i are m_lEdges[m_lEdgeStart[i]] up to
+		// m_lEdges[m_lEdgeStart[i + 1]], at the matching distances in m_lEdgeCosts
+		std::vector<int> m_lEdgeStart;
+		std::vector<int> m_lEdges;
+		std::vector<float> m_lEdgeCosts;
+
+		// Spatial lookups over all the nodes, and over just the ones with
+		// neighbours (the only ones worth starting or ending a path on)
+		AINodeGrid m_allNodeGrid;
+		AINodeGrid m_connectedNodeGrid;
+
+		// Hierarchical search; off unless m_fClusterSize > 0. Entrances are the
+		// nodes with a neighbour in another cluster. The entrances of cluster c
+		// are m_lClusterEntrances[m_lClusterEntranceStart[c]] up to the next
+		// cluster's start, as indices into m_lEntranceNodes. The entrance graph
+		// is laid out like the node graph, with each edge either an arc between
+		// clusters or the shortest way across one.
+		float m_fClusterSize;
+		glm::vec2 m_vClusterOrigin;
+		int m_iClustersX;
+		int m_iClustersZ;
+		std::vector<int> m_lNodeCluster;
+		std::vector<int> m_lEntranceNodes;
+		std::vector<int> m_lClusterEntranceStart;
+		std::vector<int> m_lClusterEntrances;
+		std::vector<int> m_lEntranceEdgeStart;
+		std::vector<int> m_lEntranceEdges;
+		std::vector<float> m_lEntranceEdgeCosts;
+
+		// Sorted nodes with an agent on them, avoided by searches. The epoch goes
+		// up whenever they change.
+		std::vector<int> m_lOccupied;
+		std::vector<int> m_lNextOccupied;
+		unsigned int m_uiOccupancyEpoch;
+
+		// Reused by searches made on the main thread
+		SearchScratch m_scratch;
+
+		// Worker threads. Both queues are guarded by the one mutex.
+		std::vector<Worker*> m_lWorkers;
+		bool m_bQuit;
+		GLFWmutex m_mutex;
+		GLFWcond m_toSearch;
+		std::deque<PathRequest*> m_lToSearch;
+		std::deque<PathRequest*> m_lSearched;
+
+		// Per agent results, and recent searches most recently used first
+		std::map<Common::GameObjectHandle, AgentPath> m_agentPaths;
+		unsigned int m_uiNextSerial;
+		PathCache m_lPathCache;
+		std::map<PathKey, PathCache::iterator> m_pathCacheIndex;
+
+		// Flow fields by target, dropped once nothing has followed them for a while
+		bool m_bFlowFieldMode;
+		unsigned int m_uiFrame;
+		std::map<Common::GameObjectHandle, FlowField> m_flowFields;
+
 		// Last path (stored for debug rendering)
 		PositionList m_lLastPath;
 
 		// Debugging
 		bool m_bDebugRendering;
 		wolf::LineDrawer* m_pLineDrawer;
+
+		// Cached handles of the agents whose positions mark nodes as occupied
+		static const int s_iNumOccupyingAgents = 3;
+		Common::GameObjectHandle m_ahOccupyingAgents[s_iNumOccupyingAgents];
 	};
 }
 
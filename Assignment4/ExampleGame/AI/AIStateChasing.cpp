@@ -26,6 +26,8 @@ using namespace week2;
 // Constructor.
 //------------------------------------------------------------------------------
 AIStateChasing::AIStateChasing()
+	:
+	m_hTargetGameObject(Common::INVALID_GAMEOBJECT_HANDLE)
 {
 }
 
@@ -49,16 +51,15 @@ void AIStateChasing::Enter()
 {
 	// Trigger the walk animation
 	ComponentAIController* pController = static_cast<ComponentAIController*>(m_pStateMachine->GetStateMachineOwner());
-	Common::ComponentBase* pComponent = pController->GetGameObject()->GetComponent("GOC_AnimController");
-	if (pComponent)
+	ComponentAnimController* pAnimController = pController->GetGameObject()->GetComponent<ComponentAnimController>();
+	if (pAnimController)
 	{
-		ComponentAnimController* pAnimController = static_cast<ComponentAnimController*>(pComponent);
 		pAnimController->SetAnim("walk");
 	}
 
 	// Set our target
 	// NOTE: this really should come into the state Enter() method as a context parameter so it's not hard coded.
-	m_pTargetGameObject = pController->GetGameObject()->GetManager()->GetGameObject("character");
+	m_hTargetGameObject = pController->GetGameObject()->GetManager()->GetGameObjectHandle("character");
 }
 
 //------------------------------------------------------------------------------
@@ -70,90 +71,23 @@ void AIStateChasing::Enter()
 //------------------------------------------------------------------------------
 void AIStateChasing::Update(float p_fDelta)
 {
-	if (m_pTargetGameObject)
+	// Resolved every frame; the target may have been destroyed and its 
+	// GameObject recycled since Enter()
+	ComponentAIController* pController = static_cast<ComponentAIController*>(m_pStateMachine->GetStateMachineOwner());
+	Common::GameObject* pTarget = pController->GetGameObject()->GetManager()->GetGameObject(m_hTargetGameObject);
+
+	if (pTarget)
 	{
-		ComponentAIController* pController = static_cast<ComponentAIController*>(m_pStateMachine->GetStateMachineOwner());
 		Common::Transform& transform = pController->GetGameObject()->GetTransform();
-		Common::Transform& targetTransform = m_pTargetGameObject->GetTransform();
+		Common::Transform& targetTransform = pTarget->GetTransform();
 
 		float fVelocity = 6.0f;
-		ComponentZombieStun* pStunComponent = static_cast<ComponentZombieStun*>(pController->GetGameObject()->GetComponent("GOC_ZombieStun"));
+		ComponentZombieStun* pStunComponent = pController->GetGameObject()->GetComponent<ComponentZombieStun>();
 		if (pStunComponent->GetIsStunned())
 			fVelocity /= 2;
 
-		bool m_bPathChange = false;
-		glm::vec3 vTemp;
-		// In two cases we want to recalculate our path:
-		//	1. If we don't have a path
-		//  2. If our target position is different from the existing path we are following
-		if (m_lPath.empty())
-		{
-			// We don't have a path yet
-			m_lPath = AIPathfinder::Instance()->FindPath(transform.GetTranslation(), targetTransform.GetTranslation());
-		}
-		else
-		{
-			const AIPathfinder::PathNode* const pEndNode = AIPathfinder::Instance()->GetClosestNode(targetTransform.GetTranslation());
-			glm::vec3 vTarget = m_lPath.back();
-			if (pEndNode->m_vPosition != vTarget)
-			{
-				// Our path has changed
-				//m_lPath.pop_front();
-				if (m_lPath.size()>1)
-					vTemp = glm::vec3(static_cast<glm::vec3>(*(m_lPath.begin())));
-				m_lPath = AIPathfinder::Instance()->FindPath(transform.GetTranslation(), targetTransform.GetTranslation());
-				m_bPathChange = true;
-			}
-		}
-
-		// Find the next node we should move towards
-		glm::vec3 vMoveTarget = transform.GetTranslation();
-		if (m_lPath.size() > 0)
-		{
-			
-			AIPathfinder::PositionList::const_iterator it1;
-			int i;
-			glm::vec3 node2;
-			for (it1 = m_lPath.begin(), i =0;it1!=m_lPath.end();it1++)
-			{
-				if (i==1)
-				{
-					node2 = static_cast<glm::vec3>(*it1);
-					break;
-				}
-				i++;
-			}
-			
-			// Move towards the first node in the path
-			AIPathfinder::PositionList::const_iterator it = m_lPath.begin();
-			
-			vMoveTarget = static_cast<glm::vec3>(*it);
-			
-			if(m_bPathChange)
-			{
-				if (node2.x == vTemp.x && node2.z == vTemp.z)
-				{
-					//vMoveTarget = vTemp;
-					if (m_lPath.size()>1)
-					{
-						m_lPath.pop_front();
-						it = m_lPath.begin();
-						vMoveTarget = static_cast<glm::vec3>(*it);
-						printf("true\n");
-					}
-				}
-				else
-					printf("false %f %f   %f %f\n", node2.x, vTemp.x, node2.z, vTemp.z);
-			}
-			
-			// If we're here then choose then next node instead
-			if (m_lPath.size() > 1 && glm::length(vMoveTarget - transform.GetTranslation()) < 0.5f)
-			{
-				m_lPath.pop_front();
-				it = m_lPath.begin();
-				vMoveTarget = static_cast<glm::vec3>(*it);
-			}
-		}
+		// Find the next position we should move towards
+		glm::vec3 vMoveTarget = m_pathFollower.GetMoveTarget(pController->GetGameObject()->GetHandle(), m_hTargetGameObject, transform.GetTranslation(), targetTransform.GetTranslation());
 
 		// Move towards our destination
 		glm::vec3 vDiff = vMoveTarget - transform.GetTranslation();
@@ -181,6 +115,9 @@ void AIStateChasing::Update(float p_fDelta)
 // Called when this state becomes inactive.
 //------------------------------------------------------------------------------
 void AIStateChasing::Exit()
-{	
-	m_pTargetGameObject = NULL;
+{
+	ComponentAIController* pController = static_cast<ComponentAIController*>(m_pStateMachine->GetStateMachineOwner());
+	m_pathFollower.Stop(pController->GetGameObject()->GetHandle());
+
+	m_hTargetGameObject = Common::INVALID_GAMEOBJECT_HANDLE;
 }
\ No newline at end of file
@@ -12,7 +12,7 @@
 
 #include "StateBase.h"
 #include "GameObject.h"
-#include <list>
+#include "AIPathFollower.h"
 
 namespace week2
 {
@@ -36,11 +36,11 @@ namespace week2
 		// Private members.
 		//------------------------------------------------------------------------------
 
-		// The GameObject we are chasing. Set when Enter() is called.
-		Common::GameObject* m_pTargetGameObject;
+		// Handle of the GameObject we are chasing. Set when Enter() is called.
+		Common::GameObjectHandle m_hTargetGameObject;
 
-		// Current path we are following
-		std::list<glm::vec3> m_lPath;
+		// Finds our way to the target
+		AIPathFollower m_pathFollower;
 	};
 } // namespace week9
 
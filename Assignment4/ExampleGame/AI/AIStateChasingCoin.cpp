@@ -49,10 +49,9 @@ void AIStateChasingCoin::Enter()
 {
 	// Trigger the walk animation
 	ComponentAIController* pController = static_cast<ComponentAIController*>(m_pStateMachine->GetStateMachineOwner());
-	Common::ComponentBase* pComponent = pController->GetGameObject()->GetComponent("GOC_AnimController");
-	if (pComponent)
+	ComponentAnimController* pAnimController = pController->GetGameObject()->GetComponent<ComponentAnimController>();
+	if (pAnimController)
 	{
-		ComponentAnimController* pAnimController = static_cast<ComponentAnimController*>(pComponent);
 		pAnimController->SetAnim("run");
 	}
 
@@ -68,93 +67,23 @@ void AIStateChasingCoin::Enter()
 //------------------------------------------------------------------------------
 void AIStateChasingCoin::Update(float p_fDelta)
 {
+	// Resolved every frame; the coin may have been collected and its 
+	// GameObject recycled
 	ComponentAIController* pController = static_cast<ComponentAIController*>(m_pStateMachine->GetStateMachineOwner());
-	m_pTargetGameObject = pController->GetGameObject()->GetManager()->GetGameObject(pController->GetCoinTarget());
+	Common::GameObject* pTarget = pController->GetGameObject()->GetManager()->GetGameObject(pController->GetCoinTarget());
 
-	if (m_pTargetGameObject)
+	if (pTarget)
 	{
-		ComponentAIController* pController = static_cast<ComponentAIController*>(m_pStateMachine->GetStateMachineOwner());
 		Common::Transform& transform = pController->GetGameObject()->GetTransform();
-		Common::Transform& targetTransform = m_pTargetGameObject->GetTransform();
+		Common::Transform& targetTransform = pTarget->GetTransform();
 
 		float fVelocity = 6.0f;
-		ComponentZombieStun* pStunComponent = static_cast<ComponentZombieStun*>(pController->GetGameObject()->GetComponent("GOC_ZombieStun"));
+		ComponentZombieStun* pStunComponent = pController->GetGameObject()->GetComponent<ComponentZombieStun>();
 		if (pStunComponent->GetIsStunned())
 			fVelocity /= 2;
 
-		bool m_bPathChange = false;
-		glm::vec3 vTemp;
-		// In two cases we want to recalculate our path:
-		//	1. If we don't have a path
-		//  2. If our target position is different from the existing path we are following
-		if (m_lPath.empty())
-		{
-			// We don't have a path yet
-			m_lPath = AIPathfinder::Instance()->FindPath(transform.GetTranslation(), targetTransform.GetTranslation());
-		}
-		else
-		{
-			const AIPathfinder::PathNode* const pEndNode = AIPathfinder::Instance()->GetClosestNode(targetTransform.GetTranslation());
-			glm::vec3 vTarget = m_lPath.back();
-			if (pEndNode->m_vPosition != vTarget)
-			{
-				// Our path has changed
-				//m_lPath.pop_front();
-				if (m_lPath.size()>1)
-					vTemp = glm::vec3(static_cast<glm::vec3>(*(m_lPath.begin())));
-				m_lPath = AIPathfinder::Instance()->FindPath(transform.GetTranslation(), targetTransform.GetTranslation());
-				m_bPathChange = true;
-			}
-		}
-
-		// Find the next node we should move towards
-		glm::vec3 vMoveTarget = transform.GetTranslation();
-		if (m_lPath.size() > 0)
-		{
-			
-			AIPathfinder::PositionList::const_iterator it1;
-			int i;
-			glm::vec3 node2;
-			for (it1 = m_lPath.begin(), i =0;it1!=m_lPath.end();it1++)
-			{
-				if (i==1)
-				{
-					node2 = static_cast<glm::vec3>(*it1);
-					break;
-				}
-				i++;
-			}
-			
-			// Move towards the first node in the path
-			AIPathfinder::PositionList::const_iterator it = m_lPath.begin();
-			
-			vMoveTarget = static_cast<glm::vec3>(*it);
-			
-			if(m_bPathChange)
-			{
-				if (node2.x == vTemp.x && node2.z == vTemp.z)
-				{
-					//vMoveTarget = vTemp;
-					if (m_lPath.size()>1)
-					{
-						m_lPath.pop_front();
-						it = m_lPath.begin();
-						vMoveTarget = static_cast<glm::vec3>(*it);
-						printf("true\n");
-					}
-				}
-				else
-					printf("false %f %f   %f %f\n", node2.x, vTemp.x, node2.z, vTemp.z);
-			}
-			
-			// If we're here then choose then next node instead
-			if (m_lPath.size() > 1 && glm::length(vMoveTarget - transform.GetTranslation()) < 0.5f)
-			{
-				m_lPath.pop_front();
-				it = m_lPath.begin();
-				vMoveTarget = static_cast<glm::vec3>(*it);
-			}
-		}
+		// Find the next position we should move towards
+		glm::vec3 vMoveTarget = m_pathFollower.GetMoveTarget(pController->GetGameObject()->GetHandle(), pController->GetCoinTarget(), transform.GetTranslation(), targetTransform.GetTranslation());
 
 		// Move towards our destination
 		glm::vec3 vDiff = vMoveTarget - transform.GetTranslation();
@@ -182,6 +111,7 @@ void AIStateChasingCoin::Update(float p_fDelta)
 // Called when this state becomes inactive.
 //------------------------------------------------------------------------------
 void AIStateChasingCoin::Exit()
-{	
-	m_pTargetGameObject = NULL;
+{
+	ComponentAIController* pController = static_cast<ComponentAIController*>(m_pStateMachine->GetStateMachineOwner());
+	m_pathFollower.Stop(pController->GetGameObject()->GetHandle());
 }
\ No newline at end of file
@@ -4,7 +4,7 @@
 
 #include "StateBase.h"
 #include "GameObject.h"
-#include <list>
+#include "AIPathFollower.h"
 
 namespace week2
 {
@@ -28,11 +28,8 @@ namespace week2
 		// Private members.
 		//------------------------------------------------------------------------------
 
-		// The GameObject we are chasing. Set when Enter() is called.
-		Common::GameObject* m_pTargetGameObject;
-
-		// Current path we are following
-		std::list<glm::vec3> m_lPath;
+		// Finds our way to the target
+		AIPathFollower m_pathFollower;
 	};
 } // namespace week9
 
@@ -45,10 +45,9 @@ void AIStateIdle::Enter()
 {
 	// Trigger the idle animation
 	ComponentAIController* pController = static_cast<ComponentAIController*>(m_pStateMachine->GetStateMachineOwner());
-	Common::ComponentBase* pComponent = pController->GetGameObject()->GetComponent("GOC_AnimController");
-	if (pComponent)
+	ComponentAnimController* pAnimController = pController->GetGameObject()->GetComponent<ComponentAnimController>();
+	if (pAnimController)
 	{
-		ComponentAnimController* pAnimController = static_cast<ComponentAnimController*>(pComponent);
 		pAnimController->SetAnim("idle");
 	}
 }
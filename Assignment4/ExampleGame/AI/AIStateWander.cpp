@@ -46,10 +46,9 @@ void AIStateWander::Enter()
 {
 	// Trigger the injured walk animation
 	ComponentAIController* pController = static_cast<ComponentAIController*>(m_pStateMachine->GetStateMachineOwner());
-	Common::ComponentBase* pComponent = pController->GetGameObject()->GetComponent("GOC_AnimController");
-	if (pComponent)
+	ComponentAnimController* pAnimController = pController->GetGameObject()->GetComponent<ComponentAnimController>();
+	if (pAnimController)
 	{
-		ComponentAnimController* pAnimController = static_cast<ComponentAnimController*>(pComponent);
 		pAnimController->SetAnim("walk");
 	}
 
@@ -5,12 +5,12 @@
 
 UtilityWorldState::UtilityWorldState()
 {
-	m_sCoinID1 = "";
-	m_sCoinID2 = "";
-	m_pCharacter = nullptr;
-	m_pZombieCharacter = nullptr;
-	m_pZombieCoin1 = nullptr;
-	m_pZombieCoin2 = nullptr;
+	m_hCoin1 = INVALID_GAMEOBJECT_HANDLE;
+	m_hCoin2 = INVALID_GAMEOBJECT_HANDLE;
+	m_hCharacter = INVALID_GAMEOBJECT_HANDLE;
+	m_hZombieCharacter = INVALID_GAMEOBJECT_HANDLE;
+	m_hZombieCoin1 = INVALID_GAMEOBJECT_HANDLE;
+	m_hZombieCoin2 = INVALID_GAMEOBJECT_HANDLE;
 }
 
 UtilityWorldState::~UtilityWorldState()
@@ -26,21 +26,22 @@ void UtilityWorldState::ApplyAction(AIState p_eStateAction)
 float UtilityWorldState::Utility(GameObject* p_pGameObject)
 {
 	float fUtility = 0.0;
-	if (m_pZombieCharacter == nullptr)
+	GameObjectHandle hGameObject = p_pGameObject->GetHandle();
+	if (m_hZombieCharacter == INVALID_GAMEOBJECT_HANDLE)
 	{
-		m_pZombieCharacter = p_pGameObject;
+		m_hZombieCharacter = hGameObject;
 		//fUtility = 100;
 	}
-	else if (m_pZombieCoin1 == nullptr)
+	else if (m_hZombieCoin1 == INVALID_GAMEOBJECT_HANDLE)
 	{
-		m_pZombieCoin1 = p_pGameObject;
+		m_hZombieCoin1 = hGameObject;
 	}
-	else if (m_pZombieCoin2 == nullptr)
+	else if (m_hZombieCoin2 == INVALID_GAMEOBJECT_HANDLE)
 	{
-		m_pZombieCoin2 = p_pGameObject;
+		m_hZombieCoin2 = hGameObject;
 	}
 
-	if (p_pGameObject == m_pZombieCharacter)
+	if (hGameObject == m_hZombieCharacter)
 	{
 		if (m_eStateAction == AIState::eAIState_Chasing)
 			fUtility = 100;
@@ -49,7 +50,7 @@ float UtilityWorldState::Utility(GameObject* p_pGameObject)
 		else if (m_eStateAction == AIState::eAIState_ChasingCoin)
 			fUtility = 0;
 	}
-	else if (p_pGameObject == m_pZombieCoin1)
+	else if (hGameObject == m_hZombieCoin1)
 	{
 		if (m_eStateAction == AIState::eAIState_Chasing)
 			fUtility = 0;
@@ -57,15 +58,15 @@ float UtilityWorldState::Utility(GameObject* p_pGameObject)
 			fUtility = 50;
 		else if (m_eStateAction == AIState::eAIState_ChasingCoin)
 		{
-			if (m_sCoinID1.compare("") != 0)
+			if (m_hCoin1 != INVALID_GAMEOBJECT_HANDLE)
 			{
 				fUtility = 100;
-				ComponentAIController *pAIController = static_cast<ComponentAIController*>(p_pGameObject->GetComponent("GOC_AIController"));
-				pAIController->SetCoinTarget(m_sCoinID1);
+				ComponentAIController *pAIController = p_pGameObject->GetComponent<ComponentAIController>();
+				pAIController->SetCoinTarget(m_hCoin1);
 			}
 		}
 	}
-	else if (p_pGameObject == m_pZombieCoin2)
+	else if (hGameObject == m_hZombieCoin2)
 	{
 		if (m_eStateAction == AIState::eAIState_Chasing)
 			fUtility = 0;
@@ -73,11 +74,11 @@ float UtilityWorldState::Utility(GameObject* p_pGameObject)
 			fUtility = 50;
 		else if (m_eStateAction == AIState::eAIState_ChasingCoin)
 		{
-			if (m_sCoinID2.compare("") != 0)
+			if (m_hCoin2 != INVALID_GAMEOBJECT_HANDLE)
 			{
 				fUtility = 100;
-				ComponentAIController *pAIController = static_cast<ComponentAIController*>(p_pGameObject->GetComponent("GOC_AIController"));
-				pAIController->SetCoinTarget(m_sCoinID2);
+				ComponentAIController *pAIController = p_pGameObject->GetComponent<ComponentAIController>();
+				pAIController->SetCoinTarget(m_hCoin2);
 			}
 		}
 	}
@@ -89,23 +90,25 @@ UtilityWorldState* UtilityWorldState::Copy()
 {
 	UtilityWorldState *worldStateCopy = new UtilityWorldState();
 
-	GameObject* pTimer = ExampleGame::GetInstance()->GameObjectManager()->GetGameObject("timer");
-	ComponentTimerLogic* pTimerLogic = static_cast<ComponentTimerLogic*>(pTimer->GetComponent("GOC_TimerLogic"));
-	std::vector<std::string>* pListCoinID = pTimerLogic->GetCurrentCoinID();
-	for (int j = 0; j<pListCoinID->size(); j++)
+	// Looked up by name every time rather than cached; a cache outliving the
+	// GameObjectManager (or a level reload) would hand back the wrong objects
+	Common::GameObjectManager* pGameObjectManager = ExampleGame::GetInstance()->GameObjectManager();
+
+	GameObject* pTimer = pGameObjectManager->GetGameObject(std::string("timer"));
+	ComponentTimerLogic* pTimerLogic = pTimer ? pTimer->GetComponent<ComponentTimerLogic>() : NULL;
+	if (pTimerLogic)
 	{
-		if (j == 0)
-			worldStateCopy->m_sCoinID1 = pListCoinID->at(j);
-		else if (j == 1)
-			worldStateCopy->m_sCoinID2 = pListCoinID->at(j);
-		else if (j==2)
-			break;
+		const std::vector<GameObjectHandle>& lCoins = pTimerLogic->GetCurrentCoins();
+		if (lCoins.size() > 0)
+			worldStateCopy->m_hCoin1 = lCoins[0];
+		if (lCoins.size() > 1)
+			worldStateCopy->m_hCoin2 = lCoins[1];
 	}
 
-	worldStateCopy->m_pCharacter = ExampleGame::GetInstance()->GameObjectManager()->GetGameObject("character");
-	worldStateCopy->m_pZombieCharacter = ExampleGame::GetInstance()->GameObjectManager()->GetGameObject("zombieCharacter");
-	worldStateCopy->m_pZombieCoin1 = ExampleGame::GetInstance()->GameObjectManager()->GetGameObject("zombieCoin1");
-	worldStateCopy->m_pZombieCoin2 = ExampleGame::GetInstance()->GameObjectManager()->GetGameObject("zombieCoin2");
+	worldStateCopy->m_hCharacter = pGameObjectManager->GetGameObjectHandle("character");
+	worldStateCopy->m_hZombieCharacter = pGameObjectManager->GetGameObjectHandle("zombieCharacter");
+	worldStateCopy->m_hZombieCoin1 = pGameObjectManager->GetGameObjectHandle("zombieCoin1");
+	worldStateCopy->m_hZombieCoin2 = pGameObjectManager->GetGameObjectHandle("zombieCoin2");
 
 	return worldStateCopy;
 }
\ No newline at end of file
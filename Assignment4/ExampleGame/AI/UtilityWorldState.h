@@ -24,14 +24,14 @@ namespace week2
 
 	private:
 		AIState m_eStateAction;
-		GameObject* m_pCharacter;
+		GameObjectHandle m_hCharacter;
 
-		GameObject* m_pZombieCharacter;
-		GameObject* m_pZombieCoin1;
-		GameObject* m_pZombieCoin2;
+		GameObjectHandle m_hZombieCharacter;
+		GameObjectHandle m_hZombieCoin1;
+		GameObjectHandle m_hZombieCoin2;
 
-		std::string m_sCoinID1;
-		std::string m_sCoinID2;
+		GameObjectHandle m_hCoin1;
+		GameObjectHandle m_hCoin2;
 
 	};
 }
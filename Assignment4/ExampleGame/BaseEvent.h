@@ -1,4 +1,3 @@
-
 #ifndef BASEEVENT_H
 #define BASEEVENT_H
 
@@ -8,18 +7,36 @@ enum EventType
 	Event_CoinDisappeared,
 	Event_ObjectCollision,
 	Event_CharacterCollision,
-	Event_CoinCollected
+	Event_CoinCollected,
+
+	Event_Count
 };
 
-class BaseEvent
+// Points in the frame where the EventManager delivers queued events
+enum EventPhase
 {
-public:
-	virtual EventType GetEventType(){return m_EventType;}
+	EventPhase_PostPhysics,
+	EventPhase_PostAI,
+	EventPhase_PreRender,
 
-protected:
-	EventType m_EventType;
+	EventPhase_Count
 };
 
+// Events are small value types stored by value in the EventManager's queues.
+// Deriving from BaseEvent<TYPE, PHASE> ties an event struct to its EventType
+// and to the phase its queued events are delivered in by default.
+//
+// Events name GameObjects by handle, never by pointer. A queued event can be
+// delivered after its GameObject was destroyed and recycled, so listeners 
+// resolve the handles when they get it and skip ones that come back NULL.
+template<EventType TYPE, EventPhase PHASE = EventPhase_PostPhysics>
+struct BaseEvent
+{
+	static const EventType s_eEventType = TYPE;
+	static const EventPhase s_eEventPhase = PHASE;
+};
 
+template<EventType TYPE, EventPhase PHASE> const EventType BaseEvent<TYPE, PHASE>::s_eEventType;
+template<EventType TYPE, EventPhase PHASE> const EventPhase BaseEvent<TYPE, PHASE>::s_eEventPhase;
 
-#endif
\ No newline at end of file
+#endif
@@ -35,7 +35,7 @@ ComponentAIController::ComponentAIController()
 	:
 	m_pStateMachine(NULL)
 {
-	m_sCoinTarget = "";
+	m_hCoinTarget = Common::INVALID_GAMEOBJECT_HANDLE;
 	m_iFrameCount = 0;
 }
 
@@ -12,6 +12,7 @@
 #define COMPNENTAICONTROLLER_H
 
 #include "ComponentBase.h"
+#include "GameObjectHandle.h"
 #include "StateMachine.h"
 #include "tinyxml\tinyxml.h"
 
@@ -44,7 +45,7 @@ namespace week2
 
 		static Common::ComponentBase* CreateComponent(TiXmlNode* p_pNode);
 
-		virtual const std::string FamilyID() { return std::string("GOC_AIController"); }
+		DECLARE_COMPONENT_FAMILY("GOC_AIController")
 		virtual const std::string ComponentID(){ return std::string("GOC_AIController"); }
 		virtual void Update(float p_fDelta);
 
@@ -62,8 +63,8 @@ namespace week2
 			else													{ return eAIState_None; }
 		}
 
-		void SetCoinTarget(std::string p_sCoin) { m_sCoinTarget = p_sCoin;}
-		const std::string& GetCoinTarget() { return m_sCoinTarget;}
+		void SetCoinTarget(Common::GameObjectHandle p_hCoin) { m_hCoinTarget = p_hCoin;}
+		Common::GameObjectHandle GetCoinTarget() { return m_hCoinTarget;}
 		AIState GetCurrentState() { return (AIState)m_pStateMachine->GetCurrentStateID();}
 	private:
 		//------------------------------------------------------------------------------
@@ -74,7 +75,7 @@ namespace week2
 		// Our state machine
 		Common::StateMachine* m_pStateMachine;
 
-		std::string m_sCoinTarget;
+		Common::GameObjectHandle m_hCoinTarget;
 		int m_iFrameCount;
 	};
 }
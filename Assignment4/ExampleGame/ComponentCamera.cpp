@@ -77,6 +77,8 @@ Common::ComponentBase* ComponentCamera::CreateComponent(TiXmlNode* p_pNode)
 }
 
 ComponentCamera::ComponentCamera(float p_fFOV, float p_fAspectRatio, float p_fNearClip, float p_fFarClip, const glm::vec3 &p_vPos, const glm::vec3& p_vTarget, const glm::vec3& p_vUp)
+	:
+	m_hCharacter(Common::INVALID_GAMEOBJECT_HANDLE)
 {
 	m_pCamera = new Common::SceneCamera(p_fFOV, p_fAspectRatio, p_fNearClip, p_fFarClip, p_vPos, p_vTarget, p_vUp);
 }
@@ -84,6 +86,9 @@ ComponentCamera::ComponentCamera(float p_fFOV, float p_fAspectRatio, float p_fNe
 
 void ComponentCamera::Update(float p_fDelta) 
 {
-	Common::GameObject* pCharacter = this->GetGameObject()->GetManager()->GetGameObject("character");
-	m_pCamera->SetTarget(pCharacter->GetTransform().GetTranslation());
+	Common::GameObject* pCharacter = this->GetGameObject()->GetManager()->ResolveGameObject(m_hCharacter, "character");
+	if (pCharacter)
+	{
+		m_pCamera->SetTarget(pCharacter->GetTransform().GetTranslation());
+	}
 }
\ No newline at end of file
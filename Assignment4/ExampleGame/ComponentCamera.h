@@ -2,6 +2,7 @@
 #define COMPNENT_CAMERA_H
 
 #include "ComponentBase.h"
+#include "GameObjectHandle.h"
 #include "SceneCamera.h"
 #include "tinyxml\tinyxml.h"
 
@@ -15,7 +16,7 @@ public:
 
 	virtual const std::string ComponentID(){ return std::string("GOC_Camera"); }
 	virtual void Update(float p_fDelta) ;
-	virtual const std::string FamilyID() { return std::string("GOC_Camera"); }
+	DECLARE_COMPONENT_FAMILY("GOC_Camera")
 
 	Common::SceneCamera* GetCamera() {return m_pCamera;}
 
@@ -23,6 +24,9 @@ public:
 
 private:
 	Common::SceneCamera *m_pCamera;
+
+	// Cached handle of the character we look at
+	Common::GameObjectHandle m_hCharacter;
 };
 }
 #endif
\ No newline at end of file
@@ -85,7 +85,7 @@ void ComponentCameraFollow::Update(float p_fDelta)
 {
 	Common::Transform objectTransform = this->GetGameObject()->GetTransform();
 
-	ComponentCharacterController *pControllerComponent = static_cast<ComponentCharacterController*>(GetGameObject()->GetComponent("GOC_CharacterController"));
+	ComponentCharacterController *pControllerComponent = GetGameObject()->GetComponent<ComponentCharacterController>();
 
 	glm::vec3 vFace = pControllerComponent->getFaceDirection();
 
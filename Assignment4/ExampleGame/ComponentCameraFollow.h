@@ -15,7 +15,7 @@ public:
 
 	virtual const std::string ComponentID(){ return std::string("GOC_CameraFollow"); }
 	virtual void Update(float p_fDelta) ;
-	virtual const std::string FamilyID() { return std::string("GOC_CameraFollow"); }
+	DECLARE_COMPONENT_FAMILY("GOC_CameraFollow")
 
 	static Common::ComponentBase* CreateComponent(TiXmlNode* p_pNode);
 
@@ -47,6 +47,6 @@ void ComponentCoinLife::Update(float p_fDelta)
 	if (m_fTimePassed > m_fLifeSpan)
 	{
 		this->GetGameObject()->GetManager()->AddRemovedObject(this->GetGameObject());
-		EventManager::Instance()->QueueEvent(new EventCoinDisappeared(this->GetGameObject()));
+		EventManager::Instance()->QueueEvent(EventCoinDisappeared(this->GetGameObject()));
 	}
 }
\ No newline at end of file
@@ -12,7 +12,7 @@ namespace week2
 		ComponentCoinLife(){};//float p_fLife) { m_fLifeSpan = p_fLife; }
 		virtual ~ComponentCoinLife(){};
 
-		virtual const std::string FamilyID() { return std::string("GOC_LifeSpan"); }
+		DECLARE_COMPONENT_FAMILY("GOC_LifeSpan")
 		virtual const std::string ComponentID(){ return std::string("GOC_LifeSpan"); }
 
 		static Common::ComponentBase* CreateComponent(TiXmlNode* p_pNode);
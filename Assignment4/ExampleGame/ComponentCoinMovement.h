@@ -13,7 +13,7 @@ namespace week2
 		ComponentCoinMovement(){m_iBobFlag = 1; m_fBob = 0;};
 		virtual ~ComponentCoinMovement(){};
 
-		virtual const std::string FamilyID() { return std::string("GOC_CoinMovement"); }
+		DECLARE_COMPONENT_FAMILY("GOC_CoinMovement")
 		virtual const std::string ComponentID(){ return std::string("GOC_CoinMovement"); }
 		virtual void Update(float p_fDelta);
 
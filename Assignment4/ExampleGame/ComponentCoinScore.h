@@ -12,7 +12,7 @@ namespace week2
 		ComponentCoinScore(){};//)int p_iScore) { m_iScore = p_iScore; }
 		virtual ~ComponentCoinScore(){};
 
-		virtual const std::string FamilyID() { return std::string("GOC_CoinScore"); }
+		DECLARE_COMPONENT_FAMILY("GOC_CoinScore")
 		virtual const std::string ComponentID(){ return std::string("GOC_CoinScore"); }
 
 		static Common::ComponentBase* CreateComponent(TiXmlNode* p_pNode);
@@ -12,7 +12,7 @@ namespace week2
 		ComponentCollision(){};//float p_fRadius) { m_fBoundingRadius = p_fRadius; }
 		virtual ~ComponentCollision(){};
 
-		virtual const std::string FamilyID() { return std::string("GOC_CollisionSphere"); }
+		DECLARE_COMPONENT_FAMILY("GOC_CollisionSphere")
 		virtual const std::string ComponentID(){ return std::string("GOC_CollisionSphere"); }
 		virtual void Update(float p_fDelta);
 
@@ -13,7 +13,7 @@ namespace week2
 		ComponentMouseClick();
 		virtual ~ComponentMouseClick();
 
-		virtual const std::string FamilyID() { return std::string("GOC_MouseClick"); }
+		DECLARE_COMPONENT_FAMILY("GOC_MouseClick")
 		virtual const std::string ComponentID(){ return std::string("GOC_MouseClick"); }
 
 		static Common::ComponentBase* CreateComponent(TiXmlNode* p_pNode);
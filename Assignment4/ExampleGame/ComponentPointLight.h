@@ -29,7 +29,7 @@ public:
     void SetLightAttenuation(glm::vec3 p_vAttenuation) { m_pPointLight->m_vAttenuation = p_vAttenuation; }
     void SetLightRange(float p_fRange) { m_pPointLight->m_fRange = p_fRange; }
 
-	virtual const std::string FamilyID() { return std::string("GOC_PointLight"); }
+	DECLARE_COMPONENT_FAMILY("GOC_PointLight")
     virtual const std::string ComponentID() { return std::string("GOC_PointLight"); }
     virtual void SyncTransform();
 
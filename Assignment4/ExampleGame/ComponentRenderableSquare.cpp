@@ -93,4 +93,5 @@ void ComponentRenderableSquare::Init(const std::string &p_strTexturePath, const
 void ComponentRenderableSquare::SyncTransform()
 {
 	m_pSquare->SetTransform(this->GetGameObject()->GetTransform().GetTransformation());
+	Common::SceneManager::Instance()->UpdateSquareBounds(m_pSquare);
 }
\ No newline at end of file
@@ -26,7 +26,7 @@ namespace week2
 		virtual ~ComponentRigidBody();
 
 		virtual const std::string ComponentID(){ return std::string("GOC_RigidBody"); }
-		virtual const std::string FamilyID(){ return std::string("GOC_RigidBody"); }
+		DECLARE_COMPONENT_FAMILY("GOC_RigidBody")
 		virtual void Update(float p_fDelta);
 
 		//------------------------------------------------------------------------------
@@ -17,13 +17,14 @@ using namespace week2;
 
 ComponentTimerLogic::ComponentTimerLogic()
 {
-	EventListener eventListener1 = std::tr1::bind(&ComponentTimerLogic::HandleCoinCollision, this, std::tr1::placeholders::_1);
-	EventManager::Instance()->AddListener(Event_ObjectCollision, eventListener1);
-
-	EventListener eventListener2 = std::tr1::bind(&ComponentTimerLogic::HandleCoinDisappeared, this, std::tr1::placeholders::_1);
-	EventManager::Instance()->AddListener(Event_CoinDisappeared, eventListener2);
+	m_hCollisionListener = EventManager::Instance()->AddBatchListener<EventObjectCollision>(std::tr1::bind(&ComponentTimerLogic::HandleCoinCollisions, this, std::tr1::placeholders::_1));
+	m_hCoinDisappearedListener = EventManager::Instance()->AddListener<EventCoinDisappeared>(std::tr1::bind(&ComponentTimerLogic::HandleCoinDisappeared, this, std::tr1::placeholders::_1));
+}
 
-	m_lNumCoin = 0;
+ComponentTimerLogic::~ComponentTimerLogic()
+{
+	EventManager::Instance()->RemoveListener(m_hCollisionListener);
+	EventManager::Instance()->RemoveListener(m_hCoinDisappearedListener);
 }
 
 Common::ComponentBase* ComponentTimerLogic::CreateComponent(TiXmlNode* p_pNode)
@@ -111,117 +112,60 @@ void ComponentTimerLogic::CreateCoin()
 	float randomZ = rand()%20 -rand()%40;;
 	
 	Common::GameObject* pCoin = ExampleGame::GetInstance()->GameObjectManager()->CreateGameObject("Assignment4/ExampleGame/data/xml/coin.xml");
-	pCoin->GetManager()->SetGameObjectGUID(pCoin, "coin" + std::to_string(m_lNumCoin++));
 	pCoin->GetTransform().Translate(glm::vec3(randomX, 10.0f, randomZ));
-	m_lCoinList.push_back(pCoin);
+	m_lCoinList.push_back(pCoin->GetHandle());
 
-	ComponentRigidBody* pCoinRigid = static_cast<ComponentRigidBody*>(pCoin->GetComponent("GOC_RigidBody"));
+	ComponentRigidBody* pCoinRigid = pCoin->GetComponent<ComponentRigidBody>();
 	pCoinRigid->BindGameObject();
 
-	EventManager::Instance()->QueueEvent(new EventCoinSpawned(pCoin));
+	EventManager::Instance()->QueueEvent(EventCoinSpawned(pCoin));
 }
 
-void ComponentTimerLogic::HandleCoinCollision(BaseEvent *p_Event)
+void ComponentTimerLogic::HandleCoinCollisions(const EventBatch<EventObjectCollision>& p_Collisions)
 {
-	EventObjectCollision *pEventCollision = static_cast<EventObjectCollision*>(p_Event);
-	Common::GameObject* pGameObjectA = pEventCollision->GetGameObject1();
-	Common::GameObject* pGameObjectB = pEventCollision->GetGameObject2();
-	
-	Common::GameObject* pCharacter = NULL;
-	Common::GameObject* pCoin = NULL;
-	Common::GameObject* pZombie = NULL;
-	
-	std::string subName1 = (pGameObjectA->GetGUID()).substr(0,4);
-	std::string subName2 = (pGameObjectB->GetGUID()).substr(0,4);
+	Common::GameObjectManager* pManager = this->GetGameObject()->GetManager();
+	bool bCoinTaken = false;
 
-	if (subName1.compare("coin") == 0)
+	for (unsigned int i = 0; i < p_Collisions.GetCount(); ++i)
 	{
-		pCoin = pGameObjectA;
-		if (pGameObjectB->GetGUID().compare("character") == 0)
-			pCharacter = pGameObjectB;
-		else
-		{
-			std::string subNameB = (pGameObjectB->GetGUID()).substr(0,6);
-			if (subNameB.compare("zombie") == 0)
-				pZombie = pGameObjectB;
-		}
-	}
-	else if (subName2.compare("coin") == 0)
-	{
-		pCoin = pGameObjectB;
-		if (pGameObjectA->GetGUID().compare("character") == 0)
-			pCharacter = pGameObjectA;
-		else
-		{
-			std::string subNameA = (pGameObjectA->GetGUID()).substr(0,6);
-			if (subNameA.compare("zombie") == 0)
-				pZombie = pGameObjectA;
-		}
-	}
-	/*
-	if (pGameObjectA->GetGUID().compare("character") == 0)
-	{
-		pCharacter = pGameObjectA;
-		pOtherObject = pGameObjectB;
-	}
-	else if (pGameObjectB->GetGUID().compare("character") == 0)
-	{
-		pCharacter = pGameObjectB;
-		pOtherObject = pGameObjectA;
-	}
-	else 	
-	{
-		std::string subName1 = (pGameObjectA->GetGUID()).substr(0,6);
-		std::string subName2 = (pGameObjectB->GetGUID()).substr(0,6);
-		if (subName1.compare("zombie") == 0)
-		{
-			pZombie = pGameObjectA;
-			pOtherObject = pGameObjectB;
-		}
-		else if (subName2.compare("zombie") == 0)
+		// Our coins are the ones in the coin list. A coin touches whatever picks 
+		// it up for several steps, but it leaves the list on the first contact, 
+		// so only that one counts.
+		Common::GameObjectHandle hOther = p_Collisions[i].GetGameObject2();
+		std::vector<Common::GameObjectHandle>::iterator it = std::find(m_lCoinList.begin(), m_lCoinList.end(), p_Collisions[i].GetGameObject1());
+		if (it == m_lCoinList.end())
 		{
-			pZombie = pGameObjectB;
-			pOtherObject = pGameObjectA;
+			hOther = p_Collisions[i].GetGameObject1();
+			it = std::find(m_lCoinList.begin(), m_lCoinList.end(), p_Collisions[i].GetGameObject2());
 		}
-	}
-	*/
+		if (it == m_lCoinList.end())
+			continue;
 
-	if (pCoin)
-	{
-		if (pCharacter)
-		{
-			std::vector<Common::GameObject*>::iterator it = std::find(m_lCoinList.begin(), m_lCoinList.end(), pCoin);
-			if (it != m_lCoinList.end())
-			{
-				m_lCoinList.erase(it);
-			}	
-			if (!this->GetGameObject()->GetManager()->CheckRemoveObject(pCoin))
-				this->GetGameObject()->GetManager()->AddRemovedObject(pCoin);
+		// Either may have been destroyed since the collision was queued
+		Common::GameObject* pCoin = pManager->GetGameObject(*it);
+		Common::GameObject* pOther = pManager->GetGameObject(hOther);
+		if (pCoin == NULL || pOther == NULL || pManager->CheckRemoveObject(pCoin))
+			continue;
 
-			EventManager::Instance()->QueueEvent(new EventCoinCollected(pEventCollision->GetGameObject1(), pCoin));
-			m_fTimePassed = 0.0f;
-		}
-		else if (pZombie)
-		{
-			std::vector<Common::GameObject*>::iterator it = std::find(m_lCoinList.begin(), m_lCoinList.end(), pCoin);
-			if (it != m_lCoinList.end())
-			{
-				m_lCoinList.erase(it);
-			}	
-			if (!this->GetGameObject()->GetManager()->CheckRemoveObject(pCoin))
-				this->GetGameObject()->GetManager()->AddRemovedObject(pCoin);
-		
-			m_fTimePassed = 0.0f;
-		}
+		bool bCharacter = pOther->GetGUID().compare("character") == 0;
+		if (!bCharacter && pOther->GetGUID().compare(0, 6, "zombie") != 0)
+			continue;
+
+		m_lCoinList.erase(it);
+		pManager->AddRemovedObject(pCoin);
+
+		if (bCharacter)
+			EventManager::Instance()->QueueEvent(EventCoinCollected(pOther, pCoin));
+		bCoinTaken = true;
 	}
+
+	if (bCoinTaken)
+		m_fTimePassed = 0.0f;
 }
 
-void ComponentTimerLogic::HandleCoinDisappeared(BaseEvent *p_Event)
+void ComponentTimerLogic::HandleCoinDisappeared(const EventCoinDisappeared& p_Event)
 {
-	EventCoinDisappeared *pEventCollision = static_cast<EventCoinDisappeared*>(p_Event);
-	Common::GameObject *pCoin = pEventCollision->GetCoin();
-
-	std::vector<Common::GameObject*>::iterator it = std::find(m_lCoinList.begin(), m_lCoinList.end(), pCoin);
+	std::vector<Common::GameObjectHandle>::iterator it = std::find(m_lCoinList.begin(), m_lCoinList.end(), p_Event.GetCoin());
 	if (it != m_lCoinList.end())
 	{
 		m_lCoinList.erase(it);
@@ -235,20 +179,14 @@ void ComponentTimerLogic::SetActive(bool value)
 	m_bActive = value;
 	for (int i=0;i<m_lCoinList.size();i++)
 	{
-		Common::GameObject* pCoin =m_lCoinList.at(i);
-		ComponentCoinMovement* pMovement = static_cast<ComponentCoinMovement*>(pCoin->GetComponent("GOC_CoinMovement"));
+		Common::GameObject* pCoin = GetGameObject()->GetManager()->GetGameObject(m_lCoinList.at(i));
+		if (pCoin == NULL)
+			continue;
+
+		ComponentCoinMovement* pMovement = pCoin->GetComponent<ComponentCoinMovement>();
 		pMovement->SetActive(value);
 
-		ComponentCoinLife* pLife = static_cast<ComponentCoinLife*>(pCoin->GetComponent("GOC_LifeSpan"));
+		ComponentCoinLife* pLife = pCoin->GetComponent<ComponentCoinLife>();
 		pLife->SetActive(value);
 	}
 }
-
-vector<std::string>* ComponentTimerLogic::GetCurrentCoinID()
-{
-	vector<std::string>* pCoinIDList = new vector<std::string>();
-	for (int i=0;i<m_lCoinList.size();i++)
-		pCoinIDList->push_back(m_lCoinList.at(i)->GetGUID());
-
-	return pCoinIDList;
-}
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <vector>
 #include "GameObject.h"
 #include "EventObjectCollision.h"
+#include "EventCoinDisappeared.h"
 #include "EventManager.h"
 #include "tinyxml\tinyxml.h"
 #include <string>
@@ -17,33 +18,36 @@ namespace week2
 	{
 	public:
 		ComponentTimerLogic();
-		virtual ~ComponentTimerLogic(){};
+		virtual ~ComponentTimerLogic();
 
-		virtual const std::string FamilyID() { return std::string("GOC_TimerLogic"); }
+		DECLARE_COMPONENT_FAMILY("GOC_TimerLogic")
 		virtual const std::string ComponentID(){ return std::string("GOC_TimerLogic"); }
 		virtual void Update(float p_fDelta);
 
 		static Common::ComponentBase* CreateComponent(TiXmlNode* p_pNode);
 
-		std::vector<Common::GameObject*> m_lCoinList;
+		// Handles rather than pointers; GameObjects are recycled once destroyed
+		std::vector<Common::GameObjectHandle> m_lCoinList;
 
 		void SetMaxCoin(int p_iMax) {m_iMaxNumCoin = p_iMax;}
 		void SetFrequency(float p_fFre) { m_fFrequency = p_fFre;}
 		void SetDefaultObject(std::string p_sObject) { m_sObjectName = p_sObject;}
 		void SetActive(bool value);
 
-		vector<std::string>* GetCurrentCoinID();
+		const std::vector<Common::GameObjectHandle>& GetCurrentCoins() { return m_lCoinList; }
 		void CreateCoin();
 	private:
-		void HandleCoinCollision(BaseEvent *p_Event);
-		void HandleCoinDisappeared(BaseEvent *p_Event);
+		void HandleCoinCollisions(const EventBatch<EventObjectCollision>& p_Collisions);
+		void HandleCoinDisappeared(const EventCoinDisappeared& p_Event);
 
 		int m_iMaxNumCoin;
 		float m_fFrequency;
 		float m_fTimePassed;
 		std::string m_sObjectName;
-		long double m_lNumCoin;
 		bool m_bActive;
+
+		EventListenerToken m_hCollisionListener;
+		EventListenerToken m_hCoinDisappearedListener;
 	};
 }
 #endif
\ No newline at end of file
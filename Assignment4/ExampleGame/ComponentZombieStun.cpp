@@ -11,8 +11,12 @@ ComponentZombieStun::ComponentZombieStun(float p_fDuration)
 	m_bIsStunned = false;
 	m_fStunTime = 0;
 
-	EventListener eventListener1 = std::tr1::bind(&ComponentZombieStun::HandleProjectileCollision, this, std::tr1::placeholders::_1);
-	EventManager::Instance()->AddListener(Event_ObjectCollision, eventListener1);
+	m_hCollisionListener = EventManager::Instance()->AddListener<EventObjectCollision>(std::tr1::bind(&ComponentZombieStun::HandleProjectileCollision, this, std::tr1::placeholders::_1));
+}
+
+ComponentZombieStun::~ComponentZombieStun()
+{
+	EventManager::Instance()->RemoveListener(m_hCollisionListener);
 }
 
 Common::ComponentBase* ComponentZombieStun::CreateComponent(TiXmlNode* p_pNode)
@@ -41,20 +45,23 @@ void ComponentZombieStun::Update(float p_fDelta)
 		{
 			m_bIsStunned = false;
 			m_fStunTime = 0;
-			ComponentAnimController *pAni = static_cast<ComponentAnimController*>(this->GetGameObject()->GetComponent("GOC_AnimController"));
+			ComponentAnimController *pAni = this->GetGameObject()->GetComponent<ComponentAnimController>();
 			pAni->SetAnim("walk");
-			ComponentAIController *pAI = static_cast<ComponentAIController*>(this->GetGameObject()->GetComponent("GOC_AIController"));
+			ComponentAIController *pAI = this->GetGameObject()->GetComponent<ComponentAIController>();
 			if (pAI->GetCurrentState() == AIState::eAIState_ChasingCoin)
 				pAni->SetAnim("run");
 		}
 	}
 }
 
-void ComponentZombieStun::HandleProjectileCollision(BaseEvent *p_Event)
+void ComponentZombieStun::HandleProjectileCollision(const EventObjectCollision& p_Event)
 {
-	EventObjectCollision *pEventCollision = static_cast<EventObjectCollision*>(p_Event);
-	Common::GameObject* pGameObjectA = pEventCollision->GetGameObject1();
-	Common::GameObject* pGameObjectB = pEventCollision->GetGameObject2();
+	// Either may have been destroyed since the collision was queued
+	Common::GameObjectManager* pManager = this->GetGameObject()->GetManager();
+	Common::GameObject* pGameObjectA = pManager->GetGameObject(p_Event.GetGameObject1());
+	Common::GameObject* pGameObjectB = pManager->GetGameObject(p_Event.GetGameObject2());
+	if (pGameObjectA == NULL || pGameObjectB == NULL)
+		return;
 	
 	Common::GameObject* pProjectTile = NULL;
 	Common::GameObject* pZombie = NULL;
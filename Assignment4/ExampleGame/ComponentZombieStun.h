@@ -5,7 +5,8 @@
 #include "GameObject.h"
 #include "tinyxml\tinyxml.h"
 #include <string>
-#include "BaseEvent.h"
+#include "EventManager.h"
+#include "EventObjectCollision.h"
 
 using namespace std;
 
@@ -15,9 +16,9 @@ namespace week2
 	{
 	public:
 		ComponentZombieStun(float p_fDuration);
-		virtual ~ComponentZombieStun(){};
+		virtual ~ComponentZombieStun();
 
-		virtual const std::string FamilyID() { return std::string("GOC_ZombieStun"); }
+		DECLARE_COMPONENT_FAMILY("GOC_ZombieStun")
 		virtual const std::string ComponentID(){ return std::string("GOC_ZombieStun"); }
 		virtual void Update(float p_fDelta);
 
@@ -25,11 +26,13 @@ namespace week2
 
 		bool GetIsStunned() { return m_bIsStunned;}
 	private:
-		void HandleProjectileCollision(BaseEvent *p_Event);
+		void HandleProjectileCollision(const EventObjectCollision& p_Event);
 
 		float m_fDuration;
 		float m_fStunTime;
 		bool m_bIsStunned;
+
+		EventListenerToken m_hCollisionListener;
 	};
 }
 #endif
\ No newline at end of file
@@ -4,19 +4,19 @@
 #include "Assignment4\ExampleGame\BaseEvent.h"
 #include "GameObject.h"
 
-class EventCharacterCollision : public BaseEvent
+class EventCharacterCollision : public BaseEvent<Event_CharacterCollision>
 {
 public:
+	EventCharacterCollision() : m_hCharacter(Common::INVALID_GAMEOBJECT_HANDLE), m_hGameObject(Common::INVALID_GAMEOBJECT_HANDLE) {}
 	EventCharacterCollision(Common::GameObject* p_pCharacter, Common::GameObject* p_pObject)
-	{m_pCharacter = p_pCharacter;m_pGameObject = p_pObject; m_EventType = Event_ObjectCollision;};
-	~EventCharacterCollision(void);
+	{m_hCharacter = p_pCharacter->GetHandle();m_hGameObject = p_pObject->GetHandle();};
 	
-	Common::GameObject* GetCharacter(){return m_pCharacter;}
-	Common::GameObject* GetGameObject(){return m_pGameObject;}
+	Common::GameObjectHandle GetCharacter() const {return m_hCharacter;}
+	Common::GameObjectHandle GetGameObject() const {return m_hGameObject;}
 
 private:
-	Common::GameObject *m_pCharacter;
-	Common::GameObject *m_pGameObject;
+	Common::GameObjectHandle m_hCharacter;
+	Common::GameObjectHandle m_hGameObject;
 };
 
-#endif
\ No newline at end of file
+#endif
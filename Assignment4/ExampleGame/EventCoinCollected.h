@@ -4,19 +4,19 @@
 #include "BaseEvent.h"
 #include "GameObject.h"
 
-class EventCoinCollected : public BaseEvent
+class EventCoinCollected : public BaseEvent<Event_CoinCollected, EventPhase_PreRender>
 {
 public:
+	EventCoinCollected() : m_hCharacter(Common::INVALID_GAMEOBJECT_HANDLE), m_hCoin(Common::INVALID_GAMEOBJECT_HANDLE) {}
 	EventCoinCollected(Common::GameObject* p_pChar, Common::GameObject* p_pCoin)
-	{m_pCharacter = p_pChar;m_pCoin = p_pCoin; m_EventType = Event_CoinCollected;};
-	~EventCoinCollected(void);
+	{m_hCharacter = p_pChar->GetHandle();m_hCoin = p_pCoin->GetHandle();};
 
-	Common::GameObject* GetCharacter(){return m_pCharacter;}
-	Common::GameObject* GetCoin(){return m_pCoin;}
+	Common::GameObjectHandle GetCharacter() const {return m_hCharacter;}
+	Common::GameObjectHandle GetCoin() const {return m_hCoin;}
 private:
-	Common::GameObject *m_pCharacter;
-	Common::GameObject *m_pCoin;
+	Common::GameObjectHandle m_hCharacter;
+	Common::GameObjectHandle m_hCoin;
 };
 
 
-#endif
\ No newline at end of file
+#endif
@@ -4,16 +4,16 @@
 #include "BaseEvent.h"
 #include "GameObject.h"
 
-class EventCoinDisappeared :public BaseEvent
+class EventCoinDisappeared : public BaseEvent<Event_CoinDisappeared, EventPhase_PostAI>
 {
 public:
-	EventCoinDisappeared(Common::GameObject* p_pCoin) {m_pCoin = p_pCoin; m_EventType = Event_CoinDisappeared;}
-	~EventCoinDisappeared(void);
+	EventCoinDisappeared() : m_hCoin(Common::INVALID_GAMEOBJECT_HANDLE) {}
+	EventCoinDisappeared(Common::GameObject* p_pCoin) {m_hCoin = p_pCoin->GetHandle();}
 
-	Common::GameObject* GetCoin(){return m_pCoin;}
+	Common::GameObjectHandle GetCoin() const {return m_hCoin;}
 
 private:
-	Common::GameObject* m_pCoin;
+	Common::GameObjectHandle m_hCoin;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -4,15 +4,15 @@
 #include "BaseEvent.h"
 #include "GameObject.h"
 
-class EventCoinSpawned : public BaseEvent
+class EventCoinSpawned : public BaseEvent<Event_CoinSpawned, EventPhase_PostAI>
 {
 public:
-	EventCoinSpawned(Common::GameObject* p_pCoin) {m_pCoin = p_pCoin; m_EventType = Event_CoinSpawned;}
-	~EventCoinSpawned(void);
+	EventCoinSpawned() : m_hCoin(Common::INVALID_GAMEOBJECT_HANDLE) {}
+	EventCoinSpawned(Common::GameObject* p_pCoin) {m_hCoin = p_pCoin->GetHandle();}
 
-	Common::GameObject* GetCoin(){return m_pCoin;}
+	Common::GameObjectHandle GetCoin() const {return m_hCoin;}
 private:
-	Common::GameObject *m_pCoin;
+	Common::GameObjectHandle m_hCoin;
 };
 
 #endif
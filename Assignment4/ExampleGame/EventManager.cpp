@@ -1,13 +1,23 @@
 #include "EventManager.h"
-#include <algorithm>
 
 EventManager* EventManager::s_pEventManagerInstance = NULL;
 
 
 EventManager::EventManager()
 {
-	EventList m_lEventList = EventList();
-	ListenerMap m_mListenerMap = ListenerMap();
+	for (int i = 0; i < Event_Count; ++i)
+	{
+		m_apChannels[i] = NULL;
+	}
+}
+
+EventManager::~EventManager()
+{
+	for (int i = 0; i < Event_Count; ++i)
+	{
+		delete m_apChannels[i];
+		m_apChannels[i] = NULL;
+	}
 }
 
 void EventManager::CreateInstance(){
@@ -28,79 +38,31 @@ EventManager* EventManager::Instance()
 	return s_pEventManagerInstance;
 }
 
-void EventManager::QueueEvent(BaseEvent* p_pBaseEvent)
+void EventManager::RemoveListener(EventListenerToken p_Token)
 {
-	ListenerMap::iterator it = m_mListenerMap.find(p_pBaseEvent->GetEventType());
-	if (it!= m_mListenerMap.end())
-	{
-		m_lEventList.push_back(p_pBaseEvent);
-	}
-}
+	if (p_Token == INVALID_EVENT_LISTENER_TOKEN)
+		return;
 
-void EventManager::TriggerEvent(BaseEvent* p_pBaseEvent)
-{
-	ListenerMap::iterator it = m_mListenerMap.find(p_pBaseEvent->GetEventType());
-	if (it!=m_mListenerMap.end())
+	unsigned int uiEventType = p_Token >> 24;
+	if (uiEventType < Event_Count && m_apChannels[uiEventType] != NULL)
 	{
-		ListenerList &listenerList = it->second;
-		for (int i=0;i<listenerList.size();i++)
-		{
-			EventListener eventDelegate = listenerList.at(i);
-			eventDelegate(p_pBaseEvent);
-		}
+		m_apChannels[uiEventType]->RemoveListener(p_Token & 0x00FFFFFF);
 	}
 }
 
-
-void EventManager::AddListener(EventType p_EventType, EventListener p_EvenListener)
+void EventManager::Dispatch(EventPhase p_ePhase)
 {
-	ListenerMap::iterator it = m_mListenerMap.find(p_EventType);
-	if (it!=m_mListenerMap.end())
+	// Keep going until everything for this phase is delivered, including
+	// events queued by listeners while we dispatch
+	assert(m_lDispatchOrder.empty());
+	EventTypeList& lPhaseOrder = m_alPhaseOrder[p_ePhase];
+	while (!lPhaseOrder.empty())
 	{
-		ListenerList &listenerList = it->second;
-		listenerList.push_back(p_EvenListener);
-	}
-	else
-	{
-		ListenerList listenerList = ListenerList();
-		listenerList.push_back(p_EvenListener);
-		m_mListenerMap.insert(std::make_pair<EventType, ListenerList>(p_EventType, listenerList));
-	}
-
-}
-
-void EventManager::RemoveListerner(EventType p_EventType, EventListener p_EvenListener)
-{
-	ListenerMap::iterator it = m_mListenerMap.find(p_EventType);
-	if (it!=m_mListenerMap.end())
-	{
-		ListenerList listenerList = it->second;
-		for (int i=0;i<listenerList.size();i++)
+		m_lDispatchOrder.swap(lPhaseOrder);
+		for (unsigned int i = 0; i < m_lDispatchOrder.size(); ++i)
 		{
-			EventListener eventDelegate = listenerList.at(i);
-			//if (eventDelegate == p_EvenListener)
-			//eventDelegate.target<void (BaseEvent*)>() == p_EvenListener.target<void (BaseEvent*)>();
-			/*
-			if (eventDelegate.target<void (BaseEvent*)>() == p_EvenListener.target<void (BaseEvent*)>()
-			 && eventDelegate.target_type() == p_EvenListener.target_type())
-			{	
-				auto listenerIter = std::find(listenerList.begin(), listenerList.end(), i);
-				if (listenerIter != listenerList.end())
-					listenerList.erase(listenerIter);
-			}
-			*/
-			
+			m_apChannels[m_lDispatchOrder[i]]->Dispatch(p_ePhase);
 		}
+		m_lDispatchOrder.clear();
 	}
 }
-
-void EventManager::Update(float p_fDelta)
-{
-	while (!m_lEventList.empty())
-	{
-		BaseEvent *pBaseEvent = m_lEventList.back();
-		m_lEventList.pop_back();
-
-		TriggerEvent(pBaseEvent);
-	}
-}
\ No newline at end of file
@@ -4,36 +4,308 @@
 #include "BaseEvent.h"
 #include <vector>
 #include <functional>
-#include <map>
 #include <assert.h>
 
-typedef std::vector<BaseEvent*> EventList;
-typedef std::tr1::function<void (BaseEvent*)> EventListener;
-typedef std::vector<EventListener> ListenerList;
-typedef std::map<EventType, ListenerList> ListenerMap;
+// Returned by AddListener; pass to RemoveListener to unsubscribe
+typedef unsigned int EventListenerToken;
+static const EventListenerToken INVALID_EVENT_LISTENER_TOKEN = 0;
+
+//------------------------------------------------------------------------------
+// Contiguous, read only view of a batch of queued events of one type. Handed to
+// batch listeners so they can process e.g. all collisions of a frame in one go.
+//------------------------------------------------------------------------------
+template<class T>
+class EventBatch
+{
+public:
+	EventBatch(const T* p_pEvents, unsigned int p_uiCount) : m_pEvents(p_pEvents), m_uiCount(p_uiCount) {}
+
+	unsigned int GetCount() const { return m_uiCount; }
+	const T& operator[](unsigned int p_uiIndex) const { assert(p_uiIndex < m_uiCount); return m_pEvents[p_uiIndex]; }
+	const T* Begin() const { return m_pEvents; }
+	const T* End() const { return m_pEvents + m_uiCount; }
+
+private:
+	const T* m_pEvents;
+	unsigned int m_uiCount;
+};
+
+//------------------------------------------------------------------------------
+// Type erased interface to the per event type channels so the EventManager can
+// keep them all in one array indexed by EventType.
+//------------------------------------------------------------------------------
+class EventChannelBase
+{
+public:
+	virtual ~EventChannelBase() {}
+	virtual void Dispatch(EventPhase p_ePhase) = 0;
+	virtual bool HasQueuedEvents(EventPhase p_ePhase) const = 0;
+	virtual void RemoveListener(unsigned int p_uiListenerID) = 0;
+};
+
+//------------------------------------------------------------------------------
+// Queues and listeners for one event type. Events are stored by value in one
+// queue per EventPhase and delivered in the order they were queued. Each queue
+// is double buffered: dispatching swaps it with a second list, so the batch
+// being delivered stays contiguous while listeners queue more, and neither list
+// gives its memory back, so steady state queueing doesn't allocate.
+//------------------------------------------------------------------------------
+template<class T>
+class EventChannel : public EventChannelBase
+{
+public:
+	typedef std::tr1::function<void (const T&)> Listener;
+	typedef std::tr1::function<void (const EventBatch<T>&)> BatchListener;
+
+	EventChannel() : m_uiNextListenerID(1), m_uiDispatchDepth(0), m_bListenersDirty(false)
+	{
+	}
+
+	virtual ~EventChannel()
+	{
+		for (unsigned int i = 0; i < m_lListeners.size(); ++i)
+		{
+			delete m_lListeners[i];
+		}
+	}
+
+	bool HasListeners() const { return !m_lListeners.empty(); }
+	virtual bool HasQueuedEvents(EventPhase p_ePhase) const { return !m_alQueues[p_ePhase].empty(); }
+
+	unsigned int AddListener(const Listener& p_Listener)
+	{
+		ListenerEntry* pEntry = CreateListenerEntry();
+		pEntry->m_Listener = p_Listener;
+		return pEntry->m_uiID;
+	}
+
+	unsigned int AddBatchListener(const BatchListener& p_BatchListener)
+	{
+		ListenerEntry* pEntry = CreateListenerEntry();
+		pEntry->m_BatchListener = p_BatchListener;
+		return pEntry->m_uiID;
+	}
+
+	virtual void RemoveListener(unsigned int p_uiListenerID)
+	{
+		for (unsigned int i = 0; i < m_lListeners.size(); ++i)
+		{
+			ListenerEntry* pEntry = m_lListeners[i];
+			if (pEntry->m_uiID != p_uiListenerID)
+			{
+				continue;
+			}
+
+			if (m_uiDispatchDepth > 0)
+			{
+				// Can't touch the list while we're walking it; skip it and clean up after
+				pEntry->m_bRemoved = true;
+				m_bListenersDirty = true;
+			}
+			else
+			{
+				delete pEntry;
+				m_lListeners.erase(m_lListeners.begin() + i);
+			}
+			return;
+		}
+	}
+
+	// Returns true if this was the first event queued for the phase
+	bool Queue(const T& p_Event, EventPhase p_ePhase)
+	{
+		EventList& lQueue = m_alQueues[p_ePhase];
+		lQueue.push_back(p_Event);
+		return lQueue.size() == 1;
+	}
+
+	void Trigger(const T& p_Event)
+	{
+		Deliver(EventBatch<T>(&p_Event, 1));
+	}
+
+	// Delivers the events that are queued for the phase right now; events
+	// queued while dispatching stay queued for the next call.
+	virtual void Dispatch(EventPhase p_ePhase)
+	{
+		if (m_alQueues[p_ePhase].empty())
+		{
+			return;
+		}
+
+		// Not re-entrant; listeners queue or trigger events, they don't dispatch
+		assert(m_lDispatching.empty());
+		m_lDispatching.swap(m_alQueues[p_ePhase]);
+
+		Deliver(EventBatch<T>(&m_lDispatching[0], m_lDispatching.size()));
+
+		// Keeps its capacity for the next swap
+		m_lDispatching.clear();
+	}
+
+private:
+	struct ListenerEntry
+	{
+		unsigned int m_uiID;
+		Listener m_Listener;
+		BatchListener m_BatchListener;
+		bool m_bRemoved;
+	};
+	typedef std::vector<ListenerEntry*> ListenerList;
+	typedef std::vector<T> EventList;
+
+	ListenerEntry* CreateListenerEntry()
+	{
+		ListenerEntry* pEntry = new ListenerEntry();
+		pEntry->m_uiID = m_uiNextListenerID++;
+		pEntry->m_bRemoved = false;
+		m_lListeners.push_back(pEntry);
+		return pEntry;
+	}
+
+	void Deliver(const EventBatch<T>& p_Batch)
+	{
+		++m_uiDispatchDepth;
+
+		// Index rather than iterator; listeners may be added while we dispatch.
+		// Per event listeners see the events one at a time in queued order,
+		// batch listeners see all of them in one call.
+		for (unsigned int i = 0; i < m_lListeners.size(); ++i)
+		{
+			const ListenerEntry* pEntry = m_lListeners[i];
+			if (pEntry->m_BatchListener)
+			{
+				if (!pEntry->m_bRemoved)
+				{
+					pEntry->m_BatchListener(p_Batch);
+				}
+				continue;
+			}
+
+			for (unsigned int j = 0; j < p_Batch.GetCount() && !pEntry->m_bRemoved; ++j)
+			{
+				pEntry->m_Listener(p_Batch[j]);
+			}
+		}
+
+		--m_uiDispatchDepth;
+		if (m_uiDispatchDepth == 0 && m_bListenersDirty)
+		{
+			PurgeRemovedListeners();
+		}
+	}
+
+	void PurgeRemovedListeners()
+	{
+		unsigned int uiCount = 0;
+		for (unsigned int i = 0; i < m_lListeners.size(); ++i)
+		{
+			if (m_lListeners[i]->m_bRemoved)
+			{
+				delete m_lListeners[i];
+			}
+			else
+			{
+				m_lListeners[uiCount++] = m_lListeners[i];
+			}
+		}
+		m_lListeners.resize(uiCount);
+		m_bListenersDirty = false;
+	}
+
+	EventList m_alQueues[EventPhase_Count];
+	EventList m_lDispatching;
+
+	ListenerList m_lListeners;
+	unsigned int m_uiNextListenerID;
+	unsigned int m_uiDispatchDepth;
+	bool m_bListenersDirty;
+};
 
 class EventManager
 {
 public:
-	
+
 	static void CreateInstance();
 	static void DestroyInstance();
 	static EventManager* Instance();
 
-	void QueueEvent(BaseEvent* p_pBaseEvent);
-	void TriggerEvent(BaseEvent* p_pBaseEvent);
-	void Update(float p_fDelta);
-	void AddListener(EventType p_EventType, EventListener p_EvenListener);
-	void RemoveListerner(EventType p_EventType, EventListener p_EvenListener);
+	// Queue an event (by value) for delivery the next time its phase is
+	// dispatched. Dropped if nobody listens to this event type.
+	template<class T>
+	void QueueEvent(const T& p_Event)
+	{
+		QueueEvent(p_Event, T::s_eEventPhase);
+	}
+
+	template<class T>
+	void QueueEvent(const T& p_Event, EventPhase p_ePhase)
+	{
+		EventChannel<T>* pChannel = GetChannel<T>();
+		if (pChannel->HasListeners() && pChannel->Queue(p_Event, p_ePhase))
+		{
+			// Remember which event type got queued first so types are
+			// delivered in the order they started arriving
+			m_alPhaseOrder[p_ePhase].push_back(T::s_eEventType);
+		}
+	}
+
+	// Deliver an event to its listeners immediately
+	template<class T>
+	void TriggerEvent(const T& p_Event)
+	{
+		GetChannel<T>()->Trigger(p_Event);
+	}
+
+	template<class T>
+	EventListenerToken AddListener(const std::tr1::function<void (const T&)>& p_Listener)
+	{
+		unsigned int uiListenerID = GetChannel<T>()->AddListener(p_Listener);
+		return MakeToken(T::s_eEventType, uiListenerID);
+	}
 
+	// Like AddListener, but the listener receives all the events of the type
+	// delivered in a phase in one call
+	template<class T>
+	EventListenerToken AddBatchListener(const std::tr1::function<void (const EventBatch<T>&)>& p_BatchListener)
+	{
+		unsigned int uiListenerID = GetChannel<T>()->AddBatchListener(p_BatchListener);
+		return MakeToken(T::s_eEventType, uiListenerID);
+	}
+
+	void RemoveListener(EventListenerToken p_Token);
+	void Dispatch(EventPhase p_ePhase);
 
 private:
 	EventManager();
-	virtual ~EventManager(){};
+	virtual ~EventManager();
 	static EventManager* s_pEventManagerInstance;
 
-	EventList m_lEventList;
-	ListenerMap m_mListenerMap;
+	template<class T>
+	EventChannel<T>* GetChannel()
+	{
+		EventChannelBase*& pChannel = m_apChannels[T::s_eEventType];
+		if (pChannel == NULL)
+		{
+			pChannel = new EventChannel<T>();
+		}
+		return static_cast<EventChannel<T>*>(pChannel);
+	}
+
+	// Token layout: event type in the top 8 bits, listener id in the rest
+	static EventListenerToken MakeToken(EventType p_eEventType, unsigned int p_uiListenerID)
+	{
+		return (static_cast<unsigned int>(p_eEventType) << 24) | (p_uiListenerID & 0x00FFFFFF);
+	}
+
+	typedef std::vector<EventType> EventTypeList;
+
+	EventChannelBase* m_apChannels[Event_Count];
+
+	// Per phase, the event types with queued events in the order their first
+	// event was queued
+	EventTypeList m_alPhaseOrder[EventPhase_Count];
+	EventTypeList m_lDispatchOrder;
 };
 
-#endif
\ No newline at end of file
+#endif
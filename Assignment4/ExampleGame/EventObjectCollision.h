@@ -4,19 +4,19 @@
 #include "BaseEvent.h"
 #include "GameObject.h"
 
-class EventObjectCollision : public BaseEvent
+class EventObjectCollision : public BaseEvent<Event_ObjectCollision>
 {
 public:
+	EventObjectCollision() : m_hGameObject1(Common::INVALID_GAMEOBJECT_HANDLE), m_hGameObject2(Common::INVALID_GAMEOBJECT_HANDLE) {}
 	EventObjectCollision(Common::GameObject* p_pObject1, Common::GameObject* p_pObject2)
-	{m_pGameObject1 = p_pObject1;m_pGameObject2 = p_pObject2; m_EventType = Event_ObjectCollision;};
-	~EventObjectCollision(void);
+	{m_hGameObject1 = p_pObject1->GetHandle();m_hGameObject2 = p_pObject2->GetHandle();};
 	
-	Common::GameObject* GetGameObject1(){return m_pGameObject1;}
-	Common::GameObject* GetGameObject2(){return m_pGameObject2;}
+	Common::GameObjectHandle GetGameObject1() const {return m_hGameObject1;}
+	Common::GameObjectHandle GetGameObject2() const {return m_hGameObject2;}
 
 private:
-	Common::GameObject *m_pGameObject1;
-	Common::GameObject *m_pGameObject2;
+	Common::GameObjectHandle m_hGameObject1;
+	Common::GameObjectHandle m_hGameObject2;
 };
 
-#endif
\ No newline at end of file
+#endif
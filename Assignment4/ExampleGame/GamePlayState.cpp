@@ -42,19 +42,19 @@ void GamePlayState::Enter()
 	pCharacter->GetTransform().Scale(glm::vec3(0.05f, 0.05, 0.05f));
 	pCharacter->GetTransform().SetTranslation(glm::vec3(5.0f, 0.0, 0.0f));
 	pCharacter->GetTransform().Rotate(glm::vec3(0.0f,80.0f,0.0f));
-	ComponentRigidBody* pCharRigid = static_cast<ComponentRigidBody*>(pCharacter->GetComponent("GOC_RigidBody"));
+	ComponentRigidBody* pCharRigid = pCharacter->GetComponent<ComponentRigidBody>();
 	pCharRigid->BindGameObject();
 
 	// lamp post
 	Common::GameObject* pLamp = m_pGameObjectManager->CreateGameObject("Assignment4/ExampleGame/data/xml/lamp.xml");
     m_pGameObjectManager->SetGameObjectGUID(pLamp, "lamp");
 	pLamp->GetTransform().Scale(glm::vec3(0.4f, 0.4, 0.4f));
-	ComponentRigidBody* pLampRigid = static_cast<ComponentRigidBody*>(pLamp->GetComponent("GOC_RigidBody"));
+	ComponentRigidBody* pLampRigid = pLamp->GetComponent<ComponentRigidBody>();
 	pLampRigid->BindGameObject();
 
 	// Create ground
 	Common::GameObject* pGround = m_pGameObjectManager->CreateGameObject("Assignment4/ExampleGame/data/xml/ground.xml");
-	ComponentRigidBody* pGroundRigid = static_cast<ComponentRigidBody*>(pGround->GetComponent("GOC_RigidBody"));
+	ComponentRigidBody* pGroundRigid = pGround->GetComponent<ComponentRigidBody>();
 	pGroundRigid->BindGameObject();
 	
 	// Create walls
@@ -62,28 +62,28 @@ void GamePlayState::Enter()
 	m_pGameObjectManager->SetGameObjectGUID(pWall1, "wall1");
 	pWall1->GetTransform().Rotate(glm::vec3(90.0f,0.0f,0.0f));
 	pWall1->GetTransform().Translate(glm::vec3(0.0f,150.0f,75.0f));
-	ComponentRigidBody* pWall1Rigid = static_cast<ComponentRigidBody*>(pWall1->GetComponent("GOC_RigidBody"));
+	ComponentRigidBody* pWall1Rigid = pWall1->GetComponent<ComponentRigidBody>();
 	pWall1Rigid->BindGameObject();
 
 	Common::GameObject* pWall2 = m_pGameObjectManager->CreateGameObject("Assignment4/ExampleGame/data/xml/wall.xml");
 	m_pGameObjectManager->SetGameObjectGUID(pWall2, "wall2");
 	pWall2->GetTransform().Rotate(glm::vec3(90.0f,0.0f,0.0f));
 	pWall2->GetTransform().Translate(glm::vec3(0.0f,150.0f,-75.0f));
-	ComponentRigidBody* pWall2Rigid = static_cast<ComponentRigidBody*>(pWall2->GetComponent("GOC_RigidBody"));
+	ComponentRigidBody* pWall2Rigid = pWall2->GetComponent<ComponentRigidBody>();
 	pWall2Rigid->BindGameObject();
 
 	Common::GameObject* pWall3 = m_pGameObjectManager->CreateGameObject("Assignment4/ExampleGame/data/xml/wall.xml");
 	m_pGameObjectManager->SetGameObjectGUID(pWall3, "wall3");
 	pWall3->GetTransform().Rotate(glm::vec3(90.0f,90.0f,0.0f));
 	pWall3->GetTransform().Translate(glm::vec3(75.0f,150.0f,0.0f));
-	ComponentRigidBody* pWall3Rigid = static_cast<ComponentRigidBody*>(pWall3->GetComponent("GOC_RigidBody"));
+	ComponentRigidBody* pWall3Rigid = pWall3->GetComponent<ComponentRigidBody>();
 	pWall3Rigid->BindGameObject();
 
 	Common::GameObject* pWall4 = m_pGameObjectManager->CreateGameObject("Assignment4/ExampleGame/data/xml/wall.xml");
 	m_pGameObjectManager->SetGameObjectGUID(pWall4, "wall4");
 	pWall4->GetTransform().Rotate(glm::vec3(90.0f,90.0f,0.0f));
 	pWall4->GetTransform().Translate(glm::vec3(-75.0f,150.0f,0.0f));
-	ComponentRigidBody* pWall4Rigid = static_cast<ComponentRigidBody*>(pWall4->GetComponent("GOC_RigidBody"));
+	ComponentRigidBody* pWall4Rigid = pWall4->GetComponent<ComponentRigidBody>();
 	pWall4Rigid->BindGameObject();
 
 	// Create timer
@@ -91,9 +91,8 @@ void GamePlayState::Enter()
 	m_pGameObjectManager->SetGameObjectGUID(pTimer, "timer");
 
 	// HUD
-	TFont tfont = TFont("Assignment4/ExampleGame/data/font/bm_0.tga","Assignment4/ExampleGame/data/font/bm.fnt");
 	string txt = std::string("Score: 0");
-	TTextBox* textbox1 = new TTextBox(&tfont,txt,	160, 40);
+	TTextBox* textbox1 = new TTextBox(NULL,txt,	160, 40);
 	textbox1->SetColor(1.0f, 0.0f, 0.0f, 1.0f);
 	textbox1->SetPos(50,50);
 	textbox1->Init();
@@ -117,7 +116,7 @@ void GamePlayState::Enter()
 			vPosition.z = randZ;
 			pCrate->GetTransform().SetTranslation(vPosition);
 
-			ComponentRigidBody* pCrateRigid = static_cast<ComponentRigidBody*>(pCrate->GetComponent("GOC_RigidBody"));
+			ComponentRigidBody* pCrateRigid = pCrate->GetComponent<ComponentRigidBody>();
 			pCrateRigid->BindGameObject();
 		}
 	}
@@ -132,21 +131,21 @@ void GamePlayState::Enter()
 	pZombie1->GetTransform().Scale(glm::vec3(0.05f, 0.05, 0.05f));
 	pZombie1->GetTransform().SetTranslation(glm::vec3(15.0f, 0.0f, 15.0f));
 	m_pGameObjectManager->SetGameObjectGUID(pZombie1, "zombieCharacter");
-	ComponentRigidBody* pRigidZombie1 = static_cast<ComponentRigidBody*>(pZombie1->GetComponent("GOC_RigidBody"));
+	ComponentRigidBody* pRigidZombie1 = pZombie1->GetComponent<ComponentRigidBody>();
 	pRigidZombie1->BindGameObject();
 	
 	Common::GameObject* pZombie3 = m_pGameObjectManager->CreateGameObject("Assignment4/ExampleGame/data/xml/zombie.xml");
 	pZombie3->GetTransform().Scale(glm::vec3(0.05f, 0.05, 0.05f));
 	pZombie3->GetTransform().SetTranslation(glm::vec3(20.0f, 0.0f, 20.0f));
 	m_pGameObjectManager->SetGameObjectGUID(pZombie3, "zombieCoin2");
-	ComponentRigidBody* pRigidZombie3 = static_cast<ComponentRigidBody*>(pZombie3->GetComponent("GOC_RigidBody"));
+	ComponentRigidBody* pRigidZombie3 = pZombie3->GetComponent<ComponentRigidBody>();
 	pRigidZombie3->BindGameObject();
 
 	Common::GameObject* pZombie2 = m_pGameObjectManager->CreateGameObject("Assignment4/ExampleGame/data/xml/zombie.xml");
 	pZombie2->GetTransform().Scale(glm::vec3(0.05f, 0.05, 0.05f));
 	pZombie2->GetTransform().SetTranslation(glm::vec3(25.0f, 0.0f, 25.0f));
 	m_pGameObjectManager->SetGameObjectGUID(pZombie2, "zombieCoin1");
-	ComponentRigidBody* pRigidZombie2 = static_cast<ComponentRigidBody*>(pZombie2->GetComponent("GOC_RigidBody"));
+	ComponentRigidBody* pRigidZombie2 = pZombie2->GetComponent<ComponentRigidBody>();
 	pRigidZombie2->BindGameObject();
 	
 }
@@ -163,7 +162,7 @@ void GamePlayState::Update(float p_fDelta)
 	}
 	bLastKeyDown = bCurrentKeyDown;
 
-	ComponentMouseClick *pMouse = static_cast<ComponentMouseClick*>(m_pButton->GetComponent("GOC_MouseClick"));
+	ComponentMouseClick *pMouse = m_pButton->GetComponent<ComponentMouseClick>();
 	if (pMouse->GetClicked())
 	{
 		pMouse->SetActive(false);
@@ -173,22 +172,22 @@ void GamePlayState::Update(float p_fDelta)
 
 void GamePlayState::Suspend()
 {
-	ComponentCharacterController* pController = static_cast<ComponentCharacterController*>(m_pGameObjectManager->GetGameObject("character")->GetComponent("GOC_CharacterController"));
+	ComponentCharacterController* pController = m_pGameObjectManager->GetGameObject("character")->GetComponent<ComponentCharacterController>();
 	pController->SetActive(false);
 
-	ComponentTimerLogic* pTimer = static_cast<ComponentTimerLogic*>(m_pGameObjectManager->GetGameObject("timer")->GetComponent("GOC_TimerLogic"));
+	ComponentTimerLogic* pTimer = m_pGameObjectManager->GetGameObject("timer")->GetComponent<ComponentTimerLogic>();
 	pTimer->SetActive(false);
 }
 
 void GamePlayState::Resume()
 {
-	ComponentMouseClick *pMouse = static_cast<ComponentMouseClick*>(m_pButton->GetComponent("GOC_MouseClick"));
+	ComponentMouseClick *pMouse = m_pButton->GetComponent<ComponentMouseClick>();
 	pMouse->SetActive(true);
 
-	ComponentCharacterController* pController = static_cast<ComponentCharacterController*>(m_pGameObjectManager->GetGameObject("character")->GetComponent("GOC_CharacterController"));
+	ComponentCharacterController* pController = m_pGameObjectManager->GetGameObject("character")->GetComponent<ComponentCharacterController>();
 	pController->SetActive(true);
 
-	ComponentTimerLogic* pTimer = static_cast<ComponentTimerLogic*>(m_pGameObjectManager->GetGameObject("timer")->GetComponent("GOC_TimerLogic"));
+	ComponentTimerLogic* pTimer = m_pGameObjectManager->GetGameObject("timer")->GetComponent<ComponentTimerLogic>();
 	pTimer->SetActive(true);
 }
 
@@ -25,7 +25,7 @@ void PauseState::Enter()
 
 void PauseState::Update(float p_fDelta)
 {
-	ComponentMouseClick *pMouse = static_cast<ComponentMouseClick*>(m_pButton->GetComponent("GOC_MouseClick"));
+	ComponentMouseClick *pMouse = m_pButton->GetComponent<ComponentMouseClick>();
 	if (pMouse->GetClicked())
 	{
 		m_pStateMachine->PopState();;
@@ -5,8 +5,10 @@
 namespace Common
 {
 Square::Square(const std::string& p_strTexturePath, const std::string& p_strVertexProgram, const std::string& p_strFragmentProgram,float x, float y, float z)
+	: m_vBoundsMin(-x, y, -z), m_vBoundsMax(x, y, z), m_iCullProxy(-1)
 {
-	m_pTexture = wolf::TextureManager::CreateTexture(p_strTexturePath);
+	// Repeats, so it can't be an atlas region
+	m_pTexture = wolf::TextureManager::CreateTextureAsync(p_strTexturePath, false);
     m_pTexture->SetWrapMode(wolf::Texture::WM_Repeat, wolf::Texture::WM_Repeat);
     m_pMaterial = wolf::MaterialManager::CreateMaterial("Square");
 
@@ -40,8 +42,11 @@ void Square::Render(const glm::mat4& p_mView, const glm::mat4& p_mProj)
 {
 	m_pVertexDeclaration->Bind();
 	m_pMaterial->SetTexture("texture", m_pTexture);
-    m_pMaterial->SetUniform("projection", p_mProj);
-    m_pMaterial->SetUniform("view", p_mView);
+	if (!m_pMaterial->GetProgram()->HasUniformBlock(wolf::UB_Frame))
+	{
+		m_pMaterial->SetUniform("projection", p_mProj);
+		m_pMaterial->SetUniform("view", p_mView);
+	}
     m_pMaterial->SetUniform("world", m_mWorldTransform);
     m_pMaterial->SetUniform("worldIT", glm::transpose(glm::inverse(m_mWorldTransform)));
     m_pMaterial->Apply();
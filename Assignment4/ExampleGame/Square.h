@@ -24,12 +24,21 @@ public:
 	void Render(const glm::mat4& p_mView, const glm::mat4& p_mProj);
 	wolf::Material* GetMaterial() { return m_pMaterial; }
 	void SetTransform(const glm::mat4& p_mWorldTransform) { m_mWorldTransform = p_mWorldTransform; }
+	const glm::mat4& GetTransform() const { return m_mWorldTransform; }
+
+	const glm::vec3& GetBoundsMin() const { return m_vBoundsMin; }
+	const glm::vec3& GetBoundsMax() const { return m_vBoundsMax; }
+	void SetCullProxy(int p_iProxy) { m_iCullProxy = p_iProxy; }
+	int GetCullProxy() const { return m_iCullProxy; }
 
 private:
 	wolf::Material* m_pMaterial;
 	glm::mat4 m_mWorldTransform;
 	wolf::VertexDeclaration* m_pVertexDeclaration;
 	wolf::Texture* m_pTexture;
+	glm::vec3 m_vBoundsMin;
+	glm::vec3 m_vBoundsMax;
+	int m_iCullProxy;
 };
 
 }
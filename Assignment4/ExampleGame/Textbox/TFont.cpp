@@ -83,10 +83,39 @@ bool ParseFont(const std::string& p_strDescription, Charset& CharsetDesc )
 TFont::TFont(const std::string& p_strTexture, const std::string& p_strDescription)
 {
 	ParseFont(p_strDescription, m_Charset);
+	BuildGlyphs();
 
 	m_pTexture = wolf::TextureManager::CreateTexture(p_strTexture);
 }
 
+TFont::~TFont()
+{
+	wolf::TextureManager::DestroyTexture(m_pTexture);
+}
+
+void TFont::BuildGlyphs()
+{
+	float width = m_Charset.Width;
+	float height = m_Charset.Height;
+
+	for (int i = 0; i < 256; i++)
+	{
+		const CharDescriptor& desc = m_Charset.Chars[i];
+		Glyph& glyph = m_aGlyphs[i];
+
+		glyph.m_fUStart = desc.x / width;
+		glyph.m_fUEnd = (desc.x + desc.Width) / width;
+		glyph.m_fVStart = (height - desc.y) / height;
+		glyph.m_fVEnd = (height - desc.Height - desc.y) / height;
+
+		glyph.m_uiWidth = desc.Width;
+		glyph.m_uiHeight = desc.Height;
+		glyph.m_uiXAdvance = desc.XAdvance;
+		glyph.m_iXOffset = desc.XOffset;
+		glyph.m_iYOffset = desc.YOffset;
+	}
+}
+
 wolf::Texture* TFont::GetTextureForChar(unsigned int p_uiCharId)
 {
 	// there is only one page char set
@@ -96,27 +125,26 @@ wolf::Texture* TFont::GetTextureForChar(unsigned int p_uiCharId)
 void TFont::GetExtentsForChar(const unsigned int p_uiCharId,float *p_uStart,float *p_uEnd,float *p_vStart,float *p_vEnd, 
 	unsigned int *p_uiWidth, unsigned int *p_uiHeight, unsigned int *p_uiXAdvance, int *p_uiXOffset, int *p_uiYOffset)
 {
-	unsigned short width = m_Charset.Width;
-	unsigned short height = m_Charset.Height;
-
-	*p_uStart = m_Charset.Chars[p_uiCharId].x / (width*1.0f);
-	*p_uEnd = ( m_Charset.Chars[p_uiCharId].x + m_Charset.Chars[p_uiCharId].Width) / (width*1.0f);
-	*p_vStart = (height - m_Charset.Chars[p_uiCharId].y) / (height*1.0f);
-	*p_vEnd = (height - m_Charset.Chars[p_uiCharId].Height - m_Charset.Chars[p_uiCharId].y) / (height*1.0f);
-
-	*p_uiWidth = m_Charset.Chars[p_uiCharId].Width;
-	*p_uiHeight = m_Charset.Chars[p_uiCharId].Height;
-	*p_uiXAdvance = m_Charset.Chars[p_uiCharId].XAdvance;
-	*p_uiXOffset = m_Charset.Chars[p_uiCharId].XOffset;
-	*p_uiYOffset = m_Charset.Chars[p_uiCharId].YOffset;
+	const Glyph& glyph = m_aGlyphs[p_uiCharId & 0xFF];
+
+	*p_uStart = glyph.m_fUStart;
+	*p_uEnd = glyph.m_fUEnd;
+	*p_vStart = glyph.m_fVStart;
+	*p_vEnd = glyph.m_fVEnd;
+
+	*p_uiWidth = glyph.m_uiWidth;
+	*p_uiHeight = glyph.m_uiHeight;
+	*p_uiXAdvance = glyph.m_uiXAdvance;
+	*p_uiXOffset = glyph.m_iXOffset;
+	*p_uiYOffset = glyph.m_iYOffset;
 }
 
 int TFont::GetCharAdvance(unsigned int p_uiCharId)
 {
-	return m_Charset.Chars[p_uiCharId].XAdvance;
+	return m_aGlyphs[p_uiCharId & 0xFF].m_uiXAdvance;
 }
 
 int TFont::GetCharHeight(unsigned int p_uiCharId)
 {
-	return m_Charset.Chars[p_uiCharId].Height;
+	return m_aGlyphs[p_uiCharId & 0xFF].m_uiHeight;
 }
\ No newline at end of file
@@ -28,10 +28,23 @@ struct Charset
 	CharDescriptor Chars[256];
 };
 
+// Everything needed to lay out and draw one character, worked out once when the
+// font is loaded
+struct Glyph
+{
+	float m_fUStart, m_fUEnd, m_fVStart, m_fVEnd;
+	unsigned int m_uiWidth, m_uiHeight, m_uiXAdvance;
+	int m_iXOffset, m_iYOffset;
+};
+
 class TFont
 {
 public:
 	TFont(const std::string& p_strTexture, const std::string& p_strDescription);
+	~TFont();
+
+	const Glyph& GetGlyph(unsigned char p_ucCharId) const { return m_aGlyphs[p_ucCharId]; }
+
 	void GetExtentsForChar(unsigned int p_uiCharId,float *p_uStart,float *p_uEnd,float *p_vStart,float *p_vEnd,
 		unsigned int *p_uiWidth, unsigned int *p_uiHeight, unsigned int *p_uiXAdvance, int *p_uiXOffset, int *p_uiYOffset);
 	wolf::Texture* GetTextureForChar(unsigned int p_uiCharId);
@@ -41,6 +54,15 @@ public:
 	Charset m_Charset;
 
 private:
+	// Owns a reference to the font texture, so it can't be copied
+	TFont(const TFont&);
+	TFont& operator=(const TFont&);
+
+	void BuildGlyphs();
+
 	wolf::Texture* m_pTexture;
+
+	// Glyphs indexed by character code
+	Glyph m_aGlyphs[256];
 };
 #endif
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "Assignment4\ExampleGame\EventCoinCollected.h"
 #include "common\GameObject.h"
 #include "Assignment4\ExampleGame\ComponentCoinScore.h"
+#include "Assignment4\ExampleGame\src\ExampleGame.h"
 
 #define NEW_LINE 40
 
@@ -10,27 +11,46 @@ TTextBox::TTextBox(TFont *p_pFont, const std::string& p_strText, unsigned int p_
 {
 	m_pProgram = NULL;
 	m_pTextureFont = m_pTextureTextBox = NULL;
+	m_pVertexBuffer = NULL;
+	m_pVertexDeclaration = NULL;
 	m_pFont = p_pFont;
+	m_bOwnsFont = false;
 	m_strText = p_strText;
 	m_uiWidth = p_uiWidth;
 	m_uiHeight = p_uiHeight;
 
+	m_uiOriginXPos = m_uiOriginYPos = 0;
 	m_iXBoxOffset1 = 10 * (m_uiWidth/256.0);
 	m_iYBoxOffset1 = 10 * (m_uiHeight/256.0);
 
-	m_pVertices = new Vertex[10000];
-	m_uiNumVertex = 0;
-
 	m_HAlignment = AL_Left;
 	m_VAlignment = AL_Top;
-	m_fSize = 1.1f;
+	m_fSize = 1.0f;
 	m_iTextHeight = 0;
+	m_iTextYOffset = 0;
+	m_iIndexNewLine = 0;
+
+	m_bLaidOut = false;
+	m_bVerticesDirty = false;
 
 	m_iScore = 0;
 
-	EventListener eventListener1 = std::tr1::bind(&TTextBox::HandleCoinCollected, this, std::tr1::placeholders::_1);
-	EventManager::Instance()->AddListener(Event_CoinCollected, eventListener1);
+	m_hCoinCollectedListener = EventManager::Instance()->AddBatchListener<EventCoinCollected>(std::tr1::bind(&TTextBox::HandleCoinsCollected, this, std::tr1::placeholders::_1));
+}
 
+TTextBox::~TTextBox()
+{
+	EventManager::Instance()->RemoveListener(m_hCoinCollectedListener);
+
+	delete m_pVertexDeclaration;
+	if (m_pVertexBuffer)
+		wolf::BufferManager::DestroyBuffer(m_pVertexBuffer);
+	if (m_pProgram)
+		wolf::ProgramManager::DestroyProgram(m_pProgram);
+	if (m_pTextureTextBox)
+		wolf::TextureManager::DestroyTexture(m_pTextureTextBox);
+	if (m_bOwnsFont)
+		delete m_pFont;
 }
 
 int TTextBox::CalculateWordSpace(int p_index1, int *p_index2)
@@ -42,7 +62,7 @@ int TTextBox::CalculateWordSpace(int p_index1, int *p_index2)
 		if (m_strText[i] == 32)
 			break;
 
-		space += m_fSize * m_pFont->GetCharAdvance(m_strText[i]);
+		space += m_fSize * m_pFont->GetCharAdvance((unsigned char)m_strText[i]);
 	}
 	*p_index2 = i-1;
 	return space;
@@ -53,82 +73,116 @@ int TTextBox::CalculateLineWidth(int p_index1, int p_index2)
 	int space=0;
 	for (int i=p_index1;i<= p_index2;i++)
 	{
-		space +=  m_fSize * m_pFont->GetCharAdvance(m_strText[i]);
+		space +=  m_fSize * m_pFont->GetCharAdvance((unsigned char)m_strText[i]);
 	}
 	return space;
 }
 
 void TTextBox::ConstructQuadforChar(unsigned int p_uiCharID)
 {
-	float fUstart, fUend, fVstart, fVend;
-	unsigned int uiWidth, uiHeight, uiXAdvance;
-	int iXOffset, iYOffset;
-
-	m_pFont->GetExtentsForChar(p_uiCharID, &fUstart, &fUend, &fVstart, &fVend, &uiWidth, &uiHeight, &uiXAdvance, &iXOffset, &iYOffset);
-
-	m_pVertices[m_uiNumVertex++] = Vertex(m_uiCurrentXPos + iXOffset, m_iTextHeight+ m_uiCurrentYPos + iYOffset, 0 , fUstart, fVstart,    0,0,0);
-	m_pVertices[m_uiNumVertex++] = Vertex(m_uiCurrentXPos + iXOffset, m_iTextHeight+ m_uiCurrentYPos + uiHeight*m_fSize , 0 , fUstart, fVend,    0,0,0);
-	m_pVertices[m_uiNumVertex++] = Vertex(m_uiCurrentXPos + uiWidth*m_fSize, m_iTextHeight+ m_uiCurrentYPos + uiHeight*m_fSize, 0, fUend, fVend,   0,0,0);
-	m_pVertices[m_uiNumVertex++] = Vertex(m_uiCurrentXPos + uiWidth*m_fSize, m_iTextHeight+ m_uiCurrentYPos + uiHeight*m_fSize, 0, fUend, fVend,   0,0,0);
-	m_pVertices[m_uiNumVertex++] = Vertex(m_uiCurrentXPos + uiWidth*m_fSize, m_iTextHeight+ m_uiCurrentYPos + iYOffset, 0, fUend, fVstart,   0,0,0);
-	m_pVertices[m_uiNumVertex++] = Vertex(m_uiCurrentXPos + iXOffset, m_iTextHeight+ m_uiCurrentYPos + iYOffset, 0 , fUstart, fVstart,   0,0,0);
-
-	m_uiCurrentXPos += uiXAdvance*m_fSize;
+	const Glyph& glyph = m_pFont->GetGlyph((unsigned char)p_uiCharID);
+	float fUstart = glyph.m_fUStart, fUend = glyph.m_fUEnd, fVstart = glyph.m_fVStart, fVend = glyph.m_fVEnd;
+	unsigned int uiWidth = glyph.m_uiWidth, uiHeight = glyph.m_uiHeight;
+	int iXOffset = glyph.m_iXOffset, iYOffset = glyph.m_iYOffset;
+
+	m_lVertices.push_back(Vertex(m_uiCurrentXPos + iXOffset, m_iTextYOffset+ m_uiCurrentYPos + iYOffset, 0 , fUstart, fVstart,    0,0,0));
+	m_lVertices.push_back(Vertex(m_uiCurrentXPos + iXOffset, m_iTextYOffset+ m_uiCurrentYPos + uiHeight*m_fSize , 0 , fUstart, fVend,    0,0,0));
+	m_lVertices.push_back(Vertex(m_uiCurrentXPos + uiWidth*m_fSize, m_iTextYOffset+ m_uiCurrentYPos + uiHeight*m_fSize, 0, fUend, fVend,   0,0,0));
+	m_lVertices.push_back(Vertex(m_uiCurrentXPos + uiWidth*m_fSize, m_iTextYOffset+ m_uiCurrentYPos + uiHeight*m_fSize, 0, fUend, fVend,   0,0,0));
+	m_lVertices.push_back(Vertex(m_uiCurrentXPos + uiWidth*m_fSize, m_iTextYOffset+ m_uiCurrentYPos + iYOffset, 0, fUend, fVstart,   0,0,0));
+	m_lVertices.push_back(Vertex(m_uiCurrentXPos + iXOffset, m_iTextYOffset+ m_uiCurrentYPos + iYOffset, 0 , fUstart, fVstart,   0,0,0));
+
+	m_uiCurrentXPos += glyph.m_uiXAdvance*m_fSize;
 }
 
 void TTextBox::ConstructQuadforTextBox()
 {
-	m_pVertices[m_uiNumVertex++] = Vertex(m_uiOriginXPos , m_uiOriginYPos , 0 , 0, 1,    0,0,0);
-	m_pVertices[m_uiNumVertex++] = Vertex(m_uiOriginXPos , m_uiOriginYPos + m_uiHeight , 0 , 0, 0,    0,0,0);
-	m_pVertices[m_uiNumVertex++] = Vertex(m_uiOriginXPos + m_uiWidth, m_uiOriginYPos + m_uiHeight, 0, 1, 0,   0,0,0);
-	m_pVertices[m_uiNumVertex++] = Vertex(m_uiOriginXPos + m_uiWidth, m_uiOriginYPos + m_uiHeight, 0, 1, 0,   0,0,0);
-	m_pVertices[m_uiNumVertex++] = Vertex(m_uiOriginXPos + m_uiWidth, m_uiOriginYPos , 0, 1, 1,   0,0,0);
-	m_pVertices[m_uiNumVertex++] = Vertex(m_uiOriginXPos , m_uiOriginYPos, 0 , 0, 1,   0,0,0);
+	m_lVertices.push_back(Vertex(m_uiOriginXPos , m_uiOriginYPos , 0 , 0, 1,    0,0,0));
+	m_lVertices.push_back(Vertex(m_uiOriginXPos , m_uiOriginYPos + m_uiHeight , 0 , 0, 0,    0,0,0));
+	m_lVertices.push_back(Vertex(m_uiOriginXPos + m_uiWidth, m_uiOriginYPos + m_uiHeight, 0, 1, 0,   0,0,0));
+	m_lVertices.push_back(Vertex(m_uiOriginXPos + m_uiWidth, m_uiOriginYPos + m_uiHeight, 0, 1, 0,   0,0,0));
+	m_lVertices.push_back(Vertex(m_uiOriginXPos + m_uiWidth, m_uiOriginYPos , 0, 1, 1,   0,0,0));
+	m_lVertices.push_back(Vertex(m_uiOriginXPos , m_uiOriginYPos, 0 , 0, 1,   0,0,0));
 }
 
 void TTextBox::Init()
 {
-	m_pFont = new TFont("assignment4/ExampleGame/data/font/bm_0.tga","assignment4/ExampleGame/data/font/bm.fnt");
-	m_uiCurrentXPos = m_uiOriginXPos + m_iXBoxOffset1;
-	m_iXBoxOffset1 = 10 * (m_uiWidth/256.0);
-	m_iYBoxOffset1 = 10 * (m_uiHeight/256.0);
+	// Everything but the layout is only created once, so Init can be called again
+	if (!m_pFont)
+	{
+		m_pFont = new TFont("assignment4/ExampleGame/data/font/bm_0.tga","assignment4/ExampleGame/data/font/bm.fnt");
+		m_bOwnsFont = true;
+	}
 
-	m_pVertices = new Vertex[10000];
-	m_uiNumVertex = 0;
+	if (!m_pProgram)
+		m_pProgram = wolf::ProgramManager::CreateProgram("Assignment4/ExampleGame/data/font/one_texture.vsh", "Assignment4/ExampleGame/data/font/one_texture.fsh");
 
-	m_HAlignment = AL_Left;
-	m_VAlignment = AL_Top;
-	m_fSize = 1.1f;
-	m_iTextHeight = 0;
+	if (!m_pVertexBuffer)
+	{
+		// Sized for the box and a short line of text; Render grows it as needed
+		m_pVertexBuffer = wolf::BufferManager::CreateVertexBuffer(sizeof(Vertex) * 6 * 32);
+
+		m_pVertexDeclaration = new wolf::VertexDeclaration();
+		m_pVertexDeclaration->Begin();
+		m_pVertexDeclaration->AppendAttribute(wolf::AT_Position, 3, wolf::CT_Float);
+		m_pVertexDeclaration->AppendAttribute(wolf::AT_TexCoord1, 2, wolf::CT_Float);
+		m_pVertexDeclaration->AppendAttribute(wolf::AT_Normal, 3, wolf::CT_Float);
+		m_pVertexDeclaration->SetVertexBuffer(m_pVertexBuffer);
+		m_pVertexDeclaration->End();
+	}
 
-	ConstructQuadforTextBox();
+	if (!m_pTextureTextBox)
+		m_pTextureTextBox = wolf::TextureManager::CreateTexture("Assignment4/ExampleGame/data/font/textbox.tga");
+	if (!m_pTextureFont)
+		m_pTextureFont = m_pFont->GetTextureForChar(0);
 
-	ShrinkUntilFit();
-	
-	if (m_VAlignment == AL_Top)
-		m_iTextHeight = 0;
-	else 
+	m_fSize = 1.0f;
+	FitText();
+	Layout(0);
+	m_bLaidOut = true;
+}
+
+void TTextBox::Layout(unsigned int p_uiFirstChar)
+{
+	if (p_uiFirstChar == 0 || m_HAlignment != AL_Left)
 	{
-		m_iTextHeight = m_uiHeight - m_iYBoxOffset1*2 - m_iTextHeight;
-		if (m_VAlignment == AL_VCenter)
-			m_iTextHeight /= 2;
-	}
+		m_lVertices.clear();
+		m_lCharLayout.clear();
+		ConstructQuadforTextBox();
+
+		m_iTextYOffset = GetTextYOffset();
+		m_uiCurrentXPos = m_uiOriginXPos + m_iXBoxOffset1;
+		m_uiCurrentYPos = m_uiOriginYPos + m_iYBoxOffset1;
+		p_uiFirstChar = 0;
 
-	if (m_HAlignment != AL_Left)
+		if (m_HAlignment != AL_Left)
+		{
+			RightCenterAlignment();
+			m_bVerticesDirty = true;
+			return;
+		}
+	}
+	else if (p_uiFirstChar < m_lCharLayout.size())
 	{
-		RightCenterAlignment();
-		return;
+		// Pick up where the character was laid out last time; otherwise the text
+		// was only appended to and the pen is already in the right place
+		const CharLayout& resume = m_lCharLayout[p_uiFirstChar];
+		m_uiCurrentXPos = resume.m_uiXPos;
+		m_uiCurrentYPos = resume.m_uiYPos;
+		m_lVertices.resize(resume.m_uiFirstVertex);
+		m_lCharLayout.resize(p_uiFirstChar);
 	}
 
 	// auto left alignment
 	int index;
-	for (int i=0; i<m_strText.size(); i++)
+	for (unsigned int i=p_uiFirstChar; i<m_strText.size(); i++)
 	{
+		CharLayout layout = { m_uiCurrentXPos, m_uiCurrentYPos, (unsigned int)m_lVertices.size() };
+		m_lCharLayout.push_back(layout);
+
 		char ch = m_strText[i];
 		if (i>0)
 		{
-			if (ch=='F') 
-				printf("sdsd");
 			if (ch != 32 && m_strText[i-1] == 32 )
 			{
 				int dif = (m_uiOriginXPos + m_uiWidth) - m_uiCurrentXPos - m_iXBoxOffset1;
@@ -144,25 +198,18 @@ void TTextBox::Init()
 		ConstructQuadforChar(ch);
 	}
 
-	if (!m_pProgram)
-		m_pProgram = wolf::ProgramManager::CreateProgram("Assignment4/ExampleGame/data/font/one_texture.vsh", "Assignment4/ExampleGame/data/font/one_texture.fsh");
-	m_pVertexBuffer = wolf::BufferManager::CreateVertexBuffer(m_pVertices,sizeof(Vertex) * m_uiNumVertex);
-
-	m_pVertexDeclaration = new wolf::VertexDeclaration();
-	m_pVertexDeclaration->Begin();
-	m_pVertexDeclaration->AppendAttribute(wolf::AT_Position, 3, wolf::CT_Float);
-	m_pVertexDeclaration->AppendAttribute(wolf::AT_TexCoord1, 2, wolf::CT_Float);
-	m_pVertexDeclaration->AppendAttribute(wolf::AT_Normal, 3, wolf::CT_Float);
-	m_pVertexDeclaration->SetVertexBuffer(m_pVertexBuffer);
-	m_pVertexDeclaration->End();
-
-	//glEnable(GL_BLEND);
-	//glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
- 
-	if (!m_pTextureTextBox)
-		m_pTextureTextBox = wolf::TextureManager::CreateTexture("Assignment4/ExampleGame/data/font/textbox.tga");
-	if (!m_pTextureFont)
-		m_pTextureFont = m_pFont->GetTextureForChar(0);
+	m_bVerticesDirty = true;
+}
+
+int TTextBox::GetTextYOffset() const
+{
+	if (m_VAlignment == AL_Top)
+		return 0;
+
+	int iOffset = m_uiHeight - m_iYBoxOffset1*2 - m_iTextHeight;
+	if (m_VAlignment == AL_VCenter)
+		iOffset /= 2;
+	return iOffset;
 }
 
 void TTextBox::RightCenterAlignment()
@@ -175,8 +222,6 @@ void TTextBox::RightCenterAlignment()
 		char ch = m_strText[i];
 		if (i>0)
 		{
-			if (ch=='F') 
-				printf("sdsd");
 			if (ch != 32 && m_strText[i-1] == 32 )
 			{
 				dif = (m_uiOriginXPos + m_uiWidth) - tempX - m_iXBoxOffset1;
@@ -220,7 +265,7 @@ void TTextBox::RightCenterAlignment()
 					ConstructQuadforChar(ch1);
 				}
 			}
-			tempX+= m_fSize * m_pFont->GetCharAdvance(ch);
+			tempX+= m_fSize * m_pFont->GetCharAdvance((unsigned char)ch);
 		}
 	}
 }
@@ -251,6 +296,13 @@ void TTextBox::SetPos(int p_iXPos, int p_iYPos)
 
 void TTextBox::Render()
 {
+	// Only upload the vertices when the text was laid out again
+	if (m_bVerticesDirty)
+	{
+		m_pVertexBuffer->Stream(&m_lVertices[0], sizeof(Vertex) * m_lVertices.size());
+		m_bVerticesDirty = false;
+	}
+
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	m_pProgram->Bind();
@@ -267,7 +319,7 @@ void TTextBox::Render()
 	// draw characters
 	m_pProgram->SetUniform("fontcolor", m_fontcolor);
 	m_pTextureFont->Bind();
-	glDrawArrays(GL_TRIANGLES, 6, m_uiNumVertex-6);
+	glDrawArrays(GL_TRIANGLES, 6, m_lVertices.size()-6);
 
 	glDisable(GL_BLEND);
 }
@@ -275,8 +327,8 @@ void TTextBox::Render()
 void TTextBox::EstimateTextLength(int *p_iX, int *p_iY)
 {
 	int index;
-	*p_iX = m_uiCurrentXPos;
-	*p_iY = m_uiCurrentYPos;
+	*p_iX = m_uiOriginXPos + m_iXBoxOffset1;
+	*p_iY = m_uiOriginYPos + m_iYBoxOffset1;
 
 	int i;
 	for (i=0; i<m_strText.size(); i++)
@@ -284,8 +336,6 @@ void TTextBox::EstimateTextLength(int *p_iX, int *p_iY)
 		char ch = m_strText[i];
 		if (i>0)
 		{
-			if (ch=='F') 
-				printf("sdsd");
 			if (ch != 32 && m_strText[i-1] == 32 )
 			{
 				int dif = (m_uiOriginXPos + m_uiWidth) - *p_iX - m_iXBoxOffset1;
@@ -299,53 +349,123 @@ void TTextBox::EstimateTextLength(int *p_iX, int *p_iY)
 			}
 		}
 
-		*p_iX += m_fSize * m_pFont->GetCharAdvance(ch);
+		*p_iX += m_fSize * m_pFont->GetCharAdvance((unsigned char)ch);
 	}
 	if (i>0)
-		*p_iY += m_fSize * m_pFont->GetCharHeight(m_strText[i-1]);
+		*p_iY += m_fSize * m_pFont->GetCharHeight((unsigned char)m_strText[i-1]);
 
 	m_iTextHeight = *p_iY - m_uiOriginYPos - m_iYBoxOffset1;
 }
 
-void TTextBox::ShrinkUntilFit()
+bool TTextBox::TextFits(int p_iX, int p_iY) const
 {
-	int estX = m_uiCurrentXPos;
-	int estY = m_uiCurrentYPos;
+	return !((p_iX > m_uiOriginXPos+ m_uiWidth - 2*m_iXBoxOffset1) || (p_iY > m_uiOriginYPos + m_uiHeight - 2*m_iYBoxOffset1));
+}
 
-	do {
-		m_fSize -= 0.1f;
-		if (m_fSize == 0.0f) break;
-		EstimateTextLength(&estX, &estY);
+bool TTextBox::FitText()
+{
+	// Font size goes in steps of 0.1 up to 1.0; use the largest that fits. Start
+	// from the current size since the text rarely changes enough to move it.
+	int iOldStep = (int)(m_fSize * 10.0f + 0.5f);
+	int iStep = iOldStep;
+	int estX, estY;
+
+	m_fSize = iStep * 0.1f;
+	EstimateTextLength(&estX, &estY);
+	if (TextFits(estX, estY))
+	{
+		while (iStep < 10)
+		{
+			m_fSize = (iStep + 1) * 0.1f;
+			EstimateTextLength(&estX, &estY);
+			if (!TextFits(estX, estY))
+				break;
+			++iStep;
+		}
+	}
+	else
+	{
+		while (iStep > 1)
+		{
+			--iStep;
+			m_fSize = iStep * 0.1f;
+			EstimateTextLength(&estX, &estY);
+			if (TextFits(estX, estY))
+				break;
+		}
 	}
-	while ((estX > m_uiOriginXPos+ m_uiWidth - 2*m_iXBoxOffset1) || (estY > m_uiOriginYPos + m_uiHeight - 2*m_iYBoxOffset1));
+
+	// Leave m_iTextHeight measured at the size we settled on
+	m_fSize = iStep * 0.1f;
+	EstimateTextLength(&estX, &estY);
+	return iStep != iOldStep;
 }
 
 void TTextBox::SetText(const char *format, ...)
 {
+	std::string strText;
+
     va_list arg_list;                                                           
     va_start(arg_list, format);                                                 
 
     char short_buf[256];                                                        
     const size_t needed = vsnprintf(short_buf, sizeof short_buf,
                                     format, arg_list) + 1;
+	va_end(arg_list);
     if (needed <= sizeof short_buf)
 	{
-		m_strText = short_buf;
-        return;
+		strText = short_buf;
+	}
+	else
+	{
+		char* p = static_cast<char*>(alloca(needed));
+		va_start(arg_list, format);
+		vsnprintf(p, needed, format, arg_list);
+		va_end(arg_list);
+		strText = p;
 	}
 
-    char* p = static_cast<char*>(alloca(needed));
-    vsnprintf(p, needed, format, arg_list);
-    m_strText = p;
+	if (!m_bLaidOut)
+	{
+		// Init lays it out
+		m_strText = strText;
+		return;
+	}
+	if (strText == m_strText)
+		return;
+
+	unsigned int uiFirstChange = 0;
+	while (uiFirstChange < m_strText.size() && uiFirstChange < strText.size() && m_strText[uiFirstChange] == strText[uiFirstChange])
+		++uiFirstChange;
+	m_strText = strText;
+
+	// A new size or height moves every character
+	int iOldYOffset = m_iTextYOffset;
+	if (FitText() || GetTextYOffset() != iOldYOffset)
+	{
+		Layout(0);
+		return;
+	}
+
+	// Whether a word wraps is decided at its first character, so go back to there
+	while (uiFirstChange > 0 && m_strText[uiFirstChange-1] != 32)
+		--uiFirstChange;
+	Layout(uiFirstChange);
 }
 
-void TTextBox::HandleCoinCollected(BaseEvent* p_pBaseEvent)
+void TTextBox::HandleCoinsCollected(const EventBatch<EventCoinCollected>& p_Events)
 {
-	EventCoinCollected *pEventCoinCollected = static_cast<EventCoinCollected*>(p_pBaseEvent);
-	Common::GameObject *pCoin = pEventCoinCollected->GetCoin();
-	week2::ComponentCoinScore *pScoreComponent = static_cast<week2::ComponentCoinScore*>( pCoin->GetComponent("GOC_CoinScore"));
+	// Add up the whole batch so the text is only rebuilt once
+	for (unsigned int i = 0; i < p_Events.GetCount(); ++i)
+	{
+		Common::GameObject *pCoin = week2::ExampleGame::GetInstance()->GameObjectManager()->GetGameObject(p_Events[i].GetCoin());
+		if (pCoin == NULL)
+			continue;
+
+		week2::ComponentCoinScore *pScoreComponent = pCoin->GetComponent<week2::ComponentCoinScore>();
+		m_iScore += pScoreComponent->GetScore();
+	}
 
-	m_iScore += pScoreComponent->GetScore();
-	Init();
+	// Only the digits after "Score: " are laid out again
 	this->SetText("Score: %d",m_iScore);
-}
\ No newline at end of file
+}
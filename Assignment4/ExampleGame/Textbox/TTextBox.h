@@ -6,6 +6,7 @@
 
 #include <cstdio>
 #include <cstdarg>
+#include <vector>
 
 #include "W_BufferManager.h"
 #include "W_VertexDeclaration.h"
@@ -13,7 +14,8 @@
 #include "W_TextureManager.h"
 
 #include "TFont.h"
-#include "Assignment4\ExampleGame\BaseEvent.h"
+#include "Assignment4\ExampleGame\EventManager.h"
+#include "Assignment4\ExampleGame\EventCoinCollected.h"
 
 struct Vertex
 {
@@ -42,8 +44,12 @@ enum TVAlignment
 class TTextBox
 {
 public:
-	TTextBox(){};
+	TTextBox() : m_pFont(NULL), m_bOwnsFont(false), m_bLaidOut(false), m_bVerticesDirty(false), m_pVertexBuffer(NULL),
+		m_pVertexDeclaration(NULL), m_pProgram(NULL), m_pTextureTextBox(NULL), m_pTextureFont(NULL), m_hCoinCollectedListener(INVALID_EVENT_LISTENER_TOKEN) {};
+
+	// Pass a NULL font to have the text box load and own the default font
 	TTextBox(TFont *p_pFont, const std::string& p_strText, unsigned int p_uiWidth, unsigned int p_uiHeight);
+	~TTextBox();
 	void SetPos(int p_iXPos, int p_iYPos);
 	void SetHorizontalAlignment(int p_Al);
 	void SetColor(float p_fRed, float p_fGreen, float p_fBlue, float p_fAlpha);
@@ -55,7 +61,20 @@ public:
 	void Render();
 
 private:
-	
+	// Pen position and vertex count at the point a character was laid out, so
+	// layout can pick up again from any character
+	struct CharLayout
+	{
+		unsigned int m_uiXPos;
+		unsigned int m_uiYPos;
+		unsigned int m_uiFirstVertex;
+	};
+
+	void Layout(unsigned int p_uiFirstChar);
+	bool FitText();
+	int GetTextYOffset() const;
+	bool TextFits(int p_iX, int p_iY) const;
+
 	void ConstructQuadforChar(unsigned int p_uiCharID);
 	void ConstructQuadforTextBox();
 	int CalculateWordSpace(int p_index1, int *p_index2);
@@ -64,11 +83,11 @@ private:
 	void LeftAlignment();
 
 	void EstimateTextLength(int *p_iX, int *p_iY);
-	void ShrinkUntilFit();
 
-	void HandleCoinCollected(BaseEvent* p_pBaseEvent);
+	void HandleCoinsCollected(const EventBatch<EventCoinCollected>& p_Events);
 
 	 TFont *m_pFont;
+	 bool m_bOwnsFont;
 	 std::string m_strText;
 	 glm::vec4 m_fontcolor;
 	 unsigned int m_uiWidth;
@@ -87,9 +106,13 @@ private:
 	 TVAlignment m_VAlignment;
 	 float m_fSize;
 	 int m_iTextHeight;
+	 int m_iTextYOffset;
 
-	 Vertex* m_pVertices;
-	 unsigned int m_uiNumVertex;
+	 // Box quad followed by one quad per character
+	 std::vector<Vertex> m_lVertices;
+	 std::vector<CharLayout> m_lCharLayout;
+	 bool m_bLaidOut;
+	 bool m_bVerticesDirty;
 
 	 wolf::VertexBuffer* m_pVertexBuffer;
 	 wolf::VertexDeclaration* m_pVertexDeclaration;
@@ -99,5 +122,6 @@ private:
 
 
 	 int m_iScore;
+	 EventListenerToken m_hCoinCollectedListener;
 };
 #endif
\ No newline at end of file
@@ -120,10 +120,9 @@ void ComponentAnimController::Update(float p_fDelta)
 	if (m_pCurrentAnim)
 	{
 		// stunned zombie
-		Common::ComponentBase *pComponent = this->GetGameObject()->GetComponent("GOC_ZombieStun");
-		if (pComponent)
+		ComponentZombieStun* pStunComponent = this->GetGameObject()->GetComponent<ComponentZombieStun>();
+		if (pStunComponent)
 		{
-			ComponentZombieStun* pStunComponent = static_cast<ComponentZombieStun*>(pComponent);
 			if (pStunComponent->GetIsStunned())
 			{
 				p_fDelta /= 2;
@@ -151,10 +150,9 @@ void ComponentAnimController::Update(float p_fDelta)
 		{
 			// Get the parent GameObject and find it's Renderable component
 			Common::GameObject* pGameObject = this->GetGameObject();
-			ComponentBase* pComponent = pGameObject->GetComponent("GOC_Renderable");
-			if (pComponent)
+			ComponentRenderableMesh* pRenderableComponent = pGameObject->GetComponent<ComponentRenderableMesh>();
+			if (pRenderableComponent)
 			{
-				ComponentRenderableMesh* pRenderableComponent = static_cast<ComponentRenderableMesh*>(pComponent);
 				pRenderableComponent->GetModel()->SetAnimFrame(m_fAnimFrame);
 			}
 		}
@@ -45,7 +45,7 @@ namespace week2
 		ComponentAnimController(int p_iAnimSpeed = 30);
 		virtual ~ComponentAnimController();
 
-		virtual const std::string FamilyID() { return std::string("GOC_AnimController"); }
+		DECLARE_COMPONENT_FAMILY("GOC_AnimController")
 		virtual const std::string ComponentID(){ return std::string("GOC_AnimController"); }
 		virtual void Update(float p_fDelta);
 
@@ -14,6 +14,7 @@
 #include "ComponentRenderableMesh.h"
 #include "GameObject.h"
 #include "Assignment4\ExampleGame\ComponentCamera.h"
+#include "Assignment4\ExampleGame\ComponentCameraFollow.h"
 #include "SceneManager.h"
 #include "Assignment4\ExampleGame\ComponentRigidBody.h"
 #include "Assignment4\ExampleGame\EventManager.h"
@@ -29,6 +30,8 @@ using namespace week2;
 // Constructor.
 //------------------------------------------------------------------------------
 ComponentCharacterController::ComponentCharacterController()
+	:
+	m_hLamp(Common::INVALID_GAMEOBJECT_HANDLE)
 {
 	memset(m_bKeysDown, 0, sizeof(bool) * 256);
 	memset(m_bKeysDownLast, 0, sizeof(bool) * 256);
@@ -74,7 +77,7 @@ void ComponentCharacterController::Update(float p_fDelta)
 		m_bKeysDown[i] = (glfwGetKey(i) == GLFW_PRESS);
 	}
 
-	ComponentAnimController* pAnimation = static_cast<ComponentAnimController*>(this->GetGameObject()->GetComponent("GOC_AnimController"));
+	ComponentAnimController* pAnimation = this->GetGameObject()->GetComponent<ComponentAnimController>();
 
 	if ((!m_bKeysDown['W'] || !m_bKeysDown['S'])&&(m_bKeysDownLast['W'] && !m_bKeysDown['W'] || m_bKeysDownLast['S'] && !m_bKeysDown['S']))
 	{
@@ -85,7 +88,7 @@ void ComponentCharacterController::Update(float p_fDelta)
 		}
 	}
 
-	ComponentRigidBody* pCharRigid = static_cast<ComponentRigidBody*>(this->GetGameObject()->GetComponent("GOC_RigidBody"));
+	ComponentRigidBody* pCharRigid = this->GetGameObject()->GetComponent<ComponentRigidBody>();
 	btRigidBody *m_pRigidBody = pCharRigid->GetRigidBody();
     m_pRigidBody->setAngularFactor(0);
 	btTransform trans;
@@ -140,15 +143,25 @@ void ComponentCharacterController::Update(float p_fDelta)
     else if (glfwGetKey('C') == GLFW_RELEASE)
         m_bToggleCamera = false;
 
-	Common::SceneCamera* pCamera;
+	// Keep whatever camera is attached if the one we want isn't there (e.g. the
+	// lamp hasn't been created yet)
+	Common::SceneCamera* pCamera = NULL;
 	if (m_b3PCamera)
     {
-		pCamera = static_cast<ComponentCamera*>(GetGameObject()->GetComponent("GOC_CameraFollow"))->GetCamera();
+		ComponentCameraFollow* pCameraFollow = GetGameObject()->GetComponent<ComponentCameraFollow>();
+		if (pCameraFollow)
+			pCamera = pCameraFollow->GetCamera();
     }
     else
-		pCamera = static_cast<ComponentCamera*>(GetGameObject()->GetManager()->GetGameObject("lamp")->GetComponent("GOC_Camera"))->GetCamera();
+	{
+		Common::GameObject* pLamp = GetGameObject()->GetManager()->ResolveGameObject(m_hLamp, "lamp");
+		ComponentCamera* pLampCamera = pLamp ? pLamp->GetComponent<ComponentCamera>() : NULL;
+		if (pLampCamera)
+			pCamera = pLampCamera->GetCamera();
+	}
   
-	Common::SceneManager::Instance()->AttachCamera(pCamera);
+	if (pCamera)
+		Common::SceneManager::Instance()->AttachCamera(pCamera);
 
 	if (!m_bToggleShoot && glfwGetMouseButton(0))
 	{
@@ -161,7 +174,7 @@ void ComponentCharacterController::Update(float p_fDelta)
 		Common::GameObject* pProjectTile = this->GetGameObject()->GetManager()->CreateGameObject("Assignment4/ExampleGame/data/xml/projectile.xml");
 		pProjectTile->GetManager()->SetGameObjectGUID(pProjectTile, "projectile" + std::to_string(m_numProjectiles++));
 		pProjectTile->GetTransform().SetTranslation(glm::vec3(vNewPos.x,vNewPos.y,vNewPos.z));
-		ComponentRigidBody* pComponentRigid = static_cast<ComponentRigidBody*>(pProjectTile->GetComponent("GOC_RigidBody"));
+		ComponentRigidBody* pComponentRigid = pProjectTile->GetComponent<ComponentRigidBody>();
 		pComponentRigid->BindGameObject();
 		pComponentRigid->ApplyCentralImpulse(glm::vec3(offset.x * 40, 0.0f, offset.z*40));
 	}
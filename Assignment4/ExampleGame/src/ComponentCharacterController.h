@@ -12,8 +12,9 @@
 #define COMPNENTCHARACTERCONTROLLER_H
 
 #include "ComponentBase.h"
+#include "GameObjectHandle.h"
 #include "tinyxml\tinyxml.h"
-#include "BaseEvent.h"
+#include "Assignment4\ExampleGame\BaseEvent.h"
 #include "glm\glm.hpp"
 
 namespace week2
@@ -32,7 +33,7 @@ namespace week2
 		ComponentCharacterController();
 		virtual ~ComponentCharacterController();
 
-		virtual const std::string FamilyID() { return std::string("GOC_CharacterController"); }
+		DECLARE_COMPONENT_FAMILY("GOC_CharacterController")
 		virtual const std::string ComponentID(){ return std::string("GOC_CharacterController"); }
 		virtual void Update(float p_fDelta);
 
@@ -63,6 +64,9 @@ namespace week2
 		bool m_bActive;
 		
 		long double m_numProjectiles;
+
+		// Cached handle of the lamp whose camera we switch to
+		Common::GameObjectHandle m_hLamp;
 	};
 }
 
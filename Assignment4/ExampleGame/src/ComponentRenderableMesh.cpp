@@ -8,6 +8,7 @@
 //------------------------------------------------------------------------
 
 #include "W_Model.h"
+#include "W_ModelManager.h"
 #include "ComponentRenderableMesh.h"
 #include "GameObject.h"
 #include "SceneManager.h"
@@ -37,10 +38,10 @@ ComponentRenderableMesh::~ComponentRenderableMesh()
 	// Remove the model from the scene
 	Common::SceneManager::Instance()->RemoveModel(m_pModel);
 
-	// Delete the model
+	// Release the model; its data stays loaded while other copies use it
 	if (m_pModel)
 	{
-		delete m_pModel;
+		wolf::ModelManager::DestroyModel(m_pModel);
 		m_pModel = NULL;
 	}
 }
@@ -125,11 +126,12 @@ Common::ComponentBase* ComponentRenderableMesh::CreateComponent(TiXmlNode* p_pNo
 // Parameter: const std::string & p_strFragmentProgramPath
 // Returns:   void
 // 
-// Initializes this component by loading the renderable object.
+// Initializes this component by loading the renderable object. It loads in
+// the background, and isn't drawn until it's done.
 //------------------------------------------------------------------------------
 void ComponentRenderableMesh::Init(const std::string& p_strPath, const std::string &p_strTexturePath, const std::string &p_strVertexProgramPath, const std::string &p_strFragmentProgramPath)
 {
-	m_pModel = new wolf::Model(p_strPath, p_strTexturePath, p_strVertexProgramPath, p_strFragmentProgramPath);
+	m_pModel = wolf::ModelManager::CreateModelAsync(p_strPath, p_strTexturePath, p_strVertexProgramPath, p_strFragmentProgramPath);
 	Common::SceneManager::Instance()->AddModel(m_pModel);
 }
 
@@ -142,4 +144,5 @@ void ComponentRenderableMesh::Init(const std::string& p_strPath, const std::stri
 void ComponentRenderableMesh::SyncTransform()
 {
 	m_pModel->SetTransform(this->GetGameObject()->GetTransform().GetTransformation());
+	Common::SceneManager::Instance()->UpdateModelBounds(m_pModel);
 }
\ No newline at end of file
@@ -14,6 +14,9 @@
 #include "GameObject.h"
 #include "SceneManager.h"
 #include "W_Model.h"
+#include "W_AssetLoader.h"
+#include "W_TextureManager.h"
+#include "W_SkinningManager.h"
 #include "Assignment4/ExampleGame/ComponentRenderableSquare.h"
 #include "Assignment4/ExampleGame/ComponentCamera.h"
 #include "Assignment4/ExampleGame/ComponentCameraFollow.h"
@@ -43,6 +46,28 @@ using namespace week2;
 
 ExampleGame* ExampleGame::s_pInstance = NULL;
 
+// Textures packed into atlases at startup, so the props (and the UI buttons)
+// share a texture bind. Anything loading one of these gets its atlas region.
+static const char* s_apPropTextures[] =
+{
+	"Assignment4/ExampleGame/data/props/coin.tga",
+	"Assignment4/ExampleGame/data/props/ball.tga",
+	"Assignment4/ExampleGame/data/props/lamp.tga",
+};
+
+static const char* s_apUITextures[] =
+{
+	"Assignment4/ExampleGame/data/ui/ButtonEmpty.tga",
+	"Assignment4/ExampleGame/data/ui/ButtonLeaderboard.tga",
+	"Assignment4/ExampleGame/data/ui/ButtonMainMenu.tga",
+	"Assignment4/ExampleGame/data/ui/ButtonPause.tga",
+	"Assignment4/ExampleGame/data/ui/ButtonPlayNow.tga",
+	"Assignment4/ExampleGame/data/ui/ButtonResume.tga",
+};
+
+// Video memory the texture mip streaming stays within
+static const unsigned int s_uiTextureMemoryBudget = 64 * 1024 * 1024;
+
 //------------------------------------------------------------------------------
 // Method:    ExampleGame
 // Parameter: void
@@ -82,6 +107,16 @@ ExampleGame::~ExampleGame()
 //------------------------------------------------------------------------------
 bool ExampleGame::Init()
 {
+	// Start loading threads, so level loads don't stall the window
+	wolf::AssetLoader::Init();
+
+	// Textures compressed with -compress stream their mips in within this budget
+	wolf::TextureManager::SetTextureMemoryBudget(s_uiTextureMemoryBudget);
+
+	// Pack the atlases before anything loads their textures
+	wolf::TextureManager::CreateAtlas(std::vector<std::string>(s_apPropTextures, s_apPropTextures + sizeof(s_apPropTextures) / sizeof(s_apPropTextures[0])));
+	wolf::TextureManager::CreateAtlas(std::vector<std::string>(s_apUITextures, s_apUITextures + sizeof(s_apUITextures) / sizeof(s_apUITextures[0])));
+
 	// Initialize our Scene Manager
 	Common::SceneManager::CreateInstance();
 
@@ -119,6 +154,7 @@ bool ExampleGame::Init()
 	// Initialize our AIPathfindingManager
 	AIPathfinder::CreateInstance();
 	AIPathfinder::Instance()->Load("Assignment4/ExampleGame/data/path/AIPathfindingData1.xml");
+	AIPathfinder::Instance()->StartWorkers();
 
 	// Everything initialized OK.
 	return true;
@@ -135,11 +171,18 @@ bool ExampleGame::Init()
 //------------------------------------------------------------------------------
 bool ExampleGame::Update(float p_fDelta)
 {
-	EventManager::Instance()->Update(p_fDelta);
+	// Upload whatever finished loading in the background, a bit per frame
+	wolf::AssetLoader::Update();
+	wolf::TextureManager::StreamMips();
+
 	m_pGameObjectManager->Update(p_fDelta);
+
+	// Steps physics, which queues the collision events
 	m_pStateMachine->Update(p_fDelta);
-	
+	EventManager::Instance()->Dispatch(EventPhase_PostPhysics);
+
 	AIPathfinder::Instance()->Update();
+	EventManager::Instance()->Dispatch(EventPhase_PostAI);
 	return true;
 }
 
@@ -153,6 +196,9 @@ bool ExampleGame::Update(float p_fDelta)
 //------------------------------------------------------------------------------
 void ExampleGame::Render()
 {
+	// Deliver anything the HUD and render components care about this frame
+	EventManager::Instance()->Dispatch(EventPhase_PreRender);
+
 	// Sync transforms to render components
 	m_pGameObjectManager->SyncTransforms();
 
@@ -182,6 +228,14 @@ void ExampleGame::Shutdown()
 	delete m_pGameObjectManager;
 	m_pGameObjectManager = NULL;
 
+	// Stop the loading threads
+	wolf::AssetLoader::Shutdown();
+	wolf::TextureManager::DestroyAtlases();
+	wolf::SkinningManager::Shutdown();
+
+	// Stops the path search threads too
+	AIPathfinder::DestroyInstance();
+
 	// Delete our camera
 	if (m_pSceneCamera)
 	{
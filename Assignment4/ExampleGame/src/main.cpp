@@ -5,12 +5,39 @@
 // Author:	Carel Boers
 //	
 // Main entry point of the game. Create a game, and run it.
+//
+// "-cook <pod files>" cooks the given models to .wmdl files and exits
+// without running the game, for doing it ahead of time.
+//
+// "-compress <tga files>" does the same for textures, writing .dds files
+// that load in place of the TGAs. Meant for the large environment textures
+// (brick.tga and ground.tga); atlased and UI textures are better left as
+// TGA.
 //------------------------------------------------------------------------
 
 #include "ExampleGame.h"
+#include "W_CookedModel.h"
+#include "W_TextureCompressor.h"
+#include <cstring>
 
 int main(int argc, char* argv[])
 {
+	if (argc > 1 && strcmp(argv[1], "-cook") == 0)
+	{
+		std::vector<std::string> lPODFiles(argv + 2, argv + argc);
+		unsigned int uiCooked = wolf::CookedModel::CookStale(lPODFiles);
+		printf("Cooked %u of %u models\n", uiCooked, (unsigned int)lPODFiles.size());
+		return 0;
+	}
+
+	if (argc > 1 && strcmp(argv[1], "-compress") == 0)
+	{
+		std::vector<std::string> lTGAFiles(argv + 2, argv + argc);
+		unsigned int uiCompressed = wolf::TextureCompressor::CompressStale(lTGAFiles);
+		printf("Compressed %u of %u textures\n", uiCompressed, (unsigned int)lTGAFiles.size());
+		return 0;
+	}
+
 	week2::ExampleGame exampleGame;
 	return exampleGame.Run();
 }
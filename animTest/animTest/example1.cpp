@@ -13,6 +13,7 @@
 #include <GL/glfw.h>
 #include "W_Common.h"
 #include "W_Model.h" 
+#include "W_ModelManager.h"
 
 struct DirectionalLight
 {
@@ -33,9 +34,9 @@ void InitExample1()
 	g_light.m_specular = wolf::Color4(1.0f,1.0f,1.0f,1.0f);
 	g_light.m_vDirection = glm::vec3(0.0f,0.0f,-1.0f);
 
-	g_pModel = new wolf::Model("data/animTest/zombie/zombie.pod", "data/animTest/zombie/", "data/animTest/skinned.vsh", "data/animTest/skinned.fsh");
-	//g_pModel = new wolf::Model("data/animTest/zombie/zombie_gangnam.pod", "data/animTest/zombie/", "data/animTest/skinned.vsh", "data/animTest/skinned.fsh");
-	//g_pModel = new wolf::Model("data/animTest/character/character.pod", "data/animTest/character/", "data/animTest/skinned.vsh", "data/animTest/skinned.fsh");
+	g_pModel = wolf::ModelManager::CreateModel("data/animTest/zombie/zombie.pod", "data/animTest/zombie/", "data/animTest/skinned.vsh", "data/animTest/skinned.fsh");
+	//g_pModel = wolf::ModelManager::CreateModel("data/animTest/zombie/zombie_gangnam.pod", "data/animTest/zombie/", "data/animTest/skinned.vsh", "data/animTest/skinned.fsh");
+	//g_pModel = wolf::ModelManager::CreateModel("data/animTest/character/character.pod", "data/animTest/character/", "data/animTest/skinned.vsh", "data/animTest/skinned.fsh");
 }
 
 void RenderExample1(float p_fDeltaTime)
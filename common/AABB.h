@@ -0,0 +1,64 @@
+//------------------------------------------------------------------------
+// AABB
+//
+// Created:	2026/10/17
+// Author:	agent
+//
+// Axis aligned bounding box used for culling.
+//------------------------------------------------------------------------
+
+#ifndef AABB_H
+#define AABB_H
+
+#include <glm/glm.hpp>
+
+namespace Common
+{
+	struct AABB
+	{
+		glm::vec3 m_vMin;
+		glm::vec3 m_vMax;
+
+		AABB() : m_vMin(0.0f), m_vMax(0.0f) {}
+		AABB(const glm::vec3& p_vMin, const glm::vec3& p_vMax) : m_vMin(p_vMin), m_vMax(p_vMax) {}
+
+		glm::vec3 GetCenter() const { return (m_vMin + m_vMax) * 0.5f; }
+		glm::vec3 GetExtents() const { return (m_vMax - m_vMin) * 0.5f; }
+
+		// Half the surface area; only used to compare boxes
+		float GetPerimeter() const
+		{
+			glm::vec3 vSize = m_vMax - m_vMin;
+			return vSize.x * vSize.y + vSize.y * vSize.z + vSize.z * vSize.x;
+		}
+
+		bool Contains(const AABB& p_Other) const
+		{
+			return m_vMin.x <= p_Other.m_vMin.x && m_vMin.y <= p_Other.m_vMin.y && m_vMin.z <= p_Other.m_vMin.z &&
+				   m_vMax.x >= p_Other.m_vMax.x && m_vMax.y >= p_Other.m_vMax.y && m_vMax.z >= p_Other.m_vMax.z;
+		}
+
+		static AABB Merge(const AABB& p_A, const AABB& p_B)
+		{
+			return AABB(glm::min(p_A.m_vMin, p_B.m_vMin), glm::max(p_A.m_vMax, p_B.m_vMax));
+		}
+
+		// Box around this box after it's transformed by the given matrix
+		AABB Transform(const glm::mat4& p_mTransform) const
+		{
+			glm::vec3 vCenter = glm::vec3(p_mTransform * glm::vec4(GetCenter(), 1.0f));
+			glm::vec3 vExtents = GetExtents();
+			glm::vec3 vNewExtents;
+			for (int i = 0; i < 3; ++i)
+			{
+				vNewExtents[i] = glm::abs(p_mTransform[0][i]) * vExtents.x +
+								 glm::abs(p_mTransform[1][i]) * vExtents.y +
+								 glm::abs(p_mTransform[2][i]) * vExtents.z;
+			}
+			return AABB(vCenter - vNewExtents, vCenter + vNewExtents);
+		}
+	};
+
+} // namespace Common
+
+#endif // AABB_H
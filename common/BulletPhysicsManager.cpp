@@ -166,7 +166,7 @@ void BulletPhysicsManager::Update(float p_fDelta)
 	for (int i=0;i<m_lPairCollision.size();i++)
 	{
 		std::pair<GameObject*,GameObject*> pair = m_lPairCollision.at(i);
-		EventManager::Instance()->QueueEvent(new EventObjectCollision(pair.first, pair.second));
+		EventManager::Instance()->QueueEvent(EventObjectCollision(pair.first, pair.second));
 	}
 	m_lPairCollision.clear();
 }
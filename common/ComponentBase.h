@@ -12,18 +12,36 @@
 #define BASECOMPONENT_H
 
 #include <string>
+#include <map>
 #include "LuaScriptManager.h"
+#include "PoolAllocator.h"
+
+//------------------------------------------------------------------------------
+// Declares the family of a component class. Place in the public section of the
+// class that owns the family (derived classes inherit it). Gives the class a 
+// static family name and an interned integer family index so lookups through
+// GameObject::GetComponent<T>() are an array index rather than a string compare.
+//------------------------------------------------------------------------------
+#define DECLARE_COMPONENT_FAMILY(FAMILY) \
+	static const std::string& FamilyName()	{ static const std::string s_strFamily(FAMILY); return s_strFamily; } \
+	static unsigned int FamilyIndex()		{ static const unsigned int s_uiFamily = Common::ComponentBase::RegisterFamily(FamilyName()); return s_uiFamily; } \
+	virtual const std::string FamilyID()	{ return FamilyName(); }
 
 namespace Common
 {
 	class ComponentBase
 	{
 		friend class GameObject;
+		friend class GameObjectManager;
+
+		// Typedef for convenience
+		typedef std::map<std::string, unsigned int> FamilyIndexMap;
+
 	public:
 		//------------------------------------------------------------------------------
 		// Public methods.
 		//------------------------------------------------------------------------------
-		ComponentBase() : m_pGameObject(NULL) {}
+		ComponentBase() : m_pGameObject(NULL), m_uiFamilyIndex(s_uiInvalidFamilyIndex), m_uiPoolIndex(s_uiInvalidPoolIndex) {}
 		virtual ~ComponentBase() {}
 
 		virtual const std::string FamilyID() = 0;
@@ -32,6 +50,48 @@ namespace Common
 
 		GameObject* GetGameObject() { return m_pGameObject; }
 
+		// Component memory is recycled through the pool allocator; the size passed to
+		// delete is that of the most derived class thanks to the virtual destructor.
+		static void* operator new(size_t p_uiSize)						{ return PoolAllocator::Allocate(p_uiSize); }
+		static void operator delete(void* p_pMemory, size_t p_uiSize)	{ PoolAllocator::Free(p_pMemory, p_uiSize); }
+
+		// Interned family index of this component (resolved once, then cached)
+		unsigned int GetFamilyIndex()
+		{
+			if (m_uiFamilyIndex == s_uiInvalidFamilyIndex)
+			{
+				m_uiFamilyIndex = RegisterFamily(FamilyID());
+			}
+			return m_uiFamilyIndex;
+		}
+
+		//------------------------------------------------------------------------------
+		// Family index registry. Every family name is interned to a small integer the
+		// first time it is seen; the indices are dense so they can index arrays.
+		//------------------------------------------------------------------------------
+		static const unsigned int s_uiInvalidFamilyIndex = 0xFFFFFFFF;
+
+		static unsigned int RegisterFamily(const std::string &p_strFamilyId)
+		{
+			FamilyIndexMap& mFamilies = GetFamilyIndexMap();
+			FamilyIndexMap::iterator it = mFamilies.find(p_strFamilyId);
+			if (it != mFamilies.end())
+			{
+				return it->second;
+			}
+
+			unsigned int uiIndex = mFamilies.size();
+			mFamilies.insert(std::make_pair(p_strFamilyId, uiIndex));
+			return uiIndex;
+		}
+
+		static unsigned int FindFamily(const std::string &p_strFamilyId)
+		{
+			FamilyIndexMap& mFamilies = GetFamilyIndexMap();
+			FamilyIndexMap::iterator it = mFamilies.find(p_strFamilyId);
+			return (it != mFamilies.end()) ? it->second : s_uiInvalidFamilyIndex;
+		}
+
 		// Lua bindings
 		static void ExportToLua()
 		{
@@ -48,6 +108,9 @@ namespace Common
 		// Set parent GameObject. Private so only GameObjects can do this.
 		void SetGameObject(GameObject* p_pGameObject)	{ m_pGameObject = p_pGameObject; }
 
+		// Storage for the family registry, shared by every translation unit
+		static FamilyIndexMap& GetFamilyIndexMap()		{ static FamilyIndexMap s_mFamilies; return s_mFamilies; }
+
 	private:
 		//------------------------------------------------------------------------------
 		// Private members.
@@ -55,6 +118,14 @@ namespace Common
 
 		// Parent GameObject that owns this component
 		GameObject* m_pGameObject;
+
+		// Cached family index
+		unsigned int m_uiFamilyIndex;
+
+		// Slot in the GameObjectManager family pool this component lives in. Only
+		// the GameObjectManager touches this so it can remove components in O(1).
+		static const unsigned int s_uiInvalidPoolIndex = 0xFFFFFFFF;
+		unsigned int m_uiPoolIndex;
 	};
 }
 
@@ -24,7 +24,7 @@ namespace Common
 		ComponentRenderable() {}
 		virtual ~ComponentRenderable() {}
 
-		virtual const std::string FamilyID() { return std::string("GOC_Renderable"); }
+		DECLARE_COMPONENT_FAMILY("GOC_Renderable")
 		virtual void SyncTransform() = 0;
 
 	private:
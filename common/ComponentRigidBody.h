@@ -25,7 +25,7 @@ namespace Common
 		virtual ~ComponentRigidBody();
 
 		virtual const std::string ComponentID(){ return std::string("GOC_RigidBody"); }
-		virtual const std::string FamilyID(){ return std::string("GOC_RigidBody"); }
+		DECLARE_COMPONENT_FAMILY("GOC_RigidBody")
 		virtual void Update(float p_fDelta);
 
 		//------------------------------------------------------------------------------
@@ -0,0 +1,397 @@
+//------------------------------------------------------------------------
+// DynamicAABBTree
+//
+// Created:	2026/10/17
+// Author:	agent
+//
+// Bounding volume hierarchy of axis aligned boxes that objects can be added
+// to, moved in and removed from at any time.
+//------------------------------------------------------------------------
+
+#include "DynamicAABBTree.h"
+#include <cassert>
+#include <algorithm>
+
+using namespace Common;
+
+//------------------------------------------------------------------------------
+// Method:    DynamicAABBTree
+// Parameter: float p_fMargin
+// Returns:
+//
+// Constructor.
+//------------------------------------------------------------------------------
+DynamicAABBTree::DynamicAABBTree(float p_fMargin)
+	:
+	m_iRoot(s_iNullProxy),
+	m_iFreeList(s_iNullProxy),
+	m_fMargin(p_fMargin)
+{
+}
+
+//------------------------------------------------------------------------------
+// Method:    ~DynamicAABBTree
+// Returns:
+//
+// Destructor.
+//------------------------------------------------------------------------------
+DynamicAABBTree::~DynamicAABBTree()
+{
+}
+
+//------------------------------------------------------------------------------
+// Method:    CreateProxy
+// Parameter: const AABB & p_AABB
+// Parameter: void * p_pUserData
+// Returns:   int
+//
+// Adds an object with the given bounds to the tree and returns its proxy id.
+//------------------------------------------------------------------------------
+int DynamicAABBTree::CreateProxy(const AABB& p_AABB, void* p_pUserData)
+{
+	int iProxy = AllocateNode();
+
+	glm::vec3 vMargin(m_fMargin);
+	m_lNodes[iProxy].m_AABB = AABB(p_AABB.m_vMin - vMargin, p_AABB.m_vMax + vMargin);
+	m_lNodes[iProxy].m_pUserData = p_pUserData;
+	m_lNodes[iProxy].m_iHeight = 0;
+
+	InsertLeaf(iProxy);
+	return iProxy;
+}
+
+//------------------------------------------------------------------------------
+// Method:    DestroyProxy
+// Parameter: int p_iProxy
+// Returns:   void
+//
+// Removes the given proxy from the tree.
+//------------------------------------------------------------------------------
+void DynamicAABBTree::DestroyProxy(int p_iProxy)
+{
+	assert(p_iProxy >= 0 && p_iProxy < (int)m_lNodes.size());
+	assert(m_lNodes[p_iProxy].IsLeaf());
+
+	RemoveLeaf(p_iProxy);
+	FreeNode(p_iProxy);
+}
+
+//------------------------------------------------------------------------------
+// Method:    MoveProxy
+// Parameter: int p_iProxy
+// Parameter: const AABB & p_AABB
+// Returns:   bool
+//
+// Updates the bounds of a proxy. Returns true if it had to be re-inserted,
+// false if the new bounds still fit in its fat box.
+//------------------------------------------------------------------------------
+bool DynamicAABBTree::MoveProxy(int p_iProxy, const AABB& p_AABB)
+{
+	assert(p_iProxy >= 0 && p_iProxy < (int)m_lNodes.size());
+	assert(m_lNodes[p_iProxy].IsLeaf());
+
+	if (m_lNodes[p_iProxy].m_AABB.Contains(p_AABB))
+	{
+		return false;
+	}
+
+	RemoveLeaf(p_iProxy);
+
+	glm::vec3 vMargin(m_fMargin);
+	m_lNodes[p_iProxy].m_AABB = AABB(p_AABB.m_vMin - vMargin, p_AABB.m_vMax + vMargin);
+
+	InsertLeaf(p_iProxy);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Method:    Query
+// Parameter: const Frustum & p_Frustum
+// Parameter: UserDataList & p_lResults
+// Returns:   void
+//
+// Appends the user data of every proxy whose fat box intersects the frustum.
+//------------------------------------------------------------------------------
+void DynamicAABBTree::Query(const Frustum& p_Frustum, UserDataList& p_lResults) const
+{
+	if (m_iRoot == s_iNullProxy)
+	{
+		return;
+	}
+
+	m_lStack.clear();
+	m_lStack.push_back(m_iRoot);
+	while (!m_lStack.empty())
+	{
+		int iNode = m_lStack.back();
+		m_lStack.pop_back();
+
+		const Node& node = m_lNodes[iNode];
+		if (!p_Frustum.Intersects(node.m_AABB))
+		{
+			continue;
+		}
+
+		if (node.IsLeaf())
+		{
+			p_lResults.push_back(node.m_pUserData);
+		}
+		else
+		{
+			m_lStack.push_back(node.m_iChild1);
+			m_lStack.push_back(node.m_iChild2);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Method:    AllocateNode
+// Returns:   int
+//
+// Takes a node off the free list, growing the node list if it's empty.
+//------------------------------------------------------------------------------
+int DynamicAABBTree::AllocateNode()
+{
+	if (m_iFreeList == s_iNullProxy)
+	{
+		Node node;
+		node.m_iParent = s_iNullProxy;
+		node.m_iHeight = -1;
+		m_iFreeList = m_lNodes.size();
+		m_lNodes.push_back(node);
+	}
+
+	int iNode = m_iFreeList;
+	Node& node = m_lNodes[iNode];
+	m_iFreeList = node.m_iParent;
+	node.m_iParent = s_iNullProxy;
+	node.m_iChild1 = s_iNullProxy;
+	node.m_iChild2 = s_iNullProxy;
+	node.m_iHeight = 0;
+	node.m_pUserData = NULL;
+	return iNode;
+}
+
+//------------------------------------------------------------------------------
+// Method:    FreeNode
+// Parameter: int p_iNode
+// Returns:   void
+//
+// Puts a node back on the free list.
+//------------------------------------------------------------------------------
+void DynamicAABBTree::FreeNode(int p_iNode)
+{
+	m_lNodes[p_iNode].m_iParent = m_iFreeList;
+	m_lNodes[p_iNode].m_iHeight = -1;
+	m_iFreeList = p_iNode;
+}
+
+//------------------------------------------------------------------------------
+// Method:    InsertLeaf
+// Parameter: int p_iLeaf
+// Returns:   void
+//
+// Inserts a leaf next to the sibling that makes the tree's area grow least,
+// then refits and rebalances its ancestors.
+//------------------------------------------------------------------------------
+void DynamicAABBTree::InsertLeaf(int p_iLeaf)
+{
+	if (m_iRoot == s_iNullProxy)
+	{
+		m_iRoot = p_iLeaf;
+		m_lNodes[m_iRoot].m_iParent = s_iNullProxy;
+		return;
+	}
+
+	// Walk down picking the cheapest child until it's cheaper to stop here
+	AABB leafAABB = m_lNodes[p_iLeaf].m_AABB;
+	int iIndex = m_iRoot;
+	while (!m_lNodes[iIndex].IsLeaf())
+	{
+		const Node& node = m_lNodes[iIndex];
+		float fArea = node.m_AABB.GetPerimeter();
+		float fCombinedArea = AABB::Merge(node.m_AABB, leafAABB).GetPerimeter();
+
+		// Cost of making a new parent for this node and the leaf, and the cost
+		// pushed down to the children if we descend instead
+		float fCost = 2.0f * fCombinedArea;
+		float fInheritanceCost = 2.0f * (fCombinedArea - fArea);
+
+		float afChildCost[2];
+		int aiChildren[2] = { node.m_iChild1, node.m_iChild2 };
+		for (int i = 0; i < 2; ++i)
+		{
+			const Node& child = m_lNodes[aiChildren[i]];
+			float fChildArea = AABB::Merge(leafAABB, child.m_AABB).GetPerimeter();
+			if (!child.IsLeaf())
+			{
+				fChildArea -= child.m_AABB.GetPerimeter();
+			}
+			afChildCost[i] = fChildArea + fInheritanceCost;
+		}
+
+		if (fCost < afChildCost[0] && fCost < afChildCost[1])
+		{
+			break;
+		}
+		iIndex = afChildCost[0] < afChildCost[1] ? aiChildren[0] : aiChildren[1];
+	}
+
+	// Make a new parent for the sibling and the leaf
+	int iSibling = iIndex;
+	int iOldParent = m_lNodes[iSibling].m_iParent;
+	int iNewParent = AllocateNode();
+	m_lNodes[iNewParent].m_iParent = iOldParent;
+	m_lNodes[iNewParent].m_AABB = AABB::Merge(leafAABB, m_lNodes[iSibling].m_AABB);
+	m_lNodes[iNewParent].m_iHeight = m_lNodes[iSibling].m_iHeight + 1;
+	m_lNodes[iNewParent].m_iChild1 = iSibling;
+	m_lNodes[iNewParent].m_iChild2 = p_iLeaf;
+	m_lNodes[iSibling].m_iParent = iNewParent;
+	m_lNodes[p_iLeaf].m_iParent = iNewParent;
+
+	if (iOldParent == s_iNullProxy)
+	{
+		m_iRoot = iNewParent;
+	}
+	else if (m_lNodes[iOldParent].m_iChild1 == iSibling)
+	{
+		m_lNodes[iOldParent].m_iChild1 = iNewParent;
+	}
+	else
+	{
+		m_lNodes[iOldParent].m_iChild2 = iNewParent;
+	}
+
+	Refit(m_lNodes[p_iLeaf].m_iParent);
+}
+
+//------------------------------------------------------------------------------
+// Method:    RemoveLeaf
+// Parameter: int p_iLeaf
+// Returns:   void
+//
+// Takes a leaf out of the tree; its sibling takes the place of their parent.
+//------------------------------------------------------------------------------
+void DynamicAABBTree::RemoveLeaf(int p_iLeaf)
+{
+	if (p_iLeaf == m_iRoot)
+	{
+		m_iRoot = s_iNullProxy;
+		return;
+	}
+
+	int iParent = m_lNodes[p_iLeaf].m_iParent;
+	int iGrandParent = m_lNodes[iParent].m_iParent;
+	int iSibling = m_lNodes[iParent].m_iChild1 == p_iLeaf ? m_lNodes[iParent].m_iChild2 : m_lNodes[iParent].m_iChild1;
+
+	if (iGrandParent == s_iNullProxy)
+	{
+		m_iRoot = iSibling;
+		m_lNodes[iSibling].m_iParent = s_iNullProxy;
+		FreeNode(iParent);
+		return;
+	}
+
+	if (m_lNodes[iGrandParent].m_iChild1 == iParent)
+	{
+		m_lNodes[iGrandParent].m_iChild1 = iSibling;
+	}
+	else
+	{
+		m_lNodes[iGrandParent].m_iChild2 = iSibling;
+	}
+	m_lNodes[iSibling].m_iParent = iGrandParent;
+	FreeNode(iParent);
+
+	Refit(iGrandParent);
+}
+
+//------------------------------------------------------------------------------
+// Method:    Refit
+// Parameter: int p_iNode
+// Returns:   void
+//
+// Walks from the given node up to the root, rebalancing and recomputing the
+// boxes and heights on the way.
+//------------------------------------------------------------------------------
+void DynamicAABBTree::Refit(int p_iNode)
+{
+	int iIndex = p_iNode;
+	while (iIndex != s_iNullProxy)
+	{
+		iIndex = Balance(iIndex);
+
+		Node& node = m_lNodes[iIndex];
+		const Node& child1 = m_lNodes[node.m_iChild1];
+		const Node& child2 = m_lNodes[node.m_iChild2];
+		node.m_iHeight = 1 + std::max(child1.m_iHeight, child2.m_iHeight);
+		node.m_AABB = AABB::Merge(child1.m_AABB, child2.m_AABB);
+
+		iIndex = node.m_iParent;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Method:    Balance
+// Parameter: int p_iNode
+// Returns:   int
+//
+// If one child of the given node is more than one level taller than the other,
+// rotates the taller child up. Returns the node now in the given node's place.
+//------------------------------------------------------------------------------
+int DynamicAABBTree::Balance(int p_iNode)
+{
+	Node& a = m_lNodes[p_iNode];
+	if (a.IsLeaf() || a.m_iHeight < 2)
+	{
+		return p_iNode;
+	}
+
+	int iB = a.m_iChild1;
+	int iC = a.m_iChild2;
+	int iBalance = m_lNodes[iC].m_iHeight - m_lNodes[iB].m_iHeight;
+	if (iBalance >= -1 && iBalance <= 1)
+	{
+		return p_iNode;
+	}
+
+	// Rotate the taller child (up) with its parent (down)
+	int iUp = iBalance > 1 ? iC : iB;
+	int iOther = iBalance > 1 ? iB : iC;
+	Node& up = m_lNodes[iUp];
+	int iF = up.m_iChild1;
+	int iG = up.m_iChild2;
+
+	// The taller child takes the node's place
+	up.m_iChild1 = p_iNode;
+	up.m_iParent = a.m_iParent;
+	a.m_iParent = iUp;
+
+	if (up.m_iParent == s_iNullProxy)
+	{
+		m_iRoot = iUp;
+	}
+	else if (m_lNodes[up.m_iParent].m_iChild1 == p_iNode)
+	{
+		m_lNodes[up.m_iParent].m_iChild1 = iUp;
+	}
+	else
+	{
+		m_lNodes[up.m_iParent].m_iChild2 = iUp;
+	}
+
+	// The taller of its children stays with it, the other goes to the node
+	int iKeep = m_lNodes[iF].m_iHeight > m_lNodes[iG].m_iHeight ? iF : iG;
+	int iGive = iKeep == iF ? iG : iF;
+	up.m_iChild2 = iKeep;
+	a.m_iChild1 = iOther;
+	a.m_iChild2 = iGive;
+	m_lNodes[iGive].m_iParent = p_iNode;
+
+	a.m_AABB = AABB::Merge(m_lNodes[iOther].m_AABB, m_lNodes[iGive].m_AABB);
+	a.m_iHeight = 1 + std::max(m_lNodes[iOther].m_iHeight, m_lNodes[iGive].m_iHeight);
+	up.m_AABB = AABB::Merge(a.m_AABB, m_lNodes[iKeep].m_AABB);
+	up.m_iHeight = 1 + std::max(a.m_iHeight, m_lNodes[iKeep].m_iHeight);
+
+	return iUp;
+}
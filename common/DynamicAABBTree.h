@@ -0,0 +1,96 @@
+//------------------------------------------------------------------------
+// DynamicAABBTree
+//
+// Created:	2026/10/17
+// Author:	agent
+//
+// Bounding volume hierarchy of axis aligned boxes that objects can be added
+// to, moved in and removed from at any time. Each object (proxy) is stored
+// with a slightly enlarged ("fat") box so small moves don't touch the tree;
+// only when an object leaves its fat box is it taken out and re-inserted.
+// Inserts pick the sibling that grows the tree's total area the least and the
+// tree is kept balanced with rotations, so queries stay logarithmic.
+//------------------------------------------------------------------------
+
+#ifndef DYNAMICAABBTREE_H
+#define DYNAMICAABBTREE_H
+
+#include "AABB.h"
+#include "Frustum.h"
+#include <vector>
+
+namespace Common
+{
+	class DynamicAABBTree
+	{
+	public:
+		// Returned by CreateProxy
+		static const int s_iNullProxy = -1;
+
+		typedef std::vector<void*> UserDataList;
+
+		//------------------------------------------------------------------------------
+		// Public methods.
+		//------------------------------------------------------------------------------
+		DynamicAABBTree(float p_fMargin = 1.0f);
+		~DynamicAABBTree();
+
+		int CreateProxy(const AABB& p_AABB, void* p_pUserData);
+		void DestroyProxy(int p_iProxy);
+		bool MoveProxy(int p_iProxy, const AABB& p_AABB);
+
+		void* GetUserData(int p_iProxy) const { return m_lNodes[p_iProxy].m_pUserData; }
+		const AABB& GetFatAABB(int p_iProxy) const { return m_lNodes[p_iProxy].m_AABB; }
+
+		void Query(const Frustum& p_Frustum, UserDataList& p_lResults) const;
+
+	private:
+		//------------------------------------------------------------------------------
+		// Private types.
+		//------------------------------------------------------------------------------
+		struct Node
+		{
+			AABB m_AABB;
+			void* m_pUserData;
+
+			// Parent while in the tree, next free node while on the free list
+			int m_iParent;
+			int m_iChild1;
+			int m_iChild2;
+
+			// Leaves are 0, free nodes -1
+			int m_iHeight;
+
+			bool IsLeaf() const { return m_iChild1 == s_iNullProxy; }
+		};
+		typedef std::vector<Node> NodeList;
+
+		//------------------------------------------------------------------------------
+		// Private methods.
+		//------------------------------------------------------------------------------
+		int AllocateNode();
+		void FreeNode(int p_iNode);
+
+		void InsertLeaf(int p_iLeaf);
+		void RemoveLeaf(int p_iLeaf);
+		void Refit(int p_iNode);
+		int Balance(int p_iNode);
+
+	private:
+		//------------------------------------------------------------------------------
+		// Private members.
+		//------------------------------------------------------------------------------
+		NodeList m_lNodes;
+		int m_iRoot;
+		int m_iFreeList;
+
+		// How far proxies' boxes are enlarged on each side
+		float m_fMargin;
+
+		// Traversal stack for Query; kept so queries don't allocate
+		mutable std::vector<int> m_lStack;
+	};
+
+} // namespace Common
+
+#endif // DYNAMICAABBTREE_H
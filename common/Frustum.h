@@ -0,0 +1,75 @@
+//------------------------------------------------------------------------
+// Frustum
+//
+// Created:	2026/10/17
+// Author:	agent
+//
+// View frustum as six planes pulled out of a projection * view matrix, for
+// testing bounding boxes against.
+//------------------------------------------------------------------------
+
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include "AABB.h"
+
+namespace Common
+{
+	class Frustum
+	{
+	public:
+		Frustum() {}
+
+		//------------------------------------------------------------------------------
+		// Builds the planes from the given projection * view matrix. Planes point
+		// inwards.
+		//------------------------------------------------------------------------------
+		void Set(const glm::mat4& p_mViewProj)
+		{
+			glm::vec4 vRow0(p_mViewProj[0][0], p_mViewProj[1][0], p_mViewProj[2][0], p_mViewProj[3][0]);
+			glm::vec4 vRow1(p_mViewProj[0][1], p_mViewProj[1][1], p_mViewProj[2][1], p_mViewProj[3][1]);
+			glm::vec4 vRow2(p_mViewProj[0][2], p_mViewProj[1][2], p_mViewProj[2][2], p_mViewProj[3][2]);
+			glm::vec4 vRow3(p_mViewProj[0][3], p_mViewProj[1][3], p_mViewProj[2][3], p_mViewProj[3][3]);
+
+			m_avPlanes[0] = vRow3 + vRow0;	// Left
+			m_avPlanes[1] = vRow3 - vRow0;	// Right
+			m_avPlanes[2] = vRow3 + vRow1;	// Bottom
+			m_avPlanes[3] = vRow3 - vRow1;	// Top
+			m_avPlanes[4] = vRow3 + vRow2;	// Near
+			m_avPlanes[5] = vRow3 - vRow2;	// Far
+
+			for (int i = 0; i < 6; ++i)
+			{
+				m_avPlanes[i] /= glm::length(glm::vec3(m_avPlanes[i]));
+			}
+		}
+
+		//------------------------------------------------------------------------------
+		// Returns false if the box is completely outside the frustum. Boxes near the
+		// corners can pass without being visible, which is fine for culling.
+		//------------------------------------------------------------------------------
+		bool Intersects(const AABB& p_AABB) const
+		{
+			for (int i = 0; i < 6; ++i)
+			{
+				// Corner of the box furthest along the plane normal
+				const glm::vec4& vPlane = m_avPlanes[i];
+				glm::vec3 vCorner(vPlane.x >= 0.0f ? p_AABB.m_vMax.x : p_AABB.m_vMin.x,
+								  vPlane.y >= 0.0f ? p_AABB.m_vMax.y : p_AABB.m_vMin.y,
+								  vPlane.z >= 0.0f ? p_AABB.m_vMax.z : p_AABB.m_vMin.z);
+
+				if (glm::dot(glm::vec3(vPlane), vCorner) + vPlane.w < 0.0f)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+	private:
+		glm::vec4 m_avPlanes[6];
+	};
+
+} // namespace Common
+
+#endif // FRUSTUM_H
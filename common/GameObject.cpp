@@ -11,13 +11,9 @@
 //------------------------------------------------------------------------
 
 #include "GameObject.h"
-#include <sstream>
 
 using namespace Common;
 
-// Static game object counter
-unsigned int GameObject::s_uiGameObjectCount = 0;
-
 //------------------------------------------------------------------------------
 // Method:    GameObject
 // Parameter: GameObjectManager * p_pGameObjectManager
@@ -27,15 +23,13 @@ unsigned int GameObject::s_uiGameObjectCount = 0;
 //------------------------------------------------------------------------------
 GameObject::GameObject(GameObjectManager* p_pGameObjectManager)
 	:
-	m_pGameObjectManager(p_pGameObjectManager)
+	m_pGameObjectManager(p_pGameObjectManager),
+	m_hHandle(INVALID_GAMEOBJECT_HANDLE),
+	m_uiListIndex(0),
+	m_bMarkedForRemoval(false)
 {
-	// Increment count of all GOs ever created on this machine
-	++s_uiGameObjectCount;
-
-	// Create a unique (per this application instance) guid
-	std::ostringstream ss;
-	ss << "GameObject_" << s_uiGameObjectCount;
-	m_strGUID = ss.str();
+	// Identity comes from the handle assigned by the GameObjectManager; a GUID
+	// (name) is only built if someone asks for one with SetGameObjectGUID().
 }
 
 //------------------------------------------------------------------------------
@@ -49,6 +43,24 @@ GameObject::~GameObject()
 	this->DeleteAllComponents();
 }
 
+//------------------------------------------------------------------------------
+// Method:    Reset
+// Returns:   void
+// 
+// Deletes all components and clears the GUID, transform and handle so the 
+// GameObject can be handed out again by the GameObjectManager. The component 
+// list keeps its capacity.
+//------------------------------------------------------------------------------
+void GameObject::Reset()
+{
+	this->DeleteAllComponents();
+	m_strGUID.clear();
+	m_Transform = Transform();
+	m_hHandle = INVALID_GAMEOBJECT_HANDLE;
+	m_uiListIndex = 0;
+	m_bMarkedForRemoval = false;
+}
+
 //------------------------------------------------------------------------------
 // Method:    AddComponent
 // Parameter: BaseComponent * p_pComponent
@@ -60,10 +72,16 @@ GameObject::~GameObject()
 bool GameObject::AddComponent(ComponentBase* p_pComponent)
 {
 	// Make sure we don't already have a component of this type
-	if (m_mComponentMap.find(p_pComponent->FamilyID()) == m_mComponentMap.end())
+	unsigned int uiFamily = p_pComponent->GetFamilyIndex();
+	if (this->GetComponent(uiFamily) == NULL)
 	{
-		m_mComponentMap.insert(std::make_pair<std::string, ComponentBase*>(p_pComponent->FamilyID(), p_pComponent));
+		if (uiFamily >= m_lComponents.size())
+		{
+			m_lComponents.resize(uiFamily + 1, NULL);
+		}
+		m_lComponents[uiFamily] = p_pComponent;
 		p_pComponent->SetGameObject(this);
+		m_pGameObjectManager->AddToComponentPool(p_pComponent);
 
 		return true;
 	}
@@ -78,17 +96,11 @@ bool GameObject::AddComponent(ComponentBase* p_pComponent)
 // Returns:   BaseComponent*
 // 
 // Get a component with the given family Id. Returns NULL if it isn't found.
+// Prefer GetComponent<T>() in per-frame code; this has to look the name up.
 //------------------------------------------------------------------------------
 ComponentBase* GameObject::GetComponent(const std::string &p_strFamilyId)
 {
-	ComponentMap::iterator it = m_mComponentMap.find(p_strFamilyId);
-	if (it != m_mComponentMap.end())
-	{
-		return (ComponentBase*)it->second;
-	}
-
-	// Don't have it.
-	return NULL;
+	return this->GetComponent(ComponentBase::FindFamily(p_strFamilyId));
 }
 
 //------------------------------------------------------------------------------
@@ -101,13 +113,12 @@ ComponentBase* GameObject::GetComponent(const std::string &p_strFamilyId)
 //------------------------------------------------------------------------------
 ComponentBase* GameObject::RemoveComponent(const std::string &p_strFamilyId)
 {
-	ComponentBase* pComponent = NULL;
-
-	ComponentMap::iterator it = m_mComponentMap.find(p_strFamilyId);
-	if (it != m_mComponentMap.end())
+	unsigned int uiFamily = ComponentBase::FindFamily(p_strFamilyId);
+	ComponentBase* pComponent = this->GetComponent(uiFamily);
+	if (pComponent)
 	{
-		pComponent = (ComponentBase*)it->second;
-		m_mComponentMap.erase(it);
+		m_lComponents[uiFamily] = NULL;
+		m_pGameObjectManager->RemoveFromComponentPool(pComponent);
 	}
 
 	return pComponent;
@@ -121,13 +132,17 @@ ComponentBase* GameObject::RemoveComponent(const std::string &p_strFamilyId)
 //------------------------------------------------------------------------------
 void GameObject::DeleteAllComponents()
 {
-	ComponentMap::iterator it = m_mComponentMap.begin(), end = m_mComponentMap.end();
+	ComponentList::iterator it = m_lComponents.begin(), end = m_lComponents.end();
 	for (; it != end; ++it)
 	{
-		ComponentBase* pComponent = (ComponentBase*)it->second;
-		delete pComponent;
+		ComponentBase* pComponent = *it;
+		if (pComponent)
+		{
+			m_pGameObjectManager->RemoveFromComponentPool(pComponent);
+			delete pComponent;
+		}
 	}
-	m_mComponentMap.clear();
+	m_lComponents.clear();
 }
 
 //------------------------------------------------------------------------------
@@ -139,11 +154,13 @@ void GameObject::DeleteAllComponents()
 //------------------------------------------------------------------------------
 void GameObject::Update(float p_fDelta)
 {
-	ComponentMap::iterator it = m_mComponentMap.begin(), end = m_mComponentMap.end();
-	for (; it != end; ++it)
+	for (unsigned int i = 0; i < m_lComponents.size(); ++i)
 	{
-		ComponentBase* pComponent = (ComponentBase*)it->second;
-		pComponent->Update(p_fDelta);
+		ComponentBase* pComponent = m_lComponents[i];
+		if (pComponent)
+		{
+			pComponent->Update(p_fDelta);
+		}
 	}
 }
 
@@ -14,18 +14,19 @@
 #define GAMEOBJECT_H
 
 #include "ComponentBase.h"
+#include "GameObjectHandle.h"
 #include "GameObjectManager.h"
 #include "LuaScriptManager.h"
 #include "Transform.h"
 
-#include <map>
+#include <vector>
 
 namespace Common
 {
 	class GameObject
 	{
-		// Typedef for convenience
-		typedef std::map<std::string, ComponentBase*> ComponentMap;
+		// Typedef for convenience; indexed by component family index
+		typedef std::vector<ComponentBase*> ComponentList;
 
 		// Only GameObjectManager can create instances (private constructor/destructor)
 		friend class GameObjectManager;
@@ -35,12 +36,27 @@ namespace Common
 		// Public methods.
 		//------------------------------------------------------------------------------
 		const std::string& GetGUID()	{ return m_strGUID; }
+		GameObjectHandle GetHandle()	{ return m_hHandle; }
+		bool IsMarkedForRemoval()		{ return m_bMarkedForRemoval; }
 		Transform& GetTransform()		{ return m_Transform; }
 		GameObjectManager* GetManager() { return m_pGameObjectManager; }
 
 		bool AddComponent(ComponentBase* p_pComponent);
 		ComponentBase* GetComponent(const std::string &p_strFamilyId);
 		ComponentBase* RemoveComponent(const std::string &p_strFamilyId);
+
+		// Lookup by interned family index; O(1)
+		ComponentBase* GetComponent(unsigned int p_uiFamilyIndex)
+		{
+			return (p_uiFamilyIndex < m_lComponents.size()) ? m_lComponents[p_uiFamilyIndex] : NULL;
+		}
+
+		// Typed lookup, T must declare (or inherit) its family with DECLARE_COMPONENT_FAMILY
+		template<class T>
+		T* GetComponent()
+		{
+			return static_cast<T*>(GetComponent(T::FamilyIndex()));
+		}
 		void DeleteAllComponents();
 
 		virtual void Update(float p_fDelta);
@@ -62,6 +78,12 @@ namespace Common
 		// Only GameObjectManager can set new GUID as it maintains the mapping of GUID -> GO
 		void SetGUID(const std::string& p_strGUID) { m_strGUID = p_strGUID; }
 
+		// Only GameObjectManager hands out handles as it owns the slots they refer to
+		void SetHandle(GameObjectHandle p_hHandle) { m_hHandle = p_hHandle; }
+
+		// Returns the GameObject to a blank state so the GameObjectManager can reuse it
+		void Reset();
+
 	private:
 		//------------------------------------------------------------------------------
 		// Private members.
@@ -70,17 +92,23 @@ namespace Common
 		// A pointer back to the GameObjectManager that created us
 		GameObjectManager* m_pGameObjectManager;
 
-		// Running tally for all game objects created
-		static unsigned int s_uiGameObjectCount;
+		// Handle to this GameObject in the GameObjectManager
+		GameObjectHandle m_hHandle;
+
+		// Index in the GameObjectManager's list of live GameObjects
+		unsigned int m_uiListIndex;
+
+		// Set when the GameObject is queued for destruction at the start of next update
+		bool m_bMarkedForRemoval;
 
-		// GUID
+		// GUID; this is an optional name (empty unless one is set through the manager)
 		std::string m_strGUID;
 
 		// All entities have a transform
 		Transform m_Transform;
 
-		// List of components
-		ComponentMap m_mComponentMap;
+		// Components, one slot per family index (NULL if we don't have that family)
+		ComponentList m_lComponents;
 	};
 }
 
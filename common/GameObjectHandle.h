@@ -0,0 +1,45 @@
+//------------------------------------------------------------------------
+// GameObjectHandle
+//
+// Created:	2026/10/17
+// Author:	agent
+//
+// Generational handle used to refer to a GameObject owned by a
+// GameObjectManager. The low bits hold the slot index of the GameObject and
+// the high bits the generation of that slot. When a GameObject is destroyed
+// its slot generation is bumped, so any handle still pointing at it resolves
+// to NULL instead of a dangling pointer (or whatever reused the slot).
+//------------------------------------------------------------------------
+
+#ifndef GAMEOBJECTHANDLE_H
+#define GAMEOBJECTHANDLE_H
+
+namespace Common
+{
+	typedef unsigned int GameObjectHandle;
+
+	// Layout of a handle: 20 bits of slot index, 12 bits of generation
+	static const unsigned int GAMEOBJECT_HANDLE_INDEX_BITS = 20;
+	static const unsigned int GAMEOBJECT_HANDLE_INDEX_MASK = (1 << GAMEOBJECT_HANDLE_INDEX_BITS) - 1;
+	static const unsigned int GAMEOBJECT_HANDLE_GENERATION_MASK = 0xFFF;
+
+	// Generations start at 1 so that 0 is never a valid handle
+	static const GameObjectHandle INVALID_GAMEOBJECT_HANDLE = 0;
+
+	inline GameObjectHandle MakeGameObjectHandle(unsigned int p_uiIndex, unsigned int p_uiGeneration)
+	{
+		return (p_uiGeneration << GAMEOBJECT_HANDLE_INDEX_BITS) | (p_uiIndex & GAMEOBJECT_HANDLE_INDEX_MASK);
+	}
+
+	inline unsigned int GetGameObjectHandleIndex(GameObjectHandle p_hHandle)
+	{
+		return p_hHandle & GAMEOBJECT_HANDLE_INDEX_MASK;
+	}
+
+	inline unsigned int GetGameObjectHandleGeneration(GameObjectHandle p_hHandle)
+	{
+		return (p_hHandle >> GAMEOBJECT_HANDLE_INDEX_BITS) & GAMEOBJECT_HANDLE_GENERATION_MASK;
+	}
+} // namespace Common
+
+#endif // GAMEOBJECTHANDLE_H
@@ -23,6 +23,10 @@ using namespace Common;
 // Constructor.
 //------------------------------------------------------------------------------
 GameObjectManager::GameObjectManager()
+	:
+	m_eUpdateMode(eUpdateMode_PerFamily),
+	m_bUpdatingPools(false),
+	m_bPoolsDirty(false)
 {
 }
 
@@ -34,7 +38,14 @@ GameObjectManager::GameObjectManager()
 //------------------------------------------------------------------------------
 GameObjectManager::~GameObjectManager()
 {
-	assert(m_mGOMap.size() == 0);
+	assert(m_lGameObjects.size() == 0);
+
+	GameObjectList::iterator it = m_lGameObjectPool.begin(), end = m_lGameObjectPool.end();
+	for (; it != end; ++it)
+	{
+		delete *it;
+	}
+	m_lGameObjectPool.clear();
 }
 
 //------------------------------------------------------------------------------
@@ -45,30 +56,102 @@ GameObjectManager::~GameObjectManager()
 //------------------------------------------------------------------------------
 GameObject* GameObjectManager::CreateGameObject()
 {
-	GameObject* pGO = new GameObject(this);
-	m_mGOMap.insert(std::make_pair<std::string, GameObject*>(pGO->GetGUID(), pGO));
+	GameObject* pGO = this->AllocateGameObject();
+	this->AddGameObject(pGO);
 	return pGO;
 }
 
+//------------------------------------------------------------------------------
+// Method:    AllocateGameObject
+// Returns:   GameObject*
+// 
+// Returns a blank GameObject, recycled from the pool of destroyed GameObjects 
+// when possible.
+//------------------------------------------------------------------------------
+GameObject* GameObjectManager::AllocateGameObject()
+{
+	if (!m_lGameObjectPool.empty())
+	{
+		GameObject* pGO = m_lGameObjectPool.back();
+		m_lGameObjectPool.pop_back();
+		return pGO;
+	}
+
+	return new GameObject(this);
+}
+
+//------------------------------------------------------------------------------
+// Method:    AddGameObject
+// Parameter: GameObject * p_pGameObject
+// Returns:   void
+// 
+// Assigns a handle to a newly created GameObject, reusing a free slot if there
+// is one, and adds it to the list of live GameObjects.
+//------------------------------------------------------------------------------
+void GameObjectManager::AddGameObject(GameObject* p_pGameObject)
+{
+	unsigned int uiIndex;
+	if (!m_lFreeSlots.empty())
+	{
+		uiIndex = m_lFreeSlots.back();
+		m_lFreeSlots.pop_back();
+	}
+	else
+	{
+		GameObjectSlot slot;
+		slot.m_pGameObject = NULL;
+		slot.m_uiGeneration = 1;
+		uiIndex = m_lSlots.size();
+		assert(uiIndex <= GAMEOBJECT_HANDLE_INDEX_MASK);
+		m_lSlots.push_back(slot);
+	}
+
+	GameObjectSlot& slot = m_lSlots[uiIndex];
+	slot.m_pGameObject = p_pGameObject;
+	p_pGameObject->SetHandle(MakeGameObjectHandle(uiIndex, slot.m_uiGeneration));
+
+	p_pGameObject->m_uiListIndex = m_lGameObjects.size();
+	m_lGameObjects.push_back(p_pGameObject);
+}
+
 //------------------------------------------------------------------------------
 // Method:    DestroyGameObject
 // Parameter: GameObject * p_pGameObject
 // Returns:   void
 // 
 // Destroys the given Game Object and removes it from internal map of all Game
-// Objects.
+// Objects. Its slot is released and the slot generation bumped so outstanding
+// handles to it go stale. The GameObject itself is reset and pooled for reuse.
 //------------------------------------------------------------------------------
 void GameObjectManager::DestroyGameObject(GameObject* p_pGameObject)
 {
-	GameObject* pGO = NULL;
-	GameObjectMap::iterator it = m_mGOMap.find(p_pGameObject->GetGUID());
-	if (it != m_mGOMap.end())
+	if (this->GetGameObject(p_pGameObject->GetHandle()) != p_pGameObject)
 	{
-		pGO = (GameObject*)it->second;
-		delete pGO;
-		pGO = NULL;
-		m_mGOMap.erase(it);
+		// Not one of ours (or already destroyed)
+		return;
+	}
+
+	// Release the slot
+	unsigned int uiIndex = GetGameObjectHandleIndex(p_pGameObject->GetHandle());
+	GameObjectSlot& slot = m_lSlots[uiIndex];
+	slot.m_pGameObject = NULL;
+	slot.m_uiGeneration = (slot.m_uiGeneration % GAMEOBJECT_HANDLE_GENERATION_MASK) + 1;
+	m_lFreeSlots.push_back(uiIndex);
+
+	// Swap the last live GameObject into this one's place
+	GameObject* pLast = m_lGameObjects.back();
+	m_lGameObjects[p_pGameObject->m_uiListIndex] = pLast;
+	pLast->m_uiListIndex = p_pGameObject->m_uiListIndex;
+	m_lGameObjects.pop_back();
+
+	// Drop the name mapping, if it has one
+	if (!p_pGameObject->GetGUID().empty())
+	{
+		m_mGOMap.erase(p_pGameObject->GetGUID());
 	}
+
+	p_pGameObject->Reset();
+	m_lGameObjectPool.push_back(p_pGameObject);
 }
 
 //------------------------------------------------------------------------------
@@ -79,14 +162,12 @@ void GameObjectManager::DestroyGameObject(GameObject* p_pGameObject)
 //------------------------------------------------------------------------------
 void GameObjectManager::DestroyAllGameObjects()
 {
-	GameObject* pGO = NULL;
-	GameObjectMap::iterator it = m_mGOMap.begin(), end = m_mGOMap.end();
-	for (; it != end; ++it)
+	while (!m_lGameObjects.empty())
 	{
-		pGO = (GameObject*)it->second;
-		delete pGO;
+		this->DestroyGameObject(m_lGameObjects.back());
 	}
-	m_mGOMap.clear();
+	m_lRemoveGOList.clear();
+	assert(m_mGOMap.size() == 0);
 }
 
 //------------------------------------------------------------------------------
@@ -95,7 +176,7 @@ void GameObjectManager::DestroyAllGameObjects()
 // Returns:   GameObject*
 // 
 // Returns a GameObject mapped to by the given GUID. Returns NULL if no GO is 
-// found.
+// found. Prefer holding on to a handle for anything looked up every frame.
 //------------------------------------------------------------------------------
 GameObject* GameObjectManager::GetGameObject(const std::string &p_strGOGUID)
 {
@@ -109,6 +190,65 @@ GameObject* GameObjectManager::GetGameObject(const std::string &p_strGOGUID)
 	return pGO;
 }
 
+//------------------------------------------------------------------------------
+// Method:    GetGameObject
+// Parameter: GameObjectHandle p_hGameObject
+// Returns:   GameObject*
+// 
+// Returns the GameObject the given handle refers to. Returns NULL if the handle
+// is invalid or the GameObject has since been destroyed.
+//------------------------------------------------------------------------------
+GameObject* GameObjectManager::GetGameObject(GameObjectHandle p_hGameObject)
+{
+	unsigned int uiIndex = GetGameObjectHandleIndex(p_hGameObject);
+	if (uiIndex < m_lSlots.size())
+	{
+		const GameObjectSlot& slot = m_lSlots[uiIndex];
+		if (slot.m_uiGeneration == GetGameObjectHandleGeneration(p_hGameObject))
+		{
+			return slot.m_pGameObject;
+		}
+	}
+
+	return NULL;
+}
+
+//------------------------------------------------------------------------------
+// Method:    GetGameObjectHandle
+// Parameter: const std::string & p_strGOGUID
+// Returns:   GameObjectHandle
+// 
+// Returns the handle of the GameObject with the given GUID, or 
+// INVALID_GAMEOBJECT_HANDLE if there isn't one.
+//------------------------------------------------------------------------------
+GameObjectHandle GameObjectManager::GetGameObjectHandle(const std::string &p_strGOGUID)
+{
+	GameObject* pGO = this->GetGameObject(p_strGOGUID);
+	return pGO ? pGO->GetHandle() : INVALID_GAMEOBJECT_HANDLE;
+}
+
+//------------------------------------------------------------------------------
+// Method:    ResolveGameObject
+// Parameter: GameObjectHandle & p_hGameObject
+// Parameter: const char * p_szGOGUID
+// Returns:   GameObject*
+// 
+// Resolves a cached handle. If the handle is invalid or stale it is refreshed
+// from the GUID index, so callers only pay for the name lookup when the 
+// GameObject they track has been (re)created.
+//------------------------------------------------------------------------------
+GameObject* GameObjectManager::ResolveGameObject(GameObjectHandle &p_hGameObject, const char* p_szGOGUID)
+{
+	GameObject* pGO = this->GetGameObject(p_hGameObject);
+	if (pGO == NULL)
+	{
+		pGO = this->GetGameObject(std::string(p_szGOGUID));
+		p_hGameObject = pGO ? pGO->GetHandle() : INVALID_GAMEOBJECT_HANDLE;
+	}
+
+	return pGO;
+}
+
 //------------------------------------------------------------------------------
 // Method:    SetGameObjectGUID
 // Parameter: GameObject * p_pGameObject
@@ -127,17 +267,22 @@ bool GameObjectManager::SetGameObjectGUID(GameObject* p_pGameObject, const std::
 		return false;
 	}
 
-	GameObjectMap::iterator it = m_mGOMap.find(p_pGameObject->GetGUID());
-	if (it == m_mGOMap.end())
+	if (this->GetGameObject(p_pGameObject->GetHandle()) != p_pGameObject)
 	{
 		// No mapping - Game Object wasn't created from this GameObjectManager instance
 		return false;
 	}
 
-	// Erase the old mapping, update the GUID and add it back
-	m_mGOMap.erase(it);
+	// Erase the old mapping (if it was named), update the GUID and add it back
+	if (!p_pGameObject->GetGUID().empty())
+	{
+		m_mGOMap.erase(p_pGameObject->GetGUID());
+	}
 	p_pGameObject->SetGUID(p_strGOGUID);
-	m_mGOMap.insert(std::make_pair<std::string, GameObject*>(p_pGameObject->GetGUID(), p_pGameObject));
+	if (!p_strGOGUID.empty())
+	{
+		m_mGOMap.insert(std::make_pair<std::string, GameObject*>(p_pGameObject->GetGUID(), p_pGameObject));
+	}
 	return true;
 }
 
@@ -166,8 +311,8 @@ GameObject* GameObjectManager::CreateGameObject(const std::string& p_strGameObje
 	}
 
 	// Create the game object
-	GameObject* pGO = new GameObject(this);
-	m_mGOMap.insert(std::make_pair<std::string, GameObject*>(pGO->GetGUID(), pGO));
+	GameObject* pGO = this->AllocateGameObject();
+	this->AddGameObject(pGO);
 
 	// Iterate components in the XML and delegate to factory methods to construct components
 	TiXmlNode* pComponentNode = pNode->FirstChild();
@@ -220,23 +365,172 @@ void GameObjectManager::RegisterComponentFactory(const std::string& p_strCompone
 //------------------------------------------------------------------------------
 void GameObjectManager::Update(float p_fDelta)
 {
-	while (m_lRemoveGOList.size()>0)
+	this->DestroyRemovedObjects();
+
+	if (m_eUpdateMode == eUpdateMode_PerFamily)
 	{
-		GameObject *pRemoveObject = m_lRemoveGOList.at(0);
-		m_lRemoveGOList.erase(m_lRemoveGOList.begin());
-		if (pRemoveObject)
-			this->DestroyGameObject(pRemoveObject);
+		this->UpdateComponentPools(p_fDelta);
 	}
-	
+	else
+	{
+		// Index rather than iterator; GameObjects may be created during the update
+		for (unsigned int i = 0; i < m_lGameObjects.size(); ++i)
+		{
+			m_lGameObjects[i]->Update(p_fDelta);
+		}
+	}
+	CheckCollision();
+}
 
-	GameObject* pGO = NULL;
-	GameObjectMap::iterator it = m_mGOMap.begin(), end = m_mGOMap.end();
+//------------------------------------------------------------------------------
+// Method:    GetComponentPool
+// Parameter: const std::string & p_strFamilyId
+// Returns:   const ComponentList*
+// 
+// Returns the contiguous list of all components of the given family, or NULL
+// if no component of that family has been added yet. Slots may be NULL while
+// an update is in progress.
+//------------------------------------------------------------------------------
+const GameObjectManager::ComponentList* GameObjectManager::GetComponentPool(const std::string &p_strFamilyId)
+{
+	return this->GetComponentPool(ComponentBase::FindFamily(p_strFamilyId));
+}
+
+//------------------------------------------------------------------------------
+// Method:    GetComponentPool
+// Parameter: unsigned int p_uiFamilyIndex
+// Returns:   const ComponentList*
+// 
+// Returns the contiguous list of all components of the given family index, or
+// NULL if no component of that family has been added yet.
+//------------------------------------------------------------------------------
+const GameObjectManager::ComponentList* GameObjectManager::GetComponentPool(unsigned int p_uiFamilyIndex)
+{
+	if (p_uiFamilyIndex < m_lComponentPools.size())
+	{
+		return &m_lComponentPools[p_uiFamilyIndex];
+	}
+	return NULL;
+}
+
+//------------------------------------------------------------------------------
+// Method:    AddToComponentPool
+// Parameter: ComponentBase * p_pComponent
+// Returns:   void
+// 
+// Appends the component to the pool for its family. Called by GameObject when
+// a component is added to it.
+//------------------------------------------------------------------------------
+void GameObjectManager::AddToComponentPool(ComponentBase* p_pComponent)
+{
+	assert(p_pComponent->m_uiPoolIndex == ComponentBase::s_uiInvalidPoolIndex);
+
+	unsigned int uiFamily = p_pComponent->GetFamilyIndex();
+	if (uiFamily >= m_lComponentPools.size())
+	{
+		m_lComponentPools.resize(uiFamily + 1);
+	}
+
+	ComponentList& lPool = m_lComponentPools[uiFamily];
+	p_pComponent->m_uiPoolIndex = lPool.size();
+	lPool.push_back(p_pComponent);
+}
+
+//------------------------------------------------------------------------------
+// Method:    RemoveFromComponentPool
+// Parameter: ComponentBase * p_pComponent
+// Returns:   void
+// 
+// Removes the component from the pool for its family by swapping the last 
+// element into its slot. While the pools are being updated the slot is only
+// cleared and the pools are compacted once the update is finished.
+//------------------------------------------------------------------------------
+void GameObjectManager::RemoveFromComponentPool(ComponentBase* p_pComponent)
+{
+	unsigned int uiIndex = p_pComponent->m_uiPoolIndex;
+	if (uiIndex == ComponentBase::s_uiInvalidPoolIndex)
+	{
+		return;
+	}
+
+	ComponentList& lPool = m_lComponentPools[p_pComponent->GetFamilyIndex()];
+	assert(uiIndex < lPool.size() && lPool[uiIndex] == p_pComponent);
+
+	p_pComponent->m_uiPoolIndex = ComponentBase::s_uiInvalidPoolIndex;
+
+	if (m_bUpdatingPools)
+	{
+		lPool[uiIndex] = NULL;
+		m_bPoolsDirty = true;
+		return;
+	}
+
+	ComponentBase* pLast = lPool.back();
+	lPool[uiIndex] = pLast;
+	pLast->m_uiPoolIndex = uiIndex;
+	lPool.pop_back();
+}
+
+//------------------------------------------------------------------------------
+// Method:    UpdateComponentPools
+// Parameter: float p_fDelta
+// Returns:   void
+// 
+// Updates every component family by family. Components created during the 
+// update are appended to their pool and get updated in the same pass.
+//------------------------------------------------------------------------------
+void GameObjectManager::UpdateComponentPools(float p_fDelta)
+{
+	m_bUpdatingPools = true;
+
+	// Indices rather than iterators or references; new families and components
+	// may be added (and the vectors reallocated) while we walk them
+	for (unsigned int uiFamily = 0; uiFamily < m_lComponentPools.size(); ++uiFamily)
+	{
+		for (unsigned int i = 0; i < m_lComponentPools[uiFamily].size(); ++i)
+		{
+			ComponentBase* pComponent = m_lComponentPools[uiFamily][i];
+			if (pComponent)
+			{
+				pComponent->Update(p_fDelta);
+			}
+		}
+	}
+
+	m_bUpdatingPools = false;
+
+	if (m_bPoolsDirty)
+	{
+		this->CompactComponentPools();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Method:    CompactComponentPools
+// Returns:   void
+// 
+// Squeezes out the slots cleared during an update and fixes up the pool 
+// indices of the components that moved.
+//------------------------------------------------------------------------------
+void GameObjectManager::CompactComponentPools()
+{
+	ComponentPoolList::iterator it = m_lComponentPools.begin(), end = m_lComponentPools.end();
 	for (; it != end; ++it)
 	{
-		pGO = (GameObject*)it->second;
-		pGO->Update(p_fDelta);
+		ComponentList& lPool = *it;
+		unsigned int uiCount = 0;
+		for (unsigned int i = 0; i < lPool.size(); ++i)
+		{
+			ComponentBase* pComponent = lPool[i];
+			if (pComponent)
+			{
+				pComponent->m_uiPoolIndex = uiCount;
+				lPool[uiCount++] = pComponent;
+			}
+		}
+		lPool.resize(uiCount);
 	}
-	CheckCollision();
+	m_bPoolsDirty = false;
 }
 
 //------------------------------------------------------------------------------
@@ -249,23 +543,21 @@ void GameObjectManager::Update(float p_fDelta)
 void GameObjectManager::SyncTransforms()
 {
 	GameObject* pGO = NULL;
-	GameObjectMap::iterator it = m_mGOMap.begin(), end = m_mGOMap.end();
+	GameObjectList::iterator it = m_lGameObjects.begin(), end = m_lGameObjects.end();
 	for (; it != end; ++it)
 	{
-		pGO = (GameObject*)it->second;
+		pGO = *it;
 	
 		// If this GO has a Renderable component, sync it's transform from the parent GO
-		Common::ComponentBase* pComponent = pGO->GetComponent("GOC_Renderable");
-		if (pComponent)
+		ComponentRenderable* pRenderable = pGO->GetComponent<ComponentRenderable>();
+		if (pRenderable)
 		{
-			ComponentRenderable* pRenderable = static_cast<ComponentRenderable*>(pComponent);
 			pRenderable->SyncTransform();
 		}
 
-		pComponent = pGO->GetComponent("GOC_PointLight");
-		if (pComponent)
+		ComponentPointLight* pPointLight = pGO->GetComponent<ComponentPointLight>();
+		if (pPointLight)
 		{
-			ComponentPointLight* pPointLight = static_cast<ComponentPointLight*>(pComponent);
 			pPointLight->SyncTransform();
 		}
 	}
@@ -352,25 +644,56 @@ LuaPlus::LuaObject GameObjectManager::LuaCreateGameObjectXML(const char* p_strPa
 }
 
 
+//------------------------------------------------------------------------------
+// Method:    AddRemovedObject
+// Parameter: GameObject * p_pObject
+// Returns:   void
+// 
+// Marks the GameObject for removal; it is destroyed at the start of the next
+// Update(). Marking an already marked GameObject does nothing.
+//------------------------------------------------------------------------------
 void GameObjectManager::AddRemovedObject(GameObject *p_pObject)
 {
-	m_lRemoveGOList.push_back(p_pObject);
-	
+	if (p_pObject->IsMarkedForRemoval())
+	{
+		return;
+	}
+
+	p_pObject->m_bMarkedForRemoval = true;
+	m_lRemoveGOList.push_back(p_pObject->GetHandle());
 }
 
+//------------------------------------------------------------------------------
+// Method:    CheckRemoveObject
+// Parameter: GameObject * p_pObject
+// Returns:   bool
+// 
+// Returns true if the GameObject is already marked for removal.
+//------------------------------------------------------------------------------
 bool GameObjectManager::CheckRemoveObject(GameObject *p_pObject)
 {
-	bool ret = false;
-	for (int i=0;i<m_lRemoveGOList.size();i++)
+	return p_pObject->IsMarkedForRemoval();
+}
+
+//------------------------------------------------------------------------------
+// Method:    DestroyRemovedObjects
+// Returns:   void
+// 
+// Destroys every GameObject marked for removal in a single pass. Handles that
+// went stale in the meantime (GameObject destroyed directly) are skipped.
+//------------------------------------------------------------------------------
+void GameObjectManager::DestroyRemovedObjects()
+{
+	// Index rather than iterator; destroying components may mark more GameObjects
+	for (unsigned int i = 0; i < m_lRemoveGOList.size(); ++i)
 	{
-		GameObject* pGO = m_lRemoveGOList.at(i);
-		if (pGO == p_pObject)
+		GameObject* pGO = this->GetGameObject(m_lRemoveGOList[i]);
+		if (pGO)
 		{
-			ret = true;
-			break;
+			this->DestroyGameObject(pGO);
 		}
 	}
-	return ret;
+	m_lRemoveGOList.clear();
 }
 
 void GameObjectManager::CheckCollision()
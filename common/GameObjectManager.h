@@ -11,6 +11,7 @@
 #define GAMEOBJECTMANAGER_H
 
 #include "GameObject.h"
+#include "GameObjectHandle.h"
 #include "LuaScriptManager.h"
 #include <map>
 #include <vector>
@@ -20,11 +21,37 @@ namespace Common
 {
 	class GameObjectManager
 	{
+		// GameObjects register/unregister their components with the family pools
+		friend class GameObject;
+
 	public:
 		// Typedef for convenience
 		typedef std::map<std::string, GameObject*> GameObjectMap;
 		typedef std::vector<GameObject*> GameObjectList;	
 
+		// A slot in the handle table. The generation is bumped every time the 
+		// GameObject in the slot is destroyed, invalidating outstanding handles.
+		struct GameObjectSlot
+		{
+			GameObject*		m_pGameObject;
+			unsigned int	m_uiGeneration;
+		};
+		typedef std::vector<GameObjectSlot> GameObjectSlotList;
+		typedef std::vector<unsigned int> FreeSlotList;
+		typedef std::vector<GameObjectHandle> GameObjectHandleList;
+
+		// Components of one family are kept together in a contiguous list so they
+		// can be updated in a tight loop rather than by walking each GameObject.
+		typedef std::vector<ComponentBase*> ComponentList;
+		typedef std::vector<ComponentList> ComponentPoolList;	// Indexed by family index
+
+		// How Update() walks the components
+		enum UpdateMode
+		{
+			eUpdateMode_PerObject = 0,		// GameObject by GameObject (original behaviour)
+			eUpdateMode_PerFamily			// Family pool by family pool
+		};
+
 		typedef ComponentBase*(*ComponentFactoryMethod)(TiXmlNode* p_pNode);
 		typedef std::map<std::string, ComponentFactoryMethod> ComponentFactoryMap;
 
@@ -40,6 +67,11 @@ namespace Common
 		GameObject* GetGameObject(const std::string &p_strGOGUID);
 		bool SetGameObjectGUID(GameObject* p_pGameObject, const std::string &p_strGOGUID);
 
+		// Handle based access; O(1) and returns NULL for stale handles
+		GameObject* GetGameObject(GameObjectHandle p_hGameObject);
+		GameObjectHandle GetGameObjectHandle(const std::string &p_strGOGUID);
+		GameObject* ResolveGameObject(GameObjectHandle &p_hGameObject, const char* p_szGOGUID);
+
 		// Data driven helpers
 		GameObject* CreateGameObject(const std::string& p_strGameObject);
 		void RegisterComponentFactory(const std::string& p_strComponentId, ComponentFactoryMethod);
@@ -47,9 +79,16 @@ namespace Common
 		void Update(float p_fDelta);
 		void SyncTransforms();
 
+		void SetUpdateMode(UpdateMode p_eUpdateMode)	{ m_eUpdateMode = p_eUpdateMode; }
+		UpdateMode GetUpdateMode() const				{ return m_eUpdateMode; }
+
+		// Direct access to the pool of all live components of a given family
+		const ComponentList* GetComponentPool(const std::string &p_strFamilyId);
+		const ComponentList* GetComponentPool(unsigned int p_uiFamilyIndex);
+
 		// Iterator access to allow outside traversal of GameObjects
-		GameObjectMap::iterator Begin()	{ return m_mGOMap.begin(); }
-		GameObjectMap::iterator End()	{ return m_mGOMap.end(); }
+		GameObjectList::iterator Begin()	{ return m_lGameObjects.begin(); }
+		GameObjectList::iterator End()		{ return m_lGameObjects.end(); }
 
 		// Lua bindings
 		static void ExportToLua();
@@ -57,22 +96,57 @@ namespace Common
 		LuaPlus::LuaObject LuaCreateGameObject();
 		LuaPlus::LuaObject LuaCreateGameObjectXML(const char* p_strPath);
 
+		// Deferred destruction; GameObjects are destroyed at the start of the next Update()
 		void AddRemovedObject(GameObject *p_pObject);
 		bool CheckRemoveObject(GameObject *p_pObject);
 		void CheckCollision();
 	private:
+		//---------------------------------------------------------------------
+		// Private methods
+		//---------------------------------------------------------------------
+		GameObject* AllocateGameObject();
+		void AddGameObject(GameObject* p_pGameObject);
+		void DestroyRemovedObjects();
+
+		void AddToComponentPool(ComponentBase* p_pComponent);
+		void RemoveFromComponentPool(ComponentBase* p_pComponent);
+		void UpdateComponentPools(float p_fDelta);
+		void CompactComponentPools();
+
 		//---------------------------------------------------------------------
 		// Private members
 		//---------------------------------------------------------------------
 
-		// Map of Game Objects
+		// Handle table; slot index and generation of each GameObject handle
+		GameObjectSlotList m_lSlots;
+
+		// Slots available for reuse
+		FreeSlotList m_lFreeSlots;
+
+		// All live Game Objects, packed for iteration
+		GameObjectList m_lGameObjects;
+
+		// Secondary index of named Game Objects (GUID -> GameObject)
 		GameObjectMap m_mGOMap;
 
 		// Map of Component factories
 		ComponentFactoryMap m_mComponentFactoryMap;
 
 		// list to be removed next frame
-		GameObjectList m_lRemoveGOList;
+		GameObjectHandleList m_lRemoveGOList;
+
+		// Destroyed GameObjects kept around for reuse
+		GameObjectList m_lGameObjectPool;
+
+		// Per family pools of components
+		ComponentPoolList m_lComponentPools;
+
+		// Update strategy
+		UpdateMode m_eUpdateMode;
+
+		// Set while walking the pools; removals only clear their slot until the walk is done
+		bool m_bUpdatingPools;
+		bool m_bPoolsDirty;
 	};
 } // namespace Common
 
@@ -0,0 +1,147 @@
+//------------------------------------------------------------------------
+// PoolAllocator
+//
+// Created:	2026/10/17
+// Author:	agent
+//	
+// Small block allocator backed by one free list per size class. Blocks are
+// carved out of larger pages and freed blocks go back on the free list of
+// their size class, so objects that are created and destroyed all the time
+// (components of spawned/despawned GameObjects) recycle their memory rather
+// than hitting the system allocator. Pages are never returned to the system.
+//------------------------------------------------------------------------
+
+#include "PoolAllocator.h"
+#include <cassert>
+#include <new>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+using namespace Common;
+
+// Free lists, one per size class
+PoolAllocator::FreeBlock* PoolAllocator::s_apFreeLists[PoolAllocator::s_uiNumSizeClasses] = { NULL };
+
+// The free lists aren't locked, so they belong to the first thread that uses
+// them. That's the main thread, which creates the first GameObject.
+#ifdef _WIN32
+static DWORD s_owningThread = 0;
+#else
+static pthread_t s_owningThread;
+#endif
+static bool s_bHasOwningThread = false;
+
+//------------------------------------------------------------------------------
+// Method:    IsOwningThread
+// Returns:   bool
+// 
+// Returns whether the calling thread is the one that owns the free lists, 
+// taking ownership on the first call.
+//------------------------------------------------------------------------------
+static bool IsOwningThread()
+{
+#ifdef _WIN32
+	DWORD thread = GetCurrentThreadId();
+#else
+	pthread_t thread = pthread_self();
+#endif
+
+	if (!s_bHasOwningThread)
+	{
+		s_owningThread = thread;
+		s_bHasOwningThread = true;
+		return true;
+	}
+
+#ifdef _WIN32
+	return s_owningThread == thread;
+#else
+	return pthread_equal(s_owningThread, thread) != 0;
+#endif
+}
+
+//------------------------------------------------------------------------------
+// Method:    Allocate
+// Parameter: size_t p_uiSize
+// Returns:   void*
+// 
+// Returns a block of at least the given size, popped from the free list of its
+// size class (refilled from a new page when empty). Main thread only.
+//------------------------------------------------------------------------------
+void* PoolAllocator::Allocate(size_t p_uiSize)
+{
+	assert(IsOwningThread());
+
+	if (p_uiSize == 0 || p_uiSize > s_uiMaxBlockSize)
+	{
+		return ::operator new(p_uiSize);
+	}
+
+	size_t uiSizeClass = (p_uiSize - 1) / s_uiGranularity;
+	if (s_apFreeLists[uiSizeClass] == NULL)
+	{
+		AllocatePage(uiSizeClass);
+	}
+
+	FreeBlock* pBlock = s_apFreeLists[uiSizeClass];
+	s_apFreeLists[uiSizeClass] = pBlock->m_pNext;
+	return pBlock;
+}
+
+//------------------------------------------------------------------------------
+// Method:    Free
+// Parameter: void * p_pMemory
+// Parameter: size_t p_uiSize
+// Returns:   void
+// 
+// Returns a block obtained from Allocate() with the same size to the free list
+// of its size class. Main thread only.
+//------------------------------------------------------------------------------
+void PoolAllocator::Free(void* p_pMemory, size_t p_uiSize)
+{
+	assert(IsOwningThread());
+
+	if (p_pMemory == NULL)
+	{
+		return;
+	}
+
+	if (p_uiSize == 0 || p_uiSize > s_uiMaxBlockSize)
+	{
+		::operator delete(p_pMemory);
+		return;
+	}
+
+	size_t uiSizeClass = (p_uiSize - 1) / s_uiGranularity;
+	FreeBlock* pBlock = static_cast<FreeBlock*>(p_pMemory);
+	pBlock->m_pNext = s_apFreeLists[uiSizeClass];
+	s_apFreeLists[uiSizeClass] = pBlock;
+}
+
+//------------------------------------------------------------------------------
+// Method:    AllocatePage
+// Parameter: size_t p_uiSizeClass
+// Returns:   void
+// 
+// Allocates a new page and threads all of its blocks onto the free list of the
+// given size class.
+//------------------------------------------------------------------------------
+void PoolAllocator::AllocatePage(size_t p_uiSizeClass)
+{
+	size_t uiBlockSize = (p_uiSizeClass + 1) * s_uiGranularity;
+	size_t uiNumBlocks = s_uiPageSize / uiBlockSize;
+	char* pPage = static_cast<char*>(::operator new(uiNumBlocks * uiBlockSize));
+
+	// Thread back to front so blocks are handed out in address order
+	for (size_t i = uiNumBlocks; i > 0; --i)
+	{
+		FreeBlock* pBlock = reinterpret_cast<FreeBlock*>(pPage + (i - 1) * uiBlockSize);
+		pBlock->m_pNext = s_apFreeLists[p_uiSizeClass];
+		s_apFreeLists[p_uiSizeClass] = pBlock;
+	}
+}
@@ -0,0 +1,68 @@
+//------------------------------------------------------------------------
+// PoolAllocator
+//
+// Created:	2026/10/17
+// Author:	agent
+//	
+// Small block allocator backed by one free list per size class. Blocks are
+// carved out of larger pages and freed blocks go back on the free list of
+// their size class, so objects that are created and destroyed all the time
+// (components of spawned/despawned GameObjects) recycle their memory rather
+// than hitting the system allocator. Pages are never returned to the system.
+//
+// There is no locking, so it must only be used from the main thread (asserted
+// in debug). Loader and pathfinding worker threads must not create or destroy
+// components.
+//------------------------------------------------------------------------
+
+#ifndef POOLALLOCATOR_H
+#define POOLALLOCATOR_H
+
+#include <cstddef>
+
+namespace Common
+{
+	class PoolAllocator
+	{
+	public:
+		//------------------------------------------------------------------------------
+		// Public methods.
+		//------------------------------------------------------------------------------
+		static void* Allocate(size_t p_uiSize);
+		static void Free(void* p_pMemory, size_t p_uiSize);
+
+	private:
+		//------------------------------------------------------------------------------
+		// Private types.
+		//------------------------------------------------------------------------------
+
+		// Free blocks are linked through their own memory
+		struct FreeBlock
+		{
+			FreeBlock* m_pNext;
+		};
+
+		// Size classes are multiples of the granularity; anything larger than the
+		// biggest class goes straight to the system allocator.
+		static const size_t s_uiGranularity = 16;
+		static const size_t s_uiMaxBlockSize = 1024;
+		static const size_t s_uiNumSizeClasses = s_uiMaxBlockSize / s_uiGranularity;
+		static const size_t s_uiPageSize = 16 * 1024;
+
+	private:
+		//------------------------------------------------------------------------------
+		// Private methods.
+		//------------------------------------------------------------------------------
+		static void AllocatePage(size_t p_uiSizeClass);
+
+	private:
+		//------------------------------------------------------------------------------
+		// Private members.
+		//------------------------------------------------------------------------------
+
+		// Head of the free list for each size class
+		static FreeBlock* s_apFreeLists[s_uiNumSizeClasses];
+	};
+}
+
+#endif // POOLALLOCATOR_H
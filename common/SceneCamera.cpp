@@ -28,7 +28,8 @@ SceneCamera::SceneCamera()
 	m_vTarget(glm::vec3(0.0f, 0.0f, 0.0f)),
 	m_vUp(glm::vec3(0.0f, 1.0f, 0.0f)),
 	m_bProjectionDirty(true),
-	m_bViewDirty(true)
+	m_bViewDirty(true),
+	m_bFrustumDirty(true)
 {
 }
 
@@ -55,7 +56,8 @@ SceneCamera::SceneCamera(float p_fFOV, float p_fAspectRatio, float p_fNearClip,
 	m_vTarget(p_vTarget),
 	m_vUp(p_vUp),
 	m_bProjectionDirty(true),
-	m_bViewDirty(true)	
+	m_bViewDirty(true),
+	m_bFrustumDirty(true)
 {
 }
 
@@ -79,6 +81,7 @@ SceneCamera::~SceneCamera()
 void SceneCamera::SetFOV(float p_fFOV)
 {
 	m_bProjectionDirty = true;
+	m_bFrustumDirty = true;
 	m_fFOV = p_fFOV;
 }
 
@@ -103,6 +106,7 @@ float SceneCamera::GetFOV() const
 void SceneCamera::SetAspectRatio(float p_fAspectRatio)
 {
 	m_bProjectionDirty = true;
+	m_bFrustumDirty = true;
 	m_fAspectRatio = p_fAspectRatio;
 }
 
@@ -127,6 +131,7 @@ float SceneCamera::GetAspectRatio() const
 void SceneCamera::SetNearClip(float p_fNearClip)
 {
 	m_bProjectionDirty = true;
+	m_bFrustumDirty = true;
 	m_fNearClip = p_fNearClip;
 }
 
@@ -151,6 +156,7 @@ float SceneCamera::GetNearClip() const
 void SceneCamera::SetFarClip(float p_fFarClip)
 {
 	m_bProjectionDirty = true;
+	m_bFrustumDirty = true;
 	m_fFarClip = p_fFarClip;
 }
 
@@ -175,6 +181,7 @@ float SceneCamera::GetFarClip() const
 void SceneCamera::SetPos(const glm::vec3 &p_vPos)
 {
 	m_bViewDirty = true;
+	m_bFrustumDirty = true;
 	m_vPos = p_vPos;
 }
 
@@ -199,6 +206,7 @@ const glm::vec3& SceneCamera::GetPos() const
 void SceneCamera::SetTarget(const glm::vec3& p_vTarget)
 {
 	m_bViewDirty = true;
+	m_bFrustumDirty = true;
 	m_vTarget = p_vTarget;
 }
 
@@ -223,6 +231,7 @@ const glm::vec3& SceneCamera::GetTarget() const
 void SceneCamera::SetUp(const glm::vec3& p_vUp)
 {
 	m_bViewDirty = true;
+	m_bFrustumDirty = true;
 	m_vUp = p_vUp;
 }
 
@@ -267,4 +276,20 @@ const glm::mat4& SceneCamera::GetViewMatrix() const
 		m_bViewDirty = false;
 	}
 	return m_mViewMatrix;
+}
+
+//------------------------------------------------------------------------------
+// Method:    GetFrustum
+// Returns:   const Frustum&
+// 
+// Returns the view frustum, recalculating it as needed.
+//------------------------------------------------------------------------------
+const Frustum& SceneCamera::GetFrustum() const
+{
+	if (m_bFrustumDirty)
+	{
+		m_Frustum.Set(GetProjectionMatrix() * GetViewMatrix());
+		m_bFrustumDirty = false;
+	}
+	return m_Frustum;
 }
\ No newline at end of file
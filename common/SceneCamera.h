@@ -11,6 +11,7 @@
 #define COMMON_SCENECAMERA_H
 
 #include <glm/glm.hpp>
+#include "Frustum.h"
 
 namespace Common
 {
@@ -47,6 +48,7 @@ namespace Common
 
 		const glm::mat4& GetProjectionMatrix() const;
 		const glm::mat4& GetViewMatrix() const;
+		const Frustum& GetFrustum() const;
 
 	private:
 		//---------------------------------------------------------------------
@@ -67,12 +69,16 @@ namespace Common
 		// Optimization; prevent calculating view/projection unless properties change
 		mutable bool m_bProjectionDirty;
 		mutable bool m_bViewDirty;
+		mutable bool m_bFrustumDirty;
 
 		// Calculated projection matrix
 		mutable glm::mat4 m_mProjectionMatrix;
 
 		// Calculated view matrix
 		mutable glm::mat4 m_mViewMatrix;
+
+		// Calculated view frustum
+		mutable Frustum m_Frustum;
 	};
 
 } // namespace common
@@ -8,8 +8,10 @@
 //------------------------------------------------------------------------
 
 #include "SceneManager.h"
+#include "W_SkinningManager.h"
 
 #include <algorithm>
+#include <cstring>
 
 using namespace Common;
 
@@ -62,7 +64,10 @@ SceneManager* SceneManager::Instance()
 SceneManager::SceneManager()
 	:
 	m_pCamera(NULL),
-	m_pLight(NULL)
+	m_pLight(NULL),
+	m_pInstanceBuffer(NULL),
+	m_pFrameBuffer(NULL),
+	m_mSpriteProj(glm::ortho(0.0f,1280.0f,720.0f,0.0f,0.0f,1000.0f))
 {
 	m_pLight = new DirectionalLight();
 	m_pLight->m_diffuse = wolf::Color4(1.0f,1.0f,1.0f,1.0f);
@@ -84,6 +89,18 @@ SceneManager::~SceneManager()
 		delete m_pLight;
 		m_pLight = NULL;
 	}
+
+	if (m_pInstanceBuffer)
+	{
+		wolf::BufferManager::DestroyBuffer(m_pInstanceBuffer);
+		m_pInstanceBuffer = NULL;
+	}
+
+	if (m_pFrameBuffer)
+	{
+		wolf::BufferManager::DestroyBuffer(m_pFrameBuffer);
+		m_pFrameBuffer = NULL;
+	}
 }
 
 //------------------------------------------------------------------------------
@@ -96,12 +113,54 @@ SceneManager::~SceneManager()
 void SceneManager::AddModel(wolf::Model* p_pModel)
 {
 	m_lModelList.push_back(p_pModel);
+
+	AABB bounds = AABB(p_pModel->GetBoundsMin(), p_pModel->GetBoundsMax()).Transform(p_pModel->GetTransform());
+	p_pModel->SetCullProxy(m_ModelCullTree.CreateProxy(bounds, p_pModel));
 }
 
 
 void SceneManager::AddSquareTexture(Square* p_pSquare)
 {
 	m_lSquareList.push_back(p_pSquare);
+
+	AABB bounds = AABB(p_pSquare->GetBoundsMin(), p_pSquare->GetBoundsMax()).Transform(p_pSquare->GetTransform());
+	p_pSquare->SetCullProxy(m_SquareCullTree.CreateProxy(bounds, p_pSquare));
+}
+
+//------------------------------------------------------------------------------
+// Method:    UpdateModelBounds
+// Parameter: wolf::Model * p_pModel
+// Returns:   void
+// 
+// Moves the model's culling bounds to its current transform.
+//------------------------------------------------------------------------------
+void SceneManager::UpdateModelBounds(wolf::Model* p_pModel)
+{
+	if (p_pModel->GetCullProxy() == DynamicAABBTree::s_iNullProxy)
+	{
+		return;
+	}
+
+	AABB bounds = AABB(p_pModel->GetBoundsMin(), p_pModel->GetBoundsMax()).Transform(p_pModel->GetTransform());
+	m_ModelCullTree.MoveProxy(p_pModel->GetCullProxy(), bounds);
+}
+
+//------------------------------------------------------------------------------
+// Method:    UpdateSquareBounds
+// Parameter: Square * p_pSquare
+// Returns:   void
+// 
+// Moves the square's culling bounds to its current transform.
+//------------------------------------------------------------------------------
+void SceneManager::UpdateSquareBounds(Square* p_pSquare)
+{
+	if (p_pSquare->GetCullProxy() == DynamicAABBTree::s_iNullProxy)
+	{
+		return;
+	}
+
+	AABB bounds = AABB(p_pSquare->GetBoundsMin(), p_pSquare->GetBoundsMax()).Transform(p_pSquare->GetTransform());
+	m_SquareCullTree.MoveProxy(p_pSquare->GetCullProxy(), bounds);
 }
 
 //------------------------------------------------------------------------------
@@ -116,6 +175,8 @@ void SceneManager::RemoveModel(wolf::Model* p_pModel)
 	ModelList::iterator it = std::find(m_lModelList.begin(), m_lModelList.end(), p_pModel);
 	if (it != m_lModelList.end())
 	{
+		m_ModelCullTree.DestroyProxy(p_pModel->GetCullProxy());
+		p_pModel->SetCullProxy(DynamicAABBTree::s_iNullProxy);
 		m_lModelList.erase(it);
 	}	
 }
@@ -126,12 +187,20 @@ void SceneManager::RemoveSquareTexture(Square* p_pSquare)
 	SquareTextureList::iterator it = std::find(m_lSquareList.begin(), m_lSquareList.end(), p_pSquare);
 	if (it != m_lSquareList.end())
 	{
+		m_SquareCullTree.DestroyProxy(p_pSquare->GetCullProxy());
+		p_pSquare->SetCullProxy(DynamicAABBTree::s_iNullProxy);
 		m_lSquareList.erase(it);
 	}	
 }
 
 void SceneManager::ClearSquareTexure()
 {
+	SquareTextureList::iterator it = m_lSquareList.begin(), end = m_lSquareList.end();
+	for (; it != end; ++it)
+	{
+		m_SquareCullTree.DestroyProxy((*it)->GetCullProxy());
+		(*it)->SetCullProxy(DynamicAABBTree::s_iNullProxy);
+	}
 	m_lSquareList.clear();
 }
 //------------------------------------------------------------------------------
@@ -142,6 +211,12 @@ void SceneManager::ClearSquareTexure()
 //------------------------------------------------------------------------------
 void SceneManager::Clear()
 {
+	ModelList::iterator it = m_lModelList.begin(), end = m_lModelList.end();
+	for (; it != end; ++it)
+	{
+		m_ModelCullTree.DestroyProxy((*it)->GetCullProxy());
+		(*it)->SetCullProxy(DynamicAABBTree::s_iNullProxy);
+	}
 	m_lModelList.clear();
 }
 
@@ -230,8 +305,8 @@ SceneCamera* SceneManager::GetCamera()
 // Method:    Render
 // Returns:   void
 // 
-// Iterates the list of models, applies the camera params to the shader and 
-// renders the model.
+// Culls the models and squares against the camera, sorts the visible ones into a render queue, applies the camera params 
+// to the shader and renders them. Sprites and the HUD go on top afterwards.
 //------------------------------------------------------------------------------
 void SceneManager::Render()
 {
@@ -245,82 +320,264 @@ void SceneManager::Render()
 	const glm::mat4& mProj = m_pCamera->GetProjectionMatrix();
 	const glm::mat4& mView = m_pCamera->GetViewMatrix();
 
-	// Iterate over the list of models and render them
-	ModelList::iterator it = m_lModelList.begin(), end = m_lModelList.end();
-	for (; it != end; ++it)
-	{
-		wolf::Model* pModel = static_cast<wolf::Model*>(*it);
-
-		pModel->GetMaterial()->SetUniform("LightAmbient", wolf::Color4(0.6f,0.6f,0.4f,1.0f));
+	UpdateFrameData(mView, mProj);
+	wolf::SkinningManager::BeginFrame();
+	BuildRenderQueue(m_pCamera->GetFrustum(), mView);
 
-		//pModel->GetMaterial()->SetUniform("worldIT", glm::transpose(glm::inverse(pModel->GetTransform())));
+	// Anything could have been bound since last frame, so start the bind caches
+	// from scratch. Within the queue consecutive items sharing a program, 
+	// texture or vertex array skip rebinding it.
+	wolf::Material::InvalidateBindCache();
+	wolf::VertexDeclaration::InvalidateBindCache();
 
-		/*
-		if (m_lPointLightList.size() > 0)
+	RenderQueue::iterator it = m_lRenderQueue.begin(), end = m_lRenderQueue.end();
+	while (it != end)
+	{
+		if (it->m_eType == eRenderItem_Model)
 		{
-			pModel->GetMaterial()->SetUniform("LightPos1", m_lPointLightList.at(0)->m_vPosition);
-			pModel->GetMaterial()->SetUniform("LightAttenuation1", m_lPointLightList.at(0)->m_vAttenuation);
-			pModel->GetMaterial()->SetUniform("LightDiffuse1", m_lPointLightList.at(0)->m_diffuse);
-			pModel->GetMaterial()->SetUniform("LightSpecular1", m_lPointLightList.at(0)->m_specular);
-			pModel->GetMaterial()->SetUniform("LightRange1", m_lPointLightList.at(0)->m_fRange);
+			it = RenderModels(it, end, mView, mProj);
 		}
+		else
+		{
+			Square* pSquare = static_cast<Square*>(it->m_pObject);
+			SetAmbientLight(pSquare->GetMaterial(), wolf::Color4(0.2f,0.2f,0.2f,1.0f));
+			pSquare->Render(mView, mProj);
+			++it;
+		}
+	}
+
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+	// Render the sprite list with the sprite projection, batched
+	m_SpriteBatch.Begin(m_mSpriteProj);
+	SpriteList::iterator sIt = m_lSpriteList.begin(), sEnd = m_lSpriteList.end();
+	for (; sIt != sEnd; ++sIt)
+	{
+		wolf::Sprite* pSprite = static_cast<wolf::Sprite*>(*sIt);
+		pSprite->Render(&m_SpriteBatch);
+	}
+	m_SpriteBatch.End();
+
+	//render HUD textbox
+	if (m_pTextBox)
+		m_pTextBox->Render();
+}
+
+//------------------------------------------------------------------------------
+// Method:    BuildRenderQueue
+// Parameter: const Frustum & p_Frustum
+// Parameter: const glm::mat4 & p_mView
+// Returns:   void
+// 
+// Fills the render queue with the models and squares whose bounds touch the
+// frustum and sorts it. Models still loading in the background are left out.
+//------------------------------------------------------------------------------
+void SceneManager::BuildRenderQueue(const Frustum& p_Frustum, const glm::mat4& p_mView)
+{
+	m_lRenderQueue.clear();
 
-		if (m_lPointLightList.size() > 1)
+	m_lVisible.clear();
+	m_ModelCullTree.Query(p_Frustum, m_lVisible);
+	DynamicAABBTree::UserDataList::iterator it = m_lVisible.begin(), end = m_lVisible.end();
+	for (; it != end; ++it)
+	{
+		wolf::Model* pModel = static_cast<wolf::Model*>(*it);
+		if (!pModel->IsReady())
 		{
-			pModel->GetMaterial()->SetUniform("LightPos2", m_lPointLightList.at(1)->m_vPosition);
-			pModel->GetMaterial()->SetUniform("LightAttenuation2", m_lPointLightList.at(1)->m_vAttenuation);
-			pModel->GetMaterial()->SetUniform("LightDiffuse2", m_lPointLightList.at(1)->m_diffuse);
-			pModel->GetMaterial()->SetUniform("LightSpecular2", m_lPointLightList.at(1)->m_specular);
-			pModel->GetMaterial()->SetUniform("LightRange2", m_lPointLightList.at(1)->m_fRange);
+			continue;
 		}
-		*/
+		AddToRenderQueue(eRenderItem_Model, pModel, pModel->GetMaterial(), pModel->GetTransform(), p_mView);
+	}
+
+	m_lVisible.clear();
+	m_SquareCullTree.Query(p_Frustum, m_lVisible);
+	for (it = m_lVisible.begin(), end = m_lVisible.end(); it != end; ++it)
+	{
+		Square* pSquare = static_cast<Square*>(*it);
+		AddToRenderQueue(eRenderItem_Square, pSquare, pSquare->GetMaterial(), pSquare->GetTransform(), p_mView);
+	}
+
+	std::sort(m_lRenderQueue.begin(), m_lRenderQueue.end());
+}
+
+//------------------------------------------------------------------------------
+// Method:    AddToRenderQueue
+// Parameter: RenderItemType p_eType
+// Parameter: void * p_pObject
+// Parameter: wolf::Material * p_pMaterial
+// Parameter: const glm::mat4 & p_mWorld
+// Parameter: const glm::mat4 & p_mView
+// Returns:   void
+// 
+// Adds an item to the render queue, keyed on its material and its view depth.
+//------------------------------------------------------------------------------
+void SceneManager::AddToRenderQueue(RenderItemType p_eType, void* p_pObject, wolf::Material* p_pMaterial, const glm::mat4& p_mWorld, const glm::mat4& p_mView)
+{
+	// Depth of the object's origin in front of the camera
+	glm::vec4 vViewPos = p_mView * p_mWorld[3];
+
+	RenderItem item;
+	item.m_uiSortKey = MakeSortKey(p_pMaterial, -vViewPos.z);
+	item.m_eType = p_eType;
+	item.m_pObject = p_pObject;
+	m_lRenderQueue.push_back(item);
+}
 
-		pModel->Render(mView, mProj);
+//------------------------------------------------------------------------------
+// Method:    MakeSortKey
+// Parameter: wolf::Material * p_pMaterial
+// Parameter: float p_fDepth
+// Returns:   unsigned long long
+// 
+// Builds a 64 bit render queue key. The top 2 bits are the pass (opaque before
+// blended). Opaque items then sort by program, material, texture and finally 
+// depth front to back, so draws sharing state are grouped. Blended items sort 
+// back to front first, since that's what they need to look right, and by state
+// after that.
+//------------------------------------------------------------------------------
+unsigned long long SceneManager::MakeSortKey(wolf::Material* p_pMaterial, float p_fDepth)
+{
+	// Non negative floats sort the same as their bit patterns, so the top 24
+	// bits make a depth that needs no range
+	if (p_fDepth < 0.0f)
+	{
+		p_fDepth = 0.0f;
 	}
+	unsigned int uiDepthBits;
+	memcpy(&uiDepthBits, &p_fDepth, sizeof(uiDepthBits));
+	unsigned long long uiDepth = uiDepthBits >> 8;
 
+	const wolf::Texture* pTexture = p_pMaterial->GetFirstTexture();
+	unsigned long long uiProgram = p_pMaterial->GetProgram() ? (p_pMaterial->GetProgram()->GetID() & 0x3FFF) : 0;
+	unsigned long long uiMaterial = p_pMaterial->GetID() & 0xFFFF;
+	unsigned long long uiTexture = pTexture ? (pTexture->GetID() & 0xFF) : 0;
 
-	SquareTextureList::iterator it1 = m_lSquareList.begin(), end1 = m_lSquareList.end();
-	for (; it1 != end1; ++it1)
+	if (p_pMaterial->GetBlend())
 	{
-		Square* pSquare = static_cast<Square*>(*it1);
+		unsigned long long uiFarToNear = (~uiDepth) & 0xFFFFFF;
+		return (1ULL << 62) | (uiFarToNear << 38) | (uiProgram << 24) | (uiMaterial << 8) | uiTexture;
+	}
 
-		pSquare->GetMaterial()->SetUniform("LightAmbient", wolf::Color4(0.2f,0.2f,0.2f,1.0f));
+	return (uiProgram << 48) | (uiMaterial << 32) | (uiTexture << 24) | uiDepth;
+}
 
-		if (m_lPointLightList.size() > 0)
+//------------------------------------------------------------------------------
+// Method:    RenderModels
+// Parameter: RenderQueue::iterator p_itBegin
+// Parameter: RenderQueue::iterator p_itEnd
+// Parameter: const glm::mat4 & p_mView
+// Parameter: const glm::mat4 & p_mProj
+// Returns:   SceneManager::RenderQueue::iterator
+// 
+// Renders the model at p_itBegin. If the models following it in the queue are 
+// copies of it (same file and material) they all go in one instanced draw. 
+// Returns the first item that wasn't rendered.
+//------------------------------------------------------------------------------
+SceneManager::RenderQueue::iterator SceneManager::RenderModels(RenderQueue::iterator p_itBegin, RenderQueue::iterator p_itEnd, const glm::mat4& p_mView, const glm::mat4& p_mProj)
+{
+	wolf::Model* pModel = static_cast<wolf::Model*>(p_itBegin->m_pObject);
+	SetAmbientLight(pModel->GetMaterial(), wolf::Color4(0.6f,0.6f,0.4f,1.0f));
+
+	// Blended models have to keep their back to front order
+	m_lInstanceBatch.clear();
+	m_lInstanceBatch.push_back(pModel);
+	RenderQueue::iterator it = p_itBegin + 1;
+	if (!pModel->GetMaterial()->GetBlend())
+	{
+		for (; it != p_itEnd && it->m_eType == eRenderItem_Model; ++it)
 		{
-			pSquare->GetMaterial()->SetUniform("LightPos1", m_lPointLightList.at(0)->m_vPosition);
-			pSquare->GetMaterial()->SetUniform("LightAttenuation1", m_lPointLightList.at(0)->m_vAttenuation);
-			pSquare->GetMaterial()->SetUniform("LightDiffuse1", m_lPointLightList.at(0)->m_diffuse);
-			pSquare->GetMaterial()->SetUniform("LightSpecular1", m_lPointLightList.at(0)->m_specular);
-			pSquare->GetMaterial()->SetUniform("LightRange1", m_lPointLightList.at(0)->m_fRange);
+			wolf::Model* pOther = static_cast<wolf::Model*>(it->m_pObject);
+			if (!pModel->CanInstanceWith(pOther))
+			{
+				break;
+			}
+			m_lInstanceBatch.push_back(pOther);
 		}
+	}
 
-		if (m_lPointLightList.size() > 1)
-		{
-			pSquare->GetMaterial()->SetUniform("LightPos2", m_lPointLightList.at(1)->m_vPosition);
-			pSquare->GetMaterial()->SetUniform("LightAttenuation2", m_lPointLightList.at(1)->m_vAttenuation);
-			pSquare->GetMaterial()->SetUniform("LightDiffuse2", m_lPointLightList.at(1)->m_diffuse);
-			pSquare->GetMaterial()->SetUniform("LightSpecular2", m_lPointLightList.at(1)->m_specular);
-			pSquare->GetMaterial()->SetUniform("LightRange2", m_lPointLightList.at(1)->m_fRange);
-		}
+	if (m_lInstanceBatch.size() == 1)
+	{
+		pModel->Render(p_mView, p_mProj);
+		return p_itBegin + 1;
+	}
 
-		pSquare->Render(mView, mProj);
+	if (m_pInstanceBuffer == NULL)
+	{
+		m_pInstanceBuffer = wolf::BufferManager::CreateVertexBuffer(sizeof(glm::mat4));
 	}
+	pModel->RenderInstanced(&m_lInstanceBatch[0], m_lInstanceBatch.size(), m_pInstanceBuffer, p_mView, p_mProj);
+	return it;
+}
 
-	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-	// Render the sprite list with an ortho camera. 
-	// TODO: We should really add the camera separately rather than hard code it.
-	const glm::mat4 mOrthoProj = glm::ortho(0.0f,1280.0f,720.0f,0.0f,0.0f,1000.0f);
-	SpriteList::iterator sIt = m_lSpriteList.begin(), sEnd = m_lSpriteList.end();
-	for (; sIt != sEnd; ++sIt)
+//------------------------------------------------------------------------------
+// Method:    UpdateFrameData
+// Parameter: const glm::mat4 & p_mView
+// Parameter: const glm::mat4 & p_mProj
+// Returns:   void
+// 
+// Fills in this frame's camera and lights and uploads them to the FrameData 
+// uniform block, which every program that declares it reads from. Point 
+// lights past MAX_POINT_LIGHTS are dropped.
+//------------------------------------------------------------------------------
+void SceneManager::UpdateFrameData(const glm::mat4& p_mView, const glm::mat4& p_mProj)
+{
+	m_frameData.m_mProjection = p_mProj;
+	m_frameData.m_mView = p_mView;
+	m_frameData.m_vCameraPos = glm::vec4(m_pCamera->GetPos(), 1.0f);
+	m_frameData.m_vViewDir = glm::vec4(glm::normalize(m_pCamera->GetPos() - m_pCamera->GetTarget()), 0.0f);
+
+	const wolf::Color4& ambient = m_pLight->m_ambient;
+	const wolf::Color4& diffuse = m_pLight->m_diffuse;
+	const wolf::Color4& specular = m_pLight->m_specular;
+	m_frameData.m_vLightDir = glm::vec4(glm::normalize(m_pLight->m_vDirection), 0.0f);
+	m_frameData.m_vLightAmbient = glm::vec4(ambient.r, ambient.g, ambient.b, ambient.a);
+	m_frameData.m_vLightDiffuse = glm::vec4(diffuse.r, diffuse.g, diffuse.b, diffuse.a);
+	m_frameData.m_vLightSpecular = glm::vec4(specular.r, specular.g, specular.b, specular.a);
+
+	int iNumPointLights = (int)m_lPointLightList.size();
+	if (iNumPointLights > MAX_POINT_LIGHTS)
 	{
-		wolf::Sprite* pSprite = static_cast<wolf::Sprite*>(*sIt);
-		pSprite->Render(mOrthoProj);
+		iNumPointLights = MAX_POINT_LIGHTS;
+	}
+	for (int i = 0; i < iNumPointLights; ++i)
+	{
+		const PointLight* pLight = m_lPointLightList[i];
+		PointLightData& data = m_frameData.m_aPointLights[i];
+		data.m_vPositionRange = glm::vec4(pLight->m_vPosition, pLight->m_fRange);
+		data.m_vAttenuation = glm::vec4(pLight->m_vAttenuation, 0.0f);
+		data.m_vDiffuse = glm::vec4(pLight->m_diffuse.r, pLight->m_diffuse.g, pLight->m_diffuse.b, pLight->m_diffuse.a);
+		data.m_vSpecular = glm::vec4(pLight->m_specular.r, pLight->m_specular.g, pLight->m_specular.b, pLight->m_specular.a);
 	}
+	m_frameData.m_aiNumPointLights[0] = iNumPointLights;
 
-	//render HUD textbox
-	if (m_pTextBox)
-		m_pTextBox->Render();
+	if (m_pFrameBuffer == NULL)
+	{
+		m_pFrameBuffer = wolf::BufferManager::CreateUniformBuffer(sizeof(FrameData));
+	}
+
+	// Only the lights in use need to go up
+	unsigned int uiSize = sizeof(FrameData) - sizeof(PointLightData) * (MAX_POINT_LIGHTS - iNumPointLights);
+	m_pFrameBuffer->Write(&m_frameData, uiSize);
+	m_pFrameBuffer->BindToBlock(wolf::UB_Frame);
+}
+
+//------------------------------------------------------------------------------
+// Method:    SetAmbientLight
+// Parameter: wolf::Material * p_pMaterial
+// Parameter: const wolf::Color4 & p_ambient
+// Returns:   void
+// 
+// Programs that don't declare the FrameData uniform block still read a plain 
+// LightAmbient uniform, so set it on the material. Programs that do declare 
+// it get their lights from the block and are left alone.
+//------------------------------------------------------------------------------
+void SceneManager::SetAmbientLight(wolf::Material* p_pMaterial, const wolf::Color4& p_ambient)
+{
+	if (p_pMaterial->GetProgram() == NULL || p_pMaterial->GetProgram()->HasUniformBlock(wolf::UB_Frame))
+	{
+		return;
+	}
+
+	p_pMaterial->SetUniform("LightAmbient", p_ambient);
 }
 
 void SceneManager::Update(float p_fDelta)
@@ -12,7 +12,9 @@
 
 #include "W_Model.h"
 #include "W_Sprite.h"
+#include "W_SpriteBatch.h"
 #include "SceneCamera.h"
+#include "DynamicAABBTree.h"
 #include "Assignment4\ExampleGame\Square.h"
 #include "Assignment4\ExampleGame\ComponentPointLight.h"
 #include "Assignment4\ExampleGame\Textbox\TTextBox.h"
@@ -27,6 +29,25 @@ namespace Common
 		typedef std::vector<Square*> SquareTextureList;
 		typedef std::vector<PointLight*> PointLightList;
 
+		// What a render queue item draws
+		enum RenderItemType
+		{
+			eRenderItem_Model,
+			eRenderItem_Square
+		};
+
+		// One draw in the render queue. Items are sorted by key so draws that
+		// share state end up next to each other (see MakeSortKey()).
+		struct RenderItem
+		{
+			unsigned long long	m_uiSortKey;
+			RenderItemType		m_eType;
+			void*				m_pObject;
+
+			bool operator<(const RenderItem& p_Other) const { return m_uiSortKey < p_Other.m_uiSortKey; }
+		};
+		typedef std::vector<RenderItem> RenderQueue;
+
 		// A directional light
 		struct DirectionalLight
 		{
@@ -37,6 +58,33 @@ namespace Common
 			DirectionalLight() : m_diffuse(0,0,0,0), m_specular(0,0,0,0), m_ambient(0,0,0,0) {}    
 		};
 
+		// Most point lights the frame uniform block holds. Has to match the
+		// PointLights array size in the shaders' FrameData block.
+		static const int MAX_POINT_LIGHTS = 16;
+
+		// Per frame values shared by all programs through the FrameData 
+		// uniform block. Laid out to match std140.
+		struct PointLightData
+		{
+			glm::vec4		m_vPositionRange;	// xyz position, w range
+			glm::vec4		m_vAttenuation;
+			glm::vec4		m_vDiffuse;
+			glm::vec4		m_vSpecular;
+		};
+		struct FrameData
+		{
+			glm::mat4		m_mProjection;
+			glm::mat4		m_mView;
+			glm::vec4		m_vCameraPos;
+			glm::vec4		m_vViewDir;			// Towards the camera
+			glm::vec4		m_vLightDir;
+			glm::vec4		m_vLightAmbient;
+			glm::vec4		m_vLightDiffuse;
+			glm::vec4		m_vLightSpecular;
+			int				m_aiNumPointLights[4];
+			PointLightData	m_aPointLights[MAX_POINT_LIGHTS];
+		};
+
 	public:
 		//------------------------------------------------------------------------------
 		// Public methods.
@@ -53,10 +101,18 @@ namespace Common
 		void RemoveSquareTexture(Square* p_oSquare);
 		void ClearSquareTexure();
 
+		// Call after moving a model or square so culling sees the new position
+		void UpdateModelBounds(wolf::Model* p_pModel);
+		void UpdateSquareBounds(Square* p_pSquare);
+
 		void AddSprite(wolf::Sprite* p_pSprite);
 		void RemoveSprite(wolf::Sprite* p_pSprite);
 		void ClearSprites();
 
+		// Projection sprites are drawn with; screen pixels by default
+		void SetSpriteProjection(const glm::mat4& p_mProj) { m_mSpriteProj = p_mProj; }
+		const glm::mat4& GetSpriteProjection() const { return m_mSpriteProj; }
+
 		void AddPointLight(PointLight* p_pPointLight);
 		void RemovePointLight(PointLight* p_pPointLight);
 		void ClearPointLights();
@@ -82,6 +138,14 @@ namespace Common
 		SceneManager();
 		virtual ~SceneManager();
 
+		void BuildRenderQueue(const Frustum& p_Frustum, const glm::mat4& p_mView);
+		void AddToRenderQueue(RenderItemType p_eType, void* p_pObject, wolf::Material* p_pMaterial, const glm::mat4& p_mWorld, const glm::mat4& p_mView);
+		void UpdateFrameData(const glm::mat4& p_mView, const glm::mat4& p_mProj);
+		void SetAmbientLight(wolf::Material* p_pMaterial, const wolf::Color4& p_ambient);
+		RenderQueue::iterator RenderModels(RenderQueue::iterator p_itBegin, RenderQueue::iterator p_itEnd, const glm::mat4& p_mView, const glm::mat4& p_mProj);
+
+		static unsigned long long MakeSortKey(wolf::Material* p_pMaterial, float p_fDepth);
+
 	private:
 		//------------------------------------------------------------------------------
 		// Private members.
@@ -99,9 +163,35 @@ namespace Common
 		// A list of sprites to render
 		SpriteList m_lSpriteList;
 
+		// Batches the sprites into as few draws as it can, and their projection
+		wolf::SpriteBatch m_SpriteBatch;
+		glm::mat4 m_mSpriteProj;
+
 		// A list of point lights
 		PointLightList m_lPointLightList;
 
+		// Bounding volume hierarchies of the models and squares, for culling 
+		// against the camera frustum. Proxy user data is the model/square.
+		DynamicAABBTree m_ModelCullTree;
+		DynamicAABBTree m_SquareCullTree;
+
+		// Scratch list for culling results
+		DynamicAABBTree::UserDataList m_lVisible;
+
+		// Models and squares to draw this frame, sorted. Kept around so the
+		// memory is reused.
+		RenderQueue m_lRenderQueue;
+
+		// Models going in the current instanced draw, and the buffer their
+		// transforms are streamed through
+		ModelList m_lInstanceBatch;
+		wolf::VertexBuffer* m_pInstanceBuffer;
+
+		// This frame's camera and lights, and the uniform buffer they're 
+		// uploaded to
+		FrameData m_frameData;
+		wolf::UniformBuffer* m_pFrameBuffer;
+
 		// A camera to view the scene
 		SceneCamera* m_pCamera;
 		
@@ -4,8 +4,9 @@
 // Created:	2013/02/18
 // Author:	Carel Boers
 //	
-// A simple line drawing utility. This isn't the most efficient class so 
-// don't plan to use for anything other than debug drawing...
+// A simple line drawing utility for debug drawing. Lines are collected into
+// one vertex array during the frame and streamed to a single vertex buffer
+// and drawn in one call on Render().
 //------------------------------------------------------------------------
 
 #include "W_BufferManager.h"
@@ -60,6 +61,16 @@ void LineDrawer::Init(const std::string &p_strVertexProgramPath, const std::stri
 {	
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 	m_pProgram = wolf::ProgramManager::CreateProgram(p_strVertexProgramPath, p_strFragmentProgramPath);
+
+	// One buffer for the life of the drawer; it grows as needed when streamed to
+	m_pVB = wolf::BufferManager::CreateVertexBuffer(sizeof(Vertex) * 1024);
+
+	m_pDecl = new wolf::VertexDeclaration();
+	m_pDecl->Begin();
+	m_pDecl->AppendAttribute(wolf::AT_Position, 3, wolf::CT_Float);
+	m_pDecl->AppendAttribute(wolf::AT_Color, 4, wolf::CT_Float);
+	m_pDecl->SetVertexBuffer(m_pVB);
+	m_pDecl->End();
 }
 
 //------------------------------------------------------------------------------
@@ -72,31 +83,9 @@ void LineDrawer::Init(const std::string &p_strVertexProgramPath, const std::stri
 //------------------------------------------------------------------------------
 void LineDrawer::Render(const glm::mat4& p_mProjectionMatrix, const glm::mat4& p_mViewMatrix)
 {
-	int len = m_lVertexVector.size();
-	if (len > 0)
+	if (!m_lVertices.empty())
 	{
-		Vertex* lineVerts = new Vertex[m_lVertexVector.size()];
-		for (int i = 0; i < len; ++i)
-		{
-			LineData* data = m_lVertexVector[i];
-			Vertex* vert = &lineVerts[i];
-			vert->x = data->x;
-			vert->y = data->y;
-			vert->z = data->z;
-			vert->r = data->r;
-			vert->g = data->g;
-			vert->b = data->b;
-			vert->a = data->a;
-		}
-
-		m_pVB = wolf::BufferManager::CreateVertexBuffer(lineVerts, sizeof(LineData) * len);
-
-		m_pDecl = new wolf::VertexDeclaration();
-		m_pDecl->Begin();
-		m_pDecl->AppendAttribute(wolf::AT_Position, 3, wolf::CT_Float);
-		m_pDecl->AppendAttribute(wolf::AT_Color, 4, wolf::CT_Float);
-		m_pDecl->SetVertexBuffer(m_pVB);
-		m_pDecl->End();
+		m_pVB->Stream(&m_lVertices[0], sizeof(Vertex) * m_lVertices.size());
 
 		// Use shader program.
 		m_pProgram->Bind();
@@ -109,20 +98,11 @@ void LineDrawer::Render(const glm::mat4& p_mProjectionMatrix, const glm::mat4& p
 		m_pDecl->Bind();
 
 		// Draw!
-		glDrawArrays(GL_LINES, 0, len);
-
-		delete[] lineVerts;
+		glDrawArrays(GL_LINES, 0, m_lVertices.size());
 	}
 
 	// Clear lines
-	LineVector::iterator it = m_lVertexVector.begin(), end = m_lVertexVector.end();
-	for (; it != end; ++it)
-	{
-		LineData* pVert = static_cast<LineData*>(*it);
-		delete pVert;
-		pVert = NULL;
-	}
-	m_lVertexVector.clear();
+	m_lVertices.clear();
 }
 
 //------------------------------------------------------------------------------
@@ -136,8 +116,8 @@ void LineDrawer::Render(const glm::mat4& p_mProjectionMatrix, const glm::mat4& p
 //------------------------------------------------------------------------------
 void LineDrawer::AddLine(const glm::vec3& p_vFrom, const glm::vec3& p_vTo, const wolf::Color4& p_cColor)
 {
-	LineData* vFrom = new LineData(p_vFrom.x, p_vFrom.y, p_vFrom.z, p_cColor.r, p_cColor.g, p_cColor.b, p_cColor.a);
-	LineData* vTo = new LineData(p_vTo.x, p_vTo.y, p_vTo.z, p_cColor.r, p_cColor.g, p_cColor.b, p_cColor.a);
-	m_lVertexVector.push_back(vFrom);
-	m_lVertexVector.push_back(vTo);
+	Vertex vFrom = { p_vFrom.x, p_vFrom.y, p_vFrom.z, p_cColor.r, p_cColor.g, p_cColor.b, p_cColor.a };
+	Vertex vTo = { p_vTo.x, p_vTo.y, p_vTo.z, p_cColor.r, p_cColor.g, p_cColor.b, p_cColor.a };
+	m_lVertices.push_back(vFrom);
+	m_lVertices.push_back(vTo);
 }
\ No newline at end of file
@@ -4,8 +4,9 @@
 // Created:	2013/02/18
 // Author:	Carel Boers
 //	
-// A simple line drawing utility. This isn't the most efficient class so 
-// don't plan to use for anything other than debug drawing...
+// A simple line drawing utility for debug drawing. Lines are collected into
+// one vertex array during the frame and streamed to a single vertex buffer
+// and drawn in one call on Render().
 //------------------------------------------------------------------------
 
 #ifndef W_LINEDRAWER_H
@@ -24,20 +25,12 @@ private:
 	//-------------------------------------------------------------------------
 	// Private types
 	//-------------------------------------------------------------------------
-	struct LineData
-	{
-		GLfloat x,y,z;
-		GLfloat r, g, b, a;
-		LineData(float _x, float _y, float _z, float _r, float _g, float _b, float _a)
-			: x(_x), y(_y), z(_z), r(_r), g(_g), b(_b), a(_a) { }
-	};
-	typedef std::vector<LineData*> LineVector;
-
 	struct Vertex
 	{
 		GLfloat x,y,z;
 		GLfloat r, g, b, a;
 	};
+	typedef std::vector<Vertex> VertexVector;
 
 public:
 	//-------------------------------------------------------------------------
@@ -62,8 +55,9 @@ private:
 	wolf::VertexBuffer* m_pVB;
 	wolf::VertexDeclaration* m_pDecl;
 
-	// List of lines to draw; cleared each frame after being rendered
-	LineVector m_lVertexVector;
+	// Vertices of the lines to draw, two per line; cleared each frame after 
+	// being rendered. Keeps its memory between frames.
+	VertexVector m_lVertices;
 };
 }
 
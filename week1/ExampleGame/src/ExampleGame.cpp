@@ -9,6 +9,7 @@
 
 #include "ExampleGame.h"
 #include "W_Model.h"
+#include "W_ModelManager.h"
 
 using namespace week1;
 
@@ -66,7 +67,7 @@ bool ExampleGame::Init()
 	g_light1.m_vDirection = glm::vec3(0.0f,0.0f,-1.0f);
 
 	// Initialize the model
-	m_pModel = new wolf::Model("week1/ExampleGame/data/zombie/zombie.pod", "week1/ExampleGame/data/zombie/", "week1/ExampleGame/data/skinned.vsh", "week1/ExampleGame/data/skinned.fsh");
+	m_pModel = wolf::ModelManager::CreateModel("week1/ExampleGame/data/zombie/zombie.pod", "week1/ExampleGame/data/zombie/", "week1/ExampleGame/data/skinned.vsh", "week1/ExampleGame/data/skinned.fsh");
 	return true;
 }
 
@@ -123,7 +124,7 @@ void ExampleGame::Shutdown()
 {
 	if (m_pModel)
 	{
-		delete m_pModel;
+		wolf::ModelManager::DestroyModel(m_pModel);
 		m_pModel = NULL;
 	}
 }
\ No newline at end of file
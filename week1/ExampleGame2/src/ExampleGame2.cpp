@@ -9,6 +9,7 @@
 
 #include "ExampleGame2.h"
 #include "W_Model.h"
+#include "W_ModelManager.h"
 
 using namespace week1;
 
@@ -57,7 +58,7 @@ bool ExampleGame2::Init()
 	Common::SceneManager::Instance()->AttachCamera(m_pSceneCamera);
 
 	// Initialize the model and add it the Scene Manager
-	m_pModel = new wolf::Model("week1/ExampleGame2/data/zombie/zombie.pod", "week1/ExampleGame2/data/zombie/", "week1/ExampleGame2/data/skinned.vsh", "week1/ExampleGame2/data/skinned.fsh");
+	m_pModel = wolf::ModelManager::CreateModel("week1/ExampleGame2/data/zombie/zombie.pod", "week1/ExampleGame2/data/zombie/", "week1/ExampleGame2/data/skinned.vsh", "week1/ExampleGame2/data/skinned.fsh");
 	Common::SceneManager::Instance()->AddModel(m_pModel);
 
 	return true;
@@ -120,7 +121,7 @@ void ExampleGame2::Shutdown()
 	if (m_pModel)
 	{
 		Common::SceneManager::Instance()->RemoveModel(m_pModel);
-		delete m_pModel;
+		wolf::ModelManager::DestroyModel(m_pModel);
 		m_pModel = NULL;
 	}
 
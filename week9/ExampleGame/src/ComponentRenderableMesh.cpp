@@ -8,6 +8,7 @@
 //------------------------------------------------------------------------
 
 #include "W_Model.h"
+#include "W_ModelManager.h"
 #include "ComponentRenderableMesh.h"
 #include "GameObject.h"
 #include "SceneManager.h"
@@ -40,7 +41,7 @@ ComponentRenderableMesh::~ComponentRenderableMesh()
 	// Delete the model
 	if (m_pModel)
 	{
-		delete m_pModel;
+		wolf::ModelManager::DestroyModel(m_pModel);
 		m_pModel = NULL;
 	}
 }
@@ -57,7 +58,7 @@ ComponentRenderableMesh::~ComponentRenderableMesh()
 //------------------------------------------------------------------------------
 void ComponentRenderableMesh::Init(const std::string& p_strPath, const std::string &p_strTexturePath, const std::string &p_strVertexProgramPath, const std::string &p_strFragmentProgramPath)
 {
-	m_pModel = new wolf::Model(p_strPath, p_strTexturePath, p_strVertexProgramPath, p_strFragmentProgramPath);
+	m_pModel = wolf::ModelManager::CreateModel(p_strPath, p_strTexturePath, p_strVertexProgramPath, p_strFragmentProgramPath);
 	Common::SceneManager::Instance()->AddModel(m_pModel);
 }
 
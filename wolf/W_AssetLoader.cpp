@@ -0,0 +1,186 @@
+//-----------------------------------------------------------------------------
+// File:			W_AssetLoader.cpp
+// Original Author:	agent
+//
+// See header for notes
+//-----------------------------------------------------------------------------
+#include "W_AssetLoader.h"
+
+namespace wolf
+{
+
+bool AssetLoader::m_bRunning = false;
+bool AssetLoader::m_bQuit = false;
+std::vector<GLFWthread> AssetLoader::m_lThreads;
+GLFWmutex AssetLoader::m_mutex = 0;
+GLFWcond AssetLoader::m_toLoad = 0;
+GLFWcond AssetLoader::m_loaded = 0;
+std::deque<AssetLoader::Job*> AssetLoader::m_lToLoad;
+std::deque<AssetLoader::Job*> AssetLoader::m_lLoaded;
+unsigned int AssetLoader::m_uiNumPending = 0;
+
+//----------------------------------------------------------
+// Starts the worker threads. Needs glfwInit() to have been
+// called.
+//----------------------------------------------------------
+void AssetLoader::Init(unsigned int p_uiNumThreads)
+{
+	if( m_bRunning )
+		return;
+
+	m_mutex = glfwCreateMutex();
+	m_toLoad = glfwCreateCond();
+	m_loaded = glfwCreateCond();
+	m_bQuit = false;
+	m_bRunning = true;
+
+	for( unsigned int i = 0; i < p_uiNumThreads; i++ )
+	{
+		GLFWthread thread = glfwCreateThread(WorkerThread, 0);
+		if( thread >= 0 )
+			m_lThreads.push_back(thread);
+	}
+
+	// No threads means loading on the spot, like before Init()
+	if( m_lThreads.empty() )
+		Shutdown();
+}
+
+//----------------------------------------------------------
+// Finishes everything still queued and stops the worker
+// threads
+//----------------------------------------------------------
+void AssetLoader::Shutdown()
+{
+	if( !m_bRunning )
+		return;
+
+	FinishAll();
+
+	glfwLockMutex(m_mutex);
+	m_bQuit = true;
+	glfwBroadcastCond(m_toLoad);
+	glfwUnlockMutex(m_mutex);
+
+	for( unsigned int i = 0; i < m_lThreads.size(); i++ )
+		glfwWaitThread(m_lThreads[i], GLFW_WAIT);
+	m_lThreads.clear();
+
+	glfwDestroyCond(m_loaded);
+	glfwDestroyCond(m_toLoad);
+	glfwDestroyMutex(m_mutex);
+	m_bRunning = false;
+}
+
+//----------------------------------------------------------
+// Hands a job to the worker threads. The loader owns it from
+// here on and deletes it once it's finished.
+//----------------------------------------------------------
+void AssetLoader::Queue(Job* p_pJob)
+{
+	if( !m_bRunning )
+	{
+		p_pJob->Load();
+		p_pJob->Finish();
+		delete p_pJob;
+		return;
+	}
+
+	m_uiNumPending++;
+
+	glfwLockMutex(m_mutex);
+	m_lToLoad.push_back(p_pJob);
+	glfwSignalCond(m_toLoad);
+	glfwUnlockMutex(m_mutex);
+}
+
+//----------------------------------------------------------
+// Finishes loaded jobs, for up to the given number of
+// seconds. Call once a frame from the main thread. At least
+// one job is finished if one is ready, however long it takes.
+//----------------------------------------------------------
+void AssetLoader::Update(double p_dBudget)
+{
+	if( m_uiNumPending == 0 )
+		return;
+
+	double dStart = glfwGetTime();
+	do
+	{
+		Job* pJob = PopLoaded(false);
+		if( !pJob )
+			break;
+
+		if( !pJob->m_bCancelled )
+			pJob->Finish();
+		delete pJob;
+		m_uiNumPending--;
+	}
+	while( glfwGetTime() - dStart < p_dBudget );
+}
+
+//----------------------------------------------------------
+// Waits for and finishes every queued job, for when the
+// game can't go on without them
+//----------------------------------------------------------
+void AssetLoader::FinishAll()
+{
+	while( m_uiNumPending > 0 )
+	{
+		Job* pJob = PopLoaded(true);
+		if( !pJob->m_bCancelled )
+			pJob->Finish();
+		delete pJob;
+		m_uiNumPending--;
+	}
+}
+
+//----------------------------------------------------------
+// Takes the next loaded job off the queue. If there isn't
+// one it waits for one if asked to, or returns NULL.
+//----------------------------------------------------------
+AssetLoader::Job* AssetLoader::PopLoaded(bool p_bWait)
+{
+	Job* pJob = 0;
+
+	glfwLockMutex(m_mutex);
+	while( p_bWait && m_lLoaded.empty() )
+		glfwWaitCond(m_loaded, m_mutex, GLFW_INFINITY);
+	if( !m_lLoaded.empty() )
+	{
+		pJob = m_lLoaded.front();
+		m_lLoaded.pop_front();
+	}
+	glfwUnlockMutex(m_mutex);
+
+	return pJob;
+}
+
+//----------------------------------------------------------
+// Worker threads take jobs off the queue and load them until
+// told to quit
+//----------------------------------------------------------
+void GLFWCALL AssetLoader::WorkerThread(void* p_pArg)
+{
+	glfwLockMutex(m_mutex);
+	for(;;)
+	{
+		while( m_lToLoad.empty() && !m_bQuit )
+			glfwWaitCond(m_toLoad, m_mutex, GLFW_INFINITY);
+		if( m_bQuit )
+			break;
+
+		Job* pJob = m_lToLoad.front();
+		m_lToLoad.pop_front();
+		glfwUnlockMutex(m_mutex);
+
+		pJob->Load();
+
+		glfwLockMutex(m_mutex);
+		m_lLoaded.push_back(pJob);
+		glfwSignalCond(m_loaded);
+	}
+	glfwUnlockMutex(m_mutex);
+}
+
+}
@@ -0,0 +1,95 @@
+//-----------------------------------------------------------------------------
+// File:			W_AssetLoader.h
+// Original Author:	agent
+//
+// Loads assets in the background. A job's Load() runs on one of a pool of
+// worker threads and does the file I/O and decoding; its Finish() then runs on
+// the main thread, from Update(), to do the GL work. Update() only finishes
+// jobs until its time budget is used up, so a frame never stalls for long on
+// uploads.
+//
+// The things being loaded (textures, models) exist from the start as
+// placeholders and fill themselves in when their job finishes. If Init()
+// hasn't been called, jobs are loaded and finished on the spot instead.
+//-----------------------------------------------------------------------------
+#ifndef W_ASSETLOADER_H
+#define W_ASSETLOADER_H
+
+#include "W_Types.h"
+#include <deque>
+#include <vector>
+
+namespace wolf
+{
+class AssetLoader
+{
+	public:
+		//-------------------------------------------------------------------------
+		// PUBLIC TYPES
+		//-------------------------------------------------------------------------
+		class Job
+		{
+			friend class AssetLoader;
+			public:
+				Job() : m_bCancelled(false) {}
+				virtual ~Job() {}
+
+				// Worker thread; must not touch GL or anything the main thread uses
+				virtual void Load() = 0;
+
+				// Main thread; not called if the job was cancelled
+				virtual void Finish() = 0;
+
+				// Main thread only. For when whatever the job is loading goes away
+				// before it's done; the loader still deletes the job.
+				void Cancel() { m_bCancelled = true; }
+
+			private:
+				bool m_bCancelled;
+		};
+		//-------------------------------------------------------------------------
+
+		//-------------------------------------------------------------------------
+		// PUBLIC INTERFACE
+		//-------------------------------------------------------------------------
+		static void Init(unsigned int p_uiNumThreads = 2);
+		static void Shutdown();
+
+		static void Queue(Job* p_pJob);
+		static void Update(double p_dBudget = 0.002);
+		static void FinishAll();
+
+		static bool IsRunning() { return m_bRunning; }
+		static unsigned int GetNumPending() { return m_uiNumPending; }
+		//-------------------------------------------------------------------------
+
+	private:
+		//-------------------------------------------------------------------------
+		// PRIVATE METHODS
+		//-------------------------------------------------------------------------
+		static void GLFWCALL WorkerThread(void* p_pArg);
+		static Job* PopLoaded(bool p_bWait);
+		//-------------------------------------------------------------------------
+
+		//-------------------------------------------------------------------------
+		// PRIVATE MEMBERS
+		//-------------------------------------------------------------------------
+		static bool					m_bRunning;
+		static bool					m_bQuit;
+		static std::vector<GLFWthread>	m_lThreads;
+
+		// Both queues are guarded by the one mutex
+		static GLFWmutex			m_mutex;
+		static GLFWcond				m_toLoad;
+		static GLFWcond				m_loaded;
+		static std::deque<Job*>		m_lToLoad;
+		static std::deque<Job*>		m_lLoaded;
+
+		// Queued but not finished yet; main thread only
+		static unsigned int			m_uiNumPending;
+		//-------------------------------------------------------------------------
+};
+
+}
+
+#endif
@@ -33,6 +33,14 @@ IndexBuffer* BufferManager::CreateIndexBuffer(unsigned int p_uiNumIndices)
 	return new IndexBuffer(p_uiNumIndices);
 }
 
+//----------------------------------------------------------
+// Creates a new Uniform Buffer
+//----------------------------------------------------------
+UniformBuffer* BufferManager::CreateUniformBuffer(unsigned int p_uiLength)
+{
+	return new UniformBuffer(p_uiLength);
+}
+
 //----------------------------------------------------------
 // Destroys a buffer. 
 //----------------------------------------------------------
@@ -14,6 +14,7 @@
 #include "W_Types.h"
 #include "W_VertexBuffer.h"
 #include "W_IndexBuffer.h"
+#include "W_UniformBuffer.h"
 #include <string>
 #include <map>
 
@@ -28,6 +29,7 @@ class BufferManager
 		static VertexBuffer* CreateVertexBuffer(unsigned int p_uiLength);
 		static VertexBuffer* CreateVertexBuffer(const void* p_pData, unsigned int p_uiLength);
 		static IndexBuffer* CreateIndexBuffer(unsigned int p_uiNumIndices);
+		static UniformBuffer* CreateUniformBuffer(unsigned int p_uiLength);
 
 		static void DestroyBuffer(Buffer* p_pBuf);
 		//-------------------------------------------------------------------------
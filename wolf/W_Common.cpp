@@ -6,6 +6,9 @@
 //-----------------------------------------------------------------------------
 #include "W_Common.h"
 #include "W_Types.h"
+#include "W_Material.h"
+#include <algorithm>
+#include <cstring>
 
 namespace wolf
 {
@@ -13,9 +16,10 @@ namespace wolf
 //----------------------------------------------------------
 // Loads in a whole file and returns the contents. User is 
 // responsible for then delete[]-ing the data. Returns 0 if 
-// file not able to be loaded.
+// file not able to be loaded. The size is returned in
+// p_pSize if given (not counting the terminating 0 added).
 //----------------------------------------------------------
-void* LoadWholeFile(const std::string& p_strFile)
+void* LoadWholeFile(const std::string& p_strFile, unsigned int* p_pSize)
 {
 	FILE* fp = fopen(p_strFile.c_str(), "rb");
 	if( !fp )
@@ -30,6 +34,9 @@ void* LoadWholeFile(const std::string& p_strFile)
     pRet[len] = 0;
 	fclose(fp);
 
+	if( p_pSize )
+		*p_pSize = (unsigned int)len;
+
 	return pRet;
 }
 
@@ -295,11 +302,6 @@ struct DDS_TEXTURE
 	DDS_IMAGE image[6];
 };
 
-#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT   0x83F0
-#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT  0x83F1
-#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT  0x83F2
-#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT  0x83F3
-
 bool ImageSpec(DDS_HEADER *ddsh, unsigned int *format,unsigned int *components)
 {
 	assert(format);
@@ -368,70 +370,78 @@ int DDSImageSize(unsigned int w,
 	}
 }
 
+//----------------------------------------------------------
+// Creates a texture from the given DDS file, including its
+// mipmaps. Returns 0 if it can't be loaded.
+//----------------------------------------------------------
 GLuint CreateTextureFromDDS(const std::string& p_strFile, unsigned int* p_pWidth, unsigned int* p_pHeight, bool* p_pHasMips)
 {
-	DDS_TEXTURE dds;
-	memset(&dds, 0, sizeof(dds));
+	unsigned int uiSize = 0;
+	unsigned char* pBuff = (unsigned char*) LoadWholeFile(p_strFile, &uiSize);
+	if( !pBuff )
+	{
+		printf("ERROR: Couldn't load %s\n", p_strFile.c_str());
+		return 0;
+	}
+
+    GLuint uiTex = 0;
+    glGenTextures(1,&uiTex);
+	if( !UploadTextureFromDDS(uiTex, pBuff, uiSize, p_pWidth, p_pHeight, p_pHasMips) )
+	{
+		Material::OnTextureDeleted(uiTex);
+		glDeleteTextures(1,&uiTex);
+		uiTex = 0;
+	}
 
-	unsigned char* pBuff = (unsigned char*) LoadWholeFile(p_strFile);
-	unsigned char* pStart = pBuff;
+	delete[] pBuff;
+    return uiTex;
+}
+
+//----------------------------------------------------------
+// Finds the format, size and mip levels of the given DDS
+// file contents, already in ram. Only flat, compressed
+// (DXT1/3/5) textures are handled. Returns false if it isn't
+// one of those, or is cut short.
+//----------------------------------------------------------
+bool ParseDDS(const void* p_pData, unsigned int p_uiSize, DDSInfo& p_info)
+{
+	const unsigned char* pBuff = (const unsigned char*) p_pData;
 
 	// read in file marker, make sure its a DDS file
-	if(strncmp((char*)pBuff,"DDS ",4)!=0)
+	if( p_uiSize < 4 + sizeof(DDS_HEADER) || strncmp((const char*)pBuff,"DDS ",4)!=0 )
 	{
-		printf("%s is not a dds file", p_strFile.c_str());
-		return 0;
+		printf("ERROR: not a dds file\n");
+		return false;
 	}
 	pBuff+=4;  //skip over header 
 
 	//read the dds header data
-	DDS_HEADER* ddsh;
-
-	ddsh=(DDS_HEADER*)pBuff;
+	DDS_HEADER ddsh;
+	memcpy(&ddsh, pBuff, sizeof(DDS_HEADER));
 	pBuff+=sizeof(DDS_HEADER);
 
-	TextureType type = TextureFlat;
-	if (ddsh->dwCaps2 & DDSF_CUBEMAP)	type = TextureCubemap;
-
 	// check if image is a volume texture
-	if ((ddsh->dwCaps2 & DDSF_VOLUME) && (ddsh->dwDepth > 0))
+	if ((ddsh.dwCaps2 & DDSF_VOLUME) && (ddsh.dwDepth > 0))
 	{
-		printf("ERROR: %s is a volume texture ", p_strFile.c_str());
-		return 0;
+		printf("ERROR: volume dds textures not supported\n");
+		return false;
 	}
 	        
-	// get the format of the image
+	//get the texture format and number of color channels
 	unsigned int	format;
 	unsigned int	components;
+	if( !ImageSpec(&ddsh,&format,&components) || !(ddsh.ddspf.dwFlags & DDSF_FOURCC) )
+		return false;
 
-	//get the texture format and number of color channels
-	ImageSpec(ddsh,&format,&components);
-
-	unsigned int width, height;
-	width = ddsh->dwWidth;
-	height = ddsh->dwHeight;
-
-	dds.buffer		= (unsigned char*)pStart;
-	dds.format		= format;
-	dds.components	= components;
-	dds.height		= height;
-	dds.width		= width;
-
-	if(ddsh->dwMipMapCount==0) ddsh->dwMipMapCount++;
-
-	dds.mips		= ddsh->dwMipMapCount;
-	dds.surfaces	= 1;
-
-    GLuint uiTex = 0;
-    glGenTextures(1,&uiTex);
-    glBindTexture(GL_TEXTURE_2D,uiTex);
-	GL_CHECK_ERROR();
-
-	int iWidth = dds.width;
-	int iHeight = dds.height;
-	unsigned char* pData = pBuff;
+	p_info.m_eFormat = format;
+	p_info.m_uiWidth = ddsh.dwWidth;
+	p_info.m_uiHeight = ddsh.dwHeight;
+	p_info.m_uiNumMips = ddsh.dwMipMapCount == 0 ? 1 : std::min(ddsh.dwMipMapCount, (unsigned int)DDSInfo::MAX_MIPS);
 
-	for( unsigned int iMipLevel = 0; iMipLevel < dds.mips; iMipLevel++ )
+	const unsigned char* pEnd = (const unsigned char*)p_pData + p_uiSize;
+	unsigned int iWidth = ddsh.dwWidth;
+	unsigned int iHeight = ddsh.dwHeight;
+	for( unsigned int iMipLevel = 0; iMipLevel < p_info.m_uiNumMips; iMipLevel++ )
 	{
 		if( iWidth == 0 )
 			iWidth = 1;
@@ -439,26 +449,55 @@ GLuint CreateTextureFromDDS(const std::string& p_strFile, unsigned int* p_pWidth
 			iHeight = 1;
 
 		unsigned int size = DDSImageSize(iWidth,iHeight,components,format);
+		if( size > (unsigned int)(pEnd - pBuff) )
+		{
+			printf("ERROR: dds file is cut short\n");
+			return false;
+		}
+
+		p_info.m_apMips[iMipLevel] = pBuff;
+		p_info.m_auiMipSizes[iMipLevel] = size;
+
+        iWidth /= 2;
+		iHeight /= 2;
+		pBuff += size;
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------
+// Uploads the given DDS file contents, already in ram, into
+// the given texture, including its mipmaps. Split out of
+// CreateTextureFromDDS() so files can be read off the main
+// thread. Returns false if it isn't a DDS we can handle.
+//----------------------------------------------------------
+bool UploadTextureFromDDS(GLuint p_uiTex, const void* p_pData, unsigned int p_uiSize, unsigned int* p_pWidth, unsigned int* p_pHeight, bool* p_pHasMips)
+{
+	DDSInfo dds;
+	if( !ParseDDS(p_pData, p_uiSize, dds) )
+		return false;
+
+    glBindTexture(GL_TEXTURE_2D,p_uiTex);
+	Material::OnTextureBound(p_uiTex);
+	GL_CHECK_ERROR();
 
+	for( unsigned int iMipLevel = 0; iMipLevel < dds.m_uiNumMips; iMipLevel++ )
+	{
 		//Start fill our texture
 		glCompressedTexImage2D(
 				GL_TEXTURE_2D,
 				iMipLevel, 
-				format,
-				iWidth,
-				iHeight,
+				dds.m_eFormat,
+				dds.GetMipWidth(iMipLevel),
+				dds.GetMipHeight(iMipLevel),
 				0,
-				size,
-				pData);
+				dds.m_auiMipSizes[iMipLevel],
+				dds.m_apMips[iMipLevel]);
 		GL_CHECK_ERROR();
-
-        iWidth /= 2;
-		iHeight /= 2;
-        
-		pData += size;
 	}
 
-	if( dds.mips > 1 )
+	if( dds.m_uiNumMips > 1 )
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 	else
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -467,12 +506,99 @@ GLuint CreateTextureFromDDS(const std::string& p_strFile, unsigned int* p_pWidth
 	GL_CHECK_ERROR();
 	
 	if( p_pWidth )
-		*p_pWidth = dds.width;
+		*p_pWidth = dds.m_uiWidth;
 	if( p_pHeight )
-		*p_pHeight = dds.height;
+		*p_pHeight = dds.m_uiHeight;
 	if( p_pHasMips )
-		*p_pHasMips = dds.mips > 1;
+		*p_pHasMips = dds.m_uiNumMips > 1;
 
-    return uiTex;
+    return true;
+}
+
+//----------------------------------------------------------
+// Writes a flat, compressed DDS file with the given mip
+// levels, largest first. p_eFormat is one of the DXT1/3/5
+// GL formats.
+//----------------------------------------------------------
+bool SaveDDS(const std::string& p_strFile, GLenum p_eFormat, unsigned int p_uiWidth, unsigned int p_uiHeight, const std::vector<std::vector<unsigned char> >& p_lMips)
+{
+	DDS_HEADER ddsh;
+	memset(&ddsh, 0, sizeof(ddsh));
+	ddsh.dwSize = sizeof(DDS_HEADER);
+	ddsh.dwFlags = DDSF_CAPS | DDSF_HEIGHT | DDSF_WIDTH | DDSF_PIXELFORMAT | DDSF_MIPMAPCOUNT | DDSF_LINEARSIZE;
+	ddsh.dwHeight = p_uiHeight;
+	ddsh.dwWidth = p_uiWidth;
+	ddsh.dwPitchOrLinearSize = p_lMips.empty() ? 0 : p_lMips[0].size();
+	ddsh.dwMipMapCount = p_lMips.size();
+	ddsh.ddspf.dwSize = sizeof(DDS_PIXELFORMAT);
+	ddsh.ddspf.dwFlags = DDSF_FOURCC;
+	ddsh.dwCaps1 = DDSF_TEXTURE | (p_lMips.size() > 1 ? DDSF_MIPMAP | DDSF_COMPLEX : 0);
+
+	switch( p_eFormat )
+	{
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:	ddsh.ddspf.dwFourCC = FOURCC_DXT1; break;
+		case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:	ddsh.ddspf.dwFourCC = FOURCC_DXT3; break;
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:	ddsh.ddspf.dwFourCC = FOURCC_DXT5; break;
+		default:
+			printf("ERROR: can only save compressed dds files\n");
+			return false;
+	}
+
+	FILE* fp = fopen(p_strFile.c_str(), "wb");
+	if( !fp )
+		return false;
+
+	bool bOK = fwrite("DDS ", 1, 4, fp) == 4 && fwrite(&ddsh, sizeof(ddsh), 1, fp) == 1;
+	for( unsigned int i = 0; i < p_lMips.size() && bOK; i++ )
+		bOK = fwrite(&p_lMips[i][0], 1, p_lMips[i].size(), fp) == p_lMips[i].size();
+	fclose(fp);
+	return bOK;
+}
+
+//----------------------------------------------------------
+// Reads the given TGA file into p_lPixels as 8 bit RGBA,
+// bottom row first like GL expects. p_iFlags are passed to
+// glfwReadImage(). Returns false if it can't be read.
+//----------------------------------------------------------
+bool ReadImageRGBA(const std::string& p_strFile, int p_iFlags, unsigned int* p_pWidth, unsigned int* p_pHeight, std::vector<unsigned char>& p_lPixels)
+{
+	GLFWimage img;
+	if( glfwReadImage(p_strFile.c_str(), &img, p_iFlags) != GL_TRUE )
+		return false;
+
+	*p_pWidth = img.Width;
+	*p_pHeight = img.Height;
+	p_lPixels.resize(img.Width * img.Height * 4);
+
+	for( int i = 0; i < img.Width * img.Height; i++ )
+	{
+		const unsigned char* pSrc = img.Data + i * img.BytesPerPixel;
+		unsigned char* pDest = &p_lPixels[i * 4];
+		switch( img.BytesPerPixel )
+		{
+			case 1:
+				if( img.Format == GL_ALPHA )
+				{
+					pDest[0] = pDest[1] = pDest[2] = 255;
+					pDest[3] = pSrc[0];
+				}
+				else
+				{
+					pDest[0] = pDest[1] = pDest[2] = pSrc[0];
+					pDest[3] = 255;
+				}
+				break;
+			case 3:
+				memcpy(pDest, pSrc, 3);
+				pDest[3] = 255;
+				break;
+			default:
+				memcpy(pDest, pSrc, 4);
+				break;
+		}
+	}
+
+	glfwFreeImage(&img);
+	return true;
 }
 }
@@ -9,6 +9,14 @@
 
 #include "W_Types.h"
 #include <string>
+#include <vector>
+
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT   0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT  0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT  0x83F2
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT  0x83F3
+#endif
 
 #ifdef DEBUG
 #define GL_CHECK_ERROR() { GLenum e = glGetError(); if( e != GL_NO_ERROR ) { printf("GL ERROR: %x\n", e); } }
@@ -21,13 +29,35 @@ namespace wolf
 {
 // Loads in a whole file and returns the contents. User is responsible for then
 // delete[]-ing the data. Returns 0 if file not able to be loaded.
-void* LoadWholeFile(const std::string& p_strFile);
+void* LoadWholeFile(const std::string& p_strFile, unsigned int* p_pSize = 0);
 
 // Loads in a vertex and pixel shader and combines them into a program
 GLuint LoadShaders(const std::string& p_strVSFile, const std::string& p_strPSFile);
 
 bool LoadTGA(const std::string& p_strFile, unsigned int* p_pWidth, unsigned int* p_pHeight, unsigned char** p_ppData);
 GLuint CreateTextureFromDDS(const std::string& p_strFile, unsigned int* p_pWidth = 0, unsigned int* p_pHeight = 0, bool* p_pHasMips = 0);
+bool UploadTextureFromDDS(GLuint p_uiTex, const void* p_pData, unsigned int p_uiSize, unsigned int* p_pWidth = 0, unsigned int* p_pHeight = 0, bool* p_pHasMips = 0);
+
+// Where the mip levels of a compressed DDS file are, pointing into its contents
+struct DDSInfo
+{
+	static const unsigned int MAX_MIPS = 16;
+
+	GLenum					m_eFormat;
+	unsigned int			m_uiWidth;
+	unsigned int			m_uiHeight;
+	unsigned int			m_uiNumMips;
+	const unsigned char*	m_apMips[MAX_MIPS];
+	unsigned int			m_auiMipSizes[MAX_MIPS];
+
+	unsigned int GetMipWidth(unsigned int p_uiMip) const { return (m_uiWidth >> p_uiMip) > 0 ? (m_uiWidth >> p_uiMip) : 1; }
+	unsigned int GetMipHeight(unsigned int p_uiMip) const { return (m_uiHeight >> p_uiMip) > 0 ? (m_uiHeight >> p_uiMip) : 1; }
+};
+bool ParseDDS(const void* p_pData, unsigned int p_uiSize, DDSInfo& p_info);
+bool SaveDDS(const std::string& p_strFile, GLenum p_eFormat, unsigned int p_uiWidth, unsigned int p_uiHeight, const std::vector<std::vector<unsigned char> >& p_lMips);
+
+// Reads a TGA as 8 bit RGBA, bottom row first
+bool ReadImageRGBA(const std::string& p_strFile, int p_iFlags, unsigned int* p_pWidth, unsigned int* p_pHeight, std::vector<unsigned char>& p_lPixels);
 }
 
 #endif
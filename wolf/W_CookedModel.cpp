@@ -0,0 +1,576 @@
+//-----------------------------------------------------------------------------
+// File:			W_CookedModel.cpp
+// Original Author:	agent
+// POD reading moved here from Gordon Wood's W_Model.cpp
+//
+// See header for notes
+//-----------------------------------------------------------------------------
+#include "W_CookedModel.h"
+#include "PVRTModelPOD.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+namespace wolf
+{
+static ComponentType gs_aPODTypeMap[] =
+{
+    wolf::CT_Invalid,   //EPODDataNone,
+	wolf::CT_Float,		//EPODDataFloat,
+	wolf::CT_Int,		//EPODDataInt,
+	wolf::CT_UShort,	//EPODDataUnsignedShort,
+	wolf::CT_UByte4,	//EPODDataRGBA,
+	wolf::CT_UByte4,	//EPODDataARGB,
+	wolf::CT_UByte4,	//EPODDataD3DCOLOR,
+	wolf::CT_UByte4,	//EPODDataUBYTE4,
+	wolf::CT_Invalid,	//EPODDataDEC3N,
+	wolf::CT_Invalid,	//EPODDataFixed16_16,
+	wolf::CT_UByte,		//EPODDataUnsignedByte,
+	wolf::CT_Short,		//EPODDataShort,
+	wolf::CT_ShortNorm,	//EPODDataShortNorm,
+	wolf::CT_Byte,		//EPODDataByte,
+	wolf::CT_ByteNorm,	//EPODDataByteNorm,
+	wolf::CT_UByteNorm, //EPODDataUnsignedByteNorm,
+	wolf::CT_UShortNorm, //EPODDataUnsignedShortNorm,
+	wolf::CT_UInt,		//EPODDataUnsignedInt
+};
+
+static const char gs_acMagic[4] = { 'W', 'M', 'D', 'L' };
+
+//----------------------------------------------------------
+// Adds an attribute to the given mesh if the POD has it
+//----------------------------------------------------------
+static void AddAttribute(CookedModel::Mesh& p_mesh, wolf::Attribute p_attr, const CPODData& p_data)
+{
+	if( p_data.n == 0 )
+		return;
+
+	CookedModel::Attribute& attr = p_mesh.m_aAttributes[p_mesh.m_uiNumAttributes++];
+	attr.m_uiAttribute = p_attr;
+	attr.m_uiType = gs_aPODTypeMap[p_data.eType];
+	attr.m_iNumComponents = p_data.n;
+	// Interleaved data keeps the offset into the vertex in the pointer
+	attr.m_iOffset = (int)(size_t)p_data.pData;
+}
+
+//----------------------------------------------------------
+// Copies the given texture's file name into p_szOut, with
+// the extension changed to match our TGA converted files
+//----------------------------------------------------------
+static void CopyTextureName(char* p_szOut, const CPVRTModelPOD& p_pod, int p_iTexture)
+{
+	p_szOut[0] = 0;
+	if( p_iTexture == -1 )
+		return;
+
+	std::string strFilename = p_pod.pTexture[p_iTexture].pszName;
+	if( strFilename.find(".jpg") != std::string::npos )
+		strFilename = strFilename.substr(0,strFilename.find(".jpg")) + std::string(".tga");
+	else if( strFilename.find(".png") != std::string::npos )
+		strFilename = strFilename.substr(0,strFilename.find(".png")) + std::string(".tga");
+
+	strncpy(p_szOut, strFilename.c_str(), CookedModel::s_uiMaxNameLength - 1);
+	p_szOut[CookedModel::s_uiMaxNameLength - 1] = 0;
+}
+
+//----------------------------------------------------------
+// Constructor. Starts out as an empty model.
+//----------------------------------------------------------
+CookedModel::CookedModel()
+{
+	Clear();
+}
+
+//----------------------------------------------------------
+// Returns the name the cooked version of the given POD file
+// is saved under
+//----------------------------------------------------------
+std::string CookedModel::GetCookedFileName(const std::string& p_strPODFile)
+{
+	std::string::size_type uiDot = p_strPODFile.rfind('.');
+	if( uiDot == std::string::npos || p_strPODFile.find_first_of("/\\", uiDot) != std::string::npos )
+		return p_strPODFile + ".wmdl";
+	return p_strPODFile.substr(0, uiDot) + ".wmdl";
+}
+
+//----------------------------------------------------------
+// Cooks the given POD file and saves the result. This is the
+// offline step; returns false if either file can't be used.
+//----------------------------------------------------------
+bool CookedModel::CookFile(const std::string& p_strPODFile, const std::string& p_strFile)
+{
+	CookedModel cooked;
+	return cooked.Cook(p_strPODFile) && cooked.Save(p_strFile);
+}
+
+//----------------------------------------------------------
+// Cooks each of the given POD files that doesn't have an up
+// to date (and readable) cooked version. Returns how many it
+// did.
+//----------------------------------------------------------
+unsigned int CookedModel::CookStale(const std::vector<std::string>& p_lPODFiles)
+{
+	unsigned int uiCooked = 0;
+	for( unsigned int i = 0; i < p_lPODFiles.size(); i++ )
+	{
+		std::string strCooked = GetCookedFileName(p_lPODFiles[i]);
+		CookedModel existing;
+		if( existing.Load(strCooked, p_lPODFiles[i]) )
+			continue;
+
+		if( CookFile(p_lPODFiles[i], strCooked) )
+			uiCooked++;
+		else
+			printf("ERROR: Couldn't cook model - %s!\n", p_lPODFiles[i].c_str());
+	}
+	return uiCooked;
+}
+
+//----------------------------------------------------------
+// Maps in the given cooked file. If a source file is given
+// and it's newer than the cooked one, the cooked one is
+// considered stale and not loaded. Returns false (leaving
+// this empty) if the file is missing, stale or not one we
+// can read.
+//----------------------------------------------------------
+bool CookedModel::Load(const std::string& p_strFile, const std::string& p_strSourceFile)
+{
+	Clear();
+
+	if( !p_strSourceFile.empty() )
+	{
+		struct stat cookedStat, sourceStat;
+		if( stat(p_strFile.c_str(), &cookedStat) != 0 )
+			return false;
+		if( stat(p_strSourceFile.c_str(), &sourceStat) == 0 && sourceStat.st_mtime > cookedStat.st_mtime )
+			return false;
+	}
+
+	if( !m_file.Open(p_strFile) )
+		return false;
+
+	m_pData = (const char*)m_file.GetData();
+	m_uiSize = m_file.GetSize();
+
+	if( !Validate() )
+	{
+		Clear();
+		return false;
+	}
+	return true;
+}
+
+//----------------------------------------------------------
+// Reads and cooks the given POD file in memory. Returns false
+// (leaving this empty) if it can't be read.
+//----------------------------------------------------------
+bool CookedModel::Cook(const std::string& p_strPODFile)
+{
+	Clear();
+
+	CPVRTModelPOD pod;
+	if( pod.ReadFromFile(p_strPODFile.c_str()) != PVR_SUCCESS )
+		return false;
+
+	Cook(pod);
+	return true;
+}
+
+//----------------------------------------------------------
+// Writes the data out to the given file. Someone else may be
+// cooking or loading the same model at once, so it's written
+// to a temp file first and renamed into place. Whoever
+// renames last wins, and a reader only ever sees a whole file.
+//----------------------------------------------------------
+bool CookedModel::Save(const std::string& p_strFile) const
+{
+	// Our address keeps the name unique among live writers
+	char szSuffix[32];
+	sprintf(szSuffix, ".%p.tmp", (const void*)this);
+	std::string strTemp = p_strFile + szSuffix;
+
+	FILE* fp = fopen(strTemp.c_str(), "wb");
+	if( !fp )
+		return false;
+
+	bool bOK = fwrite(m_pData, 1, m_uiSize, fp) == m_uiSize;
+	if( fclose(fp) != 0 )
+		bOK = false;
+
+#ifdef _WIN32
+	// rename() won't replace an existing file on Windows. This fails if the
+	// old file is mapped, which is fine as it's complete anyway.
+	if( bOK )
+		bOK = MoveFileExA(strTemp.c_str(), p_strFile.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	if( bOK )
+		bOK = rename(strTemp.c_str(), p_strFile.c_str()) == 0;
+#endif
+
+	if( !bOK )
+		remove(strTemp.c_str());
+	return bOK;
+}
+
+//----------------------------------------------------------
+// Trades data with the given model. Data pointers stay valid
+// since neither the mapping nor the cooked vector moves.
+//----------------------------------------------------------
+void CookedModel::Swap(CookedModel& p_other)
+{
+	std::swap(m_pData, p_other.m_pData);
+	std::swap(m_uiSize, p_other.m_uiSize);
+	m_file.Swap(p_other.m_file);
+	m_lCookedData.swap(p_other.m_lCookedData);
+}
+
+//----------------------------------------------------------
+// Returns the given node's world matrix at the given frame,
+// blending between the two frames either side of it
+//----------------------------------------------------------
+glm::mat4 CookedModel::GetNodeWorld(unsigned int p_uiNode, float p_fFrame) const
+{
+	const Header& header = GetHeader();
+	const glm::mat4* pFrames = Get<glm::mat4>(header.m_uiFramesOffset);
+
+	unsigned int uiFrame = p_fFrame > 0.0f ? (unsigned int)p_fFrame : 0;
+	if( uiFrame + 1 >= header.m_uiNumBakedFrames )
+		return pFrames[(header.m_uiNumBakedFrames - 1) * header.m_uiNumNodes + p_uiNode];
+
+	float fBlend = p_fFrame - uiFrame;
+	const glm::mat4& mFrom = pFrames[uiFrame * header.m_uiNumNodes + p_uiNode];
+	if( fBlend == 0.0f )
+		return mFrom;
+
+	const glm::mat4& mTo = pFrames[(uiFrame + 1) * header.m_uiNumNodes + p_uiNode];
+	return mFrom + (mTo - mFrom) * fBlend;
+}
+
+//----------------------------------------------------------
+// Drops whatever we had and becomes an empty model
+//----------------------------------------------------------
+void CookedModel::Clear()
+{
+	m_file.Close();
+
+	m_lCookedData.clear();
+	Append(0, sizeof(Header));
+
+	// One identity frame so there's always something to return
+	glm::mat4 mIdentity;
+	unsigned int uiFramesOffset = Append(&mIdentity, sizeof(mIdentity));
+
+	Header* pHeader = (Header*)&m_lCookedData[0];
+	memcpy(pHeader->m_acMagic, gs_acMagic, sizeof(gs_acMagic));
+	pHeader->m_uiVersion = s_uiVersion;
+	pHeader->m_uiMeshesOffset = pHeader->m_uiNodesOffset = pHeader->m_uiMaterialsOffset = sizeof(Header);
+	pHeader->m_uiNumBakedFrames = 1;
+	pHeader->m_uiFramesOffset = uiFramesOffset;
+
+	m_pData = &m_lCookedData[0];
+	m_uiSize = m_lCookedData.size();
+}
+
+//----------------------------------------------------------
+// Adds the given data to the end of the cooked data, padded
+// to keep everything 4 byte aligned, and returns its offset.
+// Passing no data reserves zeroed space.
+//----------------------------------------------------------
+unsigned int CookedModel::Append(const void* p_pData, unsigned int p_uiLength)
+{
+	unsigned int uiOffset = m_lCookedData.size();
+	m_lCookedData.resize(uiOffset + ((p_uiLength + 3) & ~3), 0);
+	if( p_pData && p_uiLength > 0 )
+		memcpy(&m_lCookedData[uiOffset], p_pData, p_uiLength);
+	return uiOffset;
+}
+
+//----------------------------------------------------------
+// Returns true if the data looks like a cooked model of the
+// current version and all its tables are in bounds
+//----------------------------------------------------------
+bool CookedModel::Validate() const
+{
+	if( m_uiSize < sizeof(Header) )
+		return false;
+
+	const Header& header = GetHeader();
+	if( memcmp(header.m_acMagic, gs_acMagic, sizeof(gs_acMagic)) != 0 || header.m_uiVersion != s_uiVersion )
+		return false;
+
+	if( header.m_uiNumBakedFrames == 0 || header.m_uiNumMeshNodes > header.m_uiNumNodes )
+		return false;
+
+	if( !InRange(header.m_uiMeshesOffset, header.m_uiNumMeshes, sizeof(Mesh)) ||
+		!InRange(header.m_uiNodesOffset, header.m_uiNumNodes, sizeof(Node)) ||
+		!InRange(header.m_uiMaterialsOffset, header.m_uiNumMaterials, sizeof(Material)) ||
+		!InRange(header.m_uiFramesOffset, (unsigned long long)header.m_uiNumNodes * header.m_uiNumBakedFrames, sizeof(glm::mat4)) )
+		return false;
+
+	for( unsigned int i = 0; i < header.m_uiNumMeshes; i++ )
+	{
+		if( !ValidateMesh(GetMesh(i)) )
+			return false;
+	}
+
+	for( unsigned int i = 0; i < header.m_uiNumNodes; i++ )
+	{
+		const Node& node = GetNode(i);
+		if( node.m_iMesh < -1 || node.m_iMesh >= (int)header.m_uiNumMeshes ||
+			node.m_iMaterial < -1 || node.m_iMaterial >= (int)header.m_uiNumMaterials )
+			return false;
+	}
+
+	// The names are used as C strings
+	for( unsigned int i = 0; i < header.m_uiNumMaterials; i++ )
+	{
+		const Material& mat = GetMaterial(i);
+		if( !memchr(mat.m_szName, 0, s_uiMaxNameLength) || !memchr(mat.m_szDiffuse, 0, s_uiMaxNameLength) || !memchr(mat.m_szSpecular, 0, s_uiMaxNameLength) )
+			return false;
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------
+// Checks one mesh's data, bone batches and bones all lie in
+// the file and that nothing indexes past what it refers to
+//----------------------------------------------------------
+bool CookedModel::ValidateMesh(const Mesh& p_mesh) const
+{
+	const Header& header = GetHeader();
+
+	if( p_mesh.m_uiVertexStride == 0 || p_mesh.m_uiNumAttributes > AT_NUM_ATTRIBS || p_mesh.m_uiNumIndices % 3 != 0 )
+		return false;
+	if( !InRange(p_mesh.m_uiVertexOffset, p_mesh.m_uiVertexSize, 1) || !InRange(p_mesh.m_uiIndexOffset, p_mesh.m_uiNumIndices, sizeof(unsigned short)) )
+		return false;
+
+	for( unsigned int i = 0; i < p_mesh.m_uiNumAttributes; i++ )
+	{
+		const Attribute& attr = p_mesh.m_aAttributes[i];
+		if( attr.m_uiAttribute >= AT_NUM_ATTRIBS || attr.m_iOffset < 0 || (unsigned int)attr.m_iOffset >= p_mesh.m_uiVertexStride )
+			return false;
+	}
+
+	// GL would read past the vertex buffer for these
+	unsigned int uiNumVertices = p_mesh.m_uiVertexSize / p_mesh.m_uiVertexStride;
+	const unsigned short* pIndices = (const unsigned short*)GetIndexData(p_mesh);
+	for( unsigned int i = 0; i < p_mesh.m_uiNumIndices; i++ )
+	{
+		if( pIndices[i] >= uiNumVertices )
+			return false;
+	}
+
+	if( !InRange(p_mesh.m_uiBoneBatchesOffset, p_mesh.m_uiNumBoneBatches, sizeof(BoneBatch)) )
+		return false;
+
+	for( unsigned int i = 0; i < p_mesh.m_uiNumBoneBatches; i++ )
+	{
+		const BoneBatch& batch = GetBoneBatch(p_mesh, i);
+		if( (unsigned long long)batch.m_uiFirstTriangle + batch.m_uiNumTriangles > p_mesh.m_uiNumIndices / 3 )
+			return false;
+		if( !InRange(batch.m_uiBonesOffset, batch.m_uiNumBones, sizeof(Bone)) )
+			return false;
+
+		for( unsigned int j = 0; j < batch.m_uiNumBones; j++ )
+		{
+			if( GetBone(batch, j).m_uiNode >= header.m_uiNumNodes )
+				return false;
+		}
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------
+// Returns whether p_uiCount items of p_uiItemSize bytes from
+// the given offset fit in the data. Done in 64 bits so a
+// corrupt count can't wrap around.
+//----------------------------------------------------------
+bool CookedModel::InRange(unsigned int p_uiOffset, unsigned long long p_uiCount, unsigned int p_uiItemSize) const
+{
+	if( p_uiOffset > m_uiSize || p_uiOffset % 4 != 0 )
+		return false;
+	return p_uiCount * p_uiItemSize <= m_uiSize - p_uiOffset;
+}
+
+//----------------------------------------------------------
+// Builds the cooked data from the given loaded POD
+//----------------------------------------------------------
+void CookedModel::Cook(CPVRTModelPOD& p_pod)
+{
+	m_file.Close();
+	m_lCookedData.clear();
+	Append(0, sizeof(Header));
+
+	Header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.m_acMagic, gs_acMagic, sizeof(gs_acMagic));
+	header.m_uiVersion = s_uiVersion;
+	header.m_uiNumMeshes = p_pod.nNumMesh;
+	header.m_uiNumNodes = p_pod.nNumNode;
+	header.m_uiNumMeshNodes = p_pod.nNumMeshNode;
+	header.m_uiNumMaterials = p_pod.nNumMaterial;
+	header.m_uiNumFrames = p_pod.nNumFrame;
+	header.m_uiNumBakedFrames = p_pod.nNumFrame > 0 ? p_pod.nNumFrame : 1;
+
+	// Bake every node's world matrix for every frame
+	std::vector<glm::mat4> lFrames(header.m_uiNumBakedFrames * header.m_uiNumNodes);
+	for( unsigned int f = 0; f < header.m_uiNumBakedFrames; f++ )
+	{
+		p_pod.SetFrame((float)f);
+		for( unsigned int n = 0; n < header.m_uiNumNodes; n++ )
+			p_pod.GetWorldMatrix(*((PVRTMATRIX*)glm::value_ptr(lFrames[f * header.m_uiNumNodes + n])), p_pod.pNode[n]);
+	}
+	p_pod.SetFrame(0.0f);
+
+	// Vertex and index data, then bone tables, for every mesh
+	std::vector<Mesh> lMeshes(header.m_uiNumMeshes);
+	for( unsigned int i = 0; i < header.m_uiNumMeshes; i++ )
+	{
+		SPODMesh* pPODMesh = &p_pod.pMesh[i];
+		Mesh& mesh = lMeshes[i];
+		memset(&mesh, 0, sizeof(mesh));
+
+		mesh.m_uiVertexSize = pPODMesh->nNumVertex * pPODMesh->sVertex.nStride;
+		mesh.m_uiVertexStride = pPODMesh->sVertex.nStride;
+		mesh.m_uiVertexOffset = Append(pPODMesh->pInterleaved, mesh.m_uiVertexSize);
+		mesh.m_uiNumIndices = pPODMesh->nNumFaces * 3;
+		mesh.m_uiIndexOffset = Append(pPODMesh->sFaces.pData, mesh.m_uiNumIndices * sizeof(GLushort));
+
+		// We'll always have a position
+		AddAttribute(mesh, wolf::AT_Position, pPODMesh->sVertex);
+		AddAttribute(mesh, wolf::AT_Normal, pPODMesh->sNormals);
+		for( unsigned int x = 0; x < pPODMesh->nNumUVW; x++ )
+			AddAttribute(mesh, (wolf::Attribute)(wolf::AT_TexCoord1 + x), pPODMesh->psUVW[x]);
+		AddAttribute(mesh, wolf::AT_Color, pPODMesh->sVtxColours);
+		AddAttribute(mesh, wolf::AT_BoneIndices, pPODMesh->sBoneIdx);
+		AddAttribute(mesh, wolf::AT_BoneWeight, pPODMesh->sBoneWeight);
+
+		if( pPODMesh->sBoneIdx.n == 0 )
+			continue;
+
+		header.m_uiSkinned = 1;
+
+		const CPVRTBoneBatches& batches = pPODMesh->sBoneBatches;
+		std::vector<BoneBatch> lBatches(batches.nBatchCnt);
+		for( int b = 0; b < batches.nBatchCnt; b++ )
+		{
+			BoneBatch& batch = lBatches[b];
+			batch.m_uiFirstTriangle = batches.pnBatchOffset[b];
+			if( b + 1 < batches.nBatchCnt )
+				batch.m_uiNumTriangles = batches.pnBatchOffset[b + 1] - batches.pnBatchOffset[b];
+			else
+				batch.m_uiNumTriangles = pPODMesh->nNumFaces - batches.pnBatchOffset[b];
+			batch.m_uiNumBones = batches.pnBatchBoneCnt[b];
+
+			// The bind offset is relative to whichever node uses this mesh
+			const glm::mat4* pMeshNodeBind = 0;
+			for( unsigned int n = 0; n < header.m_uiNumMeshNodes; n++ )
+			{
+				if( p_pod.pNode[n].nIdx == (int)i )
+				{
+					pMeshNodeBind = &lFrames[n];
+					break;
+				}
+			}
+
+			std::vector<Bone> lBones(batch.m_uiNumBones);
+			for( unsigned int x = 0; x < batch.m_uiNumBones; x++ )
+			{
+				Bone& bone = lBones[x];
+				bone.m_uiNode = batches.pnBatches[b * batches.nBatchBoneMax + x];
+				bone.m_mBindOffset = glm::inverse(lFrames[bone.m_uiNode]);
+				if( pMeshNodeBind )
+					bone.m_mBindOffset = bone.m_mBindOffset * *pMeshNodeBind;
+			}
+			batch.m_uiBonesOffset = lBones.empty() ? 0 : Append(&lBones[0], lBones.size() * sizeof(Bone));
+		}
+
+		mesh.m_uiNumBoneBatches = lBatches.size();
+		mesh.m_uiBoneBatchesOffset = lBatches.empty() ? 0 : Append(&lBatches[0], lBatches.size() * sizeof(BoneBatch));
+	}
+
+	std::vector<Node> lNodes(header.m_uiNumNodes);
+	for( unsigned int i = 0; i < header.m_uiNumNodes; i++ )
+	{
+		lNodes[i].m_iMesh = i < header.m_uiNumMeshNodes ? p_pod.pNode[i].nIdx : -1;
+		lNodes[i].m_iMaterial = p_pod.pNode[i].nIdxMaterial;
+	}
+
+	std::vector<Material> lMaterials(header.m_uiNumMaterials);
+	for( unsigned int i = 0; i < header.m_uiNumMaterials; i++ )
+	{
+		SPODMaterial* pPODMat = &p_pod.pMaterial[i];
+		Material& mat = lMaterials[i];
+		strncpy(mat.m_szName, pPODMat->pszName, s_uiMaxNameLength - 1);
+		mat.m_szName[s_uiMaxNameLength - 1] = 0;
+		CopyTextureName(mat.m_szDiffuse, p_pod, pPODMat->nIdxTexDiffuse);
+		CopyTextureName(mat.m_szSpecular, p_pod, pPODMat->nIdxTexSpecularColour);
+	}
+
+	// Model space bounds of the first frame. Skinned and animated models move
+	// away from that pose, so their box is grown to cover it turning any way,
+	// with some room to spare for skinned ones.
+	bool bFirst = true;
+	glm::vec3 vMin(0.0f), vMax(0.0f);
+	for( unsigned int i = 0; i < header.m_uiNumMeshNodes; i++ )
+	{
+		if( lNodes[i].m_iMesh == -1 )
+			continue;
+
+		SPODMesh* pPODMesh = &p_pod.pMesh[lNodes[i].m_iMesh];
+		if( pPODMesh->sVertex.eType != EPODDataFloat || pPODMesh->sVertex.n < 3 || pPODMesh->pInterleaved == 0 )
+			continue;
+
+		const glm::mat4& mNode = lFrames[i];
+		const PVRTuint8* pPositions = pPODMesh->pInterleaved + (size_t)pPODMesh->sVertex.pData;
+		for( unsigned int v = 0; v < pPODMesh->nNumVertex; v++ )
+		{
+			const float* pPos = (const float*)(pPositions + v * pPODMesh->sVertex.nStride);
+			glm::vec3 vPos(mNode * glm::vec4(pPos[0], pPos[1], pPos[2], 1.0f));
+
+			if( bFirst )
+			{
+				vMin = vMax = vPos;
+				bFirst = false;
+			}
+			else
+			{
+				vMin = glm::min(vMin, vPos);
+				vMax = glm::max(vMax, vPos);
+			}
+		}
+	}
+
+	if( header.m_uiSkinned || header.m_uiNumFrames > 1 )
+	{
+		glm::vec3 vCenter = (vMin + vMax) * 0.5f;
+		float fRadius = glm::length(vMax - vCenter);
+		if( header.m_uiSkinned )
+			fRadius *= 1.5f;
+
+		vMin = vCenter - glm::vec3(fRadius);
+		vMax = vCenter + glm::vec3(fRadius);
+	}
+	memcpy(header.m_afBoundsMin, glm::value_ptr(vMin), sizeof(header.m_afBoundsMin));
+	memcpy(header.m_afBoundsMax, glm::value_ptr(vMax), sizeof(header.m_afBoundsMax));
+
+	// The fixed size tables go last, now their contents' offsets are known
+	header.m_uiMeshesOffset = lMeshes.empty() ? 0 : Append(&lMeshes[0], lMeshes.size() * sizeof(Mesh));
+	header.m_uiNodesOffset = lNodes.empty() ? 0 : Append(&lNodes[0], lNodes.size() * sizeof(Node));
+	header.m_uiMaterialsOffset = lMaterials.empty() ? 0 : Append(&lMaterials[0], lMaterials.size() * sizeof(Material));
+	header.m_uiFramesOffset = lFrames.empty() ? 0 : Append(&lFrames[0], lFrames.size() * sizeof(glm::mat4));
+
+	memcpy(&m_lCookedData[0], &header, sizeof(header));
+	m_pData = &m_lCookedData[0];
+	m_uiSize = m_lCookedData.size();
+}
+
+}
@@ -0,0 +1,180 @@
+//-----------------------------------------------------------------------------
+// File:			W_CookedModel.h
+// Original Author:	agent
+//
+// Model data in a GPU ready binary form, so loading a model is mapping one
+// file and handing its blobs straight to GL with no parsing. It's "cooked"
+// from a POD file once (offline by CookStale/CookFile, e.g. "ExampleGame -cook
+// a.pod b.pod", or else by ModelData the first time it loads the POD) and saved
+// next to it with a .wmdl extension. Files are validated when mapped, so a
+// truncated or corrupt one is recooked rather than read out of bounds.
+//
+// The file is one blob, and everything in it is found by byte offsets from
+// its start, all multiples of 4:
+//	Header
+//	vertex and index data per mesh, in the layout they're uploaded in
+//	BoneBatch[] and Bone[] per skinned mesh
+//	Mesh[], Node[], Material[]
+//	mat4[] every node's world matrix for every frame, frame by frame
+//
+// Animation is baked to those per frame matrices; in between frames they're
+// blended linearly.
+//-----------------------------------------------------------------------------
+#ifndef W_COOKEDMODEL_H
+#define W_COOKEDMODEL_H
+
+#include "W_Types.h"
+#include "W_MappedFile.h"
+#include <string>
+#include <vector>
+
+class CPVRTModelPOD;
+
+namespace wolf
+{
+class CookedModel
+{
+	public:
+		//-------------------------------------------------------------------------
+		// PUBLIC TYPES
+		//-------------------------------------------------------------------------
+		static const unsigned int s_uiVersion = 2;
+		static const unsigned int s_uiMaxNameLength = 128;
+
+		struct Header
+		{
+			char			m_acMagic[4];
+			unsigned int	m_uiVersion;
+
+			unsigned int	m_uiNumMeshes;
+			unsigned int	m_uiMeshesOffset;
+			unsigned int	m_uiNumNodes;
+			unsigned int	m_uiNumMeshNodes;	// Mesh nodes come first
+			unsigned int	m_uiNodesOffset;
+			unsigned int	m_uiNumMaterials;
+			unsigned int	m_uiMaterialsOffset;
+
+			unsigned int	m_uiNumFrames;		// As exported, may be 0
+			unsigned int	m_uiNumBakedFrames;	// Always at least 1
+			unsigned int	m_uiFramesOffset;
+
+			unsigned int	m_uiSkinned;
+			float			m_afBoundsMin[3];	// Already grown for animation
+			float			m_afBoundsMax[3];
+		};
+
+		struct Attribute
+		{
+			unsigned int	m_uiAttribute;		// wolf::Attribute
+			unsigned int	m_uiType;			// wolf::ComponentType
+			int				m_iNumComponents;
+			int				m_iOffset;
+		};
+
+		struct Mesh
+		{
+			unsigned int	m_uiVertexOffset;
+			unsigned int	m_uiVertexSize;
+			unsigned int	m_uiVertexStride;
+			unsigned int	m_uiIndexOffset;
+			unsigned int	m_uiNumIndices;		// Unsigned shorts, triangle list
+
+			unsigned int	m_uiNumAttributes;
+			Attribute		m_aAttributes[AT_NUM_ATTRIBS];
+
+			unsigned int	m_uiNumBoneBatches;	// 0 if not skinned
+			unsigned int	m_uiBoneBatchesOffset;
+		};
+
+		struct BoneBatch
+		{
+			unsigned int	m_uiFirstTriangle;
+			unsigned int	m_uiNumTriangles;
+			unsigned int	m_uiNumBones;
+			unsigned int	m_uiBonesOffset;
+		};
+
+		struct Bone
+		{
+			// Takes the mesh from its bind pose into the bone's space; the bone's
+			// world matrix for a frame takes it on from there
+			glm::mat4		m_mBindOffset;
+			unsigned int	m_uiNode;
+		};
+
+		struct Node
+		{
+			int				m_iMesh;			// -1 if none
+			int				m_iMaterial;		// -1 if none
+		};
+
+		struct Material
+		{
+			char			m_szName[s_uiMaxNameLength];
+			char			m_szDiffuse[s_uiMaxNameLength];		// Empty if none
+			char			m_szSpecular[s_uiMaxNameLength];	// Empty if none
+		};
+		//-------------------------------------------------------------------------
+
+		//-------------------------------------------------------------------------
+		// PUBLIC INTERFACE
+		//-------------------------------------------------------------------------
+		CookedModel();
+
+		bool Load(const std::string& p_strFile, const std::string& p_strSourceFile = "");
+		bool Cook(const std::string& p_strPODFile);
+		bool Save(const std::string& p_strFile) const;
+		void Swap(CookedModel& p_other);
+
+		static std::string GetCookedFileName(const std::string& p_strPODFile);
+		static bool CookFile(const std::string& p_strPODFile, const std::string& p_strFile);
+		static unsigned int CookStale(const std::vector<std::string>& p_lPODFiles);
+
+		const Header& GetHeader() const { return *(const Header*)m_pData; }
+		const Mesh& GetMesh(unsigned int p_uiMesh) const { return Get<Mesh>(GetHeader().m_uiMeshesOffset)[p_uiMesh]; }
+		const Node& GetNode(unsigned int p_uiNode) const { return Get<Node>(GetHeader().m_uiNodesOffset)[p_uiNode]; }
+		const Material& GetMaterial(unsigned int p_uiMaterial) const { return Get<Material>(GetHeader().m_uiMaterialsOffset)[p_uiMaterial]; }
+
+		const void* GetVertexData(const Mesh& p_mesh) const { return m_pData + p_mesh.m_uiVertexOffset; }
+		const void* GetIndexData(const Mesh& p_mesh) const { return m_pData + p_mesh.m_uiIndexOffset; }
+		const BoneBatch& GetBoneBatch(const Mesh& p_mesh, unsigned int p_uiBatch) const { return Get<BoneBatch>(p_mesh.m_uiBoneBatchesOffset)[p_uiBatch]; }
+		const Bone& GetBone(const BoneBatch& p_batch, unsigned int p_uiBone) const { return Get<Bone>(p_batch.m_uiBonesOffset)[p_uiBone]; }
+
+		glm::mat4 GetNodeWorld(unsigned int p_uiNode, float p_fFrame) const;
+		glm::mat4 GetBoneWorld(const Bone& p_bone, float p_fFrame) const { return GetNodeWorld(p_bone.m_uiNode, p_fFrame) * p_bone.m_mBindOffset; }
+		//-------------------------------------------------------------------------
+
+	private:
+		//-------------------------------------------------------------------------
+		// PRIVATE METHODS
+		//-------------------------------------------------------------------------
+		template<typename T>
+		const T* Get(unsigned int p_uiOffset) const { return (const T*)(m_pData + p_uiOffset); }
+
+		void Clear();
+		void Cook(CPVRTModelPOD& p_pod);
+		unsigned int Append(const void* p_pData, unsigned int p_uiLength);
+		bool Validate() const;
+		bool ValidateMesh(const Mesh& p_mesh) const;
+		bool InRange(unsigned int p_uiOffset, unsigned long long p_uiCount, unsigned int p_uiItemSize) const;
+
+		// Owns its data, so can't be copied
+		CookedModel(const CookedModel&);
+		CookedModel& operator=(const CookedModel&);
+		//-------------------------------------------------------------------------
+
+		//-------------------------------------------------------------------------
+		// PRIVATE MEMBERS
+		//-------------------------------------------------------------------------
+		// Points into either the mapped file or the cooked data
+		const char*			m_pData;
+		unsigned int		m_uiSize;
+
+		MappedFile			m_file;
+		std::vector<char>	m_lCookedData;
+		//-------------------------------------------------------------------------
+};
+
+}
+
+#endif
@@ -0,0 +1,128 @@
+//-----------------------------------------------------------------------------
+// File:			W_MappedFile.cpp
+// Original Author:	agent
+//
+// See header for notes
+//-----------------------------------------------------------------------------
+#include "W_MappedFile.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace wolf
+{
+//----------------------------------------------------------
+// Constructor
+//----------------------------------------------------------
+MappedFile::MappedFile() : m_pData(0), m_uiSize(0), m_hFile(0), m_hMapping(0)
+{
+}
+
+//----------------------------------------------------------
+// Destructor
+//----------------------------------------------------------
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+//----------------------------------------------------------
+// Maps the given file, closing any file already mapped.
+// Returns false if it doesn't exist, is empty or can't be
+// mapped.
+//----------------------------------------------------------
+bool MappedFile::Open(const std::string& p_strFile)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE hFile = CreateFileA(p_strFile.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, 0);
+	if( hFile == INVALID_HANDLE_VALUE )
+		return false;
+
+	DWORD dwSize = GetFileSize(hFile, 0);
+	HANDLE hMapping = dwSize > 0 ? CreateFileMappingA(hFile, 0, PAGE_READONLY, 0, 0, 0) : 0;
+	if( !hMapping )
+	{
+		CloseHandle(hFile);
+		return false;
+	}
+
+	m_pData = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+	if( !m_pData )
+	{
+		CloseHandle(hMapping);
+		CloseHandle(hFile);
+		return false;
+	}
+
+	m_uiSize = dwSize;
+	m_hFile = hFile;
+	m_hMapping = hMapping;
+#else
+	int iFile = open(p_strFile.c_str(), O_RDONLY);
+	if( iFile < 0 )
+		return false;
+
+	struct stat fileStat;
+	if( fstat(iFile, &fileStat) != 0 || fileStat.st_size == 0 )
+	{
+		close(iFile);
+		return false;
+	}
+
+	void* pData = mmap(0, fileStat.st_size, PROT_READ, MAP_PRIVATE, iFile, 0);
+	close(iFile);
+	if( pData == MAP_FAILED )
+		return false;
+
+	m_pData = pData;
+	m_uiSize = (unsigned int)fileStat.st_size;
+#endif
+
+	return true;
+}
+
+//----------------------------------------------------------
+// Unmaps the file, if there is one
+//----------------------------------------------------------
+void MappedFile::Close()
+{
+	if( !m_pData )
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(m_pData);
+	CloseHandle((HANDLE)m_hMapping);
+	CloseHandle((HANDLE)m_hFile);
+#else
+	munmap((void*)m_pData, m_uiSize);
+#endif
+
+	m_pData = 0;
+	m_uiSize = 0;
+	m_hFile = 0;
+	m_hMapping = 0;
+}
+
+//----------------------------------------------------------
+// Trades mappings with the given file, so one can be opened
+// on a loading thread and handed over when done
+//----------------------------------------------------------
+void MappedFile::Swap(MappedFile& p_other)
+{
+	std::swap(m_pData, p_other.m_pData);
+	std::swap(m_uiSize, p_other.m_uiSize);
+	std::swap(m_hFile, p_other.m_hFile);
+	std::swap(m_hMapping, p_other.m_hMapping);
+}
+
+}
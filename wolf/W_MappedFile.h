@@ -0,0 +1,56 @@
+//-----------------------------------------------------------------------------
+// File:			W_MappedFile.h
+// Original Author:	agent
+//
+// Read only view of a whole file mapped into memory. The OS pages it in as
+// it's touched, so nothing is read or copied up front.
+//-----------------------------------------------------------------------------
+#ifndef W_MAPPEDFILE_H
+#define W_MAPPEDFILE_H
+
+#include <string>
+
+namespace wolf
+{
+class MappedFile
+{
+	public:
+		//-------------------------------------------------------------------------
+		// PUBLIC INTERFACE
+		//-------------------------------------------------------------------------
+		MappedFile();
+		~MappedFile();
+
+		bool Open(const std::string& p_strFile);
+		void Close();
+		void Swap(MappedFile& p_other);
+
+		bool IsOpen() const { return m_pData != 0; }
+		const void* GetData() const { return m_pData; }
+		unsigned int GetSize() const { return m_uiSize; }
+		//-------------------------------------------------------------------------
+
+	private:
+		//-------------------------------------------------------------------------
+		// PRIVATE METHODS
+		//-------------------------------------------------------------------------
+		// Owns the mapping, so can't be copied
+		MappedFile(const MappedFile&);
+		MappedFile& operator=(const MappedFile&);
+		//-------------------------------------------------------------------------
+
+		//-------------------------------------------------------------------------
+		// PRIVATE MEMBERS
+		//-------------------------------------------------------------------------
+		const void*			m_pData;
+		unsigned int		m_uiSize;
+
+		// OS handles (file and mapping on Windows, just the file elsewhere)
+		void*				m_hFile;
+		void*				m_hMapping;
+		//-------------------------------------------------------------------------
+};
+
+}
+
+#endif
@@ -6,6 +6,7 @@
 //-----------------------------------------------------------------------------
 #include "W_Material.h"
 #include "W_Common.h"
+#include <cstring>
 
 namespace wolf
 {
@@ -17,6 +18,8 @@ bool			Material::m_bBlendCurr = false;
 BlendEquation	Material::m_eBlendEquationCurr = BE_Add;
 BlendMode		Material::m_eSrcFactorCurr = BM_One;
 BlendMode		Material::m_eDstFactorCurr = BM_Zero;
+GLuint			Material::m_auiTextureCurr[Material::MAX_TEXTURE_UNITS] = { 0 };
+unsigned int	Material::m_uiNextID = 1;
 
 static GLenum gs_aDepthFuncMap[DF_NUM_DEPTH_FUNCS] =
 {
@@ -55,7 +58,7 @@ static GLenum gs_aBlendModeMap[] =
 // Constructor
 //----------------------------------------------------------
 Material::Material(const std::string& p_strName) 
-	: m_strName(p_strName), m_pProgram(0),
+	: m_strName(p_strName), m_uiID(m_uiNextID++), m_pProgram(0), m_bLocationsResolved(false),
 	  m_bDepthTest(true), m_bDepthWrite(true), m_eDepthFunc(DF_LessEqual),
 	  m_bBlend(false), m_eSrcFactor(BM_One), m_eDstFactor(BM_Zero), m_eBlendEquation(BE_Add)
 {
@@ -76,29 +79,50 @@ void Material::Apply()
 	// Bind the shader
 	m_pProgram->Bind();
 
-	// Set all the uniforms we have
+	if( !m_bLocationsResolved )
+		ResolveUniformLocations();
+
+	// If the program last had our uniforms uploaded to it, only what changed
+	// since needs to go. Otherwise everything does.
+	bool bUploadAll = m_pProgram->GetUniformOwner() != m_uiID;
+
 	int iTexUnit = 0;
+	bool bUnitChanged = false;
 
-	std::map<std::string, Uniform*>::iterator iter;
+	std::vector<Uniform>::iterator iter;
 	for( iter = m_uniforms.begin(); iter != m_uniforms.end(); iter++ )
 	{
 		// If it's a texture, we need to do a bit more work as we need to keep
 		// track of how many texture units we need and switch to them, and then
 		// associate that unit number with the uniform
-		if( iter->second->m_eType == UT_Texture )
+		if( iter->m_eType == UT_Texture )
 		{
-			TextureUniform* pTexUni = static_cast<TextureUniform*>(iter->second);
-
-			glActiveTexture(GL_TEXTURE0 + iTexUnit);
-			pTexUni->m_pValue->Bind();
-			m_pProgram->SetUniform(iter->first.c_str(), iTexUnit);
+			// Skip the bind if the unit already has this texture
+			assert(iTexUnit < MAX_TEXTURE_UNITS);
+			if( m_auiTextureCurr[iTexUnit] != iter->m_pTexture->GetID() )
+			{
+				// Straight to GL; Texture::Bind() would record it against unit 0
+				m_auiTextureCurr[iTexUnit] = iter->m_pTexture->GetID();
+				glActiveTexture(GL_TEXTURE0 + iTexUnit);
+				glBindTexture(GL_TEXTURE_2D, m_auiTextureCurr[iTexUnit]);
+				bUnitChanged = true;
+			}
+			if( (bUploadAll || iter->m_bDirty) && iter->m_iLocation != -1 )
+				m_pProgram->SetUniform(iter->m_iLocation, iTexUnit);
 			iTexUnit++;
 		}
-		else
+		else if( (bUploadAll || iter->m_bDirty) && iter->m_iLocation != -1 )
 		{
-			iter->second->UploadValue(m_pProgram);
+			UploadUniform(*iter);
 		}
+
+		iter->m_bDirty = iter->m_eType == UT_Matrix4Array || iter->m_eType == UT_Matrix3Array;
 	}
+	m_pProgram->SetUniformOwner(m_uiID);
+
+	// Code outside of materials binds textures on the active unit
+	if( bUnitChanged )
+		glActiveTexture(GL_TEXTURE0);
 
 	// Set up depth test
 	{
@@ -160,6 +184,56 @@ void Material::Apply()
 	}
 }
 
+//----------------------------------------------------------
+// Forgets which textures materials last bound. Binds made
+// through Texture::Bind() are tracked, but raw GL calls
+// aren't, so call this after anything that binds textures
+// behind wolf's back.
+//----------------------------------------------------------
+void Material::InvalidateBindCache()
+{
+	for( int i = 0; i < MAX_TEXTURE_UNITS; i++ )
+		m_auiTextureCurr[i] = 0;
+}
+
+//----------------------------------------------------------
+// Keeps the bind cache right when a texture is bound outside
+// of Apply(). That's always on unit 0, as Apply() leaves it
+// active.
+//----------------------------------------------------------
+void Material::OnTextureBound(GLuint p_uiTex)
+{
+	m_auiTextureCurr[0] = p_uiTex;
+}
+
+//----------------------------------------------------------
+// Forgets a texture that's being deleted. GL unbinds it, and
+// its name can be handed out again to a new texture.
+//----------------------------------------------------------
+void Material::OnTextureDeleted(GLuint p_uiTex)
+{
+	for( int i = 0; i < MAX_TEXTURE_UNITS; i++ )
+	{
+		if( m_auiTextureCurr[i] == p_uiTex )
+			m_auiTextureCurr[i] = 0;
+	}
+}
+
+//----------------------------------------------------------
+// Returns the first texture set on this material, or NULL if
+// it has none
+//----------------------------------------------------------
+const Texture* Material::GetFirstTexture() const
+{
+	std::vector<Uniform>::const_iterator iter;
+	for( iter = m_uniforms.begin(); iter != m_uniforms.end(); iter++ )
+	{
+		if( iter->m_eType == UT_Texture )
+			return iter->m_pTexture;
+	}
+	return 0;
+}
+
 //----------------------------------------------------------
 // Sets what program this material uses
 //----------------------------------------------------------
@@ -169,170 +243,184 @@ void Material::SetProgram(const std::string& p_strVS, const std::string& p_strPS
 		ProgramManager::DestroyProgram(m_pProgram);
 
 	m_pProgram = ProgramManager::CreateProgram(p_strVS, p_strPS);
+	m_bLocationsResolved = false;
 }
 
 //----------------------------------------------------------
-// Set uniform version for mat4 uniforms
+// Returns the handle for the named uniform, adding it if it
+// isn't on the material yet. Look handles up once and keep
+// them; setting by handle skips the name lookup.
 //----------------------------------------------------------
-void Material::SetUniform(const std::string& p_strName, const glm::mat4& p_m)
+Material::UniformHandle Material::GetUniformHandle(const std::string& p_strName)
 {
-	std::map<std::string, Uniform*>::iterator iter = m_uniforms.find(p_strName);
+	std::map<std::string, UniformHandle>::iterator iter = m_uniformHandles.find(p_strName);
+	if( iter != m_uniformHandles.end() )
+		return iter->second;
+
+	UniformHandle hUniform = (UniformHandle)m_uniforms.size();
+	m_uniforms.push_back(Uniform(p_strName));
+	m_uniformHandles.insert(std::pair<std::string, UniformHandle>(p_strName, hUniform));
+	m_bLocationsResolved = false;
+	return hUniform;
+}
+
+//----------------------------------------------------------
+// Makes sure the uniform has the given type, giving it room
+// in the value block the first time it's set. A uniform
+// can't change type once set.
+//----------------------------------------------------------
+Material::Uniform& Material::SetUniformType(UniformHandle p_hUniform, UniformType p_eType, unsigned int p_uiNumFloats)
+{
+	assert(p_hUniform >= 0 && p_hUniform < (UniformHandle)m_uniforms.size());
+	Uniform& uniform = m_uniforms[p_hUniform];
 
-	if( iter == m_uniforms.end() )
+	if( uniform.m_eType == UT_None )
 	{
-		m_uniforms.insert( std::pair<std::string, Uniform*>(p_strName, new Matrix4Uniform(p_strName,p_m)));
-		return;
+		uniform.m_eType = p_eType;
+		uniform.m_uiOffset = m_uniformData.size();
+		uniform.m_bDirty = true;
+		m_uniformData.resize(m_uniformData.size() + p_uiNumFloats);
 	}
 
-	assert(iter->second->m_eType == UT_Matrix4);
-	Matrix4Uniform* pUniform = static_cast<Matrix4Uniform*>(iter->second);
-	pUniform->m_value = p_m;
+	assert(uniform.m_eType == p_eType);
+	return uniform;
 }
 
 //----------------------------------------------------------
-// Set uniform version for mat3 uniforms
+// Copies a plain value into the uniform's slot, flagging it
+// for upload only if it actually changed
 //----------------------------------------------------------
-void Material::SetUniform(const std::string& p_strName, const glm::mat3& p_m)
+void Material::SetUniformData(UniformHandle p_hUniform, UniformType p_eType, const void* p_pData, unsigned int p_uiNumFloats)
 {
-	std::map<std::string, Uniform*>::iterator iter = m_uniforms.find(p_strName);
+	Uniform& uniform = SetUniformType(p_hUniform, p_eType, p_uiNumFloats);
 
-	if( iter == m_uniforms.end() )
+	float* pValue = &m_uniformData[uniform.m_uiOffset];
+	if( uniform.m_bDirty || memcmp(pValue, p_pData, p_uiNumFloats * sizeof(float)) != 0 )
 	{
-		m_uniforms.insert( std::pair<std::string, Uniform*>(p_strName, new Matrix3Uniform(p_strName,p_m)));
-		return;
+		memcpy(pValue, p_pData, p_uiNumFloats * sizeof(float));
+		uniform.m_bDirty = true;
 	}
-
-	assert(iter->second->m_eType == UT_Matrix3);
-	Matrix3Uniform* pUniform = static_cast<Matrix3Uniform*>(iter->second);
-	pUniform->m_value = p_m;
 }
 
 //----------------------------------------------------------
-// Set uniform version for vec4 uniforms
+// Looks up where the program has each of our uniforms. Done
+// when the program or the set of uniforms changes.
 //----------------------------------------------------------
-void Material::SetUniform(const std::string& p_strName, const glm::vec4& p_v)
+void Material::ResolveUniformLocations()
 {
-	std::map<std::string, Uniform*>::iterator iter = m_uniforms.find(p_strName);
-
-	if( iter == m_uniforms.end() )
+	std::vector<Uniform>::iterator iter;
+	for( iter = m_uniforms.begin(); iter != m_uniforms.end(); iter++ )
 	{
-		m_uniforms.insert( std::pair<std::string, Uniform*>(p_strName, new Vector4Uniform(p_strName,p_v)));
-		return;
+		iter->m_iLocation = m_pProgram->GetUniformLocation(iter->m_strName.c_str());
+		iter->m_bDirty = true;
 	}
-
-	assert(iter->second->m_eType == UT_Vector4);
-	Vector4Uniform* pUniform = static_cast<Vector4Uniform*>(iter->second);
-	pUniform->m_value = p_v;
+	m_bLocationsResolved = true;
 }
 
 //----------------------------------------------------------
-// Set uniform version for vec4 uniforms
+// Sends a (non texture) uniform's value to the program
 //----------------------------------------------------------
-void Material::SetUniform(const std::string& p_strName, const glm::vec3& p_v)
+void Material::UploadUniform(const Uniform& p_uniform)
 {
-	std::map<std::string, Uniform*>::iterator iter = m_uniforms.find(p_strName);
+	const float* pValue = m_uniformData.empty() ? 0 : &m_uniformData[p_uniform.m_uiOffset];
 
-	if( iter == m_uniforms.end() )
+	switch( p_uniform.m_eType )
 	{
-		m_uniforms.insert( std::pair<std::string, Uniform*>(p_strName, new Vector3Uniform(p_strName,p_v)));
-		return;
+		case UT_Matrix4:		m_pProgram->SetUniform(p_uniform.m_iLocation, *(const glm::mat4*)pValue); break;
+		case UT_Matrix3:		m_pProgram->SetUniform(p_uniform.m_iLocation, *(const glm::mat3*)pValue); break;
+		case UT_Vector3:		m_pProgram->SetUniform(p_uniform.m_iLocation, *(const glm::vec3*)pValue); break;
+		case UT_Vector4:		m_pProgram->SetUniform(p_uniform.m_iLocation, *(const glm::vec4*)pValue); break;
+		case UT_Float:			m_pProgram->SetUniform(p_uniform.m_iLocation, *pValue); break;
+		case UT_Int:
+		{
+			int iValue;
+			memcpy(&iValue, pValue, sizeof(int));
+			m_pProgram->SetUniform(p_uniform.m_iLocation, iValue);
+			break;
+		}
+		case UT_Matrix4Array:	m_pProgram->SetUniform(p_uniform.m_iLocation, (const glm::mat4*)p_uniform.m_pArray, p_uniform.m_uiCount); break;
+		case UT_Matrix3Array:	m_pProgram->SetUniform(p_uniform.m_iLocation, (const glm::mat3*)p_uniform.m_pArray, p_uniform.m_uiCount); break;
+		default: break;
 	}
+}
 
-	assert(iter->second->m_eType == UT_Vector3);
-	Vector3Uniform* pUniform = static_cast<Vector3Uniform*>(iter->second);
-	pUniform->m_value = p_v;
+//----------------------------------------------------------
+// Set uniform version for mat4 uniforms
+//----------------------------------------------------------
+void Material::SetUniform(UniformHandle p_hUniform, const glm::mat4& p_m)
+{
+	SetUniformData(p_hUniform, UT_Matrix4, glm::value_ptr(p_m), 16);
+}
+
+//----------------------------------------------------------
+// Set uniform version for mat3 uniforms
+//----------------------------------------------------------
+void Material::SetUniform(UniformHandle p_hUniform, const glm::mat3& p_m)
+{
+	SetUniformData(p_hUniform, UT_Matrix3, glm::value_ptr(p_m), 9);
 }
 
 //----------------------------------------------------------
 // Set uniform version for vec4 uniforms
 //----------------------------------------------------------
-void Material::SetUniform(const std::string& p_strName, const wolf::Color4& p_c)
+void Material::SetUniform(UniformHandle p_hUniform, const glm::vec4& p_v)
 {
-	std::map<std::string, Uniform*>::iterator iter = m_uniforms.find(p_strName);
+	SetUniformData(p_hUniform, UT_Vector4, glm::value_ptr(p_v), 4);
+}
 
-	if( iter == m_uniforms.end() )
-	{
-		m_uniforms.insert( std::pair<std::string, Uniform*>(p_strName, new Color4Uniform(p_strName,p_c)));
-		return;
-	}
+//----------------------------------------------------------
+// Set uniform version for vec3 uniforms
+//----------------------------------------------------------
+void Material::SetUniform(UniformHandle p_hUniform, const glm::vec3& p_v)
+{
+	SetUniformData(p_hUniform, UT_Vector3, glm::value_ptr(p_v), 3);
+}
 
-	assert(iter->second->m_eType == UT_Color4);
-	Color4Uniform* pUniform = static_cast<Color4Uniform*>(iter->second);
-	pUniform->m_value = p_c;
+//----------------------------------------------------------
+// Set uniform version for color uniforms. These are stored
+// and uploaded as vec4s.
+//----------------------------------------------------------
+void Material::SetUniform(UniformHandle p_hUniform, const wolf::Color4& p_c)
+{
+	SetUniformData(p_hUniform, UT_Vector4, &p_c, 4);
 }
 
 //----------------------------------------------------------
 // Set uniform version for float uniforms
 //----------------------------------------------------------
-void Material::SetUniform(const std::string& p_strName, float p_f)
+void Material::SetUniform(UniformHandle p_hUniform, float p_f)
 {
-	std::map<std::string, Uniform*>::iterator iter = m_uniforms.find(p_strName);
-
-	if( iter == m_uniforms.end() )
-	{
-		m_uniforms.insert( std::pair<std::string, Uniform*>(p_strName, new FloatUniform(p_strName,p_f)));
-		return;
-	}
-
-	assert(iter->second->m_eType == UT_Float);
-	FloatUniform* pUniform = static_cast<FloatUniform*>(iter->second);
-	pUniform->m_value = p_f;
+	SetUniformData(p_hUniform, UT_Float, &p_f, 1);
 }
 
 //----------------------------------------------------------
 // Set uniform version for int uniforms
 //----------------------------------------------------------
-void Material::SetUniform(const std::string& p_strName, int p_i)
+void Material::SetUniform(UniformHandle p_hUniform, int p_i)
 {
-	std::map<std::string, Uniform*>::iterator iter = m_uniforms.find(p_strName);
-
-	if( iter == m_uniforms.end() )
-	{
-		m_uniforms.insert( std::pair<std::string, Uniform*>(p_strName, new IntUniform(p_strName,p_i)));
-		return;
-	}
-
-	assert(iter->second->m_eType == UT_Int);
-	IntUniform* pUniform = static_cast<IntUniform*>(iter->second);
-	pUniform->m_value = p_i;
+	SetUniformData(p_hUniform, UT_Int, &p_i, 1);
 }
 
 //----------------------------------------------------------
 // Set uniform version for mat4* uniforms
 //----------------------------------------------------------
-void Material::SetUniform(const std::string& p_strName, const glm::mat4* p_aMatrices, int p_uiNumMatrices)
+void Material::SetUniform(UniformHandle p_hUniform, const glm::mat4* p_aMatrices, int p_uiNumMatrices)
 {
-	std::map<std::string, Uniform*>::iterator iter = m_uniforms.find(p_strName);
-
-	if( iter == m_uniforms.end() )
-	{
-		m_uniforms.insert( std::pair<std::string, Uniform*>(p_strName, new Matrix4ArrayUniform(p_strName,p_aMatrices,p_uiNumMatrices)));
-		return;
-	}
-
-	assert(iter->second->m_eType == UT_Matrix4Array);
-	Matrix4ArrayUniform* pUniform = static_cast<Matrix4ArrayUniform*>(iter->second);
-	pUniform->m_value = p_aMatrices;
-	pUniform->m_uiCount = p_uiNumMatrices;
+	Uniform& uniform = SetUniformType(p_hUniform, UT_Matrix4Array, 0);
+	uniform.m_pArray = p_aMatrices;
+	uniform.m_uiCount = p_uiNumMatrices;
+	uniform.m_bDirty = true;
 }
 
 //----------------------------------------------------------
 // Set uniform version for mat3* uniforms
 //----------------------------------------------------------
-void Material::SetUniform(const std::string& p_strName, const glm::mat3* p_aMatrices, int p_uiNumMatrices)
+void Material::SetUniform(UniformHandle p_hUniform, const glm::mat3* p_aMatrices, int p_uiNumMatrices)
 {
-	std::map<std::string, Uniform*>::iterator iter = m_uniforms.find(p_strName);
-
-	if( iter == m_uniforms.end() )
-	{
-		m_uniforms.insert( std::pair<std::string, Uniform*>(p_strName, new Matrix3ArrayUniform(p_strName,p_aMatrices,p_uiNumMatrices)));
-		return;
-	}
-
-	assert(iter->second->m_eType == UT_Matrix3Array);
-	Matrix3ArrayUniform* pUniform = static_cast<Matrix3ArrayUniform*>(iter->second);
-	pUniform->m_value = p_aMatrices;
-	pUniform->m_uiCount = p_uiNumMatrices;
+	Uniform& uniform = SetUniformType(p_hUniform, UT_Matrix3Array, 0);
+	uniform.m_pArray = p_aMatrices;
+	uniform.m_uiCount = p_uiNumMatrices;
+	uniform.m_bDirty = true;
 }
 
 //----------------------------------------------------------
@@ -341,17 +429,8 @@ void Material::SetUniform(const std::string& p_strName, const glm::mat3* p_aMatr
 //----------------------------------------------------------
 void Material::SetTexture(const std::string& p_strName, const Texture* p_pTex)
 {
-	std::map<std::string, Uniform*>::iterator iter = m_uniforms.find(p_strName);
-
-	if( iter == m_uniforms.end() )
-	{
-		m_uniforms.insert( std::pair<std::string, Uniform*>(p_strName, new TextureUniform(p_strName,p_pTex)));
-		return;
-	}
-
-	assert(iter->second->m_eType == UT_Texture);
-	TextureUniform* pUniform = static_cast<TextureUniform*>(iter->second);
-	pUniform->m_pValue = p_pTex;
+	Uniform& uniform = SetUniformType(GetUniformHandle(p_strName), UT_Texture, 0);
+	uniform.m_pTexture = p_pTex;
 }
 
 }
@@ -13,6 +13,7 @@
 #include "W_ProgramManager.h"
 #include <string>
 #include <map>
+#include <vector>
 
 namespace wolf
 {
@@ -25,15 +26,34 @@ class Material
 		//-------------------------------------------------------------------------
 		void Apply();
 
-		void SetUniform(const std::string& p_strName, const glm::mat4& p_m);
-		void SetUniform(const std::string& p_strName, const glm::mat3& p_m);
-		void SetUniform(const std::string& p_strName, const glm::vec4& p_m);
-		void SetUniform(const std::string& p_strName, const glm::vec3& p_m);
-		void SetUniform(const std::string& p_strName, const wolf::Color4& p_c);
-		void SetUniform(const std::string& p_strName, float p_f);
-		void SetUniform(const std::string& p_strName, int p_i);
-		void SetUniform(const std::string& p_strName, const glm::mat4* p_aMatrices, int p_uiNumMatrices);
-		void SetUniform(const std::string& p_strName, const glm::mat3* p_aMatrices, int p_uiNumMatrices);
+		static void InvalidateBindCache();
+		static void OnTextureBound(GLuint p_uiTex);
+		static void OnTextureDeleted(GLuint p_uiTex);
+
+		// Handle for setting a uniform without looking it up by name. Handles
+		// stay valid for the life of the material.
+		typedef int UniformHandle;
+		UniformHandle GetUniformHandle(const std::string& p_strName);
+
+		void SetUniform(UniformHandle p_hUniform, const glm::mat4& p_m);
+		void SetUniform(UniformHandle p_hUniform, const glm::mat3& p_m);
+		void SetUniform(UniformHandle p_hUniform, const glm::vec4& p_v);
+		void SetUniform(UniformHandle p_hUniform, const glm::vec3& p_v);
+		void SetUniform(UniformHandle p_hUniform, const wolf::Color4& p_c);
+		void SetUniform(UniformHandle p_hUniform, float p_f);
+		void SetUniform(UniformHandle p_hUniform, int p_i);
+		void SetUniform(UniformHandle p_hUniform, const glm::mat4* p_aMatrices, int p_uiNumMatrices);
+		void SetUniform(UniformHandle p_hUniform, const glm::mat3* p_aMatrices, int p_uiNumMatrices);
+
+		void SetUniform(const std::string& p_strName, const glm::mat4& p_m) { SetUniform(GetUniformHandle(p_strName), p_m); }
+		void SetUniform(const std::string& p_strName, const glm::mat3& p_m) { SetUniform(GetUniformHandle(p_strName), p_m); }
+		void SetUniform(const std::string& p_strName, const glm::vec4& p_v) { SetUniform(GetUniformHandle(p_strName), p_v); }
+		void SetUniform(const std::string& p_strName, const glm::vec3& p_v) { SetUniform(GetUniformHandle(p_strName), p_v); }
+		void SetUniform(const std::string& p_strName, const wolf::Color4& p_c) { SetUniform(GetUniformHandle(p_strName), p_c); }
+		void SetUniform(const std::string& p_strName, float p_f) { SetUniform(GetUniformHandle(p_strName), p_f); }
+		void SetUniform(const std::string& p_strName, int p_i) { SetUniform(GetUniformHandle(p_strName), p_i); }
+		void SetUniform(const std::string& p_strName, const glm::mat4* p_aMatrices, int p_uiNumMatrices) { SetUniform(GetUniformHandle(p_strName), p_aMatrices, p_uiNumMatrices); }
+		void SetUniform(const std::string& p_strName, const glm::mat3* p_aMatrices, int p_uiNumMatrices) { SetUniform(GetUniformHandle(p_strName), p_aMatrices, p_uiNumMatrices); }
 
 		void SetTexture(const std::string& p_strName, const Texture* p_pTex);
 
@@ -47,6 +67,12 @@ class Material
 
 		const std::string& GetName() const { return m_strName; }
 		void SetProgram(const std::string& p_strVS, const std::string& p_strPS);
+
+		// Used to build render queue sort keys
+		unsigned int GetID() const { return m_uiID; }
+		Program* GetProgram() const { return m_pProgram; }
+		bool GetBlend() const { return m_bBlend; }
+		const Texture* GetFirstTexture() const;
 		//-------------------------------------------------------------------------
 
 	private:
@@ -55,11 +81,11 @@ class Material
 		//-------------------------------------------------------------------------
 		enum UniformType
 		{
+			UT_None,
 			UT_Matrix4,
 			UT_Matrix3,
 			UT_Vector3,
 			UT_Vector4,
-			UT_Color4,
 			UT_Float,
 			UT_Int,
 			UT_Texture,
@@ -67,75 +93,21 @@ class Material
 			UT_Matrix3Array
 		};
 
+		// One uniform. Plain values live in m_uniformData at m_uiOffset, arrays
+		// are pointed to (their contents can change without us knowing, so 
+		// they're uploaded on every Apply).
 		struct Uniform
 		{
-			Uniform(const std::string& p_strName, UniformType p_eType) : m_strName(p_strName), m_eType(p_eType) {}
-			virtual void UploadValue(Program* p_pProgram) {}
-
-			UniformType		m_eType;
-			std::string     m_strName;
-		};
-		struct Matrix4Uniform : public Uniform
-		{
-			Matrix4Uniform(const std::string& p_strName, const glm::mat4& p_m) : Uniform(p_strName,UT_Matrix4), m_value(p_m) {}
-			void UploadValue(Program* p_pProgram) { p_pProgram->SetUniform(m_strName.c_str(), m_value); }
-			glm::mat4		m_value;
-		};
-		struct Matrix3Uniform : public Uniform
-		{
-			Matrix3Uniform(const std::string& p_strName, const glm::mat3& p_m) : Uniform(p_strName,UT_Matrix3), m_value(p_m) {}
-			void UploadValue(Program* p_pProgram) { p_pProgram->SetUniform(m_strName.c_str(), m_value); }
-			glm::mat3		m_value;
-		};
-		struct Vector3Uniform : public Uniform
-		{
-			Vector3Uniform(const std::string& p_strName, const glm::vec3& p_v) : Uniform(p_strName,UT_Vector3), m_value(p_v) {}
-			void UploadValue(Program* p_pProgram) { p_pProgram->SetUniform(m_strName.c_str(), m_value); }
-			glm::vec3		m_value;
-		};
-		struct Vector4Uniform : public Uniform
-		{
-			Vector4Uniform(const std::string& p_strName, const glm::vec4& p_v) : Uniform(p_strName,UT_Vector4), m_value(p_v) {}
-			void UploadValue(Program* p_pProgram) { p_pProgram->SetUniform(m_strName.c_str(), m_value); }
-			glm::vec4		m_value;
-		};
-		struct Color4Uniform : public Uniform
-		{
-			Color4Uniform(const std::string& p_strName, const wolf::Color4& p_c) : Uniform(p_strName,UT_Color4), m_value(p_c) {}
-			void UploadValue(Program* p_pProgram) { p_pProgram->SetUniform(m_strName.c_str(), m_value); }
-			wolf::Color4		m_value;
-		};
-		struct FloatUniform : public Uniform
-		{
-			FloatUniform(const std::string& p_strName, float p_f) : Uniform(p_strName,UT_Float), m_value(p_f) {}
-			void UploadValue(Program* p_pProgram) { p_pProgram->SetUniform(m_strName.c_str(), m_value); }
-			float		m_value;
-		};
-		struct IntUniform : public Uniform
-		{
-			IntUniform(const std::string& p_strName, int p_i) : Uniform(p_strName,UT_Int), m_value(p_i) {}
-			void UploadValue(Program* p_pProgram) { p_pProgram->SetUniform(m_strName.c_str(), m_value); }
-			int		m_value;
-		};
-		struct TextureUniform : public Uniform
-		{
-			TextureUniform(const std::string& p_strName, const Texture* p_pTex) : Uniform(p_strName,UT_Texture), m_pValue(p_pTex) {}
-			void UploadValue(Program* p_pProgram) { /* This is dealt with differently. See "Apply" */}
-			const Texture*		m_pValue;
-		};
-		struct Matrix4ArrayUniform : public Uniform
-		{
-			Matrix4ArrayUniform(const std::string& p_strName, const glm::mat4* p_am, unsigned int p_uiNumMatrices) : Uniform(p_strName,UT_Matrix4Array), m_value(p_am), m_uiCount(p_uiNumMatrices) {}
-			void UploadValue(Program* p_pProgram) { p_pProgram->SetUniform(m_strName.c_str(), m_value, m_uiCount); }
-			const glm::mat4*		m_value;
-			unsigned int 			m_uiCount;
-		};
-		struct Matrix3ArrayUniform : public Uniform
-		{
-			Matrix3ArrayUniform(const std::string& p_strName, const glm::mat3* p_am, unsigned int p_uiNumMatrices) : Uniform(p_strName,UT_Matrix3Array), m_value(p_am), m_uiCount(p_uiNumMatrices) {}
-			void UploadValue(Program* p_pProgram) { p_pProgram->SetUniform(m_strName.c_str(), m_value, m_uiCount); }
-			const glm::mat3*		m_value;
-			unsigned int 			m_uiCount;
+			Uniform(const std::string& p_strName) : m_strName(p_strName), m_eType(UT_None), m_iLocation(-1), m_uiOffset(0), m_uiCount(0), m_pArray(0), m_pTexture(0), m_bDirty(false) {}
+
+			std::string			m_strName;
+			UniformType			m_eType;
+			int					m_iLocation;
+			unsigned int		m_uiOffset;
+			unsigned int		m_uiCount;
+			const void*			m_pArray;
+			const Texture*		m_pTexture;
+			bool				m_bDirty;
 		};
 		//-------------------------------------------------------------------------
 
@@ -146,6 +118,11 @@ class Material
 		// Made private to enforce creation/deletion via MaterialManager
 		Material(const std::string& p_strName);
 		virtual ~Material();
+
+		Uniform& SetUniformType(UniformHandle p_hUniform, UniformType p_eType, unsigned int p_uiNumFloats);
+		void SetUniformData(UniformHandle p_hUniform, UniformType p_eType, const void* p_pData, unsigned int p_uiNumFloats);
+		void ResolveUniformLocations();
+		void UploadUniform(const Uniform& p_uniform);
 		
 		//-------------------------------------------------------------------------
 
@@ -153,8 +130,13 @@ class Material
 		// PRIVATE MEMBERS
 		//-------------------------------------------------------------------------
 		std::string							m_strName;
+		unsigned int						m_uiID;
 		Program*							m_pProgram;
-		std::map<std::string, Uniform*>		m_uniforms;
+		bool								m_bLocationsResolved;
+
+		std::vector<Uniform>						m_uniforms;
+		std::vector<float>							m_uniformData;
+		std::map<std::string, UniformHandle>		m_uniformHandles;
 
 		bool								m_bDepthTest;
 		DepthFunc							m_eDepthFunc;
@@ -174,6 +156,12 @@ class Material
 		static BlendEquation				m_eBlendEquationCurr;
 		static BlendMode					m_eSrcFactorCurr;
 		static BlendMode					m_eDstFactorCurr;
+
+		static const int					MAX_TEXTURE_UNITS = 8;
+		// GL names rather than Textures, so regions of the same atlas match
+		static GLuint						m_auiTextureCurr[MAX_TEXTURE_UNITS];
+
+		static unsigned int					m_uiNextID;
 		//-------------------------------------------------------------------------
 };
 
@@ -6,163 +6,26 @@
 //-----------------------------------------------------------------------------
 #include "W_Model.h"
 #include "W_Common.h"
-#include "W_BufferManager.h"
-#include "W_MaterialManager.h"
+#include "W_SkinningManager.h"
 
 namespace wolf
 {
-static ComponentType gs_aPODTypeMap[] = 
-{
-    wolf::CT_Invalid,   //EPODDataNone,
-	wolf::CT_Float,		//EPODDataFloat,
-	wolf::CT_Int,		//EPODDataInt,
-	wolf::CT_UShort,	//EPODDataUnsignedShort,
-	wolf::CT_UByte4,	//EPODDataRGBA,
-	wolf::CT_UByte4,	//EPODDataARGB,
-	wolf::CT_UByte4,	//EPODDataD3DCOLOR,
-	wolf::CT_UByte4,	//EPODDataUBYTE4,
-	wolf::CT_Invalid,	//EPODDataDEC3N,
-	wolf::CT_Invalid,	//EPODDataFixed16_16,
-	wolf::CT_UByte,		//EPODDataUnsignedByte,
-	wolf::CT_Short,		//EPODDataShort,
-	wolf::CT_ShortNorm,	//EPODDataShortNorm,
-	wolf::CT_Byte,		//EPODDataByte,
-	wolf::CT_ByteNorm,	//EPODDataByteNorm,
-	wolf::CT_UByteNorm, //EPODDataUnsignedByteNorm,
-	wolf::CT_UShortNorm, //EPODDataUnsignedShortNorm,
-	wolf::CT_UInt,		//EPODDataUnsignedInt
-};
+// Scratch list of per instance world matrices for RenderInstanced()
+static std::vector<glm::mat4> gs_lInstanceTransforms;
+
+// Scratch bone arrays for programs that take them as plain uniforms
+static std::vector<glm::mat4> gs_lBoneWorld;
+static std::vector<glm::mat3> gs_lBoneWorldIT;
 
 //----------------------------------------------------------
-// Constructor
+// Constructor. Only ModelManager makes these.
 //----------------------------------------------------------
-Model::Model(const std::string& p_strFile, const std::string& p_strTexturePrefix, const std::string& p_strVertexProgram, const std::string& p_strFragmentProgram) 
+Model::Model(ModelData* p_pData) 
 	:
-	m_fFrame(0.0f)
+	m_pData(p_pData),
+	m_fFrame(0.0f),
+	m_iCullProxy(-1)
 {
-	// Load in the POD file
-	EPVRTError error = m_pod.ReadFromFile(p_strFile.c_str());
-
-	// Build all the meshes
-	for(unsigned int i = 0; i < m_pod.nNumMesh; i++)
-	{
-		SPODMesh* pMesh = &m_pod.pMesh[i];
-
-		// Create the vertex declaration
-		wolf::VertexDeclaration* pDecl = new wolf::VertexDeclaration;
-		pDecl->Begin();
-
-        // Create the vertex buffer
-		wolf::VertexBuffer* pVB = wolf::BufferManager::CreateVertexBuffer(pMesh->pInterleaved, pMesh->nNumVertex * pMesh->sVertex.nStride);
-        
-		// Create the index buffer
-		wolf::IndexBuffer* pIB = wolf::BufferManager::CreateIndexBuffer(pMesh->nNumFaces*3);
-		pIB->Write(pMesh->sFaces.pData);
-        
-		// We'll always have a position
-		pDecl->AppendAttribute(wolf::AT_Position, pMesh->sVertex.n, gs_aPODTypeMap[pMesh->sVertex.eType], *((int*)&pMesh->sVertex.pData));
-
-		if( pMesh->sNormals.n > 0 )
-			pDecl->AppendAttribute(wolf::AT_Normal, pMesh->sNormals.n, gs_aPODTypeMap[pMesh->sNormals.eType], *((int*)&pMesh->sNormals.pData));
-
-		for(unsigned int x = 0; x < pMesh->nNumUVW; x++ )
-			pDecl->AppendAttribute((wolf::Attribute)(wolf::AT_TexCoord1 + x), pMesh->psUVW[x].n, gs_aPODTypeMap[pMesh->psUVW[x].eType], *((int*)&pMesh->psUVW[x].pData));
-
-		if( pMesh->sVtxColours.n > 0 )
-			pDecl->AppendAttribute(wolf::AT_Color, pMesh->sVtxColours.n, gs_aPODTypeMap[pMesh->sVtxColours.eType], *((int*)&pMesh->sVtxColours.pData));
-
-		if( pMesh->sBoneIdx.n != 0 )
-			pDecl->AppendAttribute(wolf::AT_BoneIndices, pMesh->sBoneIdx.n, gs_aPODTypeMap[pMesh->sBoneIdx.eType], *((int*)&pMesh->sBoneIdx.pData));
-
-		if( pMesh->sBoneWeight.n != 0 )
-			pDecl->AppendAttribute(wolf::AT_BoneWeight, pMesh->sBoneWeight.n, gs_aPODTypeMap[pMesh->sBoneWeight.eType], *((int*)&pMesh->sBoneWeight.pData));
-
-		pDecl->SetVertexBuffer(pVB);
-		pDecl->SetIndexBuffer(pIB);
-		pDecl->End();
-    
-		// Add them to our list of meshes
-		Mesh m;
-		m.m_pVB = pVB;
-		m.m_pIB = pIB;
-		m.m_pDecl = pDecl;
-		m_lMeshes.push_back(m);
-	}
-
-	// Now make sure the material manager knows about all materials we'll need
-	// CLASS NOTE: This does a bunch of work more than once (like if many nodes
-	// reference the same material - which is likely). This is a candidate for
-	// cleanup as an exercise
-	for(unsigned int i = 0; i < m_pod.nNumMeshNode; i++)
-	{
-        SPODNode* pNode = &m_pod.pNode[i];
-
-		if (pNode->nIdxMaterial == -1)
-		{
-			continue;
-		}
-
-		SPODMaterial* pPODMat = &m_pod.pMaterial[pNode->nIdxMaterial];
-        
-		// Not been created yet, so add it
-		m_pMaterial = wolf::MaterialManager::CreateMaterial(pPODMat->pszName);
-
-		// CLASS NOTE: Provide a way to override shaders in some way? Have a think
-		// about this.
-		if (!p_strVertexProgram.empty() && !p_strFragmentProgram.empty())
-		{
-			m_pMaterial->SetProgram(p_strVertexProgram, p_strFragmentProgram);
-		}
-		else
-		{
-			m_pMaterial->SetProgram("data/week9/textured.vsh", "data/week9/textured.fsh");
-		}
-
-		// Grab the texture it's using and change the filename it expects to
-		// be our TGA converted files, in the right path
-        if( pPODMat->nIdxTexDiffuse != -1 )
-        {
-            SPODTexture* pPODTex = &m_pod.pTexture[pPODMat->nIdxTexDiffuse];
-                
-            std::string strFilename = pPODTex->pszName;
-            if( strFilename.find(".jpg") != std::string::npos )
-                strFilename = strFilename.substr(0,strFilename.find(".jpg")) + std::string(".tga");
-            else if( strFilename.find(".png") != std::string::npos )
-                strFilename = strFilename.substr(0,strFilename.find(".png")) + std::string(".tga");
-
-            strFilename = p_strTexturePrefix + strFilename;
-
-            // Create the texture, make sure it's set to repeat, and assign it
-            // to the material
-            wolf::Texture* pTex = wolf::TextureManager::CreateTexture(strFilename.c_str());
-            pTex->SetWrapMode(wolf::Texture::WM_Repeat);
-            m_pMaterial->SetTexture("texture1",pTex);
-		}
-
-		// Specular map texture if it has one
-		if (pPODMat->nIdxTexSpecularColour != -1)
-		{
-			SPODTexture* pPODTex = &m_pod.pTexture[pPODMat->nIdxTexSpecularColour];
-			std::string strFilename = pPODTex->pszName;
-			if( strFilename.find(".jpg") != std::string::npos )
-				strFilename = strFilename.substr(0,strFilename.find(".jpg")) + std::string(".tga");
-			else if( strFilename.find(".png") != std::string::npos )
-				strFilename = strFilename.substr(0,strFilename.find(".png")) + std::string(".tga");
-
-			strFilename = p_strTexturePrefix + strFilename;
-
-			// Create the texture, make sure it's set to repeat, and assign it
-			// to the material
-			wolf::Texture* pTex = wolf::TextureManager::CreateTexture(strFilename.c_str());
-			pTex->SetWrapMode(wolf::Texture::WM_Repeat);
-			m_pMaterial->SetTexture("texture2",pTex);
-		}
-        
-		// CLASS NOTE: I'm not reading blend modes from the materials in the POD
-		// file. This is bad and will lead to incorrect rendering. Add some code
-		// to look in the POD file for this data and set it up in the
-		// wolf::Material accordingly!
-	}
 }
 
 //----------------------------------------------------------
@@ -170,13 +33,6 @@ Model::Model(const std::string& p_strFile, const std::string& p_strTexturePrefix
 //----------------------------------------------------------
 Model::~Model()
 {
-	for(unsigned int i = 0; i < m_lMeshes.size(); i++)
-	{
-		const Mesh& m = m_lMeshes[i];
-		wolf::BufferManager::DestroyBuffer(m.m_pVB);
-		wolf::BufferManager::DestroyBuffer(m.m_pIB);
-		delete m.m_pDecl;
-	}
 }
 
 //----------------------------------------------------------
@@ -185,11 +41,10 @@ Model::~Model()
 void Model::Update(float p_fDelta)
 {
 	m_fFrame += (p_fDelta * 30.0f);
-	if(m_fFrame > m_pod.nNumFrame - 1)
+	if(m_fFrame > m_pData->m_data.GetHeader().m_uiNumFrames - 1)
 	{
 		m_fFrame = 0;
 	}
-	m_pod.SetFrame(m_fFrame);
 }
 
 //----------------------------------------------------------
@@ -197,86 +52,182 @@ void Model::Update(float p_fDelta)
 //----------------------------------------------------------
 void Model::Render(const glm::mat4& p_mView, const glm::mat4& p_mProj)
 {
-	// Go through every mesh node in the pod file
-	for(unsigned int i = 0; i < m_pod.nNumMeshNode; i++)
+	if( !IsReady() )
+		return;
+
+	const CookedModel& data = m_pData->m_data;
+	Material* pMaterial = m_pData->m_pMaterial;
+
+	// The bones are worked out once a frame for everything on the same frame
+	unsigned int uiPose = m_pData->m_bSkinned ? SkinningManager::GetPose(m_pData, m_fFrame) : 0;
+	bool bBoneBlock = pMaterial->GetProgram()->HasUniformBlock(wolf::UB_Bones);
+
+	// Go through every mesh node in the model
+	for(unsigned int i = 0; i < data.GetHeader().m_uiNumMeshNodes; i++)
 	{
-        SPODNode* pNode = &m_pod.pNode[i];
-		SPODMesh* pMesh = &m_pod.pMesh[i];
+		const CookedModel::Node& node = data.GetNode(i);
         
 		// Safeguard
-        if( pNode->nIdx == -1 )
+        if( node.m_iMesh == -1 )
             continue;
 
-		m_pMaterial->SetUniform("projection", p_mProj);
-		m_pMaterial->SetUniform("view", p_mView);
+		const CookedModel::Mesh& cookedMesh = data.GetMesh(node.m_iMesh);
 
-		// Calculate its world matrix from the POD file
-		glm::mat4 mWorld;
-        m_pod.GetWorldMatrix(*((PVRTMATRIX*)glm::value_ptr(mWorld)), *pNode);
-        
-        mWorld = m_mWorldTransform * mWorld;
-		m_pMaterial->SetUniform("world", mWorld);  
+		// Programs with the frame uniform block get the camera from that
+		if( !pMaterial->GetProgram()->HasUniformBlock(wolf::UB_Frame) )
+		{
+			pMaterial->SetUniform(m_pData->m_hProjection, p_mProj);
+			pMaterial->SetUniform(m_pData->m_hView, p_mView);
+		}
+
+		// Calculate its world matrix from the baked animation
+        glm::mat4 mWorld = m_mWorldTransform * data.GetNodeWorld(i, m_fFrame);
+		pMaterial->SetUniform(m_pData->m_hWorld, mWorld);  
+
+		// Instanced programs read the world matrix from an attribute. With no
+		// instance buffer attached it takes the current (constant) value.
+		if( !m_pData->m_bSkinned && pMaterial->GetProgram()->IsInstanced() )
+		{
+			for( int c = 0; c < 4; c++ )
+				glVertexAttrib4fv(wolf::AT_InstanceWorld + c, glm::value_ptr(mWorld[c]));
+		}
 
 		glm::mat4 mWVP = p_mProj * p_mView * mWorld;
 		glm::mat3 mWorldIT(mWorld);
 		mWorldIT = glm::inverse(mWorldIT);
 		mWorldIT = glm::transpose(mWorldIT);
 
-		m_pMaterial->SetUniform("WorldViewProj", mWVP);
-		m_pMaterial->SetUniform("WorldIT", mWorldIT);
+		pMaterial->SetUniform(m_pData->m_hWorldViewProj, mWVP);
+		pMaterial->SetUniform(m_pData->m_hWorldIT, mWorldIT);
 
 
 		// Bind the source data
-		m_lMeshes[pNode->nIdx].m_pDecl->Bind();
+		m_pData->m_lMeshes[node.m_iMesh].m_pDecl->Bind();
 
-		if (pMesh->sBoneIdx.n > 0)
+		if (cookedMesh.m_uiNumBoneBatches > 0)
 		{
-			for(int i32Batch = 0; i32Batch < pMesh->sBoneBatches.nBatchCnt; ++i32Batch)
+			for(unsigned int uiBatch = 0; uiBatch < cookedMesh.m_uiNumBoneBatches; ++uiBatch)
 			{
-				// Go through the bones for the current bone batch
-				glm::mat4 amBoneWorld2[9];
-				glm::mat3 afBoneWorldIT2[9], mBoneIT2;
+				const CookedModel::BoneBatch& batch = data.GetBoneBatch(cookedMesh, uiBatch);
+				unsigned int uiSlot = uiPose + m_pData->m_lMeshes[node.m_iMesh].m_lBatchSlots[uiBatch];
 
-				int i32Count = pMesh->sBoneBatches.pnBatchBoneCnt[i32Batch];
-				for(int i = 0; i < i32Count; ++i)
+				if( bBoneBlock )
 				{
-					// Get the Node of the bone
-					int i32NodeID = pMesh->sBoneBatches.pnBatches[i32Batch * pMesh->sBoneBatches.nBatchBoneMax + i];
-
-					// Get the World transformation matrix for this bone and combine it with our app defined
-					// transformation matrix
-					PVRTMat4 mOut = m_pod.GetBoneWorldMatrix(*pNode, m_pod.pNode[i32NodeID]);
-					amBoneWorld2[i] = *(glm::mat4*)&mOut;
-
-					// Calculate the inverse transpose of the 3x3 rotation/scale part for correct lighting
-					glm::mat3 mTemp(amBoneWorld2[i]);
-					afBoneWorldIT2[i] = glm::transpose(glm::inverse(mTemp));
+					SkinningManager::BindBones(uiSlot);
 				}
-				m_pMaterial->SetUniform("BoneMatrixArray", amBoneWorld2, i32Count);
-				m_pMaterial->SetUniform("BoneMatrixArrayIT", afBoneWorldIT2, i32Count);
-
-				// Find number of triangles to draw for this batch
-				int i32Tris;
-				if(i32Batch+1 < pMesh->sBoneBatches.nBatchCnt)
-					i32Tris = pMesh->sBoneBatches.pnBatchOffset[i32Batch+1] - pMesh->sBoneBatches.pnBatchOffset[i32Batch];
 				else
-					i32Tris = pMesh->nNumFaces - pMesh->sBoneBatches.pnBatchOffset[i32Batch];
+				{
+					// Copy the batch's bones out into the program's uniform arrays
+					const SkinningManager::BoneMatrices* pBones = SkinningManager::GetBones(uiSlot);
+					int iCount = (int)(batch.m_uiNumBones < SkinningManager::s_uiMaxBatchBones ? batch.m_uiNumBones : SkinningManager::s_uiMaxBatchBones);
+					gs_lBoneWorld.resize(iCount);
+					gs_lBoneWorldIT.resize(iCount);
+					for(int b = 0; b < iCount; ++b)
+					{
+						gs_lBoneWorld[b] = pBones[b].m_mWorld;
+						gs_lBoneWorldIT[b] = glm::mat3(pBones[b].m_mWorldIT);
+					}
+					pMaterial->SetUniform(m_pData->m_hBoneMatrixArray, &gs_lBoneWorld[0], iCount);
+					pMaterial->SetUniform(m_pData->m_hBoneMatrixArrayIT, &gs_lBoneWorldIT[0], iCount);
+				}
 
 				// Apply the material
-				m_pMaterial->Apply();
+				pMaterial->Apply();
 
 				// Draw it!
-				size_t offset = sizeof(GLushort) * 3 * pMesh->sBoneBatches.pnBatchOffset[i32Batch];
-				glDrawElements(GL_TRIANGLES, i32Tris * 3, GL_UNSIGNED_SHORT, (void*) offset);
+				size_t offset = sizeof(GLushort) * 3 * batch.m_uiFirstTriangle;
+				glDrawElements(GL_TRIANGLES, batch.m_uiNumTriangles * 3, GL_UNSIGNED_SHORT, (void*) offset);
 			}
 		}
 		else
 		{
 			// Apply the material
-			m_pMaterial->Apply();
+			pMaterial->Apply();
 
 			// Draw it!
-			glDrawElements(GL_TRIANGLES, m_lMeshes[pNode->nIdx].m_pIB->GetNumIndices(), GL_UNSIGNED_SHORT, 0);
+			glDrawElements(GL_TRIANGLES, m_pData->m_lMeshes[node.m_iMesh].m_pIB->GetNumIndices(), GL_UNSIGNED_SHORT, 0);
+		}
+	}
+}
+
+
+//----------------------------------------------------------
+// Returns true if this model can be drawn with
+// RenderInstanced(), i.e. it isn't skinned and its program
+// takes the world matrix per instance
+//----------------------------------------------------------
+bool Model::IsInstanceable() const
+{
+	return IsReady() && !m_pData->m_bSkinned && m_pData->m_pMaterial->GetProgram() && m_pData->m_pMaterial->GetProgram()->IsInstanced();
+}
+
+//----------------------------------------------------------
+// Returns true if the given model can go in the same
+// instanced draw as this one: loaded from the same file so
+// the meshes and material are shared
+//----------------------------------------------------------
+bool Model::CanInstanceWith(const Model* p_pOther) const
+{
+	return IsInstanceable() && p_pOther->m_pData == m_pData;
+}
+
+//----------------------------------------------------------
+// Renders all the given instances with this model's buffers
+// using one instanced draw per mesh node. Every instance must
+// pass CanInstanceWith() for this model. Node transforms come
+// from each instance, so instances can be on different
+// animation frames.
+//----------------------------------------------------------
+void Model::RenderInstanced(Model* const* p_apInstances, unsigned int p_uiNumInstances, wolf::VertexBuffer* p_pInstanceVB, const glm::mat4& p_mView, const glm::mat4& p_mProj)
+{
+	const CookedModel& data = m_pData->m_data;
+	Material* pMaterial = m_pData->m_pMaterial;
+
+	assert(IsInstanceable());
+
+	if( !pMaterial->GetProgram()->HasUniformBlock(wolf::UB_Frame) )
+	{
+		pMaterial->SetUniform(m_pData->m_hProjection, p_mProj);
+		pMaterial->SetUniform(m_pData->m_hView, p_mView);
+	}
+
+	gs_lInstanceTransforms.resize(p_uiNumInstances);
+
+	for(unsigned int i = 0; i < data.GetHeader().m_uiNumMeshNodes; i++)
+	{
+		const CookedModel::Node& node = data.GetNode(i);
+		if( node.m_iMesh == -1 )
+			continue;
+
+		// Gather every instance's world matrix for this node
+		for(unsigned int j = 0; j < p_uiNumInstances; j++)
+		{
+			const Model* pInstance = p_apInstances[j];
+			assert(CanInstanceWith(pInstance));
+
+			gs_lInstanceTransforms[j] = pInstance->m_mWorldTransform * data.GetNodeWorld(i, pInstance->m_fFrame);
+		}
+
+		const ModelData::Mesh& mesh = m_pData->m_lMeshes[node.m_iMesh];
+		mesh.m_pDecl->Bind();
+
+		// Attach the instance buffer to the mesh, one matrix per instance
+		p_pInstanceVB->Stream(&gs_lInstanceTransforms[0], p_uiNumInstances * sizeof(glm::mat4));
+		for( int c = 0; c < 4; c++ )
+		{
+			glEnableVertexAttribArray(wolf::AT_InstanceWorld + c);
+			glVertexAttribPointer(wolf::AT_InstanceWorld + c, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(sizeof(glm::vec4) * c));
+			glVertexAttribDivisor(wolf::AT_InstanceWorld + c, 1);
+		}
+
+		pMaterial->Apply();
+		glDrawElementsInstanced(GL_TRIANGLES, mesh.m_pIB->GetNumIndices(), GL_UNSIGNED_SHORT, 0, p_uiNumInstances);
+
+		// Detach it again so single draws of this mesh go back to the constant
+		for( int c = 0; c < 4; c++ )
+		{
+			glVertexAttribDivisor(wolf::AT_InstanceWorld + c, 0);
+			glDisableVertexAttribArray(wolf::AT_InstanceWorld + c);
 		}
 	}
 }
@@ -2,7 +2,14 @@
 // File:			W_Model.h
 // Original Author:	Gordon Wood
 //
-// Class representing a model that can be loaded from a POD file
+// Class representing one copy (instance) of a model that can be loaded from a
+// POD file. It only holds what's particular to this copy - transform and
+// animation frame; the meshes and material are in a ModelData shared with every
+// other copy of the same file. Create and destroy them with ModelManager.
+//
+// The POD is only parsed the first time; after that the cooked version saved
+// next to it is mapped and uploaded directly (see CookedModel). Models created
+// with ModelManager::CreateModelAsync() don't draw until IsReady().
 //
 // ASSUMPTIONS:
 //	1) POD files will always be exported as Index Triangle Lists
@@ -20,7 +27,7 @@
 #include "W_VertexDeclaration.h"
 #include "W_TextureManager.h"
 #include "W_ProgramManager.h"
-#include "PVRTModelPOD.h"
+#include "W_ModelData.h"
 #include <string>
 #include <map>
 #include <vector>
@@ -29,46 +36,50 @@ namespace wolf
 {
 class Model
 {
+	friend class ModelManager;
 	public:
 		//-------------------------------------------------------------------------
 		// PUBLIC INTERFACE
 		//-------------------------------------------------------------------------
-		Model(const std::string& p_strFile, const std::string& p_strTexturePrefix = "", const std::string& p_strVertexProgram = "", const std::string& p_strFragmentProgram = "");
-		~Model();
-
 		void Update(float p_fDelta);
 		void Render(const glm::mat4& p_mView, const glm::mat4& p_mProj);
+		void RenderInstanced(Model* const* p_apInstances, unsigned int p_uiNumInstances, wolf::VertexBuffer* p_pInstanceVB, const glm::mat4& p_mView, const glm::mat4& p_mProj);
 
-		void SetAnimFrame(float p_fFrame) { m_fFrame = p_fFrame; m_pod.SetFrame(m_fFrame); }
-		wolf::Material* GetMaterial() { return m_pMaterial; }
+		bool IsReady() const { return m_pData->m_bReady; }
+		void SetAnimFrame(float p_fFrame) { m_fFrame = p_fFrame; }
+		wolf::Material* GetMaterial() { return m_pData->m_pMaterial; }
 		void SetTransform(const glm::mat4& p_mWorldTransform) { m_mWorldTransform = p_mWorldTransform; }
-		//-------------------------------------------------------------------------
+		const glm::mat4& GetTransform() const { return m_mWorldTransform; }
+		const std::string& GetFile() const { return m_pData->m_strFile; }
 
-	private:
-		//-------------------------------------------------------------------------
-		// PRIVATE TYPES
-		//-------------------------------------------------------------------------
-		struct Mesh
-		{
-			wolf::VertexBuffer* m_pVB;
-			wolf::IndexBuffer* m_pIB;
-			wolf::VertexDeclaration* m_pDecl;
-		};
+		bool IsInstanceable() const;
+
+		// Model space bounding box of all the meshes, for culling
+		const glm::vec3& GetBoundsMin() const { return m_pData->m_vBoundsMin; }
+		const glm::vec3& GetBoundsMax() const { return m_pData->m_vBoundsMax; }
+
+		// Slot for whoever culls this model to keep its id in
+		void SetCullProxy(int p_iProxy) { m_iCullProxy = p_iProxy; }
+		int GetCullProxy() const { return m_iCullProxy; }
+		bool CanInstanceWith(const Model* p_pOther) const;
 		//-------------------------------------------------------------------------
 
+	private:
 		//-------------------------------------------------------------------------
 		// PRIVATE METHODS
 		//-------------------------------------------------------------------------
+		// Made private to enforce creation and deletion via ModelManager
+		Model(ModelData* p_pData);
+		~Model();
 		//-------------------------------------------------------------------------
 
 		//-------------------------------------------------------------------------
 		// PRIVATE MEMBERS
 		//-------------------------------------------------------------------------
+		ModelData*			m_pData;
 		float				m_fFrame;
-		CPVRTModelPOD		m_pod;
-		std::vector<Mesh>	m_lMeshes;
-		Material*			m_pMaterial;
 		glm::mat4			m_mWorldTransform;
+		int					m_iCullProxy;
 		//-------------------------------------------------------------------------
 };
 
@@ -0,0 +1,340 @@
+//-----------------------------------------------------------------------------
+// File:			W_ModelData.cpp
+// Original Author:	agent
+// Material and buffer setup moved here from Gordon Wood's W_Model.cpp
+//
+// See header for notes
+//-----------------------------------------------------------------------------
+#include "W_ModelData.h"
+#include "W_BufferManager.h"
+#include "W_MaterialManager.h"
+#include "W_TextureManager.h"
+#include "W_AssetLoader.h"
+#include "W_SkinningManager.h"
+
+namespace wolf
+{
+//----------------------------------------------------------
+// Loads (or cooks) the model file on one of AssetLoader's
+// threads and hands it to its ModelData to upload once back
+// on the main thread
+//----------------------------------------------------------
+class ModelData::LoadJob : public AssetLoader::Job
+{
+	public:
+		LoadJob(ModelData* p_pModelData) : m_pModelData(p_pModelData), m_strFile(p_pModelData->m_strFile) {}
+
+		virtual void Load()
+		{
+			LoadData(m_data, m_strFile);
+		}
+
+		virtual void Finish()
+		{
+			m_pModelData->m_pLoadJob = 0;
+			m_pModelData->m_data.Swap(m_data);
+			m_pModelData->Upload(true);
+		}
+
+	private:
+		ModelData*		m_pModelData;
+		std::string		m_strFile;
+		CookedModel		m_data;
+};
+
+//----------------------------------------------------------
+// Constructor. If async, the file is loaded by AssetLoader
+// and this isn't ready until then.
+//----------------------------------------------------------
+ModelData::ModelData(const std::string& p_strFile, const std::string& p_strTexturePrefix, const std::string& p_strVertexProgram, const std::string& p_strFragmentProgram, bool p_bAsync) 
+	:
+	m_strFile(p_strFile),
+	m_strTexturePrefix(p_strTexturePrefix),
+	m_strVertexProgram(p_strVertexProgram),
+	m_strFragmentProgram(p_strFragmentProgram),
+	m_bReady(false),
+	m_bSkinned(false),
+	m_pMaterial(0),
+	m_uiNumPoseSlots(0),
+	m_pLoadJob(0)
+{
+	if( p_bAsync )
+	{
+		// Before queueing, as it may be finished on the spot
+		m_pLoadJob = new LoadJob(this);
+		AssetLoader::Queue(m_pLoadJob);
+		return;
+	}
+
+	LoadData(m_data, p_strFile);
+	Upload(false);
+}
+
+//----------------------------------------------------------
+// Loads the given model file into p_data. Uses the cooked
+// version of the file if there's an up to date one, otherwise
+// parses the POD now and saves it cooked for next time. Only
+// touches files, so is safe on any thread.
+//----------------------------------------------------------
+void ModelData::LoadData(CookedModel& p_data, const std::string& p_strFile)
+{
+	std::string strCooked = CookedModel::GetCookedFileName(p_strFile);
+	if( !p_data.Load(strCooked, p_strFile) )
+	{
+		if( p_data.Cook(p_strFile) )
+			p_data.Save(strCooked);
+	}
+}
+
+//----------------------------------------------------------
+// Builds the GPU buffers and material from the loaded data,
+// after which we're ready to render
+//----------------------------------------------------------
+void ModelData::Upload(bool p_bAsyncTextures)
+{
+	const CookedModel::Header& header = m_data.GetHeader();
+	m_bSkinned = header.m_uiSkinned != 0;
+	m_vBoundsMin = glm::make_vec3(header.m_afBoundsMin);
+	m_vBoundsMax = glm::make_vec3(header.m_afBoundsMax);
+
+	// The diffuse texture can come from an atlas if the UVs can be moved into
+	// its region: they have to stay inside the texture (no repeating), and
+	// there can't be a specular map sharing them
+	bool bAllowAtlas = true;
+	for(unsigned int i = 0; i < header.m_uiNumMeshes && bAllowAtlas; i++)
+	{
+		bAllowAtlas = UVsInUnitRange(m_data.GetMesh(i));
+	}
+	for(unsigned int i = 0; i < header.m_uiNumMeshNodes && bAllowAtlas; i++)
+	{
+		const CookedModel::Node& node = m_data.GetNode(i);
+		if (node.m_iMaterial != -1 && m_data.GetMaterial(node.m_iMaterial).m_szSpecular[0])
+		{
+			bAllowAtlas = false;
+		}
+	}
+	wolf::Texture* pDiffuse = 0;
+
+	// Now make sure the material manager knows about all materials we'll need
+	// CLASS NOTE: This does a bunch of work more than once (like if many nodes
+	// reference the same material - which is likely). This is a candidate for
+	// cleanup as an exercise
+	for(unsigned int i = 0; i < header.m_uiNumMeshNodes; i++)
+	{
+		const CookedModel::Node& node = m_data.GetNode(i);
+
+		if (node.m_iMaterial == -1)
+		{
+			continue;
+		}
+
+		const CookedModel::Material& cookedMat = m_data.GetMaterial(node.m_iMaterial);
+        
+		// Not been created yet, so add it
+		m_pMaterial = wolf::MaterialManager::CreateMaterial(cookedMat.m_szName);
+
+		// CLASS NOTE: Provide a way to override shaders in some way? Have a think
+		// about this.
+		if (!m_strVertexProgram.empty() && !m_strFragmentProgram.empty())
+		{
+			m_pMaterial->SetProgram(m_strVertexProgram, m_strFragmentProgram);
+		}
+		else
+		{
+			m_pMaterial->SetProgram("data/week9/textured.vsh", "data/week9/textured.fsh");
+		}
+
+		// Grab the texture it's using. The cooked name already expects our TGA
+		// converted files, so it just needs the right path.
+        if( cookedMat.m_szDiffuse[0] )
+        {
+            std::string strFilename = m_strTexturePrefix + cookedMat.m_szDiffuse;
+
+            // Create the texture, make sure it's set to repeat, and assign it
+            // to the material
+            wolf::Texture* pTex = p_bAsyncTextures ? wolf::TextureManager::CreateTextureAsync(strFilename, bAllowAtlas) : wolf::TextureManager::CreateTexture(strFilename, bAllowAtlas);
+            pTex->SetWrapMode(wolf::Texture::WM_Repeat);
+            m_pMaterial->SetTexture("texture1",pTex);
+            pDiffuse = pTex;
+		}
+
+		// Specular map texture if it has one
+		if (cookedMat.m_szSpecular[0])
+		{
+			std::string strFilename = m_strTexturePrefix + cookedMat.m_szSpecular;
+
+			// Create the texture, make sure it's set to repeat, and assign it
+			// to the material
+			wolf::Texture* pTex = p_bAsyncTextures ? wolf::TextureManager::CreateTextureAsync(strFilename, false) : wolf::TextureManager::CreateTexture(strFilename, false);
+			pTex->SetWrapMode(wolf::Texture::WM_Repeat);
+			m_pMaterial->SetTexture("texture2",pTex);
+		}
+        
+		// CLASS NOTE: I'm not reading blend modes from the materials in the POD
+		// file. This is bad and will lead to incorrect rendering. Add some code
+		// to look in the POD file for this data and set it up in the
+		// wolf::Material accordingly!
+	}
+
+
+	// Build all the meshes straight from the cooked data
+	for(unsigned int i = 0; i < header.m_uiNumMeshes; i++)
+	{
+		const CookedModel::Mesh& cookedMesh = m_data.GetMesh(i);
+
+		// Create the vertex buffer, with the UVs moved into the diffuse
+		// texture's atlas region if it's in one
+		wolf::VertexBuffer* pVB;
+		if( pDiffuse && pDiffuse->IsAtlasRegion() )
+		{
+			const char* pVerts = (const char*)m_data.GetVertexData(cookedMesh);
+			std::vector<char> lVerts(pVerts, pVerts + cookedMesh.m_uiVertexSize);
+			MapUVsToRect(cookedMesh, &lVerts[0], pDiffuse->GetUVRect());
+			pVB = wolf::BufferManager::CreateVertexBuffer(&lVerts[0], cookedMesh.m_uiVertexSize);
+		}
+		else
+		{
+			pVB = wolf::BufferManager::CreateVertexBuffer(m_data.GetVertexData(cookedMesh), cookedMesh.m_uiVertexSize);
+		}
+
+		// Create the index buffer
+		wolf::IndexBuffer* pIB = wolf::BufferManager::CreateIndexBuffer(cookedMesh.m_uiNumIndices);
+		pIB->Write(m_data.GetIndexData(cookedMesh));
+
+		// Create the vertex declaration
+		wolf::VertexDeclaration* pDecl = new wolf::VertexDeclaration;
+		pDecl->Begin();
+		for(unsigned int x = 0; x < cookedMesh.m_uiNumAttributes; x++)
+		{
+			const CookedModel::Attribute& attr = cookedMesh.m_aAttributes[x];
+			pDecl->AppendAttribute((wolf::Attribute)attr.m_uiAttribute, attr.m_iNumComponents, (wolf::ComponentType)attr.m_uiType, attr.m_iOffset);
+		}
+		pDecl->SetVertexBuffer(pVB);
+		pDecl->SetIndexBuffer(pIB);
+		pDecl->End();
+    
+		// Add them to our list of meshes
+		Mesh m;
+		m.m_pVB = pVB;
+		m.m_pIB = pIB;
+		m.m_pDecl = pDecl;
+
+		// Lay its batches' bones out in our poses, each batch starting where
+		// its range of the bone buffer can be bound
+		for(unsigned int uiBatch = 0; uiBatch < cookedMesh.m_uiNumBoneBatches; uiBatch++)
+		{
+			unsigned int uiNumBones = m_data.GetBoneBatch(cookedMesh, uiBatch).m_uiNumBones;
+			if( uiNumBones > SkinningManager::s_uiMaxBatchBones )
+			{
+				printf("WARNING: %s has a bone batch of %d bones, only %d are used\n", m_strFile.c_str(), uiNumBones, SkinningManager::s_uiMaxBatchBones);
+				uiNumBones = SkinningManager::s_uiMaxBatchBones;
+			}
+
+			unsigned int uiAlign = SkinningManager::GetSlotAlignment();
+			m.m_lBatchSlots.push_back(m_uiNumPoseSlots);
+			m_uiNumPoseSlots += (uiNumBones + uiAlign - 1) / uiAlign * uiAlign;
+		}
+		m_lMeshes.push_back(m);
+	}
+
+	FindUniformHandles();
+	m_bReady = true;
+}
+
+//----------------------------------------------------------
+// Finds the given mesh's first UV channel, if it's one we can
+// read and rewrite (two or more floats). Returns NULL if not.
+//----------------------------------------------------------
+static const CookedModel::Attribute* FindUVs(const CookedModel::Mesh& p_mesh)
+{
+	for(unsigned int i = 0; i < p_mesh.m_uiNumAttributes; i++)
+	{
+		const CookedModel::Attribute& attr = p_mesh.m_aAttributes[i];
+		if( attr.m_uiAttribute == AT_TexCoord1 )
+			return (attr.m_uiType == CT_Float && attr.m_iNumComponents >= 2) ? &attr : 0;
+	}
+	return 0;
+}
+
+//----------------------------------------------------------
+// Returns true if every UV in the given mesh is between 0 and
+// 1, so could be moved into an atlas region. Meshes without
+// UVs don't care where their texture is.
+//----------------------------------------------------------
+bool ModelData::UVsInUnitRange(const CookedModel::Mesh& p_mesh) const
+{
+	bool bHasUVs = false;
+	for(unsigned int i = 0; i < p_mesh.m_uiNumAttributes; i++)
+		bHasUVs |= p_mesh.m_aAttributes[i].m_uiAttribute == AT_TexCoord1;
+	if( !bHasUVs )
+		return true;
+
+	const CookedModel::Attribute* pUVs = FindUVs(p_mesh);
+	if( !pUVs || p_mesh.m_uiVertexStride == 0 )
+		return false;
+
+	const char* pVerts = (const char*)m_data.GetVertexData(p_mesh);
+	for(unsigned int uiOfs = pUVs->m_iOffset; uiOfs + 2 * sizeof(float) <= p_mesh.m_uiVertexSize; uiOfs += p_mesh.m_uiVertexStride)
+	{
+		const float* pUV = (const float*)(pVerts + uiOfs);
+		if( pUV[0] < 0.0f || pUV[0] > 1.0f || pUV[1] < 0.0f || pUV[1] > 1.0f )
+			return false;
+	}
+	return true;
+}
+
+//----------------------------------------------------------
+// Rewrites the UVs in the given copy of a mesh's vertices to
+// cover just the given (u0, v0, u1, v1) part of the texture
+//----------------------------------------------------------
+void ModelData::MapUVsToRect(const CookedModel::Mesh& p_mesh, char* p_pVerts, const glm::vec4& p_vUVRect)
+{
+	const CookedModel::Attribute* pUVs = FindUVs(p_mesh);
+	if( !pUVs || p_mesh.m_uiVertexStride == 0 )
+		return;
+
+	for(unsigned int uiOfs = pUVs->m_iOffset; uiOfs + 2 * sizeof(float) <= p_mesh.m_uiVertexSize; uiOfs += p_mesh.m_uiVertexStride)
+	{
+		float* pUV = (float*)(p_pVerts + uiOfs);
+		pUV[0] = p_vUVRect.x + pUV[0] * (p_vUVRect.z - p_vUVRect.x);
+		pUV[1] = p_vUVRect.y + pUV[1] * (p_vUVRect.w - p_vUVRect.y);
+	}
+}
+
+//----------------------------------------------------------
+// Looks up the handles of the uniforms Model::Render() sets, so it
+// doesn't have to find them by name every node every frame
+//----------------------------------------------------------
+void ModelData::FindUniformHandles()
+{
+	if( !m_pMaterial )
+		return;
+
+	m_hProjection = m_pMaterial->GetUniformHandle("projection");
+	m_hView = m_pMaterial->GetUniformHandle("view");
+	m_hWorld = m_pMaterial->GetUniformHandle("world");
+	m_hWorldViewProj = m_pMaterial->GetUniformHandle("WorldViewProj");
+	m_hWorldIT = m_pMaterial->GetUniformHandle("WorldIT");
+	m_hBoneMatrixArray = m_pMaterial->GetUniformHandle("BoneMatrixArray");
+	m_hBoneMatrixArrayIT = m_pMaterial->GetUniformHandle("BoneMatrixArrayIT");
+}
+
+//----------------------------------------------------------
+// Destructor
+//----------------------------------------------------------
+ModelData::~ModelData()
+{
+	// The job's still owned by AssetLoader, just make sure it leaves us alone
+	if( m_pLoadJob )
+		m_pLoadJob->Cancel();
+
+	for(unsigned int i = 0; i < m_lMeshes.size(); i++)
+	{
+		const Mesh& m = m_lMeshes[i];
+		wolf::BufferManager::DestroyBuffer(m.m_pVB);
+		wolf::BufferManager::DestroyBuffer(m.m_pIB);
+		delete m.m_pDecl;
+	}
+}
+
+}
@@ -0,0 +1,100 @@
+//-----------------------------------------------------------------------------
+// File:			W_ModelData.h
+// Original Author:	agent
+//
+// Everything about a model that's the same for every copy of it: the cooked
+// file, the GPU buffers built from it and its material. ModelManager keeps one
+// of these per file, shared by all the Models (instances) loaded from it.
+//
+// It can also be loaded in the background through AssetLoader, in which case
+// it has no meshes or material until it's ready, and Models using it don't
+// draw.
+//-----------------------------------------------------------------------------
+#ifndef W_MODELDATA_H
+#define W_MODELDATA_H
+
+#include "W_Types.h"
+#include "W_VertexBuffer.h"
+#include "W_IndexBuffer.h"
+#include "W_Material.h"
+#include "W_VertexDeclaration.h"
+#include "W_CookedModel.h"
+#include <string>
+#include <vector>
+
+namespace wolf
+{
+class ModelData
+{
+	friend class Model;
+	friend class ModelManager;
+	friend class SkinningManager;
+
+	private:
+		//-------------------------------------------------------------------------
+		// PRIVATE TYPES
+		//-------------------------------------------------------------------------
+		struct Mesh
+		{
+			wolf::VertexBuffer* m_pVB;
+			wolf::IndexBuffer* m_pIB;
+			wolf::VertexDeclaration* m_pDecl;
+
+			// Where each bone batch's bones start in a pose
+			std::vector<unsigned int> m_lBatchSlots;
+		};
+		//-------------------------------------------------------------------------
+
+		//-------------------------------------------------------------------------
+		// PRIVATE METHODS
+		//-------------------------------------------------------------------------
+		class LoadJob;
+
+		// Made private to enforce creation and deletion via ModelManager
+		ModelData(const std::string& p_strFile, const std::string& p_strTexturePrefix, const std::string& p_strVertexProgram, const std::string& p_strFragmentProgram, bool p_bAsync);
+		~ModelData();
+
+		static void LoadData(CookedModel& p_data, const std::string& p_strFile);
+		void Upload(bool p_bAsyncTextures);
+		bool UVsInUnitRange(const CookedModel::Mesh& p_mesh) const;
+		static void MapUVsToRect(const CookedModel::Mesh& p_mesh, char* p_pVerts, const glm::vec4& p_vUVRect);
+		void FindUniformHandles();
+		//-------------------------------------------------------------------------
+
+		//-------------------------------------------------------------------------
+		// PRIVATE MEMBERS
+		//-------------------------------------------------------------------------
+		std::string			m_strFile;
+		std::string			m_strTexturePrefix;
+		std::string			m_strVertexProgram;
+		std::string			m_strFragmentProgram;
+		bool				m_bReady;
+		bool				m_bSkinned;
+		CookedModel			m_data;
+		std::vector<Mesh>	m_lMeshes;
+		Material*			m_pMaterial;
+
+		// Bones in a pose of this model, see SkinningManager
+		unsigned int		m_uiNumPoseSlots;
+
+		// Handles of the uniforms set on every render
+		Material::UniformHandle	m_hProjection;
+		Material::UniformHandle	m_hView;
+		Material::UniformHandle	m_hWorld;
+		Material::UniformHandle	m_hWorldViewProj;
+		Material::UniformHandle	m_hWorldIT;
+		Material::UniformHandle	m_hBoneMatrixArray;
+		Material::UniformHandle	m_hBoneMatrixArrayIT;
+
+		// Model space bounding box of all the meshes, for culling
+		glm::vec3			m_vBoundsMin;
+		glm::vec3			m_vBoundsMax;
+
+		// Set while loading in the background
+		LoadJob*			m_pLoadJob;
+		//-------------------------------------------------------------------------
+};
+
+}
+
+#endif
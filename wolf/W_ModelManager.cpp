@@ -0,0 +1,87 @@
+//-----------------------------------------------------------------------------
+// File:			W_ModelManager.cpp
+// Original Author:	agent
+//
+// See header for notes
+//-----------------------------------------------------------------------------
+#include "W_ModelManager.h"
+#include <cassert>
+
+namespace wolf
+{
+
+std::map<std::string, ModelManager::Entry*>	ModelManager::m_models;
+
+//----------------------------------------------------------
+// Creates a new Model, loading its data or sharing an
+// existing copy if it was loaded previously
+//----------------------------------------------------------
+Model* ModelManager::CreateModel(const std::string& p_strFile, const std::string& p_strTexturePrefix, const std::string& p_strVertexProgram, const std::string& p_strFragmentProgram)
+{
+	return CreateModel(p_strFile, p_strTexturePrefix, p_strVertexProgram, p_strFragmentProgram, false);
+}
+
+//----------------------------------------------------------
+// Same as CreateModel(), but new data is loaded in the
+// background by AssetLoader, and the model doesn't draw until
+// it's done (see Model::IsReady())
+//----------------------------------------------------------
+Model* ModelManager::CreateModelAsync(const std::string& p_strFile, const std::string& p_strTexturePrefix, const std::string& p_strVertexProgram, const std::string& p_strFragmentProgram)
+{
+	return CreateModel(p_strFile, p_strTexturePrefix, p_strVertexProgram, p_strFragmentProgram, true);
+}
+
+//----------------------------------------------------------
+// Does the work for both of the above. Existing data is
+// shared as is, even if it's still loading.
+//----------------------------------------------------------
+Model* ModelManager::CreateModel(const std::string& p_strFile, const std::string& p_strTexturePrefix, const std::string& p_strVertexProgram, const std::string& p_strFragmentProgram, bool p_bAsync)
+{
+	std::string strKey = p_strFile + "|" + p_strTexturePrefix + "|" + p_strVertexProgram + "|" + p_strFragmentProgram;
+	std::map<std::string, Entry*>::iterator iter = m_models.find(strKey);
+
+	Entry* pEntry;
+	if( iter != m_models.end() )
+	{
+		pEntry = iter->second;
+	}
+	else
+	{
+		pEntry = new Entry(new ModelData(p_strFile, p_strTexturePrefix, p_strVertexProgram, p_strFragmentProgram, p_bAsync));
+		m_models[strKey] = pEntry;
+	}
+
+	pEntry->m_iRefCount++;
+	return new Model(pEntry->m_pData);
+}
+
+//----------------------------------------------------------
+// Destroys a model. Its data is only actually deleted once
+// no models are using it.
+//----------------------------------------------------------
+void ModelManager::DestroyModel(Model* p_pModel)
+{
+	ModelData* pData = p_pModel->m_pData;
+	delete p_pModel;
+
+	std::map<std::string, Entry*>::iterator iter;
+	for( iter = m_models.begin(); iter != m_models.end(); iter++ )
+	{
+		if( iter->second->m_pData == pData )
+		{
+			iter->second->m_iRefCount--;
+			if( iter->second->m_iRefCount == 0 )
+			{
+				delete iter->second->m_pData;
+				delete iter->second;
+				m_models.erase(iter);
+			}
+			return;
+		}
+	}
+
+	// Should never get here!
+	assert(false);
+}
+
+}
@@ -0,0 +1,59 @@
+//-----------------------------------------------------------------------------
+// File:			W_ModelManager.h
+// Original Author:	agent
+//
+// Class to manage models. Every model created gets its own Model (transform,
+// animation frame), but the data loaded from the file - meshes, GPU buffers and
+// material - is loaded once and shared by every Model made from that file.
+//-----------------------------------------------------------------------------
+#ifndef W_MODEL_MANAGER_H
+#define W_MODEL_MANAGER_H
+
+#include "W_Types.h"
+#include "W_Model.h"
+#include <string>
+#include <map>
+
+namespace wolf
+{
+class ModelManager
+{
+	public:
+		//-------------------------------------------------------------------------
+		// PUBLIC INTERFACE
+		//-------------------------------------------------------------------------
+		static Model* CreateModel(const std::string& p_strFile, const std::string& p_strTexturePrefix = "", const std::string& p_strVertexProgram = "", const std::string& p_strFragmentProgram = "");
+		static Model* CreateModelAsync(const std::string& p_strFile, const std::string& p_strTexturePrefix = "", const std::string& p_strVertexProgram = "", const std::string& p_strFragmentProgram = "");
+		static void DestroyModel(Model* p_pModel);
+		//-------------------------------------------------------------------------
+
+	private:
+		//-------------------------------------------------------------------------
+		// PRIVATE TYPES
+		//-------------------------------------------------------------------------
+		struct Entry
+		{
+			ModelData*	m_pData;
+			int			m_iRefCount;
+			Entry(ModelData* p_pData) : m_pData(p_pData), m_iRefCount(0) {}
+		};
+		//-------------------------------------------------------------------------
+
+		//-------------------------------------------------------------------------
+		// PRIVATE METHODS
+		//-------------------------------------------------------------------------
+		static Model* CreateModel(const std::string& p_strFile, const std::string& p_strTexturePrefix, const std::string& p_strVertexProgram, const std::string& p_strFragmentProgram, bool p_bAsync);
+		//-------------------------------------------------------------------------
+
+		//-------------------------------------------------------------------------
+		// PRIVATE MEMBERS
+		//-------------------------------------------------------------------------
+		// Keyed on everything the data is loaded with, not just the file, as the
+		// textures and programs end up in it too
+		static std::map<std::string, Entry*>	m_models;
+		//-------------------------------------------------------------------------
+};
+
+}
+
+#endif
@@ -6,6 +6,7 @@
 //-----------------------------------------------------------------------------
 #include "W_Program.h"
 #include "W_Common.h"
+#include <algorithm>
 
 namespace wolf
 {
@@ -28,10 +29,18 @@ static const char* gs_aAttributeMap[wolf::AT_NUM_ATTRIBS] =
 	"a_boneWeights"	//AT_BoneWeight
 };
 
+static const char* gs_aUniformBlockMap[wolf::UB_NUM_BLOCKS] =
+{
+	"FrameData",	//UB_Frame
+	"BoneData",		//UB_Bones
+};
+
+GLuint Program::m_uiProgramCurr = 0;
+
 //----------------------------------------------------------
 // Constructor
 //----------------------------------------------------------
-Program::Program(const std::string& p_strVS, const std::string& p_strPS) : m_uiProgram(0)
+Program::Program(const std::string& p_strVS, const std::string& p_strPS) : m_uiProgram(0), m_bInstanced(false), m_uiUniformBlocks(0), m_uiUniformOwner(0)
 {
     GLuint uiVS, uiPS;
     
@@ -62,6 +71,7 @@ Program::Program(const std::string& p_strVS, const std::string& p_strPS) : m_uiP
 	{
 		glBindAttribLocation(m_uiProgram, i, gs_aAttributeMap[i]);
 	}
+	glBindAttribLocation(m_uiProgram, wolf::AT_InstanceWorld, "a_instanceWorld");
     
     // 6. Link program.
     if( !LinkProgram() )
@@ -84,6 +94,20 @@ Program::Program(const std::string& p_strVS, const std::string& p_strPS) : m_uiP
         return;
     }
     
+	m_bInstanced = glGetAttribLocation(m_uiProgram, "a_instanceWorld") == wolf::AT_InstanceWorld;
+	ReflectUniforms();
+
+	// Hook any shared uniform blocks the program uses up to their binding points
+	for( int i = 0; i < wolf::UB_NUM_BLOCKS; i++ )
+	{
+		GLuint uiIndex = glGetUniformBlockIndex(m_uiProgram, gs_aUniformBlockMap[i]);
+		if( uiIndex != GL_INVALID_INDEX )
+		{
+			glUniformBlockBinding(m_uiProgram, uiIndex, i);
+			m_uiUniformBlocks |= 1 << i;
+		}
+	}
+
     // Release vertex and fragment shaders.
     if( uiVS )
         glDeleteShader(uiVS);
@@ -98,28 +122,122 @@ Program::~Program()
 {
 	if( m_uiProgram )
 		glDeleteProgram(m_uiProgram);
+
+	// GL may hand the name out again, so don't let the cache match it
+	if( m_uiProgramCurr == m_uiProgram )
+		m_uiProgramCurr = 0;
 }
 
 //----------------------------------------------------------
-// Binds this program as the current one
+// Binds this program as the current one. All programs are
+// bound through here, so we can skip binding the one that's
+// already current.
 //----------------------------------------------------------
 void Program::Bind()
 {
+	if( m_uiProgram == m_uiProgramCurr )
+		return;
+
+	m_uiProgramCurr = m_uiProgram;
 	glUseProgram(m_uiProgram);
 }
 
+//----------------------------------------------------------
+// Returns the location of the given uniform, or -1 if the
+// program has no active uniform by that name
+//----------------------------------------------------------
+int Program::GetUniformLocation(const char* p_strName) const
+{
+	std::vector<UniformLocation>::const_iterator iter = std::lower_bound(m_uniformLocations.begin(), m_uniformLocations.end(), p_strName, UniformLocationLess());
+	if( iter == m_uniformLocations.end() || strcmp(iter->first.c_str(), p_strName) != 0 )
+		return -1;
+	return iter->second;
+}
+
+//----------------------------------------------------------
+// Sets a matrix uniform at the given location
+//----------------------------------------------------------
+void Program::SetUniform(int p_iLoc, const glm::mat4& p_m)
+{
+	m_uiUniformOwner = 0;
+	glUniformMatrix4fv(p_iLoc, 1, GL_FALSE, glm::value_ptr(p_m));
+}
+
+//----------------------------------------------------------
+// Sets a matrix uniform at the given location
+//----------------------------------------------------------
+void Program::SetUniform(int p_iLoc, const glm::mat3& p_m)
+{
+	m_uiUniformOwner = 0;
+	glUniformMatrix3fv(p_iLoc, 1, GL_FALSE, glm::value_ptr(p_m));
+}
+
+//----------------------------------------------------------
+// Sets a vector uniform at the given location
+//----------------------------------------------------------
+void Program::SetUniform(int p_iLoc, const glm::vec3& p_v)
+{
+	m_uiUniformOwner = 0;
+	glUniform3fv(p_iLoc, 1, glm::value_ptr(p_v));
+}
+
+//----------------------------------------------------------
+// Sets a vector uniform at the given location
+//----------------------------------------------------------
+void Program::SetUniform(int p_iLoc, const glm::vec4& p_v)
+{
+	m_uiUniformOwner = 0;
+	glUniform4fv(p_iLoc, 1, glm::value_ptr(p_v));
+}
+
+//----------------------------------------------------------
+// Sets a floating point uniform at the given location
+//----------------------------------------------------------
+void Program::SetUniform(int p_iLoc, float p_f)
+{
+	m_uiUniformOwner = 0;
+	glUniform1f(p_iLoc, p_f);
+}
+
+//----------------------------------------------------------
+// Sets an int uniform at the given location
+//----------------------------------------------------------
+void Program::SetUniform(int p_iLoc, int p_i)
+{
+	m_uiUniformOwner = 0;
+	glUniform1i(p_iLoc, p_i);
+}
+
+//----------------------------------------------------------
+// Sets a mat4* uniform at the given location
+//----------------------------------------------------------
+void Program::SetUniform(int p_iLoc, const glm::mat4* p_m, int p_uiNumMatrices)
+{
+	m_uiUniformOwner = 0;
+	glUniformMatrix4fv(p_iLoc, p_uiNumMatrices, GL_FALSE, glm::value_ptr(*p_m));
+}
+
+//----------------------------------------------------------
+// Sets a mat3* uniform at the given location
+//----------------------------------------------------------
+void Program::SetUniform(int p_iLoc, const glm::mat3* p_m, int p_uiNumMatrices)
+{
+	m_uiUniformOwner = 0;
+	glUniformMatrix3fv(p_iLoc, p_uiNumMatrices, GL_FALSE, glm::value_ptr(*p_m));
+}
+
 //----------------------------------------------------------
 // Sets a matrix uniform of the given name
 //----------------------------------------------------------
 void Program::SetUniform(const char* p_strName, const glm::mat4& p_m)
 {
-	int iLoc = glGetUniformLocation(m_uiProgram,p_strName);
+	int iLoc = GetUniformLocation(p_strName);
 	if( iLoc == -1 )
 	{
 		//printf("WARNING: Unknown uniform %s\n", p_strName);
 		return;
 	}
-	glUniformMatrix4fv(iLoc, 1, GL_FALSE, glm::value_ptr(p_m));
+	SetUniform(iLoc, p_m);
 }
 
 //----------------------------------------------------------
@@ -127,13 +245,13 @@ void Program::SetUniform(const char* p_strName, const glm::mat4& p_m)
 //----------------------------------------------------------
 void Program::SetUniform(const char* p_strName, const glm::mat3& p_m)
 {
-	int iLoc = glGetUniformLocation(m_uiProgram,p_strName);
+	int iLoc = GetUniformLocation(p_strName);
 	if( iLoc == -1 )
 	{
 		//printf("WARNING: Unknown uniform %s\n", p_strName);
 		return;
 	}
-	glUniformMatrix3fv(iLoc, 1, GL_FALSE, glm::value_ptr(p_m));
+	SetUniform(iLoc, p_m);
 }
 
 //----------------------------------------------------------
@@ -141,13 +259,13 @@ void Program::SetUniform(const char* p_strName, const glm::mat3& p_m)
 //----------------------------------------------------------
 void Program::SetUniform(const char* p_strName, const glm::vec3& p_v)
 {
-	int iLoc = glGetUniformLocation(m_uiProgram,p_strName);
+	int iLoc = GetUniformLocation(p_strName);
 	if( iLoc == -1 )
 	{
 		//printf("WARNING: Unknown uniform %s\n", p_strName);
 		return;
 	}
-	glUniform3fv(iLoc, 1, glm::value_ptr(p_v));
+	SetUniform(iLoc, p_v);
 }
 
 //----------------------------------------------------------
@@ -155,13 +273,13 @@ void Program::SetUniform(const char* p_strName, const glm::vec3& p_v)
 //----------------------------------------------------------
 void Program::SetUniform(const char* p_strName, const glm::vec4& p_v)
 {
-	int iLoc = glGetUniformLocation(m_uiProgram,p_strName);
+	int iLoc = GetUniformLocation(p_strName);
 	if( iLoc == -1 )
 	{
 		//printf("WARNING: Unknown uniform %s\n", p_strName);
 		return;
 	}
-	glUniform4fv(iLoc, 1, glm::value_ptr(p_v));
+	SetUniform(iLoc, p_v);
 }
 
 //----------------------------------------------------------
@@ -169,13 +287,13 @@ void Program::SetUniform(const char* p_strName, const glm::vec4& p_v)
 //----------------------------------------------------------
 void Program::SetUniform(const char* p_strName, const wolf::Color4& p_c)
 {
-	int iLoc = glGetUniformLocation(m_uiProgram,p_strName);
+	int iLoc = GetUniformLocation(p_strName);
 	if( iLoc == -1 )
 	{
 		//printf("WARNING: Unknown uniform %s\n", p_strName);
 		return;
 	}
-	glUniform4fv(iLoc, 1, (GLfloat*)&p_c);
+	SetUniform(iLoc, glm::vec4(p_c.r, p_c.g, p_c.b, p_c.a));
 }
 
 //----------------------------------------------------------
@@ -183,13 +301,13 @@ void Program::SetUniform(const char* p_strName, const wolf::Color4& p_c)
 //----------------------------------------------------------
 void Program::SetUniform(const char* p_strName, float p_f)
 {
-	int iLoc = glGetUniformLocation(m_uiProgram,p_strName);
+	int iLoc = GetUniformLocation(p_strName);
 	if( iLoc == -1 )
 	{
 		//printf("WARNING: Unknown uniform %s\n", p_strName);
 		return;
 	}
-	glUniform1f(iLoc, p_f);
+	SetUniform(iLoc, p_f);
 }
 
 //----------------------------------------------------------
@@ -197,13 +315,13 @@ void Program::SetUniform(const char* p_strName, float p_f)
 //----------------------------------------------------------
 void Program::SetUniform(const char* p_strName, int p_i)
 {
-	int iLoc = glGetUniformLocation(m_uiProgram,p_strName);
+	int iLoc = GetUniformLocation(p_strName);
 	if( iLoc == -1 )
 	{
 		//printf("WARNING: Unknown uniform %s\n", p_strName);
 		return;
 	}
-	glUniform1i(iLoc, p_i);
+	SetUniform(iLoc, p_i);
 }
 
 
@@ -212,13 +330,13 @@ void Program::SetUniform(const char* p_strName, int p_i)
 //----------------------------------------------------------
 void Program::SetUniform(const char* p_strName, const glm::mat4* p_m, int p_uiNumMatrices)
 {
-	int iLoc = glGetUniformLocation(m_uiProgram,p_strName);
+	int iLoc = GetUniformLocation(p_strName);
 	if( iLoc == -1 )
 	{
 		printf("WARNING: Unknown uniform %s\n", p_strName);
 		return;
 	}
-	glUniformMatrix4fv(iLoc, p_uiNumMatrices, GL_FALSE, glm::value_ptr(*p_m));
+	SetUniform(iLoc, p_m, p_uiNumMatrices);
 }
 
 //----------------------------------------------------------
@@ -226,13 +344,13 @@ void Program::SetUniform(const char* p_strName, const glm::mat4* p_m, int p_uiNu
 //----------------------------------------------------------
 void Program::SetUniform(const char* p_strName, const glm::mat3* p_m, int p_uiNumMatrices)
 {
-	int iLoc = glGetUniformLocation(m_uiProgram,p_strName);
+	int iLoc = GetUniformLocation(p_strName);
 	if( iLoc == -1 )
 	{
 		printf("WARNING: Unknown uniform %s\n", p_strName);
 		return;
 	}
-	glUniformMatrix3fv(iLoc, p_uiNumMatrices, GL_FALSE, glm::value_ptr(*p_m));
+	SetUniform(iLoc, p_m, p_uiNumMatrices);
 }
 
 //----------------------------------------------------------
@@ -310,5 +428,39 @@ bool Program::LinkProgram()
     return true;
 }
 
+//----------------------------------------------------------
+// Builds the table of active uniform locations so setting
+// uniforms never has to ask GL. Arrays are listed as
+// "name[0]" by GL; they go in the table as just "name".
+//----------------------------------------------------------
+void Program::ReflectUniforms()
+{
+	m_uniformLocations.clear();
+
+	GLint iNumUniforms = 0, iMaxLength = 0;
+	glGetProgramiv(m_uiProgram, GL_ACTIVE_UNIFORMS, &iNumUniforms);
+	glGetProgramiv(m_uiProgram, GL_ACTIVE_UNIFORM_MAX_LENGTH, &iMaxLength);
+	if( iNumUniforms <= 0 || iMaxLength <= 0 )
+		return;
+
+	GLchar* pName = new GLchar[iMaxLength];
+	for( GLint i = 0; i < iNumUniforms; i++ )
+	{
+		GLsizei iLength = 0;
+		GLint iSize = 0;
+		GLenum eType;
+		glGetActiveUniform(m_uiProgram, i, iMaxLength, &iLength, &iSize, &eType, pName);
+
+		std::string strName(pName, iLength);
+		size_t uiBracket = strName.find('[');
+		if( uiBracket != std::string::npos )
+			strName.erase(uiBracket);
+
+		m_uniformLocations.push_back(UniformLocation(strName, glGetUniformLocation(m_uiProgram, pName)));
+	}
+	delete[] pName;
+
+	std::sort(m_uniformLocations.begin(), m_uniformLocations.end(), UniformLocationLess());
+}
 
 }
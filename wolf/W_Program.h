@@ -10,6 +10,8 @@
 
 #include "W_Types.h"
 #include <string>
+#include <vector>
+#include <cstring>
 
 namespace wolf
 {
@@ -21,6 +23,32 @@ class Program
 		// PUBLIC INTERFACE
 		//-------------------------------------------------------------------------
 		void Bind();
+		GLuint GetID() const { return m_uiProgram; }
+
+		// True if the program takes its world matrix from a_instanceWorld
+		bool IsInstanced() const { return m_bInstanced; }
+
+		// True if the program reads the given shared uniform block
+		bool HasUniformBlock(UniformBlock p_eBlock) const { return (m_uiUniformBlocks & (1 << p_eBlock)) != 0; }
+
+		// Location of the named active uniform from the table built at link
+		// time, or -1 if the program doesn't use it
+		int GetUniformLocation(const char* p_strName) const;
+
+		// Which material last uploaded all of its uniforms to this program.
+		// Setting uniforms by hand clears it.
+		unsigned int GetUniformOwner() const { return m_uiUniformOwner; }
+		void SetUniformOwner(unsigned int p_uiOwner) { m_uiUniformOwner = p_uiOwner; }
+
+		// Set uniforms at locations from GetUniformLocation(). Program must be bound.
+		void SetUniform(int p_iLoc, const glm::mat4& p_m);
+		void SetUniform(int p_iLoc, const glm::mat3& p_m);
+		void SetUniform(int p_iLoc, const glm::vec3& p_v);
+		void SetUniform(int p_iLoc, const glm::vec4& p_v);
+		void SetUniform(int p_iLoc, float p_f);
+		void SetUniform(int p_iLoc, int p_i);
+		void SetUniform(int p_iLoc, const glm::mat4* p_m, int p_uiNumMatrices);
+		void SetUniform(int p_iLoc, const glm::mat3* p_m, int p_uiNumMatrices);
 
         void SetUniform(const char* p_strName, const glm::mat4& p_m);
         void SetUniform(const char* p_strName, const glm::mat3& p_m);
@@ -34,6 +62,21 @@ class Program
 		//-------------------------------------------------------------------------
 
 	private:
+		//-------------------------------------------------------------------------
+		// PRIVATE TYPES
+		//-------------------------------------------------------------------------
+
+		// Uniform locations are kept sorted by name, and compared with strcmp
+		// so a char* name can be looked up without building a std::string
+		typedef std::pair<std::string, int> UniformLocation;
+		struct UniformLocationLess
+		{
+			bool operator()(const UniformLocation& p_a, const UniformLocation& p_b) const { return strcmp(p_a.first.c_str(), p_b.first.c_str()) < 0; }
+			bool operator()(const UniformLocation& p_a, const char* p_b) const { return strcmp(p_a.first.c_str(), p_b) < 0; }
+			bool operator()(const char* p_a, const UniformLocation& p_b) const { return strcmp(p_a, p_b.first.c_str()) < 0; }
+		};
+		//-------------------------------------------------------------------------
+
 		//-------------------------------------------------------------------------
 		// PRIVATE METHODS
 		//-------------------------------------------------------------------------
@@ -44,12 +87,21 @@ class Program
 		
 		bool CompileShader(GLuint* p_pShader, GLenum p_eType, const std::string& p_strFile);
 		bool LinkProgram();
+		void ReflectUniforms();
 		//-------------------------------------------------------------------------
 
 		//-------------------------------------------------------------------------
 		// PRIVATE MEMBERS
 		//-------------------------------------------------------------------------
 		GLuint		m_uiProgram;
+		bool		m_bInstanced;
+		unsigned int	m_uiUniformBlocks;
+
+		std::vector<UniformLocation>	m_uniformLocations;
+		unsigned int					m_uiUniformOwner;
+
+		// For caching
+		static GLuint	m_uiProgramCurr;
 		//-------------------------------------------------------------------------
 };
 
@@ -0,0 +1,140 @@
+//-----------------------------------------------------------------------------
+// File:			W_SkinningManager.cpp
+// Original Author:	agent
+//
+// See header for notes
+//-----------------------------------------------------------------------------
+#include "W_SkinningManager.h"
+#include "W_BufferManager.h"
+#include "W_ModelData.h"
+#include <algorithm>
+
+namespace wolf
+{
+
+std::vector<SkinningManager::BoneMatrices>			SkinningManager::m_lBones;
+std::map<SkinningManager::PoseKey, unsigned int>	SkinningManager::m_poses;
+UniformBuffer*										SkinningManager::m_pBuffer = 0;
+unsigned int										SkinningManager::m_uiSlotAlignment = 0;
+
+//----------------------------------------------------------
+// Forgets last frame's poses. Draws already made with them
+// still see them, as the buffer's storage is orphaned.
+//----------------------------------------------------------
+void SkinningManager::BeginFrame()
+{
+	m_lBones.clear();
+	m_poses.clear();
+	if( m_pBuffer )
+		m_pBuffer->Discard();
+}
+
+//----------------------------------------------------------
+// Frees the buffer
+//----------------------------------------------------------
+void SkinningManager::Shutdown()
+{
+	m_lBones.clear();
+	m_poses.clear();
+	if( m_pBuffer )
+	{
+		BufferManager::DestroyBuffer(m_pBuffer);
+		m_pBuffer = 0;
+	}
+}
+
+//----------------------------------------------------------
+// Returns the number of bones every batch's start is rounded
+// up to, so its range can be bound
+//----------------------------------------------------------
+unsigned int SkinningManager::GetSlotAlignment()
+{
+	if( m_uiSlotAlignment == 0 )
+	{
+		GLint iAlign = 0;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &iAlign);
+		m_uiSlotAlignment = std::max(1u, (unsigned int)((iAlign + sizeof(BoneMatrices) - 1) / sizeof(BoneMatrices)));
+	}
+	return m_uiSlotAlignment;
+}
+
+//----------------------------------------------------------
+// Returns where the given model's pose at the given frame
+// starts, evaluating and uploading it if nothing's asked for
+// it yet this frame. Add a batch's slot from ModelData to
+// get its bones.
+//----------------------------------------------------------
+unsigned int SkinningManager::GetPose(const ModelData* p_pData, float p_fFrame)
+{
+	int iSubFrame = (int)(p_fFrame * s_uiSubFrames + 0.5f);
+	PoseKey key(p_pData, iSubFrame);
+
+	std::map<PoseKey, unsigned int>::iterator iter = m_poses.find(key);
+	if( iter != m_poses.end() )
+		return iter->second;
+
+	unsigned int uiAlign = GetSlotAlignment();
+	unsigned int uiSlot = ((unsigned int)m_lBones.size() + uiAlign - 1) / uiAlign * uiAlign;
+	unsigned int uiNumSlots = p_pData->m_uiNumPoseSlots;
+	m_lBones.resize(uiSlot + uiNumSlots);
+	if( uiNumSlots > 0 )
+		EvaluatePose(p_pData, (float)iSubFrame / s_uiSubFrames, &m_lBones[uiSlot]);
+	m_poses[key] = uiSlot;
+
+	// A whole block's range is bound from any batch, so leave room for one past the end
+	unsigned int uiNeeded = (unsigned int)(m_lBones.size() + s_uiMaxBatchBones) * sizeof(BoneMatrices);
+	if( !m_pBuffer || m_pBuffer->GetLength() < uiNeeded )
+	{
+		// Draws already made keep the old buffer until they're done with it
+		if( m_pBuffer )
+			BufferManager::DestroyBuffer(m_pBuffer);
+		m_pBuffer = BufferManager::CreateUniformBuffer(uiNeeded * 2);
+		if( !m_lBones.empty() )
+			m_pBuffer->WriteAt(0, &m_lBones[0], (unsigned int)m_lBones.size() * sizeof(BoneMatrices));
+	}
+	else if( uiNumSlots > 0 )
+	{
+		m_pBuffer->WriteAt(uiSlot * sizeof(BoneMatrices), &m_lBones[uiSlot], uiNumSlots * sizeof(BoneMatrices));
+	}
+
+	return uiSlot;
+}
+
+//----------------------------------------------------------
+// Binds the bones starting at the given slot to the BoneData
+// uniform block
+//----------------------------------------------------------
+void SkinningManager::BindBones(unsigned int p_uiSlot)
+{
+	m_pBuffer->BindRangeToBlock(UB_Bones, p_uiSlot * sizeof(BoneMatrices), s_uiMaxBatchBones * sizeof(BoneMatrices));
+}
+
+//----------------------------------------------------------
+// Fills in every batch's bones for the given model and frame
+//----------------------------------------------------------
+void SkinningManager::EvaluatePose(const ModelData* p_pData, float p_fFrame, BoneMatrices* p_pBones)
+{
+	const CookedModel& data = p_pData->m_data;
+	for(unsigned int i = 0; i < p_pData->m_lMeshes.size(); i++)
+	{
+		const CookedModel::Mesh& cookedMesh = data.GetMesh(i);
+		const std::vector<unsigned int>& lBatchSlots = p_pData->m_lMeshes[i].m_lBatchSlots;
+
+		for(unsigned int uiBatch = 0; uiBatch < lBatchSlots.size(); uiBatch++)
+		{
+			const CookedModel::BoneBatch& batch = data.GetBoneBatch(cookedMesh, uiBatch);
+			BoneMatrices* pBones = p_pBones + lBatchSlots[uiBatch];
+
+			unsigned int uiNumBones = batch.m_uiNumBones < s_uiMaxBatchBones ? batch.m_uiNumBones : s_uiMaxBatchBones;
+			for(unsigned int b = 0; b < uiNumBones; b++)
+			{
+				pBones[b].m_mWorld = data.GetBoneWorld(data.GetBone(batch, b), p_fFrame);
+
+				// Inverse transpose of the 3x3 rotation/scale part for correct lighting
+				pBones[b].m_mWorldIT = glm::mat4(glm::transpose(glm::inverse(glm::mat3(pBones[b].m_mWorld))));
+			}
+		}
+	}
+}
+
+}
@@ -0,0 +1,89 @@
+//-----------------------------------------------------------------------------
+// File:			W_SkinningManager.h
+// Original Author:	agent
+//
+// Works out the bone matrices of skinned models and hands them to the GPU.
+//
+// A pose (every bone of every batch of a model file at one animation frame) is
+// evaluated at most once a frame, into one flat palette shared by every Model
+// of that file on that frame. Frames are rounded to 1/s_uiSubFrames of a baked
+// frame so crowds on nearly the same frame share too.
+//
+// All the frame's poses go in one uniform buffer. Each bone batch binds its
+// range of it to the BoneData uniform block, so shaders index up to
+// s_uiMaxBatchBones bones a batch instead of a fixed uniform array. Programs
+// without the block can still read a batch's bones through GetBones().
+//
+// Call BeginFrame() before rendering each frame.
+//-----------------------------------------------------------------------------
+#ifndef W_SKINNINGMANAGER_H
+#define W_SKINNINGMANAGER_H
+
+#include "W_Types.h"
+#include "W_UniformBuffer.h"
+#include <map>
+#include <vector>
+
+namespace wolf
+{
+class ModelData;
+
+class SkinningManager
+{
+	public:
+		//-------------------------------------------------------------------------
+		// PUBLIC TYPES
+		//-------------------------------------------------------------------------
+		// One bone in the BoneData block (std140). The inverse transpose is only
+		// 3x3, but padded to a mat4 to match the block's layout.
+		struct BoneMatrices
+		{
+			glm::mat4	m_mWorld;
+			glm::mat4	m_mWorldIT;
+		};
+
+		// Size of the BoneData block's array; 16KB, the least GL allows a block
+		static const unsigned int s_uiMaxBatchBones = 128;
+		static const unsigned int s_uiSubFrames = 4;
+		//-------------------------------------------------------------------------
+
+		//-------------------------------------------------------------------------
+		// PUBLIC INTERFACE
+		//-------------------------------------------------------------------------
+		static void BeginFrame();
+		static void Shutdown();
+
+		static unsigned int GetSlotAlignment();
+		static unsigned int GetPose(const ModelData* p_pData, float p_fFrame);
+		static const BoneMatrices* GetBones(unsigned int p_uiSlot) { return &m_lBones[p_uiSlot]; }
+		static void BindBones(unsigned int p_uiSlot);
+		//-------------------------------------------------------------------------
+
+	private:
+		//-------------------------------------------------------------------------
+		// PRIVATE TYPES
+		//-------------------------------------------------------------------------
+		typedef std::pair<const ModelData*, int> PoseKey;
+		//-------------------------------------------------------------------------
+
+		//-------------------------------------------------------------------------
+		// PRIVATE METHODS
+		//-------------------------------------------------------------------------
+		static void EvaluatePose(const ModelData* p_pData, float p_fFrame, BoneMatrices* p_pBones);
+		//-------------------------------------------------------------------------
+
+		//-------------------------------------------------------------------------
+		// PRIVATE MEMBERS
+		//-------------------------------------------------------------------------
+		// This frame's poses, and where each starts
+		static std::vector<BoneMatrices>		m_lBones;
+		static std::map<PoseKey, unsigned int>	m_poses;
+
+		static UniformBuffer*					m_pBuffer;
+		static unsigned int						m_uiSlotAlignment;
+		//-------------------------------------------------------------------------
+};
+
+}
+
+#endif
@@ -12,52 +12,21 @@
 
 using namespace wolf;
 
-struct Vertex
-{
-	GLfloat x,y;
-	GLfloat u,v;
-};
-
 //----------------------------------------------------------
 // Constructor
 //----------------------------------------------------------
 Sprite::Sprite(const std::string& p_strTexture, const std::string& p_strVertexProgram, const std::string& p_strFragmentProgram, const glm::vec2& p_vDimensions) 
 	:
-	m_pVB(NULL),
-	m_pDecl(NULL),
-	m_pProgram(NULL)
+	m_pProgram(NULL),
+	m_pTexture(NULL),
+	m_vDimensions(p_vDimensions),
+	m_vUVRect(0.0f, 0.0f, 1.0f, 1.0f),
+	m_cTint(1.0f, 1.0f, 1.0f, 1.0f)
 {
-	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-
-	const Vertex squareVertices[] = {
-		{ 0.0f, 0.0f,	0, 1 }, 
-		{ 0.0f, p_vDimensions.y,	0, 0 }, 
-		{ p_vDimensions.x, p_vDimensions.y,	1, 0 }, 
-
-		{ p_vDimensions.x, p_vDimensions.y,	1, 0 }, 
-		{ p_vDimensions.x, 0.0f,	1, 1 }, 
-		{ 0.0f, 0.0,	0, 1 }, 
-	};
-
 	m_pProgram = wolf::ProgramManager::CreateProgram(p_strVertexProgram, p_strFragmentProgram);
-	m_pVB = wolf::BufferManager::CreateVertexBuffer(squareVertices, sizeof(Vertex) * 6);
-
-	m_pDecl = new wolf::VertexDeclaration();
-	m_pDecl->Begin();
-	m_pDecl->AppendAttribute(wolf::AT_Position, 2, wolf::CT_Float);
-	m_pDecl->AppendAttribute(wolf::AT_TexCoord1, 2, wolf::CT_Float);
-	m_pDecl->SetVertexBuffer(m_pVB);
-	m_pDecl->End();
 
-	glGenTextures(1,&m_uiTex);
-	glBindTexture(GL_TEXTURE_2D, m_uiTex);
-	GLFWimage img;
-	glfwReadImage(p_strTexture.c_str(), &img, 0 );
-	glTexImage2D(GL_TEXTURE_2D, 0, img.Format, img.Width, img.Height, 0, img.Format, GL_UNSIGNED_BYTE, img.Data);
-	glfwFreeImage(&img);
-
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	m_pTexture = wolf::TextureManager::CreateTexture(p_strTexture);
+	m_pTexture->SetFilterMode(wolf::Texture::FM_Linear, wolf::Texture::FM_Linear);
 }
 
 //----------------------------------------------------------
@@ -65,8 +34,7 @@ Sprite::Sprite(const std::string& p_strTexture, const std::string& p_strVertexPr
 //----------------------------------------------------------
 Sprite::~Sprite()
 {
-	wolf::BufferManager::DestroyBuffer(m_pVB);
-	delete m_pDecl;
+	wolf::TextureManager::DestroyTexture(m_pTexture);
 	wolf::ProgramManager::DestroyProgram(m_pProgram);
 }
 
@@ -79,24 +47,17 @@ void Sprite::Update(float p_fDelta)
 }
 
 //----------------------------------------------------------
-// Renders this sprite
+// Adds this sprite to the given batch to be drawn when the
+// batch ends
 //----------------------------------------------------------
-void Sprite::Render(const glm::mat4& p_mProj)
+void Sprite::Render(SpriteBatch* p_pBatch)
 {
-	// Use shader program.
-	m_pProgram->Bind();
-
-	// Bind the texture
-	glBindTexture(GL_TEXTURE_2D, (int)m_uiTex);
-
-	// Bind Uniforms
-	m_pProgram->SetUniform("projection", p_mProj);
-	m_pProgram->SetUniform("world", m_mWorldTransform);
-	m_pProgram->SetUniform("texture", 0);
-
-	// Set up source data
-	m_pDecl->Bind();
-
-	// Draw!
-	glDrawArrays(GL_TRIANGLES, 0, 6);
+	// Our UV rect is within our texture, which may itself only be part of an
+	// atlas
+	const glm::vec4& vTexRect = m_pTexture->GetUVRect();
+	glm::vec2 vTexSize(vTexRect.z - vTexRect.x, vTexRect.w - vTexRect.y);
+	glm::vec4 vUVRect(vTexRect.x + m_vUVRect.x * vTexSize.x, vTexRect.y + m_vUVRect.y * vTexSize.y,
+					  vTexRect.x + m_vUVRect.z * vTexSize.x, vTexRect.y + m_vUVRect.w * vTexSize.y);
+
+	p_pBatch->Draw(m_pProgram, m_pTexture, m_mWorldTransform, m_vDimensions, vUVRect, m_cTint);
 }
\ No newline at end of file
@@ -16,6 +16,7 @@
 #include "W_VertexDeclaration.h"
 #include "W_TextureManager.h"
 #include "W_ProgramManager.h"
+#include "W_SpriteBatch.h"
 #include <string>
 #include <map>
 #include <vector>
@@ -32,9 +33,13 @@ class Sprite
 		~Sprite();
 
 		void Update(float p_fDelta);
-		void Render(const glm::mat4& p_mProj);
+		void Render(SpriteBatch* p_pBatch);
 
 		void SetTransform(const glm::mat4& p_mWorldTransform) { m_mWorldTransform = p_mWorldTransform; }
+
+		// Part of the texture to show as (u0, v0, u1, v1), for sprites in an atlas
+		void SetUVRect(const glm::vec4& p_vUVRect) { m_vUVRect = p_vUVRect; }
+		void SetTint(const wolf::Color4& p_cTint) { m_cTint = p_cTint; }
 		//-------------------------------------------------------------------------
 
 	private:
@@ -42,11 +47,12 @@ class Sprite
 		// PRIVATE MEMBERS
 		//-------------------------------------------------------------------------
 
-		wolf::VertexBuffer*			m_pVB;
-		wolf::VertexDeclaration*	m_pDecl;
 		wolf::Program*				m_pProgram;
-		GLuint						m_uiTex;
+		wolf::Texture*				m_pTexture;
 
+		glm::vec2					m_vDimensions;
+		glm::vec4					m_vUVRect;
+		wolf::Color4				m_cTint;
 		glm::mat4					m_mWorldTransform;
 
 		//-------------------------------------------------------------------------
@@ -0,0 +1,129 @@
+//-----------------------------------------------------------------------------
+// File:			W_SpriteBatch.cpp
+// Original Author:	agent
+//
+// See header for notes
+//-----------------------------------------------------------------------------
+#include "W_SpriteBatch.h"
+#include "W_Common.h"
+#include "W_BufferManager.h"
+#include "W_Material.h"
+
+namespace wolf
+{
+//----------------------------------------------------------
+// Constructor
+//----------------------------------------------------------
+SpriteBatch::SpriteBatch()
+	:
+	m_pVB(NULL),
+	m_pDecl(NULL)
+{
+}
+
+//----------------------------------------------------------
+// Destructor
+//----------------------------------------------------------
+SpriteBatch::~SpriteBatch()
+{
+	wolf::BufferManager::DestroyBuffer(m_pVB);
+	delete m_pDecl;
+}
+
+//----------------------------------------------------------
+// Starts collecting quads to draw with the given projection
+//----------------------------------------------------------
+void SpriteBatch::Begin(const glm::mat4& p_mProj)
+{
+	m_mProj = p_mProj;
+	m_lVertices.clear();
+	m_lBatches.clear();
+}
+
+//----------------------------------------------------------
+// Adds a quad, starting a new batch only if the program or
+// texture differs from the previous quad's. Textures that are
+// regions of the same atlas count as the same.
+//----------------------------------------------------------
+void SpriteBatch::Draw(Program* p_pProgram, const Texture* p_pTexture, const glm::mat4& p_mWorld, const glm::vec2& p_vSize, const glm::vec4& p_vUVRect, const wolf::Color4& p_cTint)
+{
+	if( m_lBatches.empty() || m_lBatches.back().m_pProgram != p_pProgram || m_lBatches.back().m_pTexture->GetID() != p_pTexture->GetID() )
+	{
+		Batch batch;
+		batch.m_pProgram = p_pProgram;
+		batch.m_pTexture = p_pTexture;
+		batch.m_uiFirstVertex = m_lVertices.size();
+		batch.m_uiNumVertices = 0;
+		m_lBatches.push_back(batch);
+	}
+
+	glm::vec4 vTopLeft = p_mWorld * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	glm::vec4 vBottomLeft = p_mWorld * glm::vec4(0.0f, p_vSize.y, 0.0f, 1.0f);
+	glm::vec4 vBottomRight = p_mWorld * glm::vec4(p_vSize.x, p_vSize.y, 0.0f, 1.0f);
+	glm::vec4 vTopRight = p_mWorld * glm::vec4(p_vSize.x, 0.0f, 0.0f, 1.0f);
+
+	const Vertex aQuad[] = {
+		{ vTopLeft.x, vTopLeft.y,			p_vUVRect.x, p_vUVRect.w,	p_cTint.r, p_cTint.g, p_cTint.b, p_cTint.a },
+		{ vBottomLeft.x, vBottomLeft.y,		p_vUVRect.x, p_vUVRect.y,	p_cTint.r, p_cTint.g, p_cTint.b, p_cTint.a },
+		{ vBottomRight.x, vBottomRight.y,	p_vUVRect.z, p_vUVRect.y,	p_cTint.r, p_cTint.g, p_cTint.b, p_cTint.a },
+
+		{ vBottomRight.x, vBottomRight.y,	p_vUVRect.z, p_vUVRect.y,	p_cTint.r, p_cTint.g, p_cTint.b, p_cTint.a },
+		{ vTopRight.x, vTopRight.y,			p_vUVRect.z, p_vUVRect.w,	p_cTint.r, p_cTint.g, p_cTint.b, p_cTint.a },
+		{ vTopLeft.x, vTopLeft.y,			p_vUVRect.x, p_vUVRect.w,	p_cTint.r, p_cTint.g, p_cTint.b, p_cTint.a },
+	};
+
+	m_lVertices.insert(m_lVertices.end(), aQuad, aQuad + 6);
+	m_lBatches.back().m_uiNumVertices += 6;
+}
+
+//----------------------------------------------------------
+// Uploads all the quads in one go and draws each batch
+//----------------------------------------------------------
+void SpriteBatch::End()
+{
+	if( m_lBatches.empty() )
+		return;
+
+	if( !m_pVB )
+	{
+		m_pVB = wolf::BufferManager::CreateVertexBuffer(sizeof(Vertex) * m_lVertices.size());
+
+		m_pDecl = new wolf::VertexDeclaration();
+		m_pDecl->Begin();
+		m_pDecl->AppendAttribute(wolf::AT_Position, 2, wolf::CT_Float);
+		m_pDecl->AppendAttribute(wolf::AT_TexCoord1, 2, wolf::CT_Float);
+		m_pDecl->AppendAttribute(wolf::AT_Color, 4, wolf::CT_Float);
+		m_pDecl->SetVertexBuffer(m_pVB);
+		m_pDecl->End();
+	}
+
+	m_pVB->Stream(&m_lVertices[0], sizeof(Vertex) * m_lVertices.size());
+	m_pDecl->Bind();
+
+	// Quads are already in screen space, so the world matrix (for shaders
+	// that still have one) is identity
+	const glm::mat4 mIdentity;
+	glActiveTexture(GL_TEXTURE0);
+
+	Program* pProgram = NULL;
+	std::vector<Batch>::const_iterator iter;
+	for( iter = m_lBatches.begin(); iter != m_lBatches.end(); iter++ )
+	{
+		if( iter->m_pProgram != pProgram )
+		{
+			pProgram = iter->m_pProgram;
+			pProgram->Bind();
+			pProgram->SetUniform("projection", m_mProj);
+			pProgram->SetUniform("world", mIdentity);
+			pProgram->SetUniform("texture1", 0);
+		}
+
+		iter->m_pTexture->Bind();
+		glDrawArrays(GL_TRIANGLES, iter->m_uiFirstVertex, iter->m_uiNumVertices);
+	}
+
+	// We bound textures behind the materials' backs
+	wolf::Material::InvalidateBindCache();
+}
+
+}
@@ -0,0 +1,77 @@
+//-----------------------------------------------------------------------------
+// File:			W_SpriteBatch.h
+// Original Author:	agent
+//
+// Collects 2D textured quads between Begin() and End() and draws them with as
+// few draw calls as possible. Quads are transformed on the CPU and written
+// into one vertex buffer per frame; consecutive quads sharing a program and
+// texture (e.g. sprites from the same atlas) go in the same draw. Draw order
+// is kept, so later quads still draw over earlier ones.
+//-----------------------------------------------------------------------------
+#ifndef W_SPRITEBATCH_H
+#define W_SPRITEBATCH_H
+
+#include "W_Types.h"
+#include "W_VertexBuffer.h"
+#include "W_VertexDeclaration.h"
+#include "W_Program.h"
+#include "W_Texture.h"
+#include <vector>
+
+namespace wolf
+{
+class SpriteBatch
+{
+	public:
+		//-------------------------------------------------------------------------
+		// PUBLIC INTERFACE
+		//-------------------------------------------------------------------------
+		SpriteBatch();
+		~SpriteBatch();
+
+		void Begin(const glm::mat4& p_mProj);
+
+		// Adds a quad of the given size with its top left corner at the world
+		// transform's origin. The UV rect is (u0, v0, u1, v1) with v1 at the
+		// top of the quad.
+		void Draw(Program* p_pProgram, const Texture* p_pTexture, const glm::mat4& p_mWorld, const glm::vec2& p_vSize, const glm::vec4& p_vUVRect, const wolf::Color4& p_cTint);
+
+		void End();
+		//-------------------------------------------------------------------------
+
+	private:
+		//-------------------------------------------------------------------------
+		// PRIVATE TYPES
+		//-------------------------------------------------------------------------
+		struct Vertex
+		{
+			GLfloat x,y;
+			GLfloat u,v;
+			GLfloat r,g,b,a;
+		};
+
+		// A run of quads drawn in one call
+		struct Batch
+		{
+			Program*		m_pProgram;
+			const Texture*	m_pTexture;
+			unsigned int	m_uiFirstVertex;
+			unsigned int	m_uiNumVertices;
+		};
+		//-------------------------------------------------------------------------
+
+		//-------------------------------------------------------------------------
+		// PRIVATE MEMBERS
+		//-------------------------------------------------------------------------
+		glm::mat4					m_mProj;
+		std::vector<Vertex>			m_lVertices;
+		std::vector<Batch>			m_lBatches;
+
+		wolf::VertexBuffer*			m_pVB;
+		wolf::VertexDeclaration*	m_pDecl;
+		//-------------------------------------------------------------------------
+};
+
+}
+
+#endif
@@ -6,6 +6,10 @@
 //-----------------------------------------------------------------------------
 #include "W_Texture.h"
 #include "W_Common.h"
+#include "W_Material.h"
+#include "W_AssetLoader.h"
+#include "W_TextureCompressor.h"
+#include <algorithm>
 
 namespace wolf
 {
@@ -35,22 +39,111 @@ static GLenum gs_aWrapMap[Texture::WM_NUM_WRAP_MODES] =
 	GL_MIRRORED_REPEAT			//WM_MirroredRepeat,
 };
 
+// DDS levels this size or smaller are uploaded on load; larger ones are streamed
+static const unsigned int gs_uiStreamedMipSize = 64;
+
 //----------------------------------------------------------
-// Constructor, taking in filename to load
+// Loads a texture file on one of AssetLoader's threads and
+// uploads it into its texture once back on the main thread
 //----------------------------------------------------------
-Texture::Texture(const std::string& p_strFile) 
+class Texture::LoadJob : public AssetLoader::Job
+{
+	public:
+		LoadJob(Texture* p_pTex, const std::string& p_strFile) 
+			: m_pTex(p_pTex), m_strFile(p_strFile), m_bDDS(p_strFile.find(".dds") != std::string::npos), m_bLoaded(false), m_pDDSData(0), m_uiDDSSize(0) {}
+
+		virtual ~LoadJob()
+		{
+			if( m_bLoaded && !m_bDDS )
+				glfwFreeImage(&m_img);
+			delete[] (char*)m_pDDSData;
+		}
+
+		virtual void Load()
+		{
+			if( m_bDDS )
+			{
+				m_pDDSData = wolf::LoadWholeFile(m_strFile, &m_uiDDSSize);
+				m_bLoaded = m_pDDSData != 0;
+			}
+			else
+			{
+				m_bLoaded = glfwReadImage(m_strFile.c_str(), &m_img, 0) == GL_TRUE;
+			}
+		}
+
+		virtual void Finish()
+		{
+			m_pTex->m_pLoadJob = 0;
+
+			if( !m_bLoaded )
+			{
+				printf("ERROR: Couldn't load texture - %s!\n", m_strFile.c_str());
+				return;
+			}
+
+			if( m_bDDS )
+			{
+				// The texture keeps the data if it streams its mips
+				m_pTex->UploadDDS(m_pDDSData, m_uiDDSSize);
+				m_pDDSData = 0;
+			}
+			else
+				m_pTex->UploadTGA(m_img);
+		}
+
+	private:
+		Texture*		m_pTex;
+		std::string		m_strFile;
+		bool			m_bDDS;
+		bool			m_bLoaded;
+		GLFWimage		m_img;
+		void*			m_pDDSData;
+		unsigned int	m_uiDDSSize;
+};
+
+//----------------------------------------------------------
+// Constructor, taking in filename to load. If async, the
+// file is loaded by AssetLoader and this is a placeholder
+// until then.
+//----------------------------------------------------------
+Texture::Texture(const std::string& p_strFile, bool p_bAsync) 
 	: m_eFilterMin(Texture::FM_Invalid), m_eFilterMag(Texture::FM_Invalid),
 	  m_eWrapU(Texture::WM_Invalid), m_eWrapV(Texture::WM_Invalid),
-	  m_uiWidth(0), m_uiHeight(0), m_uiTex(0)
+	  m_uiWidth(0), m_uiHeight(0), m_uiTex(0), m_pLoadJob(0),
+	  m_pAtlas(0), m_vUVRect(0.0f, 0.0f, 1.0f, 1.0f),
+	  m_pStreamData(0), m_uiStreamSize(0), m_iBaseLevel(0), m_uiResidentBytes(0)
 {
-	if( p_strFile.find(".dds") != std::string::npos )
-		LoadFromDDS(p_strFile);
-	else if( p_strFile.find(".tga") != std::string::npos )
-		LoadFromTGA(p_strFile);
-	else
+	glGenTextures(1,&m_uiTex);
+
+	// Use the compressed version if it's been made and is current
+	std::string strFile = p_strFile;
+	if( strFile.find(".tga") != std::string::npos && TextureCompressor::IsUpToDate(strFile) )
+		strFile = TextureCompressor::GetCompressedFileName(strFile);
+
+	if( strFile.find(".dds") == std::string::npos && strFile.find(".tga") == std::string::npos )
 	{
-		printf("ERROR: No idea how to load this file - %s!", p_strFile.c_str());
+		printf("ERROR: No idea how to load this file - %s!", strFile.c_str());
 	}
+	else if( p_bAsync )
+	{
+		// The placeholder's filter is set directly, so whatever's set through
+		// SetFilterMode() before the load finishes still gets applied after
+		static const unsigned char s_aucWhite[4] = { 255, 255, 255, 255 };
+		Bind();
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, s_aucWhite);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		m_uiWidth = m_uiHeight = 1;
+
+		// Before queueing, as it may be finished on the spot
+		m_pLoadJob = new LoadJob(this, strFile);
+		AssetLoader::Queue(m_pLoadJob);
+	}
+	else if( strFile.find(".dds") != std::string::npos )
+		LoadFromDDS(strFile);
+	else
+		LoadFromTGA(strFile);
 
 	SetWrapMode(WM_Clamp);
 }
@@ -61,15 +154,18 @@ Texture::Texture(const std::string& p_strFile)
 Texture::Texture(void* p_pData, unsigned int p_uiWidth, unsigned int p_uiHeight, Format p_eFormat)
 	: m_eFilterMin(Texture::FM_Invalid), m_eFilterMag(Texture::FM_Invalid),
 	  m_eWrapU(Texture::WM_Invalid), m_eWrapV(Texture::WM_Invalid),
-	  m_uiWidth(0), m_uiHeight(0), m_uiTex(0)
+	  m_uiWidth(0), m_uiHeight(0), m_uiTex(0), m_pLoadJob(0),
+	  m_pAtlas(0), m_vUVRect(0.0f, 0.0f, 1.0f, 1.0f),
+	  m_pStreamData(0), m_uiStreamSize(0), m_iBaseLevel(0), m_uiResidentBytes(0)
 {
 	glGenTextures(1,&m_uiTex);
-	glBindTexture(GL_TEXTURE_2D, m_uiTex);
+	Bind();
 
 	glTexImage2D(GL_TEXTURE_2D, 0, gs_aFormatMap[p_eFormat], p_uiWidth, p_uiHeight, 0, gs_aFormatMap[p_eFormat], gs_aTypeMap[p_eFormat], p_pData);
 
 	m_uiWidth = p_uiWidth;
 	m_uiHeight = p_uiHeight;
+	m_uiResidentBytes = p_uiWidth * p_uiHeight * 4 * 4 / 3;
 
 	SetWrapMode(WM_Clamp);
 
@@ -77,21 +173,44 @@ Texture::Texture(void* p_pData, unsigned int p_uiWidth, unsigned int p_uiHeight,
 	SetFilterMode(FM_TrilinearMipmap, FM_Linear);
 }
 
+//----------------------------------------------------------
+// Constructor for a region of an atlas
+//----------------------------------------------------------
+Texture::Texture(const Texture* p_pAtlas, const glm::vec4& p_vUVRect, unsigned int p_uiWidth, unsigned int p_uiHeight)
+	: m_eFilterMin(p_pAtlas->m_eFilterMin), m_eFilterMag(p_pAtlas->m_eFilterMag),
+	  m_eWrapU(p_pAtlas->m_eWrapU), m_eWrapV(p_pAtlas->m_eWrapV),
+	  m_uiWidth(p_uiWidth), m_uiHeight(p_uiHeight), m_uiTex(p_pAtlas->m_uiTex), m_pLoadJob(0),
+	  m_pAtlas(p_pAtlas), m_vUVRect(p_vUVRect),
+	  m_pStreamData(0), m_uiStreamSize(0), m_iBaseLevel(0), m_uiResidentBytes(0)
+{
+}
+
 //----------------------------------------------------------
 // Destructor
 //----------------------------------------------------------
 Texture::~Texture()
 {
-	glDeleteTextures(1,&m_uiTex);
+	// The job's still owned by AssetLoader, just make sure it leaves us alone
+	if( m_pLoadJob )
+		m_pLoadJob->Cancel();
+
+	if( !m_pAtlas )
+	{
+		Material::OnTextureDeleted(m_uiTex);
+		glDeleteTextures(1,&m_uiTex);
+	}
+	delete[] (char*)m_pStreamData;
 }
 
 //----------------------------------------------------------
 // Binds this texture as the current one (on the currently
-// active texture unit)
+// active texture unit, which outside of Material::Apply() is
+// always unit 0) and tells the material bind cache
 //----------------------------------------------------------
 void Texture::Bind() const
 {
 	glBindTexture(GL_TEXTURE_2D, m_uiTex);
+	Material::OnTextureBound(m_uiTex);
 }
 
 //----------------------------------------------------------
@@ -100,15 +219,15 @@ void Texture::Bind() const
 //----------------------------------------------------------
 void Texture::LoadFromDDS(const std::string& p_strFile)
 {
-	bool bHasMips = false;
-	m_uiTex = wolf::CreateTextureFromDDS(p_strFile, &m_uiWidth, &m_uiHeight, &bHasMips);
-
-	if( bHasMips )
-		m_eFilterMin = FM_TrilinearMipmap;
-	else
-		m_eFilterMin = FM_Linear;
+	unsigned int uiSize = 0;
+	void* pData = wolf::LoadWholeFile(p_strFile, &uiSize);
+	if( !pData )
+	{
+		printf("ERROR: Couldn't load texture - %s!\n", p_strFile.c_str());
+		return;
+	}
 
-	m_eFilterMag = FM_Linear;
+	UploadDDS(pData, uiSize);
 }
 
 //----------------------------------------------------------
@@ -117,20 +236,146 @@ void Texture::LoadFromDDS(const std::string& p_strFile)
 //----------------------------------------------------------
 void Texture::LoadFromTGA(const std::string& p_strFile)
 {
-	glGenTextures(1,&m_uiTex);
-	glBindTexture(GL_TEXTURE_2D, m_uiTex);
-
 	GLFWimage img;
-	glfwReadImage( p_strFile.c_str(), &img, 0 );
-    glTexImage2D(GL_TEXTURE_2D, 0, img.Format, img.Width, img.Height, 0, img.Format, GL_UNSIGNED_BYTE, img.Data);
-    
-    m_uiWidth = img.Width;
-	m_uiHeight = img.Height;
-    
+	if( glfwReadImage( p_strFile.c_str(), &img, 0 ) != GL_TRUE )
+	{
+		printf("ERROR: Couldn't load texture - %s!\n", p_strFile.c_str());
+		return;
+	}
+
+	UploadTGA(img);
 	glfwFreeImage(&img);
+}
+
+//----------------------------------------------------------
+// Uploads the given DDS file contents into our texture, and
+// takes ownership of them. Only levels up to
+// gs_uiStreamedMipSize go up now; if there are larger ones
+// the contents are kept until they've been streamed in. Its
+// filter is chosen by whether it has mipmaps, unless one was
+// set already.
+//----------------------------------------------------------
+void Texture::UploadDDS(void* p_pData, unsigned int p_uiSize)
+{
+	DDSInfo dds;
+	if( !wolf::ParseDDS(p_pData, p_uiSize, dds) )
+	{
+		delete[] (char*)p_pData;
+		return;
+	}
+
+	m_uiWidth = dds.m_uiWidth;
+	m_uiHeight = dds.m_uiHeight;
+	bool bHasMips = dds.m_uiNumMips > 1;
+
+	// Without mips there's nothing smaller to show in the meantime
+	m_iBaseLevel = 0;
+	if( bHasMips )
+	{
+		while( m_iBaseLevel < (int)dds.m_uiNumMips - 1 &&
+			   std::max(dds.GetMipWidth(m_iBaseLevel), dds.GetMipHeight(m_iBaseLevel)) > gs_uiStreamedMipSize )
+			m_iBaseLevel++;
+	}
+
+	Bind();
+	m_uiResidentBytes = 0;
+	for( unsigned int i = m_iBaseLevel; i < dds.m_uiNumMips; i++ )
+	{
+		glCompressedTexImage2D(GL_TEXTURE_2D, i, dds.m_eFormat, dds.GetMipWidth(i), dds.GetMipHeight(i), 0, dds.m_auiMipSizes[i], dds.m_apMips[i]);
+		m_uiResidentBytes += dds.m_auiMipSizes[i];
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, m_iBaseLevel);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, dds.m_uiNumMips - 1);
+	GL_CHECK_ERROR();
+
+	if( m_iBaseLevel > 0 )
+	{
+		m_pStreamData = p_pData;
+		m_uiStreamSize = p_uiSize;
+	}
+	else
+		delete[] (char*)p_pData;
+
+	if( m_eFilterMin != FM_Invalid )
+	{
+		ApplyFilterMode();
+		return;
+	}
+
+	SetFilterMode(bHasMips ? FM_TrilinearMipmap : FM_Linear, FM_Linear);
+}
+
+//----------------------------------------------------------
+// Uploads the given decoded image into our texture and
+// generates its mipmaps
+//----------------------------------------------------------
+void Texture::UploadTGA(const GLFWimage& p_img)
+{
+	Bind();
+	glTexImage2D(GL_TEXTURE_2D, 0, p_img.Format, p_img.Width, p_img.Height, 0, p_img.Format, GL_UNSIGNED_BYTE, p_img.Data);
+
+	m_uiWidth = p_img.Width;
+	m_uiHeight = p_img.Height;
+	m_uiResidentBytes = p_img.Width * p_img.Height * 4 * 4 / 3;
 
 	glGenerateMipmap(GL_TEXTURE_2D);
-	SetFilterMode(FM_TrilinearMipmap, FM_Linear);
+	if( m_eFilterMin != FM_Invalid )
+		ApplyFilterMode();
+	else
+		SetFilterMode(FM_TrilinearMipmap, FM_Linear);
+}
+
+//----------------------------------------------------------
+// Returns the larger side of the next level to be streamed
+// in, or 0 if there isn't one
+//----------------------------------------------------------
+unsigned int Texture::GetNextMipDimension() const
+{
+	if( !m_pStreamData )
+		return 0;
+	return std::max(std::max(m_uiWidth >> (m_iBaseLevel - 1), m_uiHeight >> (m_iBaseLevel - 1)), 1u);
+}
+
+//----------------------------------------------------------
+// Returns the size of the next level to be streamed in, or 0
+// if there isn't one
+//----------------------------------------------------------
+unsigned int Texture::GetNextMipBytes() const
+{
+	DDSInfo dds;
+	if( !m_pStreamData || !wolf::ParseDDS(m_pStreamData, m_uiStreamSize, dds) )
+		return 0;
+	return dds.m_auiMipSizes[m_iBaseLevel - 1];
+}
+
+//----------------------------------------------------------
+// Uploads the next larger mip level and starts sampling from
+// it. The file contents are freed once the top level is in.
+// Returns the bytes uploaded.
+//----------------------------------------------------------
+unsigned int Texture::StreamNextMip()
+{
+	DDSInfo dds;
+	if( !m_pStreamData || !wolf::ParseDDS(m_pStreamData, m_uiStreamSize, dds) )
+		return 0;
+
+	m_iBaseLevel--;
+	Bind();
+	glCompressedTexImage2D(GL_TEXTURE_2D, m_iBaseLevel, dds.m_eFormat, dds.GetMipWidth(m_iBaseLevel), dds.GetMipHeight(m_iBaseLevel), 0,
+						   dds.m_auiMipSizes[m_iBaseLevel], dds.m_apMips[m_iBaseLevel]);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, m_iBaseLevel);
+	GL_CHECK_ERROR();
+
+	unsigned int uiBytes = dds.m_auiMipSizes[m_iBaseLevel];
+	m_uiResidentBytes += uiBytes;
+
+	if( m_iBaseLevel == 0 )
+	{
+		delete[] (char*)m_pStreamData;
+		m_pStreamData = 0;
+		m_uiStreamSize = 0;
+	}
+	return uiBytes;
 }
 
 //----------------------------------------------------------
@@ -145,6 +390,10 @@ void Texture::SetWrapMode(WrapMode p_eWrapU, WrapMode p_eWrapV)
 	if( m_eWrapU == p_eWrapU && m_eWrapV == p_eWrapV )
 		return; // Nothing to do, move along!
 
+	// Would change the whole atlas
+	if( m_pAtlas )
+		return;
+
     Bind();
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, gs_aWrapMap[p_eWrapU]);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, gs_aWrapMap[p_eWrapV]);
@@ -164,7 +413,27 @@ void Texture::SetFilterMode(FilterMode p_eFilterMin, FilterMode p_eFilterMag)
 	if( m_eFilterMin == p_eFilterMin && m_eFilterMag == p_eFilterMag )
 		return;
 
-	switch( p_eFilterMin )
+	// Would change the whole atlas
+	if( m_pAtlas )
+		return;
+
+	m_eFilterMin = p_eFilterMin;
+	m_eFilterMag = p_eFilterMag;
+
+	// The placeholder has no mipmaps; this gets applied once loaded
+	if( m_pLoadJob )
+		return;
+
+	Bind();
+	ApplyFilterMode();
+}
+
+//----------------------------------------------------------
+// Sets our filter modes on the bound texture
+//----------------------------------------------------------
+void Texture::ApplyFilterMode()
+{
+	switch( m_eFilterMin )
 	{
 		case FM_Nearest:
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -181,7 +450,7 @@ void Texture::SetFilterMode(FilterMode p_eFilterMin, FilterMode p_eFilterMag)
         default: ;
 	}
 
-	switch( p_eFilterMag )
+	switch( m_eFilterMag )
 	{
 		case FM_Nearest:
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -191,10 +460,6 @@ void Texture::SetFilterMode(FilterMode p_eFilterMin, FilterMode p_eFilterMag)
 			break;
         default: ;            
 	}
-
-	m_eFilterMin = p_eFilterMin;
-	m_eFilterMag = p_eFilterMag;
 }
 
 }
-
@@ -3,6 +3,20 @@
 // Original Author:	Gordon Wood
 //
 // Class encapsulating a texture
+//
+// A texture can also be loaded in the background through AssetLoader (see
+// TextureManager::CreateTextureAsync). Until it's loaded it's a 1x1 white
+// placeholder; wrap and filter modes set in the meantime are kept and applied
+// to the real thing.
+//
+// A texture can also be a region of a TextureAtlas, sharing the atlas' GL
+// texture. Anything drawing with it has to map its UVs into GetUVRect(), and
+// its wrap and filter modes are the atlas' and can't be changed.
+//
+// A TGA with an up to date compressed DDS next to it (see TextureCompressor)
+// loads the DDS instead. A DDS with mipmaps only uploads its small levels at
+// first; TextureManager::StreamMips() then adds the rest, smallest first, a few
+// a frame.
 //-----------------------------------------------------------------------------
 #ifndef W_TEXTURE_H
 #define W_TEXTURE_H
@@ -59,8 +73,18 @@ class Texture
 		void SetWrapMode(WrapMode p_eWrapU, WrapMode p_eWrapV = WM_Invalid);
 		void SetFilterMode(FilterMode p_eFilterMin, FilterMode p_eFilterMag = FM_Invalid);
 
+		bool IsLoaded() const { return m_pLoadJob == 0; }
+		bool IsAtlasRegion() const { return m_pAtlas != 0; }
+
+		// Part of the GL texture that's this texture as (u0, v0, u1, v1)
+		const glm::vec4& GetUVRect() const { return m_vUVRect; }
+
 		unsigned int GetWidth() const { return m_uiWidth; }
 		unsigned int GetHeight() const { return m_uiHeight; }
+		GLuint GetID() const { return m_uiTex; }
+
+		// Estimated video memory used by the levels uploaded so far
+		unsigned int GetResidentBytes() const { return m_uiResidentBytes; }
 		//-------------------------------------------------------------------------
 
 	private:
@@ -68,13 +92,25 @@ class Texture
 		// PRIVATE METHODS
 		//-------------------------------------------------------------------------
 
+		class LoadJob;
+
 		// Made private to enforce creation/destruction via TextureManager
-		Texture(const std::string& p_strFile);
+		Texture(const std::string& p_strFile, bool p_bAsync = false);
 		Texture(void* p_pData, unsigned int p_uiWidth, unsigned int p_uiHeight, Format p_eFormat);
+		Texture(const Texture* p_pAtlas, const glm::vec4& p_vUVRect, unsigned int p_uiWidth, unsigned int p_uiHeight);
 		virtual ~Texture();
 
 		void LoadFromDDS(const std::string& p_strFile);
 		void LoadFromTGA(const std::string& p_strFile);
+		void UploadDDS(void* p_pData, unsigned int p_uiSize);
+		void UploadTGA(const GLFWimage& p_img);
+		void ApplyFilterMode();
+
+		// Mip streaming, driven by TextureManager
+		bool IsStreaming() const { return m_pStreamData != 0; }
+		unsigned int GetNextMipDimension() const;
+		unsigned int GetNextMipBytes() const;
+		unsigned int StreamNextMip();
 		//-------------------------------------------------------------------------
 
 		//-------------------------------------------------------------------------
@@ -87,6 +123,20 @@ class Texture
 		FilterMode		m_eFilterMag;
 		unsigned int	m_uiWidth;
 		unsigned int    m_uiHeight;
+
+		// Set while loading in the background
+		LoadJob*		m_pLoadJob;
+
+		// Set if we're a region of an atlas, which owns the GL texture
+		const Texture*	m_pAtlas;
+		glm::vec4		m_vUVRect;
+
+		// DDS contents kept while levels are still to be streamed in, and the
+		// largest level uploaded so far
+		void*			m_pStreamData;
+		unsigned int	m_uiStreamSize;
+		int				m_iBaseLevel;
+		unsigned int	m_uiResidentBytes;
 		//-------------------------------------------------------------------------
 };
 
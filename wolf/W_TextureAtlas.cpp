@@ -0,0 +1,206 @@
+//-----------------------------------------------------------------------------
+// File:			W_TextureAtlas.cpp
+// Original Author:	agent
+//
+// See header for notes
+//-----------------------------------------------------------------------------
+#include "W_TextureAtlas.h"
+#include "W_TextureManager.h"
+#include "W_Common.h"
+#include <algorithm>
+#include <cstring>
+
+namespace wolf
+{
+// Mip levels past this one are never sampled. At level N a texel covers a
+// 2^N square, so with every slot lined up on that and a border of that size
+// each region still has a texel of its own edge around it at the last level.
+static const unsigned int gs_uiMaxMipLevel = 2;
+static const unsigned int gs_uiAlign = 1 << gs_uiMaxMipLevel;
+
+// Pixels of repeated edge around every image (at least; slots are rounded up)
+static const unsigned int gs_uiBorder = gs_uiAlign;
+
+//----------------------------------------------------------
+// Returns the size of the slot an image side needs, border
+// included, rounded up to the mip alignment
+//----------------------------------------------------------
+static unsigned int SlotSize(unsigned int p_uiSize)
+{
+	return (p_uiSize + gs_uiBorder * 2 + gs_uiAlign - 1) & ~(gs_uiAlign - 1);
+}
+
+//----------------------------------------------------------
+// Constructor
+//----------------------------------------------------------
+TextureAtlas::TextureAtlas() : m_pTexture(0)
+{
+}
+
+//----------------------------------------------------------
+// Destructor
+//----------------------------------------------------------
+TextureAtlas::~TextureAtlas()
+{
+	if( m_pTexture )
+		TextureManager::DestroyTexture(m_pTexture);
+}
+
+//----------------------------------------------------------
+// Loads all the given TGA files and packs them into one
+// texture, the smallest that fits them. Files that can't be
+// loaded are left out. Returns false if nothing could be
+// packed.
+//----------------------------------------------------------
+bool TextureAtlas::Build(const std::vector<std::string>& p_lFiles)
+{
+	if( m_pTexture )
+	{
+		TextureManager::DestroyTexture(m_pTexture);
+		m_pTexture = 0;
+	}
+	m_regions.clear();
+
+	std::vector<Image> lImages(p_lFiles.size());
+	std::vector<Image*> lToPack;
+	for( unsigned int i = 0; i < p_lFiles.size(); i++ )
+	{
+		if( ReadImage(p_lFiles[i], lImages[i]) )
+			lToPack.push_back(&lImages[i]);
+		else
+			printf("ERROR: Couldn't add %s to texture atlas\n", p_lFiles[i].c_str());
+	}
+	if( lToPack.empty() )
+		return false;
+
+	std::sort(lToPack.begin(), lToPack.end(), TallerThan);
+
+	// Try every width that could fit and keep the one using the least area
+	GLint iMaxSize = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &iMaxSize);
+
+	unsigned int uiWidth = 0, uiHeight = 0;
+	for( unsigned int uiTryWidth = 64; uiTryWidth <= (unsigned int)iMaxSize; uiTryWidth *= 2 )
+	{
+		unsigned int uiTryHeight;
+		if( !Pack(lToPack, uiTryWidth, iMaxSize, uiTryHeight) )
+			continue;
+		if( uiWidth == 0 || uiTryWidth * uiTryHeight < uiWidth * uiHeight )
+		{
+			uiWidth = uiTryWidth;
+			uiHeight = uiTryHeight;
+		}
+	}
+
+	if( uiWidth == 0 )
+	{
+		printf("ERROR: Texture atlas images don't fit in a %dx%d texture\n", iMaxSize, iMaxSize);
+		return false;
+	}
+	Pack(lToPack, uiWidth, iMaxSize, uiHeight);
+
+	// Copy every image in, with its edge pixels repeated out into its border
+	std::vector<unsigned char> lPixels(uiWidth * uiHeight * 4, 0);
+	for( unsigned int i = 0; i < lToPack.size(); i++ )
+	{
+		const Image& image = *lToPack[i];
+		unsigned int uiRightBorder = SlotSize(image.m_uiWidth) - gs_uiBorder - image.m_uiWidth;
+		for( unsigned int y = 0; y < SlotSize(image.m_uiHeight); y++ )
+		{
+			unsigned int uiSrcY = y < gs_uiBorder ? 0 : std::min(y - gs_uiBorder, image.m_uiHeight - 1);
+			unsigned char* pDest = &lPixels[((image.m_uiY - gs_uiBorder + y) * uiWidth + image.m_uiX - gs_uiBorder) * 4];
+			const unsigned char* pSrcRow = &image.m_lPixels[uiSrcY * image.m_uiWidth * 4];
+
+			for( unsigned int x = 0; x < gs_uiBorder; x++ )
+				memcpy(pDest + x * 4, pSrcRow, 4);
+			memcpy(pDest + gs_uiBorder * 4, pSrcRow, image.m_uiWidth * 4);
+			for( unsigned int x = 0; x < uiRightBorder; x++ )
+				memcpy(pDest + (gs_uiBorder + image.m_uiWidth + x) * 4, pSrcRow + (image.m_uiWidth - 1) * 4, 4);
+		}
+
+		Region region;
+		region.m_vUVRect = glm::vec4((float)image.m_uiX / uiWidth, (float)image.m_uiY / uiHeight,
+									 (float)(image.m_uiX + image.m_uiWidth) / uiWidth, (float)(image.m_uiY + image.m_uiHeight) / uiHeight);
+		region.m_uiWidth = image.m_uiWidth;
+		region.m_uiHeight = image.m_uiHeight;
+		m_regions[image.m_strFile] = region;
+	}
+
+	m_pTexture = TextureManager::CreateTexture(&lPixels[0], uiWidth, uiHeight, Texture::FMT_8888);
+
+	// Smaller levels would average neighbouring regions together
+	m_pTexture->Bind();
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, gs_uiMaxMipLevel);
+	return true;
+}
+
+//----------------------------------------------------------
+// Returns the region the given file was packed into, or
+// NULL if it isn't in this atlas
+//----------------------------------------------------------
+const TextureAtlas::Region* TextureAtlas::FindRegion(const std::string& p_strFile) const
+{
+	std::map<std::string, Region>::const_iterator iter = m_regions.find(p_strFile);
+	if( iter == m_regions.end() )
+		return 0;
+	return &iter->second;
+}
+
+//----------------------------------------------------------
+// Reads the given TGA file into p_image as RGBA, at its own
+// size rather than rescaled to a power of two
+//----------------------------------------------------------
+bool TextureAtlas::ReadImage(const std::string& p_strFile, Image& p_image)
+{
+	if( !wolf::ReadImageRGBA(p_strFile, GLFW_NO_RESCALE_BIT, &p_image.m_uiWidth, &p_image.m_uiHeight, p_image.m_lPixels) )
+		return false;
+
+	p_image.m_strFile = p_strFile;
+	p_image.m_uiX = p_image.m_uiY = 0;
+	return true;
+}
+
+//----------------------------------------------------------
+// Orders images tallest first, for packing
+//----------------------------------------------------------
+bool TextureAtlas::TallerThan(const Image* p_pA, const Image* p_pB)
+{
+	return p_pA->m_uiHeight > p_pB->m_uiHeight;
+}
+
+//----------------------------------------------------------
+// Places the given images (tallest first) on shelves across
+// a texture of the given width, setting their positions and
+// the height needed. Returns false if they don't fit.
+//----------------------------------------------------------
+bool TextureAtlas::Pack(std::vector<Image*>& p_lImages, unsigned int p_uiWidth, unsigned int p_uiMaxHeight, unsigned int& p_uiHeight)
+{
+	unsigned int uiX = 0, uiShelfY = 0, uiShelfHeight = 0;
+	for( unsigned int i = 0; i < p_lImages.size(); i++ )
+	{
+		Image& image = *p_lImages[i];
+		unsigned int uiSlotWidth = SlotSize(image.m_uiWidth);
+		unsigned int uiSlotHeight = SlotSize(image.m_uiHeight);
+		if( uiSlotWidth > p_uiWidth )
+			return false;
+
+		// Start a new shelf when this one's full
+		if( uiX + uiSlotWidth > p_uiWidth )
+		{
+			uiShelfY += uiShelfHeight;
+			uiX = uiShelfHeight = 0;
+		}
+
+		image.m_uiX = uiX + gs_uiBorder;
+		image.m_uiY = uiShelfY + gs_uiBorder;
+		uiX += uiSlotWidth;
+		uiShelfHeight = std::max(uiShelfHeight, uiSlotHeight);
+	}
+
+	// Height isn't rounded up to a power of two; with the borders that would
+	// often double it
+	p_uiHeight = uiShelfY + uiShelfHeight;
+	return p_uiHeight <= p_uiMaxHeight;
+}
+
+}
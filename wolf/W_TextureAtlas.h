@@ -0,0 +1,91 @@
+//-----------------------------------------------------------------------------
+// File:			W_TextureAtlas.h
+// Original Author:	agent
+//
+// Packs a set of TGA files into one texture at load time, so things drawn with
+// any of them can share a texture bind (and a sprite batch). Each file ends up
+// as a region of the atlas, found by its file name.
+//
+// Images are packed on shelves, tallest first, with their edges repeated into
+// a small border so filtering doesn't bleed between neighbours. Only the first
+// couple of mip levels are kept, since below that the border is gone and 
+// regions would mix; things drawn at a small fraction of their size will 
+// shimmer a little.
+// Normally used through TextureManager::CreateAtlas(), after which
+// CreateTexture() on any of the files gives back its region.
+//-----------------------------------------------------------------------------
+#ifndef W_TEXTUREATLAS_H
+#define W_TEXTUREATLAS_H
+
+#include "W_Types.h"
+#include "W_Texture.h"
+#include <string>
+#include <vector>
+#include <map>
+
+namespace wolf
+{
+class TextureAtlas
+{
+	public:
+		//-------------------------------------------------------------------------
+		// PUBLIC TYPES
+		//-------------------------------------------------------------------------
+		struct Region
+		{
+			glm::vec4		m_vUVRect;		// (u0, v0, u1, v1)
+			unsigned int	m_uiWidth;
+			unsigned int	m_uiHeight;
+		};
+		//-------------------------------------------------------------------------
+
+		//-------------------------------------------------------------------------
+		// PUBLIC INTERFACE
+		//-------------------------------------------------------------------------
+		TextureAtlas();
+		~TextureAtlas();
+
+		bool Build(const std::vector<std::string>& p_lFiles);
+
+		Texture* GetTexture() const { return m_pTexture; }
+		const Region* FindRegion(const std::string& p_strFile) const;
+		//-------------------------------------------------------------------------
+
+	private:
+		//-------------------------------------------------------------------------
+		// PRIVATE TYPES
+		//-------------------------------------------------------------------------
+		struct Image
+		{
+			std::string					m_strFile;
+			unsigned int				m_uiWidth;
+			unsigned int				m_uiHeight;
+			std::vector<unsigned char>	m_lPixels;	// RGBA, bottom row first
+			unsigned int				m_uiX;
+			unsigned int				m_uiY;
+		};
+		//-------------------------------------------------------------------------
+
+		//-------------------------------------------------------------------------
+		// PRIVATE METHODS
+		//-------------------------------------------------------------------------
+		static bool ReadImage(const std::string& p_strFile, Image& p_image);
+		static bool TallerThan(const Image* p_pA, const Image* p_pB);
+		static bool Pack(std::vector<Image*>& p_lImages, unsigned int p_uiWidth, unsigned int p_uiMaxHeight, unsigned int& p_uiHeight);
+
+		// Owns its texture, so can't be copied
+		TextureAtlas(const TextureAtlas&);
+		TextureAtlas& operator=(const TextureAtlas&);
+		//-------------------------------------------------------------------------
+
+		//-------------------------------------------------------------------------
+		// PRIVATE MEMBERS
+		//-------------------------------------------------------------------------
+		Texture*						m_pTexture;
+		std::map<std::string, Region>	m_regions;
+		//-------------------------------------------------------------------------
+};
+
+}
+
+#endif
@@ -0,0 +1,300 @@
+//-----------------------------------------------------------------------------
+// File:			W_TextureCompressor.cpp
+// Original Author:	agent
+//
+// See header for notes
+//-----------------------------------------------------------------------------
+#include "W_TextureCompressor.h"
+#include "W_Common.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/stat.h>
+
+namespace wolf
+{
+//----------------------------------------------------------
+// Packs an 8 bit colour into 5:6:5
+//----------------------------------------------------------
+static unsigned short To565(const unsigned char* p_pColor)
+{
+	return (unsigned short)(((p_pColor[0] * 31 + 127) / 255) << 11 | ((p_pColor[1] * 63 + 127) / 255) << 5 | ((p_pColor[2] * 31 + 127) / 255));
+}
+
+//----------------------------------------------------------
+// Unpacks a 5:6:5 colour to 8 bits a channel, the way the
+// GPU will
+//----------------------------------------------------------
+static void From565(unsigned short p_usColor, int* p_pColor)
+{
+	int r = (p_usColor >> 11) & 31, g = (p_usColor >> 5) & 63, b = p_usColor & 31;
+	p_pColor[0] = (r << 3) | (r >> 2);
+	p_pColor[1] = (g << 2) | (g >> 4);
+	p_pColor[2] = (b << 3) | (b >> 2);
+}
+
+//----------------------------------------------------------
+// Returns the name the compressed version of the given file
+// is saved under
+//----------------------------------------------------------
+std::string TextureCompressor::GetCompressedFileName(const std::string& p_strFile)
+{
+	std::string::size_type uiDot = p_strFile.rfind('.');
+	if( uiDot == std::string::npos || p_strFile.find_first_of("/\\", uiDot) != std::string::npos )
+		return p_strFile + ".dds";
+	return p_strFile.substr(0, uiDot) + ".dds";
+}
+
+//----------------------------------------------------------
+// Returns true if the given file has a compressed version
+// that's at least as new as it (or the file itself is gone)
+//----------------------------------------------------------
+bool TextureCompressor::IsUpToDate(const std::string& p_strFile)
+{
+	struct stat compressedStat, sourceStat;
+	if( stat(GetCompressedFileName(p_strFile).c_str(), &compressedStat) != 0 )
+		return false;
+	return stat(p_strFile.c_str(), &sourceStat) != 0 || sourceStat.st_mtime <= compressedStat.st_mtime;
+}
+
+//----------------------------------------------------------
+// Compresses the given TGA and all its mip levels and saves
+// them as a DDS. Returns false if either file can't be used.
+//----------------------------------------------------------
+bool TextureCompressor::CompressFile(const std::string& p_strFile, const std::string& p_strCompressedFile)
+{
+	// Read it like Texture would, scaled to a power of two
+	unsigned int uiWidth, uiHeight;
+	std::vector<unsigned char> lLevel;
+	if( !wolf::ReadImageRGBA(p_strFile, 0, &uiWidth, &uiHeight, lLevel) )
+		return false;
+
+	bool bAlpha = false;
+	for( unsigned int i = 3; i < lLevel.size() && !bAlpha; i += 4 )
+		bAlpha = lLevel[i] != 255;
+
+	std::vector<std::vector<unsigned char> > lMips;
+	unsigned int uiMipWidth = uiWidth, uiMipHeight = uiHeight;
+	for(;;)
+	{
+		lMips.push_back(std::vector<unsigned char>());
+		CompressImage(&lLevel[0], uiMipWidth, uiMipHeight, bAlpha, lMips.back());
+
+		if( uiMipWidth == 1 && uiMipHeight == 1 )
+			break;
+
+		std::vector<unsigned char> lNext;
+		Downsample(lLevel, uiMipWidth, uiMipHeight, lNext);
+		lLevel.swap(lNext);
+		uiMipWidth = uiMipWidth > 1 ? uiMipWidth / 2 : 1;
+		uiMipHeight = uiMipHeight > 1 ? uiMipHeight / 2 : 1;
+	}
+
+	return wolf::SaveDDS(p_strCompressedFile, bAlpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, uiWidth, uiHeight, lMips);
+}
+
+//----------------------------------------------------------
+// Compresses each of the given files that doesn't have an up
+// to date compressed version. Returns how many it did.
+//----------------------------------------------------------
+unsigned int TextureCompressor::CompressStale(const std::vector<std::string>& p_lFiles)
+{
+	unsigned int uiCompressed = 0;
+	for( unsigned int i = 0; i < p_lFiles.size(); i++ )
+	{
+		if( IsUpToDate(p_lFiles[i]) )
+			continue;
+
+		if( CompressFile(p_lFiles[i], GetCompressedFileName(p_lFiles[i])) )
+			uiCompressed++;
+		else
+			printf("ERROR: Couldn't compress texture - %s!\n", p_lFiles[i].c_str());
+	}
+	return uiCompressed;
+}
+
+//----------------------------------------------------------
+// Compresses one mip level into DXT1 (8 bytes a block) or,
+// with alpha, DXT5 (16 bytes a block) blocks. Blocks hanging
+// off the edge repeat the edge pixels.
+//----------------------------------------------------------
+void TextureCompressor::CompressImage(const unsigned char* p_pRGBA, unsigned int p_uiWidth, unsigned int p_uiHeight, bool p_bAlpha, std::vector<unsigned char>& p_lOut)
+{
+	unsigned int uiBlocksX = (p_uiWidth + 3) / 4, uiBlocksY = (p_uiHeight + 3) / 4;
+	unsigned int uiBlockSize = p_bAlpha ? 16 : 8;
+	p_lOut.resize(uiBlocksX * uiBlocksY * uiBlockSize);
+
+	unsigned char* pOut = &p_lOut[0];
+	for( unsigned int by = 0; by < uiBlocksY; by++ )
+	{
+		for( unsigned int bx = 0; bx < uiBlocksX; bx++ )
+		{
+			unsigned char aucBlock[16 * 4];
+			for( unsigned int y = 0; y < 4; y++ )
+			{
+				unsigned int uiY = std::min(by * 4 + y, p_uiHeight - 1);
+				for( unsigned int x = 0; x < 4; x++ )
+				{
+					unsigned int uiX = std::min(bx * 4 + x, p_uiWidth - 1);
+					memcpy(&aucBlock[(y * 4 + x) * 4], &p_pRGBA[(uiY * p_uiWidth + uiX) * 4], 4);
+				}
+			}
+
+			if( p_bAlpha )
+			{
+				CompressAlphaBlock(aucBlock, pOut);
+				pOut += 8;
+			}
+			CompressColorBlock(aucBlock, pOut);
+			pOut += 8;
+		}
+	}
+}
+
+//----------------------------------------------------------
+// Encodes the colours of a 4x4 RGBA block as a DXT1 colour
+// block: two 5:6:5 end points spanning the block's bounding
+// box, and a 2 bit index per pixel into them and the two
+// colours in between
+//----------------------------------------------------------
+void TextureCompressor::CompressColorBlock(const unsigned char* p_pBlock, unsigned char* p_pOut)
+{
+	unsigned char aucMin[4] = { 255, 255, 255, 255 }, aucMax[4] = { 0, 0, 0, 0 };
+	for( unsigned int i = 0; i < 16; i++ )
+	{
+		for( unsigned int c = 0; c < 3; c++ )
+		{
+			aucMin[c] = std::min(aucMin[c], p_pBlock[i * 4 + c]);
+			aucMax[c] = std::max(aucMax[c], p_pBlock[i * 4 + c]);
+		}
+	}
+
+	// Pull the end points in a little; the box corners are usually outliers
+	for( unsigned int c = 0; c < 3; c++ )
+	{
+		int iInset = (aucMax[c] - aucMin[c]) / 16;
+		aucMin[c] = (unsigned char)(aucMin[c] + iInset);
+		aucMax[c] = (unsigned char)(aucMax[c] - iInset);
+	}
+
+	// The first end point must be the larger, or it's read as 3 colour mode
+	unsigned short usColor0 = To565(aucMax), usColor1 = To565(aucMin);
+	if( usColor0 < usColor1 )
+		std::swap(usColor0, usColor1);
+
+	unsigned int uiIndices = 0;
+	if( usColor0 != usColor1 )
+	{
+		int aaiPalette[4][3];
+		From565(usColor0, aaiPalette[0]);
+		From565(usColor1, aaiPalette[1]);
+		for( unsigned int c = 0; c < 3; c++ )
+		{
+			aaiPalette[2][c] = (2 * aaiPalette[0][c] + aaiPalette[1][c]) / 3;
+			aaiPalette[3][c] = (aaiPalette[0][c] + 2 * aaiPalette[1][c]) / 3;
+		}
+
+		for( unsigned int i = 0; i < 16; i++ )
+		{
+			unsigned int uiBest = 0;
+			int iBestDist = 0x7FFFFFFF;
+			for( unsigned int p = 0; p < 4; p++ )
+			{
+				int iDist = 0;
+				for( unsigned int c = 0; c < 3; c++ )
+				{
+					int iDiff = p_pBlock[i * 4 + c] - aaiPalette[p][c];
+					iDist += iDiff * iDiff;
+				}
+				if( iDist < iBestDist )
+				{
+					iBestDist = iDist;
+					uiBest = p;
+				}
+			}
+			uiIndices |= uiBest << (i * 2);
+		}
+	}
+
+	p_pOut[0] = (unsigned char)(usColor0 & 0xFF);
+	p_pOut[1] = (unsigned char)(usColor0 >> 8);
+	p_pOut[2] = (unsigned char)(usColor1 & 0xFF);
+	p_pOut[3] = (unsigned char)(usColor1 >> 8);
+	for( unsigned int i = 0; i < 4; i++ )
+		p_pOut[4 + i] = (unsigned char)(uiIndices >> (i * 8));
+}
+
+//----------------------------------------------------------
+// Encodes the alpha of a 4x4 RGBA block as a DXT5 alpha
+// block: the block's max and min alpha, and a 3 bit index
+// per pixel into them and the six values in between
+//----------------------------------------------------------
+void TextureCompressor::CompressAlphaBlock(const unsigned char* p_pBlock, unsigned char* p_pOut)
+{
+	unsigned char ucMin = 255, ucMax = 0;
+	for( unsigned int i = 0; i < 16; i++ )
+	{
+		ucMin = std::min(ucMin, p_pBlock[i * 4 + 3]);
+		ucMax = std::max(ucMax, p_pBlock[i * 4 + 3]);
+	}
+
+	unsigned long long ullIndices = 0;
+	if( ucMax != ucMin )
+	{
+		int aiPalette[8];
+		aiPalette[0] = ucMax;
+		aiPalette[1] = ucMin;
+		for( int p = 2; p < 8; p++ )
+			aiPalette[p] = ((8 - p) * ucMax + (p - 1) * ucMin) / 7;
+
+		for( unsigned int i = 0; i < 16; i++ )
+		{
+			unsigned long long ullBest = 0;
+			int iBestDist = 256;
+			for( unsigned int p = 0; p < 8; p++ )
+			{
+				int iDist = abs(p_pBlock[i * 4 + 3] - aiPalette[p]);
+				if( iDist < iBestDist )
+				{
+					iBestDist = iDist;
+					ullBest = p;
+				}
+			}
+			ullIndices |= ullBest << (i * 3);
+		}
+	}
+
+	p_pOut[0] = ucMax;
+	p_pOut[1] = ucMin;
+	for( unsigned int i = 0; i < 6; i++ )
+		p_pOut[2 + i] = (unsigned char)(ullIndices >> (i * 8));
+}
+
+//----------------------------------------------------------
+// Halves the given RGBA image in each direction (down to 1),
+// averaging each 2x2 block of pixels
+//----------------------------------------------------------
+void TextureCompressor::Downsample(const std::vector<unsigned char>& p_lSrc, unsigned int p_uiWidth, unsigned int p_uiHeight, std::vector<unsigned char>& p_lDest)
+{
+	unsigned int uiWidth = p_uiWidth > 1 ? p_uiWidth / 2 : 1;
+	unsigned int uiHeight = p_uiHeight > 1 ? p_uiHeight / 2 : 1;
+	p_lDest.resize(uiWidth * uiHeight * 4);
+
+	for( unsigned int y = 0; y < uiHeight; y++ )
+	{
+		unsigned int uiY0 = std::min(y * 2, p_uiHeight - 1), uiY1 = std::min(y * 2 + 1, p_uiHeight - 1);
+		for( unsigned int x = 0; x < uiWidth; x++ )
+		{
+			unsigned int uiX0 = std::min(x * 2, p_uiWidth - 1), uiX1 = std::min(x * 2 + 1, p_uiWidth - 1);
+			for( unsigned int c = 0; c < 4; c++ )
+			{
+				unsigned int uiSum = p_lSrc[(uiY0 * p_uiWidth + uiX0) * 4 + c] + p_lSrc[(uiY0 * p_uiWidth + uiX1) * 4 + c] +
+									 p_lSrc[(uiY1 * p_uiWidth + uiX0) * 4 + c] + p_lSrc[(uiY1 * p_uiWidth + uiX1) * 4 + c];
+				p_lDest[(y * uiWidth + x) * 4 + c] = (unsigned char)((uiSum + 2) / 4);
+			}
+		}
+	}
+}
+
+}
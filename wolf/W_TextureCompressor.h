@@ -0,0 +1,52 @@
+//-----------------------------------------------------------------------------
+// File:			W_TextureCompressor.h
+// Original Author:	agent
+//
+// Offline step that converts TGA textures to GPU compressed DDS files with a
+// full mip chain: DXT1 (BC1) if the image is opaque, DXT5 (BC3) if it has
+// alpha. That's a quarter to an eighth of the memory and load bandwidth of the
+// TGA, and no glGenerateMipmap at load.
+//
+// The compressed file is saved next to the TGA with a .dds extension, and
+// Texture loads it instead of the TGA whenever it's up to date. Rows are kept
+// in the TGA's bottom up order, so UVs work the same either way.
+//
+// The encoder is a quick bounding box fit; fine for props and environment
+// textures, less so for text and UI, which are better left as TGA.
+//-----------------------------------------------------------------------------
+#ifndef W_TEXTURECOMPRESSOR_H
+#define W_TEXTURECOMPRESSOR_H
+
+#include "W_Types.h"
+#include <string>
+#include <vector>
+
+namespace wolf
+{
+class TextureCompressor
+{
+	public:
+		//-------------------------------------------------------------------------
+		// PUBLIC INTERFACE
+		//-------------------------------------------------------------------------
+		static std::string GetCompressedFileName(const std::string& p_strFile);
+		static bool IsUpToDate(const std::string& p_strFile);
+
+		static bool CompressFile(const std::string& p_strFile, const std::string& p_strCompressedFile);
+		static unsigned int CompressStale(const std::vector<std::string>& p_lFiles);
+		//-------------------------------------------------------------------------
+
+	private:
+		//-------------------------------------------------------------------------
+		// PRIVATE METHODS
+		//-------------------------------------------------------------------------
+		static void CompressImage(const unsigned char* p_pRGBA, unsigned int p_uiWidth, unsigned int p_uiHeight, bool p_bAlpha, std::vector<unsigned char>& p_lOut);
+		static void CompressColorBlock(const unsigned char* p_pBlock, unsigned char* p_pOut);
+		static void CompressAlphaBlock(const unsigned char* p_pBlock, unsigned char* p_pOut);
+		static void Downsample(const std::vector<unsigned char>& p_lSrc, unsigned int p_uiWidth, unsigned int p_uiHeight, std::vector<unsigned char>& p_lDest);
+		//-------------------------------------------------------------------------
+};
+
+}
+
+#endif
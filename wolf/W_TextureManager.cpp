@@ -10,13 +10,46 @@ namespace wolf
 {
 
 std::map<std::string, TextureManager::Entry*>	TextureManager::m_textures;
+std::map<std::string, TextureManager::Entry*>	TextureManager::m_regions;
+std::vector<TextureAtlas*>						TextureManager::m_atlases;
+unsigned int									TextureManager::m_uiMemoryBudget = 0xFFFFFFFF;
 
 //----------------------------------------------------------
 // Creates a new texture or returns an existing copy if already
-// loaded previously
+// loaded previously. If the file's in an atlas, the texture
+// is its region of the atlas, unless p_bAllowAtlas is false
+// (for things whose UVs can't be remapped, or that need to
+// repeat).
 //----------------------------------------------------------
-Texture* TextureManager::CreateTexture(const std::string& p_strFile)
+Texture* TextureManager::CreateTexture(const std::string& p_strFile, bool p_bAllowAtlas)
 {
+	return CreateTexture(p_strFile, false, p_bAllowAtlas);
+}
+
+//----------------------------------------------------------
+// Same as CreateTexture(), but a new texture is loaded in the
+// background by AssetLoader and is a placeholder until it's
+// done (see Texture::IsLoaded()). Atlas regions are ready
+// straight away.
+//----------------------------------------------------------
+Texture* TextureManager::CreateTextureAsync(const std::string& p_strFile, bool p_bAllowAtlas)
+{
+	return CreateTexture(p_strFile, true, p_bAllowAtlas);
+}
+
+//----------------------------------------------------------
+// Does the work for both of the above. An existing copy is
+// returned as is, even if it's still loading.
+//----------------------------------------------------------
+Texture* TextureManager::CreateTexture(const std::string& p_strFile, bool p_bAsync, bool p_bAllowAtlas)
+{
+	if( p_bAllowAtlas )
+	{
+		Texture* pRegion = CreateAtlasRegion(p_strFile);
+		if( pRegion )
+			return pRegion;
+	}
+
 	std::map<std::string, Entry*>::iterator iter = m_textures.find(p_strFile);
 
 	if( iter != m_textures.end() )
@@ -25,12 +58,72 @@ Texture* TextureManager::CreateTexture(const std::string& p_strFile)
 		return iter->second->m_pTex;
 	}
 
-	Texture* pTex = new Texture(p_strFile);
+	Texture* pTex = new Texture(p_strFile, p_bAsync);
 	Entry* pEntry = new Entry(pTex);
+	pEntry->m_iRefCount++;
 	m_textures[p_strFile] = pEntry;
 	return pTex;
 }
 
+//----------------------------------------------------------
+// Returns a texture for the given file's region of whichever
+// atlas it's in, or NULL if it's in none
+//----------------------------------------------------------
+Texture* TextureManager::CreateAtlasRegion(const std::string& p_strFile)
+{
+	std::map<std::string, Entry*>::iterator iter = m_regions.find(p_strFile);
+
+	if( iter != m_regions.end() )
+	{
+		iter->second->m_iRefCount++;
+		return iter->second->m_pTex;
+	}
+
+	for( unsigned int i = 0; i < m_atlases.size(); i++ )
+	{
+		const TextureAtlas::Region* pRegion = m_atlases[i]->FindRegion(p_strFile);
+		if( !pRegion )
+			continue;
+
+		Texture* pTex = new Texture(m_atlases[i]->GetTexture(), pRegion->m_vUVRect, pRegion->m_uiWidth, pRegion->m_uiHeight);
+		Entry* pEntry = new Entry(pTex);
+		pEntry->m_iRefCount++;
+		m_regions[p_strFile] = pEntry;
+		return pTex;
+	}
+
+	return 0;
+}
+
+//----------------------------------------------------------
+// Packs the given files into a new atlas. Only affects
+// textures created after this. Returns false if the atlas
+// couldn't be built.
+//----------------------------------------------------------
+bool TextureManager::CreateAtlas(const std::vector<std::string>& p_lFiles)
+{
+	TextureAtlas* pAtlas = new TextureAtlas();
+	if( !pAtlas->Build(p_lFiles) )
+	{
+		delete pAtlas;
+		return false;
+	}
+
+	m_atlases.push_back(pAtlas);
+	return true;
+}
+
+//----------------------------------------------------------
+// Deletes all the atlases. Any region textures still around
+// can't be drawn with after this.
+//----------------------------------------------------------
+void TextureManager::DestroyAtlases()
+{
+	for( unsigned int i = 0; i < m_atlases.size(); i++ )
+		delete m_atlases[i];
+	m_atlases.clear();
+}
+
 //----------------------------------------------------------
 // When creating directly from data, we don't check for duplicates
 // and just delegate directly to the texture class
@@ -45,9 +138,25 @@ Texture* TextureManager::CreateTexture(void* p_pData, unsigned int p_uiWidth, un
 // is down to 0.
 //----------------------------------------------------------
 void TextureManager::DestroyTexture(Texture* p_pTex)
+{
+	if( Release(m_textures, p_pTex) || Release(m_regions, p_pTex) )
+		return;
+
+	// If we got here, it can only be via a from-data texture which wasn't in
+	// the list (unless the pointer being passed in is dodgy in which case we're
+	// in trouble anyway).
+	delete p_pTex;
+}
+
+//----------------------------------------------------------
+// Drops a reference to the given texture if it's in the given
+// map, deleting it if that was the last. Returns false if it
+// isn't in there.
+//----------------------------------------------------------
+bool TextureManager::Release(std::map<std::string, Entry*>& p_map, Texture* p_pTex)
 {
 	std::map<std::string, Entry*>::iterator iter;
-	for( iter = m_textures.begin(); iter != m_textures.end(); iter++ )
+	for( iter = p_map.begin(); iter != p_map.end(); iter++ )
 	{
 		if( iter->second->m_pTex == p_pTex )
 		{
@@ -55,18 +164,60 @@ void TextureManager::DestroyTexture(Texture* p_pTex)
 			if( iter->second->m_iRefCount == 0 )
 			{
 				delete iter->second->m_pTex;
-				m_textures.erase(iter);
+				delete iter->second;
+				p_map.erase(iter);
 			}
-			return;
+			return true;
 		}
 	}
-
-	// If we got here, it can only be via a from-data texture which wasn't in
-	// the list (unless the pointer being passed in is dodgy in which case we're
-	// in trouble anyway).
-	delete p_pTex;
+	return false;
 }
 
+//----------------------------------------------------------
+// Returns the estimated video memory used by all the loaded
+// texture files
+//----------------------------------------------------------
+unsigned int TextureManager::GetTextureMemoryUsed()
+{
+	unsigned int uiBytes = 0;
+	std::map<std::string, Entry*>::iterator iter;
+	for( iter = m_textures.begin(); iter != m_textures.end(); iter++ )
+		uiBytes += iter->second->m_pTex->GetResidentBytes();
+	return uiBytes;
 }
 
+//----------------------------------------------------------
+// Uploads waiting mip levels, up to the given number of bytes
+// (but at least one level, if there's room in the budget).
+// The smallest waiting level of any texture always goes
+// next, so everything sharpens evenly and whatever doesn't
+// fit in the budget is what stays blurry. Call once a frame.
+//----------------------------------------------------------
+void TextureManager::StreamMips(unsigned int p_uiMaxBytesPerFrame)
+{
+	unsigned int uiUsed = GetTextureMemoryUsed();
+	unsigned int uiUploaded = 0;
+	for(;;)
+	{
+		Texture* pNext = 0;
+		std::map<std::string, Entry*>::iterator iter;
+		for( iter = m_textures.begin(); iter != m_textures.end(); iter++ )
+		{
+			Texture* pTex = iter->second->m_pTex;
+			if( pTex->IsStreaming() && (!pNext || pTex->GetNextMipDimension() < pNext->GetNextMipDimension()) )
+				pNext = pTex;
+		}
+		if( !pNext )
+			return;
+
+		unsigned int uiBytes = pNext->GetNextMipBytes();
+		if( uiUsed + uiBytes > m_uiMemoryBudget || (uiUploaded > 0 && uiUploaded + uiBytes > p_uiMaxBytesPerFrame) )
+			return;
 
+		pNext->StreamNextMip();
+		uiUsed += uiBytes;
+		uiUploaded += uiBytes;
+	}
+}
+
+}
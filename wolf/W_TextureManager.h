@@ -5,14 +5,24 @@
 // Class to manage textures. Handles creation of them and dealing with duplicate
 // requests for the same texture. Also provides a place for a central means 
 // to reload all textures when a context is lost (in a potential future update)
+//
+// Small textures can be packed into atlases with CreateAtlas(). After that,
+// CreateTexture() on any file in an atlas gives back a Texture for its region
+// of the atlas rather than loading it, unless asked not to.
+//
+// Compressed DDS textures come up with only their small mip levels; call
+// StreamMips() once a frame to bring the rest in, smallest first across all
+// textures, while the total stays under SetTextureMemoryBudget().
 //-----------------------------------------------------------------------------
 #ifndef W_TEXTURE_MANAGER_H
 #define W_TEXTURE_MANAGER_H
 
 #include "W_Types.h"
 #include "W_Texture.h"
+#include "W_TextureAtlas.h"
 #include <string>
 #include <map>
+#include <vector>
 
 namespace wolf
 {
@@ -22,10 +32,18 @@ class TextureManager
 		//-------------------------------------------------------------------------
 		// PUBLIC INTERFACE
 		//-------------------------------------------------------------------------
-		static Texture* CreateTexture(const std::string& p_strFile);
+		static Texture* CreateTexture(const std::string& p_strFile, bool p_bAllowAtlas = true);
+		static Texture* CreateTextureAsync(const std::string& p_strFile, bool p_bAllowAtlas = true);
 		static Texture* CreateTexture(void* p_pData, unsigned int p_uiWidth, unsigned int p_uiHeight, Texture::Format p_eFormat);
 		static void DestroyTexture(Texture* p_pTex);
 
+		static bool CreateAtlas(const std::vector<std::string>& p_lFiles);
+		static void DestroyAtlases();
+
+		static void SetTextureMemoryBudget(unsigned int p_uiBytes) { m_uiMemoryBudget = p_uiBytes; }
+		static unsigned int GetTextureMemoryUsed();
+		static void StreamMips(unsigned int p_uiMaxBytesPerFrame = 1024 * 1024);
+
 		// TODO: You should really have a method like "Cleanup" that will delete
 		// any leftover textures that weren't destroyed by the game, as
 		// a safeguard - or at least prints a warning.
@@ -43,10 +61,25 @@ class TextureManager
 		};
 		//-------------------------------------------------------------------------
 
+		//-------------------------------------------------------------------------
+		// PRIVATE METHODS
+		//-------------------------------------------------------------------------
+		static Texture* CreateTexture(const std::string& p_strFile, bool p_bAsync, bool p_bAllowAtlas);
+		static Texture* CreateAtlasRegion(const std::string& p_strFile);
+		static bool Release(std::map<std::string, Entry*>& p_map, Texture* p_pTex);
+		//-------------------------------------------------------------------------
+
 		//-------------------------------------------------------------------------
 		// PRIVATE MEMBERS
 		//-------------------------------------------------------------------------
 		static std::map<std::string, Entry*>	m_textures;
+
+		// Atlas region textures, kept apart so a file can be both
+		static std::map<std::string, Entry*>	m_regions;
+		static std::vector<TextureAtlas*>		m_atlases;
+
+		// Mip streaming stops short of going over this
+		static unsigned int						m_uiMemoryBudget;
 		//-------------------------------------------------------------------------
 };
 
@@ -41,6 +41,20 @@ enum Attribute
 	AT_NUM_ATTRIBS
 };
 
+// Instanced programs take their world matrix as a mat4 attribute named
+// a_instanceWorld, which uses the four locations starting here. Skinned meshes
+// aren't instanced, so it shares them with the bone attributes.
+static const int AT_InstanceWorld = AT_BoneIndices;
+
+// Uniform blocks shared by all programs. Each is bound to the binding point of
+// the same number, see Program and UniformBuffer.
+enum UniformBlock
+{
+	UB_Frame = 0,
+	UB_Bones,
+	UB_NUM_BLOCKS
+};
+
 enum ComponentType
 {
 	CT_Float = 0,
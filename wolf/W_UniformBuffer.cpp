@@ -0,0 +1,89 @@
+//-----------------------------------------------------------------------------
+// File:			W_UniformBuffer.cpp
+// Original Author:	agent
+//
+// See header for notes
+//-----------------------------------------------------------------------------
+#include "W_UniformBuffer.h"
+
+namespace wolf
+{
+//----------------------------------------------------------
+// Constructor
+//----------------------------------------------------------
+UniformBuffer::UniformBuffer(unsigned int p_uiLength) : m_uiLength(p_uiLength)
+{
+	glGenBuffers(1, &m_uiBuffer);
+	Bind();
+	glBufferData(GL_UNIFORM_BUFFER, m_uiLength, 0, GL_DYNAMIC_DRAW);
+}
+
+//----------------------------------------------------------
+// Destructor
+//----------------------------------------------------------
+UniformBuffer::~UniformBuffer()
+{
+	glDeleteBuffers(1,&m_uiBuffer);
+}
+
+//----------------------------------------------------------
+// Fills this uniform buffer with the given data. It's
+// expected to be rewritten often (every frame), so the old
+// storage is orphaned rather than waited on.
+//----------------------------------------------------------
+void UniformBuffer::Write(const void* p_pData, int p_iLength)
+{
+	Bind();
+	glBufferData(GL_UNIFORM_BUFFER, m_uiLength, 0, GL_DYNAMIC_DRAW);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, p_iLength == -1 ? m_uiLength : p_iLength, p_pData);
+}
+
+//----------------------------------------------------------
+// Orphans the buffer's storage, so it can be filled again
+// with WriteAt() without waiting on draws still reading it
+//----------------------------------------------------------
+void UniformBuffer::Discard()
+{
+	Bind();
+	glBufferData(GL_UNIFORM_BUFFER, m_uiLength, 0, GL_DYNAMIC_DRAW);
+}
+
+//----------------------------------------------------------
+// Writes part of this uniform buffer, leaving the rest. The
+// part written shouldn't be in use by any draw since the
+// last Discard().
+//----------------------------------------------------------
+void UniformBuffer::WriteAt(unsigned int p_uiOffset, const void* p_pData, unsigned int p_uiLength)
+{
+	Bind();
+	glBufferSubData(GL_UNIFORM_BUFFER, p_uiOffset, p_uiLength, p_pData);
+}
+
+//----------------------------------------------------------
+// Binds this buffer
+//----------------------------------------------------------
+void UniformBuffer::Bind()
+{
+	glBindBuffer(GL_UNIFORM_BUFFER, m_uiBuffer);
+}
+
+//----------------------------------------------------------
+// Makes this buffer the source of the given uniform block
+// for all programs
+//----------------------------------------------------------
+void UniformBuffer::BindToBlock(UniformBlock p_eBlock)
+{
+	glBindBufferBase(GL_UNIFORM_BUFFER, p_eBlock, m_uiBuffer);
+}
+
+//----------------------------------------------------------
+// Makes part of this buffer the source of the given uniform
+// block for all programs. The offset must be a multiple of
+// GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT.
+//----------------------------------------------------------
+void UniformBuffer::BindRangeToBlock(UniformBlock p_eBlock, unsigned int p_uiOffset, unsigned int p_uiLength)
+{
+	glBindBufferRange(GL_UNIFORM_BUFFER, p_eBlock, m_uiBuffer, p_uiOffset, p_uiLength);
+}
+
+}
@@ -0,0 +1,56 @@
+//-----------------------------------------------------------------------------
+// File:			W_UniformBuffer.h
+// Original Author:	agent
+//
+// Derived class from wolf::Buffer, this one holding the values of a uniform
+// block. Bound to one of the UniformBlock binding points, every program using
+// that block reads from it.
+//-----------------------------------------------------------------------------
+#ifndef W_UNIFORMBUFFER_H
+#define W_UNIFORMBUFFER_H
+
+#include "W_Types.h"
+#include "W_Buffer.h"
+
+namespace wolf
+{
+class UniformBuffer : public Buffer
+{
+	friend class BufferManager;
+	public:
+		//-------------------------------------------------------------------------
+		// PUBLIC INTERFACE
+		//-------------------------------------------------------------------------
+		virtual void Bind();
+		virtual void Write(const void* p_pData, int p_iLength = -1);
+
+		void BindToBlock(UniformBlock p_eBlock);
+
+		// For buffers holding many blocks' worth of data, written a piece at a
+		// time and bound a range at a time
+		void Discard();
+		void WriteAt(unsigned int p_uiOffset, const void* p_pData, unsigned int p_uiLength);
+		void BindRangeToBlock(UniformBlock p_eBlock, unsigned int p_uiOffset, unsigned int p_uiLength);
+		unsigned int GetLength() const { return m_uiLength; }
+		//-------------------------------------------------------------------------
+
+	private:
+		//-------------------------------------------------------------------------
+		// PRIVATE METHODS
+		//-------------------------------------------------------------------------
+		// Made private to enforce creation and deletion via BufferManager
+		UniformBuffer(unsigned int p_uiLength);
+		virtual ~UniformBuffer();
+		//-------------------------------------------------------------------------
+
+		//-------------------------------------------------------------------------
+		// PRIVATE MEMBERS
+		//-------------------------------------------------------------------------
+		unsigned int		m_uiLength;	
+		GLuint				m_uiBuffer;
+		//-------------------------------------------------------------------------
+};
+
+}
+
+#endif
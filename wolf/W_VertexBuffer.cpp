@@ -42,6 +42,23 @@ void VertexBuffer::Write(const void* p_pData, int p_iLength)
 	glBufferData(GL_ARRAY_BUFFER, p_iLength == -1 ? m_uiLength : p_iLength, p_pData, GL_STATIC_DRAW);
 }
 
+//----------------------------------------------------------
+// Replaces the contents with the given data. Storage is 
+// given back to GL and reallocated first so the write never
+// waits on a draw still reading last frame's data. When the
+// data outgrows the buffer the size is at least doubled, so
+// a buffer that keeps growing reallocates rarely.
+//----------------------------------------------------------
+void VertexBuffer::Stream(const void* p_pData, unsigned int p_uiLength)
+{
+	if( p_uiLength > m_uiLength )
+		m_uiLength = p_uiLength > m_uiLength * 2 ? p_uiLength : m_uiLength * 2;
+
+	Bind();
+	glBufferData(GL_ARRAY_BUFFER, m_uiLength, 0, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, p_uiLength, p_pData);
+}
+
 //----------------------------------------------------------
 // Binds this buffer
 //----------------------------------------------------------
@@ -22,6 +22,10 @@ class VertexBuffer : public Buffer
 		//-------------------------------------------------------------------------
 		virtual void Bind();
 		virtual void Write(const void* p_pData, int p_iLength = -1);
+
+		// For buffers refilled every frame. Orphans the old storage instead
+		// of waiting for draws using it, growing it if the data won't fit.
+		void Stream(const void* p_pData, unsigned int p_uiLength);
 		//-------------------------------------------------------------------------
 
 	private:
@@ -59,6 +59,8 @@ GLboolean g_aNormalizeMap[] =
 	GL_TRUE				// CT_UShortNorm,
 };
 
+GLuint VertexDeclaration::m_vaoCurr = 0;
+
 //----------------------------------------------------------
 // Constructor
 //----------------------------------------------------------
@@ -73,6 +75,9 @@ VertexDeclaration::VertexDeclaration() : m_pVB(0), m_pIB(0), m_vao(0)
 VertexDeclaration::~VertexDeclaration()
 {
 	glDeleteVertexArrays(1, &m_vao);
+
+	if( m_vaoCurr == m_vao )
+		m_vaoCurr = 0;
 }
 
 //----------------------------------------------------------
@@ -83,6 +88,7 @@ VertexDeclaration::~VertexDeclaration()
 void VertexDeclaration::Begin()
 {
 	glBindVertexArray(m_vao);
+	m_vaoCurr = m_vao;
 }
 
 //----------------------------------------------------------
@@ -144,12 +150,29 @@ void VertexDeclaration::AppendAttribute(wolf::Attribute p_attr, int p_iNumCompon
 //----------------------------------------------------------
 void VertexDeclaration::Bind()
 {
+	// Already bound, and the VAO remembers the buffers
+	if( m_vao == m_vaoCurr )
+		return;
+
+	m_vaoCurr = m_vao;
     glBindVertexArray(m_vao);
     m_pVB->Bind();
     if( m_pIB )
         m_pIB->Bind();
 }
 
+//----------------------------------------------------------
+// Forgets which vertex array is bound so the next Bind()
+// rebinds it, along with its buffers. Writing to an index
+// buffer binds it to whatever vertex array is current, so
+// call this before drawing anything that was bound before
+// buffers got written.
+//----------------------------------------------------------
+void VertexDeclaration::InvalidateBindCache()
+{
+	m_vaoCurr = 0;
+}
+
 //----------------------------------------------------------
 // Sets the Vertex Buffer that all the attributes are stored
 // in. Note that this class requires that all attributes be
@@ -32,6 +32,8 @@ class VertexDeclaration
 		void End();
 
 		void Bind();
+
+		static void InvalidateBindCache();
 		//-------------------------------------------------------------------------
 
 	private:
@@ -54,6 +56,9 @@ class VertexDeclaration
 		wolf::VertexBuffer*			m_pVB;
 		wolf::IndexBuffer*			m_pIB;
 		GLuint						m_vao;
+
+		// For caching
+		static GLuint				m_vaoCurr;
 		//-------------------------------------------------------------------------
 };
 